@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+#include <omp.h>
+#endif
+
+#include <aramid/aramid.h>
+
+#include "driver.hpp"
+#include "thread_pool.hpp"
+#include "workloads.hpp"
+
+using namespace aramid::bench;
+
+namespace {
+
+std::vector<std::unique_ptr<Workload>>
+create_workloads(const ARMD_MemoryAllocator *memory_allocator) {
+    std::vector<std::unique_ptr<Workload>> workloads;
+
+    workloads.push_back(create_fib_workload(memory_allocator, 27, 2));
+    workloads.push_back(create_fib_workload(memory_allocator, 35, 16));
+    workloads.push_back(create_nqueens_workload(memory_allocator, 12, 12));
+    workloads.push_back(create_nqueens_workload(memory_allocator, 13, 4));
+    // The expected number of children of a non-root node is 0.99
+    workloads.push_back(create_uts_workload(memory_allocator, 1000, 4, 0.2475));
+    workloads.push_back(create_matmul_workload(memory_allocator, 512, 32));
+    workloads.push_back(create_matmul_workload(memory_allocator, 512, 128));
+    for (ARMD_Size grain_size : {1024, 16384, 262144}) {
+        workloads.push_back(create_parallel_for_workload(
+            memory_allocator, ARMD_Size(1) << 24, grain_size));
+    }
+    for (ARMD_Size grain_size : {1024, 16384, 262144}) {
+        workloads.push_back(create_reduce_workload(
+            memory_allocator, ARMD_Size(1) << 24, grain_size));
+    }
+    workloads.push_back(create_promise_dag_workload(memory_allocator, 100, 64));
+    workloads.push_back(create_ping_pong_workload(memory_allocator, 2000));
+    workloads.push_back(
+        create_promise_callback_workload(memory_allocator, 2000, 10000));
+    workloads.push_back(
+        create_promise_fan_out_workload(memory_allocator, 10000));
+
+    return workloads;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+
+    std::vector<std::unique_ptr<Workload>> workloads =
+        create_workloads(&memory_allocator);
+
+    Reporter reporter(options.format, stdout);
+
+    for (ARMD_Size num_threads : options.num_threads_list) {
+        // Only one of them runs at a time; the others sleep in the meantime
+        ARMD_Context *context =
+            armd_context_create(&memory_allocator, num_threads);
+        if (context == nullptr) {
+            std::fprintf(stderr, "Failed to create a context\n");
+            return 1;
+        }
+        ThreadPool thread_pool(num_threads);
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+        omp_set_num_threads(static_cast<int>(num_threads));
+#endif
+
+        for (const std::unique_ptr<Workload> &workload : workloads) {
+            if (!matches_filter(options, workload->get_name(),
+                                workload->get_params())) {
+                continue;
+            }
+
+            Workload *target = workload.get();
+            auto run = [&](const char *implementation,
+                           const std::function<bool()> &func) {
+                if (!is_implementation_selected(options, implementation)) {
+                    return;
+                }
+
+                // The latencies of the warm-up run are dropped
+                ARMD_Histogram latencies;
+                ARMD_Size num_runs = 0;
+                Result result = measure(
+                    target->get_name(), target->get_params(), implementation,
+                    num_threads, options.num_repeats, target->get_num_ops(),
+                    [&]() {
+                        if (num_runs++ == 1) {
+                            target->take_latencies(&latencies);
+                        }
+                        return func();
+                    });
+                if (target->take_latencies(&latencies)) {
+                    set_latency(&result, latencies);
+                }
+                reporter.report(result);
+            };
+
+            run("aramid", [&]() { return target->run(context); });
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+            run("openmp", [&]() { return target->run_openmp(); });
+#endif
+            run("thread_pool",
+                [&]() { return target->run_thread_pool(&thread_pool); });
+        }
+
+        armd_context_destroy(context);
+    }
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include "driver.hpp"
+#include "primitives.hpp"
+
+using namespace aramid::bench;
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+
+    Reporter reporter(options.format, stdout);
+
+    run_deque_benchmarks(options, &reporter);
+    run_hash_table_benchmarks(options, &reporter);
+    run_memory_region_benchmarks(options, &reporter);
+    run_lock_benchmarks(options, &reporter);
+    run_time_benchmarks(options, &reporter);
+
+    return 0;
+}
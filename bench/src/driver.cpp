@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "driver.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+void print_usage(const char *program) {
+    std::fprintf(
+        stderr,
+        "Usage: %s [options]\n"
+        "  --threads=N,N,...   Thread counts to sweep (default: 1, 2, 4, ...\n"
+        "                      up to the hardware concurrency)\n"
+        "  --repeats=N         Measured runs per case (default: 5)\n"
+        "  --format=FORMAT     table, csv or json (default: table)\n"
+        "  --filter=TEXT       Run only the cases whose benchmark/params\n"
+        "                      contain TEXT\n"
+        "  --impl=NAME,...     Run only the implementations (default: all)\n",
+        program);
+}
+
+std::vector<ARMD_Size> get_default_num_threads_list() {
+    ARMD_Size max_num_threads = std::thread::hardware_concurrency();
+    if (max_num_threads == 0) {
+        max_num_threads = 1;
+    }
+
+    std::vector<ARMD_Size> num_threads_list;
+    for (ARMD_Size num_threads = 1; num_threads < max_num_threads;
+         num_threads *= 2) {
+        num_threads_list.push_back(num_threads);
+    }
+    num_threads_list.push_back(max_num_threads);
+
+    return num_threads_list;
+}
+
+bool parse_num_threads_list(const char *text,
+                            std::vector<ARMD_Size> *num_threads_list) {
+    num_threads_list->clear();
+
+    while (*text != '\0') {
+        char *end;
+        unsigned long value = std::strtoul(text, &end, 10);
+        if (end == text || value == 0) {
+            return false;
+        }
+        num_threads_list->push_back(value);
+
+        if (*end == ',') {
+            ++end;
+        } else if (*end != '\0') {
+            return false;
+        }
+        text = end;
+    }
+
+    return !num_threads_list->empty();
+}
+
+std::vector<std::string> split(const char *text) {
+    std::vector<std::string> items;
+    std::string item;
+    for (; *text != '\0'; ++text) {
+        if (*text == ',') {
+            items.push_back(item);
+            item.clear();
+        } else {
+            item += *text;
+        }
+    }
+    items.push_back(item);
+    return items;
+}
+
+bool starts_with(const char *text, const char *prefix) {
+    return std::strncmp(text, prefix, std::strlen(prefix)) == 0;
+}
+
+void write_json_string(std::FILE *file, const std::string &value) {
+    std::fputc('"', file);
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(c, file);
+    }
+    std::fputc('"', file);
+}
+
+} // namespace
+
+bool parse_options(int argc, char **argv, Options *options) {
+    options->num_threads_list = get_default_num_threads_list();
+    options->num_repeats = 5;
+    options->format = Format::Table;
+    options->filter.clear();
+    options->implementations.clear();
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (starts_with(arg, "--threads=")) {
+            if (!parse_num_threads_list(arg + std::strlen("--threads="),
+                                        &options->num_threads_list)) {
+                print_usage(argv[0]);
+                return false;
+            }
+        } else if (starts_with(arg, "--repeats=")) {
+            int num_repeats = std::atoi(arg + std::strlen("--repeats="));
+            if (num_repeats <= 0) {
+                print_usage(argv[0]);
+                return false;
+            }
+            options->num_repeats = num_repeats;
+        } else if (std::strcmp(arg, "--format=table") == 0) {
+            options->format = Format::Table;
+        } else if (std::strcmp(arg, "--format=csv") == 0) {
+            options->format = Format::Csv;
+        } else if (std::strcmp(arg, "--format=json") == 0) {
+            options->format = Format::Json;
+        } else if (starts_with(arg, "--filter=")) {
+            options->filter = arg + std::strlen("--filter=");
+        } else if (starts_with(arg, "--impl=")) {
+            options->implementations = split(arg + std::strlen("--impl="));
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool matches_filter(const Options &options, const std::string &benchmark,
+                    const std::string &params) {
+    return (benchmark + "/" + params).find(options.filter) !=
+           std::string::npos;
+}
+
+bool is_implementation_selected(const Options &options,
+                                const std::string &implementation) {
+    return options.implementations.empty() ||
+           std::find(options.implementations.begin(),
+                     options.implementations.end(),
+                     implementation) != options.implementations.end();
+}
+
+Result measure(const std::string &benchmark, const std::string &params,
+               const std::string &implementation, ARMD_Size num_threads,
+               ARMD_Size num_repeats, double num_ops,
+               const std::function<bool()> &func) {
+    std::vector<double> seconds_list;
+    for (ARMD_Size i = 0; i < num_repeats + 1; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        bool correct = func();
+        auto end = std::chrono::steady_clock::now();
+
+        if (!correct) {
+            std::fprintf(stderr, "%s/%s (%s, %u threads): wrong result\n",
+                         benchmark.c_str(), params.c_str(),
+                         implementation.c_str(), (unsigned)num_threads);
+            std::exit(1);
+        }
+
+        // The first run is for warm-up
+        if (i != 0) {
+            seconds_list.push_back(
+                std::chrono::duration<double>(end - begin).count());
+        }
+    }
+
+    std::sort(seconds_list.begin(), seconds_list.end());
+
+    double sum_seconds = 0.0;
+    for (double seconds : seconds_list) {
+        sum_seconds += seconds;
+    }
+
+    Result result;
+    result.benchmark = benchmark;
+    result.params = params;
+    result.implementation = implementation;
+    result.num_threads = num_threads;
+    result.num_repeats = num_repeats;
+    result.num_ops = num_ops;
+    result.min_seconds = seconds_list.front();
+    result.median_seconds = seconds_list[seconds_list.size() / 2];
+    result.mean_seconds = sum_seconds / seconds_list.size();
+    result.has_latency = false;
+    result.latency_p50_nanoseconds = 0;
+    result.latency_p99_nanoseconds = 0;
+    result.latency_max_nanoseconds = 0;
+
+    return result;
+}
+
+void set_latency(Result *result, const ARMD_Histogram &histogram) {
+    result->has_latency = true;
+    result->latency_p50_nanoseconds =
+        armd_histogram_get_percentile(&histogram, 50.0);
+    result->latency_p99_nanoseconds =
+        armd_histogram_get_percentile(&histogram, 99.0);
+    result->latency_max_nanoseconds = histogram.max;
+}
+
+void run_in_threads(ARMD_Size num_threads,
+                    const std::function<void(ARMD_Size)> &func) {
+    std::atomic<ARMD_Size> num_waiting(num_threads);
+    std::vector<std::thread> threads;
+    for (ARMD_Size i = 0; i < num_threads; ++i) {
+        threads.emplace_back([i, &num_waiting, &func]() {
+            // Not to measure the thread creation of the others
+            --num_waiting;
+            while (num_waiting.load() != 0) {
+                std::this_thread::yield();
+            }
+
+            func(i);
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+Reporter::Reporter(Format format, std::FILE *file)
+    : format(format), file(file), num_reported(0) {
+    switch (format) {
+    case Format::Table:
+        std::fprintf(
+            file, "%-24s %-24s %-12s %7s %12s %12s %14s %10s %8s %10s %10s\n",
+            "benchmark", "params", "impl", "threads", "min [ms]",
+            "median [ms]", "ops/s", "ns/op", "scaling", "p50 [us]",
+            "p99 [us]");
+        break;
+    case Format::Csv:
+        std::fprintf(file, "benchmark,params,implementation,num_threads,"
+                           "num_repeats,num_ops,min_seconds,median_seconds,"
+                           "mean_seconds,latency_p50_nanoseconds,"
+                           "latency_p99_nanoseconds,"
+                           "latency_max_nanoseconds\n");
+        break;
+    case Format::Json:
+        std::fprintf(file, "[");
+        break;
+    }
+    std::fflush(file);
+}
+
+Reporter::~Reporter() {
+    if (format == Format::Json) {
+        std::fprintf(file, "\n]\n");
+    }
+    std::fflush(file);
+}
+
+void Reporter::report(const Result &result) {
+    switch (format) {
+    case Format::Table: {
+        // Relative to the first thread count, usually 1
+        std::string key = result.benchmark + "/" + result.params + "/" +
+                          result.implementation;
+        if (baseline_seconds.find(key) == baseline_seconds.end()) {
+            baseline_seconds[key] = result.median_seconds;
+        }
+
+        std::fprintf(
+            file, "%-24s %-24s %-12s %7u %12.3f %12.3f %14.4g %10.2f %7.2fx",
+            result.benchmark.c_str(), result.params.c_str(),
+            result.implementation.c_str(), (unsigned)result.num_threads,
+            result.min_seconds * 1e3, result.median_seconds * 1e3,
+            result.num_ops / result.median_seconds,
+            result.median_seconds * 1e9 / result.num_ops,
+            baseline_seconds[key] / result.median_seconds);
+        if (result.has_latency) {
+            std::fprintf(file, " %10.2f %10.2f\n",
+                         result.latency_p50_nanoseconds * 1e-3,
+                         result.latency_p99_nanoseconds * 1e-3);
+        } else {
+            std::fprintf(file, " %10s %10s\n", "-", "-");
+        }
+        break;
+    }
+    case Format::Csv:
+        // params may contain commas
+        std::fprintf(file, "%s,\"%s\",%s,%u,%u,%.17g,%.9g,%.9g,%.9g",
+                     result.benchmark.c_str(), result.params.c_str(),
+                     result.implementation.c_str(),
+                     (unsigned)result.num_threads,
+                     (unsigned)result.num_repeats, result.num_ops,
+                     result.min_seconds, result.median_seconds,
+                     result.mean_seconds);
+        if (result.has_latency) {
+            std::fprintf(file, ",%llu,%llu,%llu\n",
+                         (unsigned long long)result.latency_p50_nanoseconds,
+                         (unsigned long long)result.latency_p99_nanoseconds,
+                         (unsigned long long)result.latency_max_nanoseconds);
+        } else {
+            std::fprintf(file, ",,,\n");
+        }
+        break;
+    case Format::Json:
+        std::fprintf(file, num_reported == 0 ? "\n" : ",\n");
+        std::fprintf(file, "{\"benchmark\":");
+        write_json_string(file, result.benchmark);
+        std::fprintf(file, ",\"params\":");
+        write_json_string(file, result.params);
+        std::fprintf(file, ",\"implementation\":");
+        write_json_string(file, result.implementation);
+        std::fprintf(file,
+                     ",\"num_threads\":%u,\"num_repeats\":%u,\"num_ops\":%.17g,"
+                     "\"min_seconds\":%.9g,\"median_seconds\":%.9g,"
+                     "\"mean_seconds\":%.9g",
+                     (unsigned)result.num_threads,
+                     (unsigned)result.num_repeats, result.num_ops,
+                     result.min_seconds, result.median_seconds,
+                     result.mean_seconds);
+        if (result.has_latency) {
+            std::fprintf(file,
+                         ",\"latency_p50_nanoseconds\":%llu,"
+                         "\"latency_p99_nanoseconds\":%llu,"
+                         "\"latency_max_nanoseconds\":%llu",
+                         (unsigned long long)result.latency_p50_nanoseconds,
+                         (unsigned long long)result.latency_p99_nanoseconds,
+                         (unsigned long long)result.latency_max_nanoseconds);
+        }
+        std::fprintf(file, "}");
+        break;
+    }
+    std::fflush(file);
+
+    ++num_reported;
+}
+
+} // namespace bench
+} // namespace aramid
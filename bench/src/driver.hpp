@@ -0,0 +1,98 @@
+#ifndef ARAMID_BENCH_DRIVER_HPP
+#define ARAMID_BENCH_DRIVER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <aramid/aramid.h>
+
+namespace aramid {
+namespace bench {
+
+enum class Format {
+    Table,
+    Csv,
+    Json,
+};
+
+struct Options {
+    std::vector<ARMD_Size> num_threads_list;
+    ARMD_Size num_repeats;
+    Format format;
+    std::string filter;
+    // Empty for all the implementations
+    std::vector<std::string> implementations;
+};
+
+// Prints the usage and returns false if the options are invalid
+bool parse_options(int argc, char **argv, Options *options);
+
+// Whether "benchmark/params" contains the filter
+bool matches_filter(const Options &options, const std::string &benchmark,
+                    const std::string &params);
+
+// Whether the implementation is selected with --impl
+bool is_implementation_selected(const Options &options,
+                                const std::string &implementation);
+
+struct Result {
+    std::string benchmark;
+    std::string params;
+    std::string implementation;
+    ARMD_Size num_threads;
+    ARMD_Size num_repeats;
+    // The number of operations, e.g. tasks or elements, done in a run
+    double num_ops;
+    double min_seconds;
+    double median_seconds;
+    double mean_seconds;
+    // Set by the benchmarks measuring the latency of each operation
+    bool has_latency;
+    uint64_t latency_p50_nanoseconds;
+    uint64_t latency_p99_nanoseconds;
+    uint64_t latency_max_nanoseconds;
+};
+
+// Fills the latency of result from the histogram in nanoseconds
+void set_latency(Result *result, const ARMD_Histogram &histogram);
+
+// Runs func once for warm-up, then num_repeats times for the measurement.
+// func returns whether the result of the run is correct; the process exits
+// on an incorrect result.
+Result measure(const std::string &benchmark, const std::string &params,
+               const std::string &implementation, ARMD_Size num_threads,
+               ARMD_Size num_repeats, double num_ops,
+               const std::function<bool()> &func);
+
+// Runs func(thread_index) on num_threads threads which start together and
+// returns after all of them finish
+void run_in_threads(ARMD_Size num_threads,
+                    const std::function<void(ARMD_Size)> &func);
+
+class Reporter {
+public:
+    Reporter(Format format, std::FILE *file);
+    ~Reporter();
+
+    Reporter(const Reporter &) = delete;
+    Reporter &operator=(const Reporter &) = delete;
+
+    void report(const Result &result);
+
+private:
+    Format format;
+    std::FILE *file;
+    ARMD_Size num_reported;
+    // The median of the first report of each case, by
+    // "benchmark/params/implementation", for the scaling column
+    std::map<std::string, double> baseline_seconds;
+};
+
+} // namespace bench
+} // namespace aramid
+
+#endif // ARAMID_BENCH_DRIVER_HPP
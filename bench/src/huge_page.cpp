@@ -0,0 +1,127 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <aramid/aramid.h>
+
+namespace {
+
+const std::size_t page_size = 4096;
+
+typedef struct TAG_StridedAccessArgs {
+    unsigned char *buf;
+    ARMD_Size num_pages;
+    ARMD_Size num_tasks;
+    ARMD_Size num_passes;
+} StridedAccessArgs;
+
+ARMD_Size strided_access_count(void *args, void *frame) {
+    (void)frame;
+    return reinterpret_cast<StridedAccessArgs *>(args)->num_tasks;
+}
+
+// Each task touches one cache line in every num_tasks-th page, so the tasks
+// together sweep the whole buffer with a page-sized stride. The line moves from
+// page to page not to hit the same cache sets on physically contiguous pages.
+int strided_access_continuation(ARMD_Job *job, const void *constants,
+                                void *args, void *frame, ARMD_Size index) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    StridedAccessArgs *typed_args = reinterpret_cast<StridedAccessArgs *>(args);
+    for (ARMD_Size pass = 0; pass < typed_args->num_passes; ++pass) {
+        for (ARMD_Size page = index; page < typed_args->num_pages;
+             page += typed_args->num_tasks) {
+            ARMD_Size line = (page / typed_args->num_tasks + pass) %
+                             (page_size / 64);
+            ++typed_args->buf[page * page_size + line * 64];
+        }
+    }
+
+    return 0;
+}
+
+double run(ARMD_Context *context, ARMD_Procedure *procedure,
+           const ARMD_MemoryAllocator *buffer_allocator, ARMD_Size buffer_size,
+           ARMD_Size num_tasks, ARMD_Size num_passes) {
+    unsigned char *buf = static_cast<unsigned char *>(
+        armd_memory_allocator_allocate(buffer_allocator, buffer_size));
+    if (buf == nullptr) {
+        fprintf(stderr, "Failed to allocate the buffer\n");
+        std::exit(1);
+    }
+
+    StridedAccessArgs args;
+    args.buf = buf;
+    args.num_pages = buffer_size / page_size;
+    args.num_tasks = num_tasks;
+    args.num_passes = num_passes;
+
+    // Fault all the pages in before measurement
+    for (ARMD_Size i = 0; i < buffer_size; i += page_size) {
+        buf[i] = 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    ARMD_Handle promise = armd_invoke(context, procedure, &args, 0, nullptr);
+    armd_await(context, promise);
+
+    auto end = std::chrono::steady_clock::now();
+
+    armd_memory_allocator_free(buffer_allocator, buf);
+
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    ARMD_Size buffer_size_mib = argc > 1 ? std::atoi(argv[1]) : 1024;
+    ARMD_Size num_executors =
+        argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    ARMD_Size num_passes = argc > 3 ? std::atoi(argv[3]) : 16;
+    if (num_executors == 0) {
+        num_executors = 1;
+    }
+
+    const ARMD_Size buffer_size = buffer_size_mib * 1024 * 1024;
+    const ARMD_Size num_tasks = num_executors * 16;
+
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+    ARMD_MemoryAllocator huge_page_memory_allocator;
+    armd_memory_allocator_init_huge_page(&huge_page_memory_allocator);
+
+    ARMD_Context *context =
+        armd_context_create(&memory_allocator, num_executors);
+
+    ARMD_ProcedureBuilder *builder =
+        armd_procedure_builder_create(&memory_allocator, 0, 0);
+    armd_then_parallel_for(builder, strided_access_count,
+                           strided_access_continuation);
+    ARMD_Procedure *procedure =
+        armd_procedure_builder_build_and_destroy(builder);
+
+    printf("buffer: %u MiB, executors: %u, passes: %u\n",
+           (unsigned)buffer_size_mib, (unsigned)num_executors,
+           (unsigned)num_passes);
+
+    double default_seconds = run(context, procedure, &memory_allocator,
+                                 buffer_size, num_tasks, num_passes);
+    printf("default:   %.3f s\n", default_seconds);
+
+    double huge_page_seconds =
+        run(context, procedure, &huge_page_memory_allocator, buffer_size,
+            num_tasks, num_passes);
+    printf("huge page: %.3f s (%.2fx)\n", huge_page_seconds,
+           default_seconds / huge_page_seconds);
+
+    armd_procedure_destroy(procedure);
+    armd_context_destroy(context);
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef ARAMID_BENCH_PRIMITIVES_HPP
+#define ARAMID_BENCH_PRIMITIVES_HPP
+
+#include "driver.hpp"
+
+namespace aramid {
+namespace bench {
+
+// Each function measures the cases of a primitive which match the filter.
+// The multi-threaded cases are swept over options.num_threads_list.
+
+// Push/pop by the owner and steals by the other threads as executors do
+void run_deque_benchmarks(const Options &options, Reporter *reporter);
+
+// Insert/remove and get with sequential keys as promise handles are
+void run_hash_table_benchmarks(const Options &options, Reporter *reporter);
+
+// Allocate/free from every thread on a single-shard and a sharded region
+void run_memory_region_benchmarks(const Options &options, Reporter *reporter);
+
+// Short critical sections under a spinlock and a mutex
+void run_lock_benchmarks(const Options &options, Reporter *reporter);
+
+// Reads of the wall clock, the monotonic clock and the timestamp counter
+void run_time_benchmarks(const Options &options, Reporter *reporter);
+
+} // namespace bench
+} // namespace aramid
+
+#endif // ARAMID_BENCH_PRIMITIVES_HPP
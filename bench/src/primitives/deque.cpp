@@ -0,0 +1,158 @@
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+#include <aramid/aramid.h>
+
+#include "../primitives.hpp"
+#include "../../../lib/src/deque.h"
+#include "../../../lib/src/spinlock.h"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+ARMD_Job *to_job(ARMD_Size value) {
+    return reinterpret_cast<ARMD_Job *>(static_cast<uintptr_t>(value));
+}
+
+// Pushes and pops depth jobs at a time from a single thread
+bool push_pop(ARMD__Deque *deque, ARMD_Size depth, ARMD_Size num_rounds) {
+    bool correct = true;
+    for (ARMD_Size round = 0; round < num_rounds; ++round) {
+        for (ARMD_Size i = 0; i < depth; ++i) {
+            if (armd__deque_enqueue_forward(deque, to_job(i + 1)) != 0) {
+                return false;
+            }
+        }
+        for (ARMD_Size i = 0; i < depth; ++i) {
+            ARMD_Job *job;
+            if (armd__deque_dequeue_forward(deque, &job) != 0 ||
+                job != to_job(depth - i)) {
+                correct = false;
+            }
+        }
+    }
+    return correct;
+}
+
+typedef struct TAG_StealState {
+    ARMD__Spinlock lock;
+    ARMD__Deque *deque;
+    ARMD_Size num_jobs;
+    std::atomic<bool> done;
+    std::atomic<ARMD_Size> num_consumed;
+} StealState;
+
+ARMD_Bool try_dequeue(StealState *state, ARMD_Bool forward) {
+    int res = 0;
+    (void)res;
+
+    ARMD_Job *job;
+    res = armd__spinlock_lock(&state->lock);
+    assert(res == 0);
+    int status = forward ? armd__deque_dequeue_forward(state->deque, &job)
+                         : armd__deque_dequeue_back(state->deque, &job);
+    res = armd__spinlock_unlock(&state->lock);
+    assert(res == 0);
+
+    return status == 0;
+}
+
+// Thread 0 is the owner; it pushes every job and pops half as often as an
+// executor forking two children does. The others steal from the other end.
+void steal_thread(StealState *state, ARMD_Size thread_index) {
+    int res = 0;
+    (void)res;
+
+    ARMD_Size num_consumed = 0;
+    if (thread_index == 0) {
+        for (ARMD_Size i = 0; i < state->num_jobs; ++i) {
+            res = armd__spinlock_lock(&state->lock);
+            assert(res == 0);
+            if (armd__deque_enqueue_forward(state->deque, to_job(i + 1)) !=
+                0) {
+                std::abort();
+            }
+            res = armd__spinlock_unlock(&state->lock);
+            assert(res == 0);
+
+            if ((i & 1) != 0 && try_dequeue(state, 1)) {
+                ++num_consumed;
+            }
+        }
+
+        while (try_dequeue(state, 1)) {
+            ++num_consumed;
+        }
+        state->done = true;
+    } else {
+        while (!state->done) {
+            if (try_dequeue(state, 0)) {
+                ++num_consumed;
+            }
+        }
+    }
+
+    state->num_consumed += num_consumed;
+}
+
+} // namespace
+
+void run_deque_benchmarks(const Options &options, Reporter *reporter) {
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create(&memory_allocator);
+
+    const ARMD_Size num_push_pop_ops = ARMD_Size(1) << 23;
+    for (ARMD_Size depth : {1, 64, 4096}) {
+        std::string params = "depth=" + std::to_string(depth);
+        if (!matches_filter(options, "deque_push_pop", params)) {
+            continue;
+        }
+
+        // The first run for warm-up grows the buffer
+        ARMD__Deque *deque = armd__deque_create(memory_region, 128);
+        ARMD_Size num_rounds = num_push_pop_ops / 2 / depth;
+        reporter->report(measure("deque_push_pop", params, "aramid", 1,
+                                 options.num_repeats, num_push_pop_ops,
+                                 [deque, depth, num_rounds]() {
+                                     return push_pop(deque, depth, num_rounds);
+                                 }));
+        armd__deque_destroy(deque);
+    }
+
+    const ARMD_Size num_jobs = ARMD_Size(1) << 20;
+    std::string params = "n=" + std::to_string(num_jobs);
+    if (matches_filter(options, "deque_steal", params)) {
+        for (ARMD_Size num_threads : options.num_threads_list) {
+            StealState state;
+            armd__spinlock_init(&state.lock);
+            state.deque = armd__deque_create(memory_region, 128);
+            state.num_jobs = num_jobs;
+
+            // A push and a pop or steal per job
+            reporter->report(measure(
+                "deque_steal", params, "aramid", num_threads,
+                options.num_repeats, 2.0 * num_jobs, [&state, num_threads]() {
+                    state.done = false;
+                    state.num_consumed = 0;
+                    run_in_threads(num_threads, [&state](ARMD_Size index) {
+                        steal_thread(&state, index);
+                    });
+                    return state.num_consumed == state.num_jobs;
+                }));
+
+            armd__deque_destroy(state.deque);
+            armd__spinlock_deinit(&state.lock);
+        }
+    }
+
+    armd_memory_region_destroy(memory_region);
+}
+
+} // namespace bench
+} // namespace aramid
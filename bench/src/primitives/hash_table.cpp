@@ -0,0 +1,107 @@
+#include <cstdint>
+
+#include <aramid/aramid.h>
+
+#include "../primitives.hpp"
+#include "../../../lib/src/hash_table.h"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+void *to_value(ARMD_Handle key) {
+    return reinterpret_cast<void *>(static_cast<uintptr_t>(key));
+}
+
+bool insert_remove(ARMD__HashTable *hash_table, ARMD_Handle first_key,
+                   ARMD_Size num_entries) {
+    for (ARMD_Size i = 0; i < num_entries; ++i) {
+        ARMD_Handle key = first_key + i;
+        if (armd__hash_table_insert(hash_table, key, to_value(key)) != 0) {
+            return false;
+        }
+    }
+    for (ARMD_Size i = 0; i < num_entries; ++i) {
+        if (armd__hash_table_remove(hash_table, first_key + i) != 0) {
+            return false;
+        }
+    }
+    return armd__hash_table_is_empty(hash_table);
+}
+
+bool get(ARMD__HashTable *hash_table, ARMD_Size num_entries,
+         ARMD_Size num_rounds) {
+    bool correct = true;
+    for (ARMD_Size round = 0; round < num_rounds; ++round) {
+        for (ARMD_Size i = 0; i < num_entries; ++i) {
+            void *value;
+            if (armd__hash_table_get(hash_table, i + 1, &value) != 0 ||
+                value != to_value(i + 1)) {
+                correct = false;
+            }
+        }
+    }
+    return correct;
+}
+
+} // namespace
+
+void run_hash_table_benchmarks(const Options &options, Reporter *reporter) {
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create(&memory_allocator);
+
+    // Keep the number of operations per run about the same for every size
+    const ARMD_Size num_ops = ARMD_Size(1) << 22;
+
+    for (ARMD_Size num_entries : {16, 1024, 65536, 1048576}) {
+        std::string params = "n=" + std::to_string(num_entries);
+        ARMD_Size num_rounds =
+            num_entries < num_ops ? num_ops / num_entries : 1;
+
+        if (matches_filter(options, "hash_table_insert_remove", params)) {
+            // The same initial size and rehash ratio as the promise table.
+            // Fresh keys in every round as handles are never reused.
+            ARMD__HashTable *hash_table =
+                armd__hash_table_create(memory_region, 16, 0.5f);
+            ARMD_Handle first_key = 1;
+            reporter->report(measure(
+                "hash_table_insert_remove", params, "aramid", 1,
+                options.num_repeats, 2.0 * num_entries * num_rounds, [&]() {
+                    bool correct = true;
+                    for (ARMD_Size round = 0; round < num_rounds; ++round) {
+                        correct = insert_remove(hash_table, first_key,
+                                                num_entries) &&
+                                  correct;
+                        first_key += num_entries;
+                    }
+                    return correct;
+                }));
+            armd__hash_table_destroy(hash_table);
+        }
+
+        if (matches_filter(options, "hash_table_get", params)) {
+            ARMD__HashTable *hash_table =
+                armd__hash_table_create(memory_region, 16, 0.5f);
+            for (ARMD_Size i = 0; i < num_entries; ++i) {
+                armd__hash_table_insert(hash_table, i + 1, to_value(i + 1));
+            }
+            reporter->report(measure(
+                "hash_table_get", params, "aramid", 1, options.num_repeats,
+                static_cast<double>(num_entries * num_rounds), [&]() {
+                    return get(hash_table, num_entries, num_rounds);
+                }));
+            for (ARMD_Size i = 0; i < num_entries; ++i) {
+                armd__hash_table_remove(hash_table, i + 1);
+            }
+            armd__hash_table_destroy(hash_table);
+        }
+    }
+
+    armd_memory_region_destroy(memory_region);
+}
+
+} // namespace bench
+} // namespace aramid
@@ -0,0 +1,81 @@
+#include <cassert>
+
+#include <aramid/aramid.h>
+
+#include "../primitives.hpp"
+#include "../../../lib/src/mutex.h"
+#include "../../../lib/src/spinlock.h"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+typedef struct TAG_LockState {
+    ARMD__Spinlock spinlock;
+    ARMD__Mutex mutex;
+    ARMD_Size counter;
+} LockState;
+
+template <class Lock, int (*lock)(Lock *), int (*unlock)(Lock *)>
+void increment(Lock *target, ARMD_Size *counter, ARMD_Size num_increments) {
+    int res = 0;
+    (void)res;
+
+    for (ARMD_Size i = 0; i < num_increments; ++i) {
+        res = lock(target);
+        assert(res == 0);
+        ++*counter;
+        res = unlock(target);
+        assert(res == 0);
+    }
+}
+
+} // namespace
+
+void run_lock_benchmarks(const Options &options, Reporter *reporter) {
+    const ARMD_Size num_increments_per_thread = ARMD_Size(1) << 20;
+    std::string params = "n=" + std::to_string(num_increments_per_thread);
+    if (!matches_filter(options, "lock", params)) {
+        return;
+    }
+
+    LockState state;
+    armd__spinlock_init(&state.spinlock);
+    armd__mutex_init(&state.mutex);
+
+    for (ARMD_Size num_threads : options.num_threads_list) {
+        ARMD_Size expected = num_increments_per_thread * num_threads;
+
+        reporter->report(measure(
+            "lock", params, "spinlock", num_threads, options.num_repeats,
+            static_cast<double>(expected), [&]() {
+                state.counter = 0;
+                run_in_threads(num_threads, [&](ARMD_Size) {
+                    increment<ARMD__Spinlock, armd__spinlock_lock,
+                              armd__spinlock_unlock>(&state.spinlock,
+                                                     &state.counter,
+                                                     num_increments_per_thread);
+                });
+                return state.counter == expected;
+            }));
+
+        reporter->report(measure(
+            "lock", params, "mutex", num_threads, options.num_repeats,
+            static_cast<double>(expected), [&]() {
+                state.counter = 0;
+                run_in_threads(num_threads, [&](ARMD_Size) {
+                    increment<ARMD__Mutex, armd__mutex_lock,
+                              armd__mutex_unlock>(&state.mutex, &state.counter,
+                                                  num_increments_per_thread);
+                });
+                return state.counter == expected;
+            }));
+    }
+
+    armd__mutex_deinit(&state.mutex);
+    armd__spinlock_deinit(&state.spinlock);
+}
+
+} // namespace bench
+} // namespace aramid
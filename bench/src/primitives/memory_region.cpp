@@ -0,0 +1,78 @@
+#include <atomic>
+
+#include <aramid/aramid.h>
+
+#include "../primitives.hpp"
+#include "../../../lib/src/memory_region.h"
+#include "../../../lib/src/thread.h"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+const ARMD_Size batch_size = 64;
+const ARMD_Size allocation_size = 64;
+
+// Allocates a batch and frees it, num_rounds times, as jobs come and go
+bool allocate_free(ARMD_MemoryRegion *memory_region, ARMD_Size num_rounds) {
+    void *allocations[batch_size];
+    for (ARMD_Size round = 0; round < num_rounds; ++round) {
+        for (ARMD_Size i = 0; i < batch_size; ++i) {
+            allocations[i] =
+                armd_memory_region_allocate(memory_region, allocation_size);
+            if (allocations[i] == nullptr) {
+                return false;
+            }
+        }
+        for (ARMD_Size i = 0; i < batch_size; ++i) {
+            armd_memory_region_free(memory_region, allocations[i]);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void run_memory_region_benchmarks(const Options &options, Reporter *reporter) {
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+
+    const ARMD_Size num_rounds_per_thread = ARMD_Size(1) << 14;
+    std::string params = "size=" + std::to_string(allocation_size) +
+                         ",batch=" + std::to_string(batch_size);
+    if (!matches_filter(options, "memory_region", params)) {
+        return;
+    }
+
+    for (ARMD_Size num_threads : options.num_threads_list) {
+        // A region shared by all the threads, and a region with a shard per
+        // thread as the context creates for its executors
+        for (bool sharded : {false, true}) {
+            ARMD_MemoryRegion *memory_region =
+                sharded ? armd__memory_region_create_sharded(&memory_allocator,
+                                                             num_threads + 1)
+                        : armd_memory_region_create(&memory_allocator);
+
+            reporter->report(measure(
+                "memory_region", params, sharded ? "sharded" : "single",
+                num_threads, options.num_repeats,
+                2.0 * batch_size * num_rounds_per_thread * num_threads, [&]() {
+                    std::atomic<bool> correct(true);
+                    run_in_threads(num_threads, [&](ARMD_Size index) {
+                        armd__thread_set_slot(index);
+                        if (!allocate_free(memory_region,
+                                           num_rounds_per_thread)) {
+                            correct = false;
+                        }
+                    });
+                    return correct.load();
+                }));
+
+            armd_memory_region_destroy(memory_region);
+        }
+    }
+}
+
+} // namespace bench
+} // namespace aramid
@@ -0,0 +1,76 @@
+#include <cstdint>
+
+#include <aramid/aramid.h>
+
+#include "../primitives.hpp"
+#include "../../../lib/src/time.h"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+// Keeps the reads from being optimized out
+volatile uint64_t sink;
+
+template <class Func>
+void read_clock(ARMD_Size num_reads, const Func &func) {
+    uint64_t sum = 0;
+    for (ARMD_Size i = 0; i < num_reads; ++i) {
+        sum += func();
+    }
+    sink = sum;
+}
+
+} // namespace
+
+void run_time_benchmarks(const Options &options, Reporter *reporter) {
+    const ARMD_Size num_reads_per_thread = ARMD_Size(1) << 20;
+    std::string params = "n=" + std::to_string(num_reads_per_thread);
+    if (!matches_filter(options, "time", params)) {
+        return;
+    }
+
+    // Calibrates the clock out of the measurement
+    armd_get_timestamp();
+
+    for (ARMD_Size num_threads : options.num_threads_list) {
+        double num_ops =
+            static_cast<double>(num_reads_per_thread * num_threads);
+
+        reporter->report(measure(
+            "time", params, "get_time", num_threads, options.num_repeats,
+            num_ops, [&]() {
+                run_in_threads(num_threads, [&](ARMD_Size) {
+                    read_clock(num_reads_per_thread, []() {
+                        ARMD_Timespec timespec;
+                        armd_get_time(&timespec);
+                        return static_cast<uint64_t>(timespec.nanoseconds);
+                    });
+                });
+                return true;
+            }));
+
+        reporter->report(measure(
+            "time", params, "monotonic", num_threads, options.num_repeats,
+            num_ops, [&]() {
+                run_in_threads(num_threads, [&](ARMD_Size) {
+                    read_clock(num_reads_per_thread,
+                               armd__time_get_monotonic_nanoseconds);
+                });
+                return true;
+            }));
+
+        reporter->report(measure(
+            "time", params, "timestamp", num_threads, options.num_repeats,
+            num_ops, [&]() {
+                run_in_threads(num_threads, [&](ARMD_Size) {
+                    read_clock(num_reads_per_thread, armd_get_timestamp);
+                });
+                return true;
+            }));
+    }
+}
+
+} // namespace bench
+} // namespace aramid
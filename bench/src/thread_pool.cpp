@@ -0,0 +1,100 @@
+#include "thread_pool.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+// Whether the current thread is a worker of some pool
+thread_local bool is_worker = false;
+
+} // namespace
+
+ThreadPool::ThreadPool(ARMD_Size num_threads) : stopping(false) {
+    for (ARMD_Size i = 0; i < num_threads; ++i) {
+        threads.emplace_back([this]() { worker_main(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condvar.notify_all();
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(TaskGroup *group, std::function<void()> task) {
+    ++group->num_pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(Task{group, std::move(task)});
+    }
+    condvar.notify_all();
+}
+
+void ThreadPool::wait(TaskGroup *group) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (group->num_pending != 0) {
+        // Takes the newest task, usually a child of the waiting one. Taking
+        // the oldest nests unrelated waits deeper and deeper on the stack.
+        if (is_worker && !queue.empty()) {
+            Task task = std::move(queue.back());
+            queue.pop_back();
+            lock.unlock();
+            run_task(&task);
+            lock.lock();
+            continue;
+        }
+
+        condvar.wait(lock);
+    }
+}
+
+void ThreadPool::parallel_for(ARMD_Size count,
+                              const std::function<void(ARMD_Size)> &func) {
+    TaskGroup group;
+    for (ARMD_Size i = 0; i < count; ++i) {
+        submit(&group, [&func, i]() { func(i); });
+    }
+    wait(&group);
+}
+
+void ThreadPool::worker_main() {
+    is_worker = true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (!queue.empty()) {
+            Task task = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            run_task(&task);
+            lock.lock();
+            continue;
+        }
+
+        if (stopping) {
+            break;
+        }
+
+        condvar.wait(lock);
+    }
+}
+
+void ThreadPool::run_task(Task *task) {
+    task->func();
+
+    if (--task->group->num_pending == 0) {
+        // Under the lock not to slip in between the check and the wait
+        std::lock_guard<std::mutex> lock(mutex);
+        condvar.notify_all();
+    }
+}
+
+} // namespace bench
+} // namespace aramid
@@ -0,0 +1,65 @@
+#ifndef ARAMID_BENCH_THREAD_POOL_HPP
+#define ARAMID_BENCH_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <aramid/aramid.h>
+
+namespace aramid {
+namespace bench {
+
+// A naive thread pool as a baseline: a single FIFO queue under a mutex
+class ThreadPool {
+public:
+    // The tasks submitted together, to be awaited with wait
+    class TaskGroup {
+    public:
+        TaskGroup() : num_pending(0) {}
+
+    private:
+        friend class ThreadPool;
+        std::atomic<ARMD_Size> num_pending;
+    };
+
+    explicit ThreadPool(ARMD_Size num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(TaskGroup *group, std::function<void()> task);
+
+    // Blocks until all the tasks in the group finish. The workers run the
+    // queued tasks while waiting, so that tasks can wait for their children.
+    void wait(TaskGroup *group);
+
+    // Runs func(index) for index in [0, count) with a task per index
+    void parallel_for(ARMD_Size count,
+                      const std::function<void(ARMD_Size)> &func);
+
+private:
+    struct Task {
+        TaskGroup *group;
+        std::function<void()> func;
+    };
+
+    std::mutex mutex;
+    std::condition_variable condvar;
+    std::deque<Task> queue;
+    bool stopping;
+    std::vector<std::thread> threads;
+
+    void worker_main();
+    void run_task(Task *task);
+};
+
+} // namespace bench
+} // namespace aramid
+
+#endif // ARAMID_BENCH_THREAD_POOL_HPP
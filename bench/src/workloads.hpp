@@ -0,0 +1,98 @@
+#ifndef ARAMID_BENCH_WORKLOADS_HPP
+#define ARAMID_BENCH_WORKLOADS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <aramid/aramid.h>
+
+#include "thread_pool.hpp"
+
+namespace aramid {
+namespace bench {
+
+// A workload implemented with libaramid and the baselines to compare with.
+// The procedures and the data are prepared on construction so that the runs
+// measure only the execution. Every implementation computes the same result
+// with the same task granularity.
+class Workload {
+public:
+    virtual ~Workload() {}
+
+    virtual std::string get_name() const = 0;
+    virtual std::string get_params() const = 0;
+    // The number of operations, e.g. tasks or elements, done in a run
+    virtual double get_num_ops() const = 0;
+    // Returns whether the result is correct
+    virtual bool run(ARMD_Context *context) = 0;
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    // With OpenMP tasks or worksharing loops on omp_get_max_threads() threads
+    virtual bool run_openmp() = 0;
+#endif
+    virtual bool run_thread_pool(ThreadPool *thread_pool) = 0;
+    // Moves the latencies in nanoseconds recorded by the runs since the last
+    // call into histogram. Returns false if the workload records none.
+    virtual bool take_latencies(ARMD_Histogram *histogram) {
+        (void)histogram;
+        return false;
+    }
+};
+
+// Doubly recursive Fibonacci with one task per call above cutoff
+std::unique_ptr<Workload>
+create_fib_workload(const ARMD_MemoryAllocator *memory_allocator,
+                    uint64_t input, uint64_t cutoff);
+
+// Counts N-queens solutions with one task per placement above cutoff_row
+std::unique_ptr<Workload>
+create_nqueens_workload(const ARMD_MemoryAllocator *memory_allocator,
+                        ARMD_Size num_queens, ARMD_Size cutoff_row);
+
+// Unbalanced tree search on a binomial tree with one task per node
+std::unique_ptr<Workload>
+create_uts_workload(const ARMD_MemoryAllocator *memory_allocator,
+                    ARMD_Size num_root_children, ARMD_Size num_children,
+                    double branch_probability);
+
+// Blocked square matrix multiplication with one task per output block
+std::unique_ptr<Workload>
+create_matmul_workload(const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD_Size size, ARMD_Size block_size);
+
+// y = a * x + y with one parallel-for index per grain
+std::unique_ptr<Workload>
+create_parallel_for_workload(const ARMD_MemoryAllocator *memory_allocator,
+                             ARMD_Size num_elements, ARMD_Size grain_size);
+
+// Sum with one parallel-for index per grain and a sequential final step
+std::unique_ptr<Workload>
+create_reduce_workload(const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD_Size num_elements, ARMD_Size grain_size);
+
+// Layers of invocations, each depending on two of the previous layer
+std::unique_ptr<Workload>
+create_promise_dag_workload(const ARMD_MemoryAllocator *memory_allocator,
+                            ARMD_Size num_layers, ARMD_Size width);
+
+// Invokes an empty procedure and awaits it, one at a time
+std::unique_ptr<Workload>
+create_ping_pong_workload(const ARMD_MemoryAllocator *memory_allocator,
+                          ARMD_Size num_round_trips);
+
+// Invocations whose callbacks are busy for callback_nanoseconds each. The
+// latency is from the end of each invocation to the start of its callback.
+std::unique_ptr<Workload>
+create_promise_callback_workload(const ARMD_MemoryAllocator *memory_allocator,
+                                 ARMD_Size num_promises,
+                                 uint64_t callback_nanoseconds);
+
+// Invocations which all depend on a single unfinished invocation
+std::unique_ptr<Workload>
+create_promise_fan_out_workload(const ARMD_MemoryAllocator *memory_allocator,
+                                ARMD_Size num_dependents);
+
+} // namespace bench
+} // namespace aramid
+
+#endif // ARAMID_BENCH_WORKLOADS_HPP
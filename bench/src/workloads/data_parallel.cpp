@@ -0,0 +1,321 @@
+#include <vector>
+
+#include <aramid/aramid.h>
+
+#include "../workloads.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+ARMD_Size get_num_grains(ARMD_Size num_elements, ARMD_Size grain_size) {
+    return (num_elements + grain_size - 1) / grain_size;
+}
+
+typedef struct TAG_AxpyArgs {
+    ARMD_Size num_elements;
+    ARMD_Size grain_size;
+    double a;
+    const double *x;
+    const double *y;
+    double *z;
+} AxpyArgs;
+
+ARMD_Size axpy_count(void *args, void *frame) {
+    (void)frame;
+
+    const AxpyArgs *typed_args = reinterpret_cast<const AxpyArgs *>(args);
+    return get_num_grains(typed_args->num_elements, typed_args->grain_size);
+}
+
+int axpy_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame, ARMD_Size index) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    const AxpyArgs *typed_args = reinterpret_cast<const AxpyArgs *>(args);
+    ARMD_Size begin = index * typed_args->grain_size;
+    ARMD_Size end = begin + typed_args->grain_size;
+    if (end > typed_args->num_elements) {
+        end = typed_args->num_elements;
+    }
+
+    double a = typed_args->a;
+    for (ARMD_Size i = begin; i < end; ++i) {
+        typed_args->z[i] = a * typed_args->x[i] + typed_args->y[i];
+    }
+
+    return 0;
+}
+
+class ParallelForWorkload : public Workload {
+public:
+    ParallelForWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                        ARMD_Size num_elements, ARMD_Size grain_size)
+        : num_elements(num_elements),
+          grain_size(grain_size == 0 ? 1 : grain_size), num_runs(0),
+          x(num_elements), y(num_elements), z(num_elements) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_parallel_for(builder, axpy_count, axpy_continuation);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        for (ARMD_Size i = 0; i < num_elements; ++i) {
+            x[i] = static_cast<double>(i & 1023);
+            y[i] = static_cast<double>(i & 7);
+        }
+    }
+
+    ~ParallelForWorkload() override { armd_procedure_destroy(procedure); }
+
+    std::string get_name() const override { return "parallel_for"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(num_elements) +
+               ",grain=" + std::to_string(grain_size);
+    }
+
+    double get_num_ops() const override {
+        return static_cast<double>(num_elements);
+    }
+
+    bool run(ARMD_Context *context) override {
+        AxpyArgs args = get_args();
+
+        ARMD_Handle promise =
+            armd_invoke(context, procedure, &args, 0, nullptr);
+        if (promise == 0 || armd_await(context, promise) != 0) {
+            return false;
+        }
+
+        return check(args);
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        AxpyArgs args = get_args();
+        ARMD_Size num_grains = axpy_count(&args, nullptr);
+
+        // Dynamic as libaramid hands out the indices one by one
+#pragma omp parallel for schedule(dynamic)
+        for (ARMD_Size i = 0; i < num_grains; ++i) {
+            axpy_continuation(nullptr, nullptr, &args, nullptr, i);
+        }
+
+        return check(args);
+    }
+#endif
+
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        AxpyArgs args = get_args();
+        thread_pool->parallel_for(
+            axpy_count(&args, nullptr), [&args](ARMD_Size index) {
+                axpy_continuation(nullptr, nullptr, &args, nullptr, index);
+            });
+
+        return check(args);
+    }
+
+private:
+    ARMD_Size num_elements;
+    ARMD_Size grain_size;
+    ARMD_Size num_runs;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    ARMD_Procedure *procedure;
+
+    AxpyArgs get_args() {
+        AxpyArgs args;
+        args.num_elements = num_elements;
+        args.grain_size = grain_size;
+        // Alternated so that a stale output does not pass the check
+        args.a = (num_runs++ % 2 == 0) ? 2.0 : 3.0;
+        args.x = x.data();
+        args.y = y.data();
+        args.z = z.data();
+        return args;
+    }
+
+    // Samples the output to keep the check out of the measurement
+    bool check(const AxpyArgs &args) const {
+        ARMD_Size stride = num_elements / 1024 + 1;
+        for (ARMD_Size i = 0; i < num_elements; i += stride) {
+            if (z[i] != args.a * x[i] + y[i]) {
+                return false;
+            }
+        }
+        return num_elements == 0 ||
+               z[num_elements - 1] ==
+                   args.a * x[num_elements - 1] + y[num_elements - 1];
+    }
+};
+
+typedef struct TAG_ReduceArgs {
+    ARMD_Size num_elements;
+    ARMD_Size grain_size;
+    const double *x;
+    double *partial_sums;
+    double result;
+} ReduceArgs;
+
+ARMD_Size reduce_count(void *args, void *frame) {
+    (void)frame;
+
+    const ReduceArgs *typed_args = reinterpret_cast<const ReduceArgs *>(args);
+    return get_num_grains(typed_args->num_elements, typed_args->grain_size);
+}
+
+int reduce_continuation1(ARMD_Job *job, const void *constants, void *args,
+                         void *frame, ARMD_Size index) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    ReduceArgs *typed_args = reinterpret_cast<ReduceArgs *>(args);
+    ARMD_Size begin = index * typed_args->grain_size;
+    ARMD_Size end = begin + typed_args->grain_size;
+    if (end > typed_args->num_elements) {
+        end = typed_args->num_elements;
+    }
+
+    double sum = 0.0;
+    for (ARMD_Size i = begin; i < end; ++i) {
+        sum += typed_args->x[i];
+    }
+    typed_args->partial_sums[index] = sum;
+
+    return 0;
+}
+
+int reduce_continuation2(ARMD_Job *job, const void *constants, void *args,
+                         void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    ReduceArgs *typed_args = reinterpret_cast<ReduceArgs *>(args);
+    ARMD_Size num_grains =
+        get_num_grains(typed_args->num_elements, typed_args->grain_size);
+
+    double sum = 0.0;
+    for (ARMD_Size i = 0; i < num_grains; ++i) {
+        sum += typed_args->partial_sums[i];
+    }
+    typed_args->result = sum;
+
+    return 0;
+}
+
+class ReduceWorkload : public Workload {
+public:
+    ReduceWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                   ARMD_Size num_elements, ARMD_Size grain_size)
+        : num_elements(num_elements),
+          grain_size(grain_size == 0 ? 1 : grain_size), x(num_elements),
+          partial_sums(get_num_grains(num_elements, this->grain_size)) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_parallel_for(builder, reduce_count, reduce_continuation1);
+        armd_then_single(builder, reduce_continuation2);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        // Small integers, so that any summation order gives the exact sum
+        expected = 0.0;
+        for (ARMD_Size i = 0; i < num_elements; ++i) {
+            x[i] = static_cast<double>(i & 1023);
+            expected += x[i];
+        }
+    }
+
+    ~ReduceWorkload() override { armd_procedure_destroy(procedure); }
+
+    std::string get_name() const override { return "reduce"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(num_elements) +
+               ",grain=" + std::to_string(grain_size);
+    }
+
+    double get_num_ops() const override {
+        return static_cast<double>(num_elements);
+    }
+
+    bool run(ARMD_Context *context) override {
+        ReduceArgs args = get_args();
+
+        ARMD_Handle promise =
+            armd_invoke(context, procedure, &args, 0, nullptr);
+        if (promise == 0 || armd_await(context, promise) != 0) {
+            return false;
+        }
+
+        return args.result == expected;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        ReduceArgs args = get_args();
+        ARMD_Size num_grains = reduce_count(&args, nullptr);
+
+        double sum = 0.0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : sum)
+        for (ARMD_Size i = 0; i < num_grains; ++i) {
+            reduce_continuation1(nullptr, nullptr, &args, nullptr, i);
+            sum += args.partial_sums[i];
+        }
+
+        return sum == expected;
+    }
+#endif
+
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        ReduceArgs args = get_args();
+        thread_pool->parallel_for(
+            reduce_count(&args, nullptr), [&args](ARMD_Size index) {
+                reduce_continuation1(nullptr, nullptr, &args, nullptr, index);
+            });
+        reduce_continuation2(nullptr, nullptr, &args, nullptr);
+
+        return args.result == expected;
+    }
+
+private:
+    ARMD_Size num_elements;
+    ARMD_Size grain_size;
+    std::vector<double> x;
+    std::vector<double> partial_sums;
+    double expected;
+    ARMD_Procedure *procedure;
+
+    ReduceArgs get_args() {
+        ReduceArgs args;
+        args.num_elements = num_elements;
+        args.grain_size = grain_size;
+        args.x = x.data();
+        args.partial_sums = partial_sums.data();
+        args.result = -1.0;
+        return args;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Workload>
+create_parallel_for_workload(const ARMD_MemoryAllocator *memory_allocator,
+                             ARMD_Size num_elements, ARMD_Size grain_size) {
+    return std::unique_ptr<Workload>(
+        new ParallelForWorkload(memory_allocator, num_elements, grain_size));
+}
+
+std::unique_ptr<Workload>
+create_reduce_workload(const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD_Size num_elements, ARMD_Size grain_size) {
+    return std::unique_ptr<Workload>(
+        new ReduceWorkload(memory_allocator, num_elements, grain_size));
+}
+
+} // namespace bench
+} // namespace aramid
@@ -0,0 +1,218 @@
+#include <cstdint>
+
+#include <aramid/aramid.h>
+
+#include "../workloads.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+typedef struct TAG_FibArgs {
+    uint64_t input;
+    uint64_t *result;
+} FibArgs;
+
+typedef struct TAG_FibFrame {
+    FibArgs child_args[2];
+    uint64_t child_results[2];
+} FibFrame;
+
+typedef struct TAG_FibConstants {
+    ARMD_Procedure *fib_procedure;
+    uint64_t cutoff;
+} FibConstants;
+
+uint64_t fib_serial(uint64_t input) {
+    return input < 2 ? input : fib_serial(input - 1) + fib_serial(input - 2);
+}
+
+int fib_continuation1(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    const FibConstants *typed_constants =
+        reinterpret_cast<const FibConstants *>(constants);
+    FibArgs *typed_args = reinterpret_cast<FibArgs *>(args);
+    FibFrame *typed_frame = reinterpret_cast<FibFrame *>(frame);
+
+    if (typed_args->input < typed_constants->cutoff) {
+        *typed_args->result = fib_serial(typed_args->input);
+        return 0;
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        typed_frame->child_args[i].input = typed_args->input - 1 - i;
+        typed_frame->child_args[i].result = &typed_frame->child_results[i];
+        if (armd_fork(job, typed_constants->fib_procedure,
+                      &typed_frame->child_args[i]) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int fib_continuation2(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)job;
+
+    const FibConstants *typed_constants =
+        reinterpret_cast<const FibConstants *>(constants);
+    FibArgs *typed_args = reinterpret_cast<FibArgs *>(args);
+    FibFrame *typed_frame = reinterpret_cast<FibFrame *>(frame);
+
+    if (typed_args->input >= typed_constants->cutoff) {
+        *typed_args->result =
+            typed_frame->child_results[0] + typed_frame->child_results[1];
+    }
+
+    return 0;
+}
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+uint64_t fib_openmp(uint64_t input, uint64_t cutoff) {
+    if (input < cutoff) {
+        return fib_serial(input);
+    }
+
+    uint64_t child_results[2];
+#pragma omp task shared(child_results)
+    child_results[0] = fib_openmp(input - 1, cutoff);
+#pragma omp task shared(child_results)
+    child_results[1] = fib_openmp(input - 2, cutoff);
+#pragma omp taskwait
+
+    return child_results[0] + child_results[1];
+}
+#endif
+
+uint64_t fib_thread_pool(ThreadPool *thread_pool, uint64_t input,
+                         uint64_t cutoff) {
+    if (input < cutoff) {
+        return fib_serial(input);
+    }
+
+    uint64_t child_results[2];
+    ThreadPool::TaskGroup group;
+    for (int i = 0; i < 2; ++i) {
+        thread_pool->submit(&group, [=, &child_results]() {
+            child_results[i] = fib_thread_pool(thread_pool, input - 1 - i,
+                                               cutoff);
+        });
+    }
+    thread_pool->wait(&group);
+
+    return child_results[0] + child_results[1];
+}
+
+class FibWorkload : public Workload {
+public:
+    FibWorkload(const ARMD_MemoryAllocator *memory_allocator, uint64_t input,
+                uint64_t cutoff)
+        : input(input), cutoff(cutoff < 2 ? 2 : cutoff) {
+        ARMD_ProcedureBuilder *builder = armd_procedure_builder_create(
+            memory_allocator, sizeof(FibConstants), sizeof(FibFrame));
+        armd_then_single(builder, fib_continuation1);
+        armd_then_single(builder, fib_continuation2);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        FibConstants *constants = reinterpret_cast<FibConstants *>(
+            armd_procedure_get_constants(procedure));
+        constants->fib_procedure = procedure;
+        constants->cutoff = this->cutoff;
+
+        uint64_t prev = 0;
+        uint64_t current = 1;
+        for (uint64_t i = 0; i < input; ++i) {
+            uint64_t next = prev + current;
+            prev = current;
+            current = next;
+        }
+        expected = prev;
+    }
+
+    ~FibWorkload() override { armd_procedure_destroy(procedure); }
+
+    std::string get_name() const override { return "fib"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(input) +
+               ",cutoff=" + std::to_string(cutoff);
+    }
+
+    double get_num_ops() const override {
+        // The number of tasks
+        return static_cast<double>(count_tasks(input));
+    }
+
+    bool run(ARMD_Context *context) override {
+        uint64_t result = 0;
+        FibArgs args;
+        args.input = input;
+        args.result = &result;
+
+        ARMD_Handle promise =
+            armd_invoke(context, procedure, &args, 0, nullptr);
+        if (promise == 0 || armd_await(context, promise) != 0) {
+            return false;
+        }
+
+        return result == expected;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        uint64_t result = 0;
+#pragma omp parallel
+#pragma omp single
+        result = fib_openmp(input, cutoff);
+
+        return result == expected;
+    }
+#endif
+
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        uint64_t result = 0;
+        ThreadPool::TaskGroup group;
+        thread_pool->submit(&group, [&]() {
+            result = fib_thread_pool(thread_pool, input, cutoff);
+        });
+        thread_pool->wait(&group);
+
+        return result == expected;
+    }
+
+private:
+    uint64_t input;
+    uint64_t cutoff;
+    uint64_t expected;
+    ARMD_Procedure *procedure;
+
+    uint64_t count_tasks(uint64_t n) const {
+        if (n < cutoff) {
+            return 1;
+        }
+
+        // The calls below cutoff are a task each
+        uint64_t prev = 1;    // tasks(i - 1)
+        uint64_t current = 1; // tasks(i - 2)
+        for (uint64_t i = cutoff; i <= n; ++i) {
+            uint64_t next = 1 + prev + current;
+            current = prev;
+            prev = next;
+        }
+        return prev;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Workload>
+create_fib_workload(const ARMD_MemoryAllocator *memory_allocator,
+                    uint64_t input, uint64_t cutoff) {
+    return std::unique_ptr<Workload>(
+        new FibWorkload(memory_allocator, input, cutoff));
+}
+
+} // namespace bench
+} // namespace aramid
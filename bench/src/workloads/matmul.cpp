@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <vector>
+
+#include <aramid/aramid.h>
+
+#include "../workloads.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+typedef struct TAG_MatmulArgs {
+    ARMD_Size size;
+    ARMD_Size block_size;
+    const double *a;
+    const double *b;
+    double *c;
+} MatmulArgs;
+
+// Computes c[i0..i1][j0..j1] = a[i0..i1][:] * b[:][j0..j1]
+void multiply_block(const MatmulArgs *args, ARMD_Size i0, ARMD_Size i1,
+                    ARMD_Size j0, ARMD_Size j1) {
+    ARMD_Size n = args->size;
+    for (ARMD_Size i = i0; i < i1; ++i) {
+        for (ARMD_Size j = j0; j < j1; ++j) {
+            args->c[i * n + j] = 0.0;
+        }
+        for (ARMD_Size k = 0; k < n; ++k) {
+            double a_ik = args->a[i * n + k];
+            for (ARMD_Size j = j0; j < j1; ++j) {
+                args->c[i * n + j] += a_ik * args->b[k * n + j];
+            }
+        }
+    }
+}
+
+ARMD_Size get_num_blocks_per_side(const MatmulArgs *args) {
+    return (args->size + args->block_size - 1) / args->block_size;
+}
+
+ARMD_Size matmul_count(void *args, void *frame) {
+    (void)frame;
+
+    const MatmulArgs *typed_args = reinterpret_cast<const MatmulArgs *>(args);
+    ARMD_Size num_blocks_per_side = get_num_blocks_per_side(typed_args);
+    return num_blocks_per_side * num_blocks_per_side;
+}
+
+int matmul_continuation(ARMD_Job *job, const void *constants, void *args,
+                        void *frame, ARMD_Size index) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    const MatmulArgs *typed_args = reinterpret_cast<const MatmulArgs *>(args);
+    ARMD_Size n = typed_args->size;
+    ARMD_Size block_size = typed_args->block_size;
+    ARMD_Size num_blocks_per_side = get_num_blocks_per_side(typed_args);
+
+    ARMD_Size i0 = (index / num_blocks_per_side) * block_size;
+    ARMD_Size j0 = (index % num_blocks_per_side) * block_size;
+    ARMD_Size i1 = i0 + block_size < n ? i0 + block_size : n;
+    ARMD_Size j1 = j0 + block_size < n ? j0 + block_size : n;
+    multiply_block(typed_args, i0, i1, j0, j1);
+
+    return 0;
+}
+
+class MatmulWorkload : public Workload {
+public:
+    MatmulWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                   ARMD_Size size, ARMD_Size block_size)
+        : size(size), block_size(block_size == 0 ? 1 : block_size),
+          a(size * size), b(size * size), c(size * size),
+          expected(size * size) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_parallel_for(builder, matmul_count, matmul_continuation);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        for (ARMD_Size i = 0; i < size * size; ++i) {
+            a[i] = static_cast<double>(i % 7) - 3.0;
+            b[i] = static_cast<double>(i % 5) * 0.5;
+        }
+
+        MatmulArgs args = get_args();
+        args.c = expected.data();
+        multiply_block(&args, 0, size, 0, size);
+    }
+
+    ~MatmulWorkload() override { armd_procedure_destroy(procedure); }
+
+    std::string get_name() const override { return "matmul"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(size) +
+               ",block=" + std::to_string(block_size);
+    }
+
+    double get_num_ops() const override {
+        // Floating-point operations
+        return 2.0 * size * size * size;
+    }
+
+    bool run(ARMD_Context *context) override {
+        std::fill(c.begin(), c.end(), 0.0);
+        MatmulArgs args = get_args();
+
+        ARMD_Handle promise =
+            armd_invoke(context, procedure, &args, 0, nullptr);
+        if (promise == 0 || armd_await(context, promise) != 0) {
+            return false;
+        }
+
+        // The summation order is the same as the serial one
+        return c == expected;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        std::fill(c.begin(), c.end(), 0.0);
+        MatmulArgs args = get_args();
+        ARMD_Size num_blocks = matmul_count(&args, nullptr);
+
+        // Dynamic as libaramid hands out the indices one by one
+#pragma omp parallel for schedule(dynamic)
+        for (ARMD_Size i = 0; i < num_blocks; ++i) {
+            matmul_continuation(nullptr, nullptr, &args, nullptr, i);
+        }
+
+        return c == expected;
+    }
+#endif
+
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        std::fill(c.begin(), c.end(), 0.0);
+        MatmulArgs args = get_args();
+        thread_pool->parallel_for(
+            matmul_count(&args, nullptr), [&args](ARMD_Size index) {
+                matmul_continuation(nullptr, nullptr, &args, nullptr, index);
+            });
+
+        return c == expected;
+    }
+
+private:
+    ARMD_Size size;
+    ARMD_Size block_size;
+    std::vector<double> a;
+    std::vector<double> b;
+    std::vector<double> c;
+    std::vector<double> expected;
+    ARMD_Procedure *procedure;
+
+    MatmulArgs get_args() {
+        MatmulArgs args;
+        args.size = size;
+        args.block_size = block_size;
+        args.a = a.data();
+        args.b = b.data();
+        args.c = c.data();
+        return args;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Workload>
+create_matmul_workload(const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD_Size size, ARMD_Size block_size) {
+    return std::unique_ptr<Workload>(
+        new MatmulWorkload(memory_allocator, size, block_size));
+}
+
+} // namespace bench
+} // namespace aramid
@@ -0,0 +1,314 @@
+#include <cstdint>
+
+#include <aramid/aramid.h>
+
+#include "../workloads.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+const ARMD_Size max_num_queens = 16;
+
+// Known numbers of solutions, indexed by the number of queens
+const uint64_t num_solutions_table[max_num_queens + 1] = {
+    1,   1,   0,    0,     2,     10,     4,       40,      92,
+    352, 724, 2680, 14200, 73712, 365596, 2279184, 14772512};
+
+typedef struct TAG_NQueensArgs {
+    ARMD_Size row;
+    // Occupied columns and diagonals as bit sets
+    uint32_t columns;
+    uint32_t left_diagonals;
+    uint32_t right_diagonals;
+    uint64_t *result;
+} NQueensArgs;
+
+typedef struct TAG_NQueensFrame {
+    ARMD_Size num_children;
+    NQueensArgs child_args[max_num_queens];
+    uint64_t child_results[max_num_queens];
+} NQueensFrame;
+
+typedef struct TAG_NQueensConstants {
+    ARMD_Procedure *nqueens_procedure;
+    ARMD_Size num_queens;
+    ARMD_Size cutoff_row;
+} NQueensConstants;
+
+uint32_t get_free_columns(ARMD_Size num_queens, uint32_t columns,
+                          uint32_t left_diagonals, uint32_t right_diagonals) {
+    uint32_t all = (uint32_t(1) << num_queens) - 1;
+    return all & ~(columns | left_diagonals | right_diagonals);
+}
+
+uint64_t nqueens_serial(ARMD_Size num_queens, ARMD_Size row, uint32_t columns,
+                        uint32_t left_diagonals, uint32_t right_diagonals) {
+    if (row == num_queens) {
+        return 1;
+    }
+
+    uint64_t count = 0;
+    uint32_t free_columns = get_free_columns(num_queens, columns,
+                                             left_diagonals, right_diagonals);
+    while (free_columns != 0) {
+        uint32_t bit = free_columns & (~free_columns + 1);
+        free_columns &= free_columns - 1;
+        count += nqueens_serial(num_queens, row + 1, columns | bit,
+                                (left_diagonals | bit) << 1,
+                                (right_diagonals | bit) >> 1);
+    }
+
+    return count;
+}
+
+uint64_t count_tasks(ARMD_Size num_queens, ARMD_Size cutoff_row, ARMD_Size row,
+                     uint32_t columns, uint32_t left_diagonals,
+                     uint32_t right_diagonals) {
+    if (row >= cutoff_row || row == num_queens) {
+        return 1;
+    }
+
+    uint64_t count = 1;
+    uint32_t free_columns = get_free_columns(num_queens, columns,
+                                             left_diagonals, right_diagonals);
+    while (free_columns != 0) {
+        uint32_t bit = free_columns & (~free_columns + 1);
+        free_columns &= free_columns - 1;
+        count += count_tasks(num_queens, cutoff_row, row + 1, columns | bit,
+                             (left_diagonals | bit) << 1,
+                             (right_diagonals | bit) >> 1);
+    }
+
+    return count;
+}
+
+int nqueens_continuation1(ARMD_Job *job, const void *constants, void *args,
+                          void *frame) {
+    const NQueensConstants *typed_constants =
+        reinterpret_cast<const NQueensConstants *>(constants);
+    NQueensArgs *typed_args = reinterpret_cast<NQueensArgs *>(args);
+    NQueensFrame *typed_frame = reinterpret_cast<NQueensFrame *>(frame);
+
+    ARMD_Size num_queens = typed_constants->num_queens;
+    if (typed_args->row >= typed_constants->cutoff_row ||
+        typed_args->row == num_queens) {
+        *typed_args->result =
+            nqueens_serial(num_queens, typed_args->row, typed_args->columns,
+                           typed_args->left_diagonals,
+                           typed_args->right_diagonals);
+        typed_frame->num_children = 0;
+        return 0;
+    }
+
+    ARMD_Size num_children = 0;
+    uint32_t free_columns = get_free_columns(
+        num_queens, typed_args->columns, typed_args->left_diagonals,
+        typed_args->right_diagonals);
+    while (free_columns != 0) {
+        uint32_t bit = free_columns & (~free_columns + 1);
+        free_columns &= free_columns - 1;
+
+        NQueensArgs *child_args = &typed_frame->child_args[num_children];
+        child_args->row = typed_args->row + 1;
+        child_args->columns = typed_args->columns | bit;
+        child_args->left_diagonals = (typed_args->left_diagonals | bit) << 1;
+        child_args->right_diagonals = (typed_args->right_diagonals | bit) >> 1;
+        child_args->result = &typed_frame->child_results[num_children];
+        ++num_children;
+
+        if (armd_fork(job, typed_constants->nqueens_procedure, child_args) !=
+            0) {
+            return 1;
+        }
+    }
+    typed_frame->num_children = num_children;
+
+    // Stays 0 if there is no child
+    *typed_args->result = 0;
+
+    return 0;
+}
+
+int nqueens_continuation2(ARMD_Job *job, const void *constants, void *args,
+                          void *frame) {
+    (void)job;
+    (void)constants;
+
+    NQueensArgs *typed_args = reinterpret_cast<NQueensArgs *>(args);
+    NQueensFrame *typed_frame = reinterpret_cast<NQueensFrame *>(frame);
+
+    if (typed_frame->num_children != 0) {
+        uint64_t count = 0;
+        for (ARMD_Size i = 0; i < typed_frame->num_children; ++i) {
+            count += typed_frame->child_results[i];
+        }
+        *typed_args->result = count;
+    }
+
+    return 0;
+}
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+uint64_t nqueens_openmp(ARMD_Size num_queens, ARMD_Size cutoff_row,
+                        ARMD_Size row, uint32_t columns,
+                        uint32_t left_diagonals, uint32_t right_diagonals) {
+    if (row >= cutoff_row || row == num_queens) {
+        return nqueens_serial(num_queens, row, columns, left_diagonals,
+                              right_diagonals);
+    }
+
+    uint64_t child_results[max_num_queens];
+    ARMD_Size num_children = 0;
+    uint32_t free_columns = get_free_columns(num_queens, columns,
+                                             left_diagonals, right_diagonals);
+    while (free_columns != 0) {
+        uint32_t bit = free_columns & (~free_columns + 1);
+        free_columns &= free_columns - 1;
+
+        uint64_t *child_result = &child_results[num_children++];
+#pragma omp task firstprivate(child_result)
+        *child_result = nqueens_openmp(num_queens, cutoff_row, row + 1,
+                                       columns | bit,
+                                       (left_diagonals | bit) << 1,
+                                       (right_diagonals | bit) >> 1);
+    }
+#pragma omp taskwait
+
+    uint64_t count = 0;
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        count += child_results[i];
+    }
+    return count;
+}
+#endif
+
+uint64_t nqueens_thread_pool(ThreadPool *thread_pool, ARMD_Size num_queens,
+                             ARMD_Size cutoff_row, ARMD_Size row,
+                             uint32_t columns, uint32_t left_diagonals,
+                             uint32_t right_diagonals) {
+    if (row >= cutoff_row || row == num_queens) {
+        return nqueens_serial(num_queens, row, columns, left_diagonals,
+                              right_diagonals);
+    }
+
+    uint64_t child_results[max_num_queens];
+    ARMD_Size num_children = 0;
+    ThreadPool::TaskGroup group;
+    uint32_t free_columns = get_free_columns(num_queens, columns,
+                                             left_diagonals, right_diagonals);
+    while (free_columns != 0) {
+        uint32_t bit = free_columns & (~free_columns + 1);
+        free_columns &= free_columns - 1;
+
+        uint64_t *child_result = &child_results[num_children++];
+        thread_pool->submit(&group, [=]() {
+            *child_result = nqueens_thread_pool(
+                thread_pool, num_queens, cutoff_row, row + 1, columns | bit,
+                (left_diagonals | bit) << 1, (right_diagonals | bit) >> 1);
+        });
+    }
+    thread_pool->wait(&group);
+
+    uint64_t count = 0;
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        count += child_results[i];
+    }
+    return count;
+}
+
+class NQueensWorkload : public Workload {
+public:
+    NQueensWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                    ARMD_Size num_queens, ARMD_Size cutoff_row)
+        : num_queens(num_queens > max_num_queens ? max_num_queens
+                                                 : num_queens),
+          cutoff_row(cutoff_row) {
+        ARMD_ProcedureBuilder *builder = armd_procedure_builder_create(
+            memory_allocator, sizeof(NQueensConstants), sizeof(NQueensFrame));
+        armd_then_single(builder, nqueens_continuation1);
+        armd_then_single(builder, nqueens_continuation2);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        NQueensConstants *constants = reinterpret_cast<NQueensConstants *>(
+            armd_procedure_get_constants(procedure));
+        constants->nqueens_procedure = procedure;
+        constants->num_queens = this->num_queens;
+        constants->cutoff_row = cutoff_row;
+
+        num_tasks = count_tasks(this->num_queens, cutoff_row, 0, 0, 0, 0);
+    }
+
+    ~NQueensWorkload() override { armd_procedure_destroy(procedure); }
+
+    std::string get_name() const override { return "nqueens"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(num_queens) +
+               ",cutoff=" + std::to_string(cutoff_row);
+    }
+
+    double get_num_ops() const override {
+        return static_cast<double>(num_tasks);
+    }
+
+    bool run(ARMD_Context *context) override {
+        uint64_t result = 0;
+        NQueensArgs args;
+        args.row = 0;
+        args.columns = 0;
+        args.left_diagonals = 0;
+        args.right_diagonals = 0;
+        args.result = &result;
+
+        ARMD_Handle promise =
+            armd_invoke(context, procedure, &args, 0, nullptr);
+        if (promise == 0 || armd_await(context, promise) != 0) {
+            return false;
+        }
+
+        return result == num_solutions_table[num_queens];
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        uint64_t result = 0;
+#pragma omp parallel
+#pragma omp single
+        result = nqueens_openmp(num_queens, cutoff_row, 0, 0, 0, 0);
+
+        return result == num_solutions_table[num_queens];
+    }
+#endif
+
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        uint64_t result = 0;
+        ThreadPool::TaskGroup group;
+        thread_pool->submit(&group, [&]() {
+            result = nqueens_thread_pool(thread_pool, num_queens, cutoff_row,
+                                         0, 0, 0, 0);
+        });
+        thread_pool->wait(&group);
+
+        return result == num_solutions_table[num_queens];
+    }
+
+private:
+    ARMD_Size num_queens;
+    ARMD_Size cutoff_row;
+    uint64_t num_tasks;
+    ARMD_Procedure *procedure;
+};
+
+} // namespace
+
+std::unique_ptr<Workload>
+create_nqueens_workload(const ARMD_MemoryAllocator *memory_allocator,
+                        ARMD_Size num_queens, ARMD_Size cutoff_row) {
+    return std::unique_ptr<Workload>(
+        new NQueensWorkload(memory_allocator, num_queens, cutoff_row));
+}
+
+} // namespace bench
+} // namespace aramid
@@ -0,0 +1,650 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <aramid/aramid.h>
+
+#include "../workloads.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+typedef struct TAG_DagNodeArgs {
+    // Indexed by layer * width + position
+    unsigned char *done_flags;
+    ARMD_Size index;
+    ARMD_Size num_dependencies;
+    ARMD_Size dependencies[2];
+} DagNodeArgs;
+
+int dag_node_continuation(ARMD_Job *job, const void *constants, void *args,
+                          void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    DagNodeArgs *typed_args = reinterpret_cast<DagNodeArgs *>(args);
+    for (ARMD_Size i = 0; i < typed_args->num_dependencies; ++i) {
+        if (!typed_args->done_flags[typed_args->dependencies[i]]) {
+            return 1;
+        }
+    }
+    typed_args->done_flags[typed_args->index] = 1;
+
+    return 0;
+}
+
+class PromiseDagWorkload : public Workload {
+public:
+    PromiseDagWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD_Size num_layers, ARMD_Size width)
+        : num_layers(num_layers), width(width == 0 ? 1 : width),
+          done_flags(num_layers * this->width),
+          node_args(num_layers * this->width),
+          handles(num_layers * this->width),
+          num_pending_dependencies(num_layers * this->width) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_single(builder, dag_node_continuation);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        for (ARMD_Size layer = 0; layer < num_layers; ++layer) {
+            for (ARMD_Size position = 0; position < this->width; ++position) {
+                DagNodeArgs *args = &node_args[layer * this->width + position];
+                args->done_flags = done_flags.data();
+                args->index = layer * this->width + position;
+                if (layer == 0) {
+                    args->num_dependencies = 0;
+                    continue;
+                }
+
+                ARMD_Size previous_layer = (layer - 1) * this->width;
+                // Both refer to the same node if the width is 1
+                args->num_dependencies = this->width > 1 ? 2 : 1;
+                args->dependencies[0] = previous_layer + position;
+                args->dependencies[1] =
+                    previous_layer + (position + 1) % this->width;
+            }
+        }
+    }
+
+    ~PromiseDagWorkload() override { armd_procedure_destroy(procedure); }
+
+    std::string get_name() const override { return "promise_dag"; }
+
+    std::string get_params() const override {
+        return "layers=" + std::to_string(num_layers) +
+               ",width=" + std::to_string(width);
+    }
+
+    double get_num_ops() const override {
+        // The number of promises
+        return static_cast<double>(num_layers * width);
+    }
+
+    bool run(ARMD_Context *context) override {
+        std::fill(done_flags.begin(), done_flags.end(), 0);
+
+        for (ARMD_Size i = 0; i < node_args.size(); ++i) {
+            DagNodeArgs *args = &node_args[i];
+            ARMD_Handle dependencies[2];
+            for (ARMD_Size j = 0; j < args->num_dependencies; ++j) {
+                dependencies[j] = handles[args->dependencies[j]];
+            }
+
+            handles[i] = armd_invoke(context, procedure, args,
+                                     args->num_dependencies, dependencies);
+            if (handles[i] == 0) {
+                return false;
+            }
+        }
+
+        bool correct = true;
+        for (ARMD_Size i = 0; i < handles.size(); ++i) {
+            if (armd_await(context, handles[i]) != 0) {
+                correct = false;
+            }
+        }
+
+        return correct;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        std::fill(done_flags.begin(), done_flags.end(), 0);
+        correct = true;
+
+        // GCC does not count the uses in the depend clauses
+        unsigned char *flags = done_flags.data();
+        (void)flags;
+#pragma omp parallel
+#pragma omp single
+        for (ARMD_Size i = 0; i < node_args.size(); ++i) {
+            DagNodeArgs *args = &node_args[i];
+            if (args->num_dependencies == 0) {
+#pragma omp task firstprivate(args) depend(out : flags[args->index])
+                run_node(args);
+            } else {
+#pragma omp task firstprivate(args)                                            \
+    depend(in : flags[args->dependencies[0]], flags[args->dependencies[1]])    \
+        depend(out : flags[args->index])
+                run_node(args);
+            }
+        }
+
+        return correct;
+    }
+#endif
+
+    // Each node submits its successors when it completes the last of their
+    // dependencies, as the promises of libaramid do
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        std::fill(done_flags.begin(), done_flags.end(), 0);
+        correct = true;
+
+        for (ARMD_Size i = 0; i < node_args.size(); ++i) {
+            num_pending_dependencies[i] = node_args[i].num_dependencies;
+        }
+
+        ThreadPool::TaskGroup group;
+        for (ARMD_Size i = 0; i < width && i < node_args.size(); ++i) {
+            thread_pool->submit(&group, [=, &group]() {
+                run_node_thread_pool(thread_pool, &group, i);
+            });
+        }
+        thread_pool->wait(&group);
+
+        return correct;
+    }
+
+private:
+    ARMD_Size num_layers;
+    ARMD_Size width;
+    std::vector<unsigned char> done_flags;
+    std::vector<DagNodeArgs> node_args;
+    std::vector<ARMD_Handle> handles;
+    std::vector<std::atomic<ARMD_Size>> num_pending_dependencies;
+    std::atomic<bool> correct;
+    ARMD_Procedure *procedure;
+
+    void run_node(DagNodeArgs *args) {
+        if (dag_node_continuation(nullptr, nullptr, args, nullptr) != 0) {
+            correct = false;
+        }
+    }
+
+    void run_node_thread_pool(ThreadPool *thread_pool,
+                              ThreadPool::TaskGroup *group, ARMD_Size index) {
+        run_node(&node_args[index]);
+
+        ARMD_Size next_layer = (index / width + 1) * width;
+        if (next_layer >= node_args.size()) {
+            return;
+        }
+
+        // The nodes which depend on this one
+        ARMD_Size position = index % width;
+        ARMD_Size successors[2] = {position, (position + width - 1) % width};
+        ARMD_Size num_successors = width > 1 ? 2 : 1;
+        for (ARMD_Size i = 0; i < num_successors; ++i) {
+            ARMD_Size successor = next_layer + successors[i];
+            if (--num_pending_dependencies[successor] == 0) {
+                thread_pool->submit(group, [=]() {
+                    run_node_thread_pool(thread_pool, group, successor);
+                });
+            }
+        }
+    }
+};
+
+int empty_continuation(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    ++*reinterpret_cast<ARMD_Size *>(args);
+
+    return 0;
+}
+
+class PingPongWorkload : public Workload {
+public:
+    PingPongWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                     ARMD_Size num_round_trips)
+        : num_round_trips(num_round_trips) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_single(builder, empty_continuation);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    ~PingPongWorkload() override { armd_procedure_destroy(procedure); }
+
+    std::string get_name() const override { return "ping_pong"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(num_round_trips);
+    }
+
+    double get_num_ops() const override {
+        return static_cast<double>(num_round_trips);
+    }
+
+    bool run(ARMD_Context *context) override {
+        ARMD_Size count = 0;
+        for (ARMD_Size i = 0; i < num_round_trips; ++i) {
+            ARMD_Handle promise =
+                armd_invoke(context, procedure, &count, 0, nullptr);
+            if (promise == 0 || armd_await(context, promise) != 0) {
+                return false;
+            }
+        }
+
+        return count == num_round_trips;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        ARMD_Size count = 0;
+#pragma omp parallel
+#pragma omp single
+        for (ARMD_Size i = 0; i < num_round_trips; ++i) {
+#pragma omp task shared(count)
+            empty_continuation(nullptr, nullptr, &count, nullptr);
+#pragma omp taskwait
+        }
+
+        return count == num_round_trips;
+    }
+#endif
+
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        ARMD_Size count = 0;
+        for (ARMD_Size i = 0; i < num_round_trips; ++i) {
+            ThreadPool::TaskGroup group;
+            thread_pool->submit(&group, [&count]() {
+                empty_continuation(nullptr, nullptr, &count, nullptr);
+            });
+            thread_pool->wait(&group);
+        }
+
+        return count == num_round_trips;
+    }
+
+private:
+    ARMD_Size num_round_trips;
+    ARMD_Procedure *procedure;
+};
+
+// Busy for the duration to stand for the work done in a callback
+void spin_for(uint64_t nanoseconds) {
+    uint64_t begin = armd_get_timestamp();
+    while (armd_timestamp_to_nanoseconds(armd_get_timestamp() - begin) <
+           nanoseconds) {
+    }
+}
+
+struct CallbackContext {
+    std::atomic<bool> released;
+    std::atomic<ARMD_Size> num_called;
+    uint64_t callback_nanoseconds;
+};
+
+int gate_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    CallbackContext *callback_context =
+        reinterpret_cast<CallbackContext *>(args);
+    while (!callback_context->released.load()) {
+    }
+
+    return 0;
+}
+
+// One per invocation, passed to both the procedure and the callback
+struct CallbackArgs {
+    CallbackContext *callback_context;
+    // Written at the end of the invocation and read by the callback
+    uint64_t end_timestamp;
+    uint64_t latency_nanoseconds;
+};
+
+int stamp_continuation(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    reinterpret_cast<CallbackArgs *>(args)->end_timestamp =
+        armd_get_timestamp();
+
+    return 0;
+}
+
+void slow_callback(ARMD_Handle handle, void *callback_args, int has_error) {
+    (void)handle;
+    (void)has_error;
+
+    CallbackArgs *typed_args = reinterpret_cast<CallbackArgs *>(callback_args);
+    typed_args->latency_nanoseconds = armd_timestamp_to_nanoseconds(
+        armd_get_timestamp() - typed_args->end_timestamp);
+
+    CallbackContext *callback_context = typed_args->callback_context;
+    spin_for(callback_context->callback_nanoseconds);
+    ++callback_context->num_called;
+}
+
+class PromiseCallbackWorkload : public Workload {
+public:
+    PromiseCallbackWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                            ARMD_Size num_promises,
+                            uint64_t callback_nanoseconds)
+        : num_promises(num_promises),
+          callback_nanoseconds(callback_nanoseconds), handles(num_promises),
+          callback_args(num_promises) {
+        armd_histogram_init(&latencies);
+
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_single(builder, stamp_continuation);
+        stamp_procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        builder = armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_single(builder, gate_continuation);
+        gate_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    ~PromiseCallbackWorkload() override {
+        armd_procedure_destroy(gate_procedure);
+        armd_procedure_destroy(stamp_procedure);
+    }
+
+    std::string get_name() const override { return "promise_callback"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(num_promises) +
+               ",callback_ns=" + std::to_string(callback_nanoseconds);
+    }
+
+    double get_num_ops() const override {
+        // The number of callbacks
+        return static_cast<double>(num_promises);
+    }
+
+    // The promises are held by the gate until their callbacks are added, so
+    // that the callbacks run on the executors as they complete
+    bool run(ARMD_Context *context) override {
+        CallbackContext callback_context;
+        callback_context.released = false;
+        callback_context.num_called = 0;
+        callback_context.callback_nanoseconds = callback_nanoseconds;
+        init_callback_args(&callback_context);
+
+        ARMD_Handle gate = armd_invoke(context, gate_procedure,
+                                       &callback_context, 0, nullptr);
+        if (gate == 0) {
+            return false;
+        }
+
+        bool correct = true;
+        for (ARMD_Size i = 0; i < num_promises; ++i) {
+            handles[i] = armd_invoke(context, stamp_procedure,
+                                     &callback_args[i], 1, &gate);
+            if (handles[i] == 0 ||
+                armd_add_promise_callback(context, handles[i],
+                                          &callback_args[i],
+                                          slow_callback) != 0) {
+                correct = false;
+            }
+        }
+        callback_context.released = true;
+
+        if (armd_await(context, gate) != 0) {
+            correct = false;
+        }
+        for (ARMD_Size i = 0; i < num_promises; ++i) {
+            if (handles[i] != 0 && armd_await(context, handles[i]) != 0) {
+                correct = false;
+            }
+        }
+
+        record_latencies();
+        return correct && callback_context.num_called == num_promises;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        CallbackContext callback_context;
+        callback_context.num_called = 0;
+        callback_context.callback_nanoseconds = callback_nanoseconds;
+        init_callback_args(&callback_context);
+
+        CallbackArgs *args = callback_args.data();
+#pragma omp parallel
+#pragma omp single
+        for (ARMD_Size i = 0; i < num_promises; ++i) {
+#pragma omp task firstprivate(args, i)
+            {
+                stamp_continuation(nullptr, nullptr, &args[i], nullptr);
+                slow_callback(0, &args[i], 0);
+            }
+        }
+
+        record_latencies();
+        return callback_context.num_called == num_promises;
+    }
+#endif
+
+    // The task calls the callback at its end
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        CallbackContext callback_context;
+        callback_context.num_called = 0;
+        callback_context.callback_nanoseconds = callback_nanoseconds;
+        init_callback_args(&callback_context);
+
+        ThreadPool::TaskGroup group;
+        for (ARMD_Size i = 0; i < num_promises; ++i) {
+            CallbackArgs *args = &callback_args[i];
+            thread_pool->submit(&group, [args]() {
+                stamp_continuation(nullptr, nullptr, args, nullptr);
+                slow_callback(0, args, 0);
+            });
+        }
+        thread_pool->wait(&group);
+
+        record_latencies();
+        return callback_context.num_called == num_promises;
+    }
+
+    bool take_latencies(ARMD_Histogram *histogram) override {
+        *histogram = latencies;
+        armd_histogram_init(&latencies);
+        return true;
+    }
+
+private:
+    ARMD_Size num_promises;
+    uint64_t callback_nanoseconds;
+    std::vector<ARMD_Handle> handles;
+    std::vector<CallbackArgs> callback_args;
+    ARMD_Histogram latencies;
+    ARMD_Procedure *stamp_procedure;
+    ARMD_Procedure *gate_procedure;
+
+    void init_callback_args(CallbackContext *callback_context) {
+        for (CallbackArgs &args : callback_args) {
+            args.callback_context = callback_context;
+            args.end_timestamp = 0;
+            args.latency_nanoseconds = 0;
+        }
+    }
+
+    void record_latencies() {
+        for (const CallbackArgs &args : callback_args) {
+            armd_histogram_record(&latencies, args.latency_nanoseconds);
+        }
+    }
+};
+
+int count_continuation(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    ++*reinterpret_cast<std::atomic<ARMD_Size> *>(args);
+
+    return 0;
+}
+
+class PromiseFanOutWorkload : public Workload {
+public:
+    PromiseFanOutWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                          ARMD_Size num_dependents)
+        : num_dependents(num_dependents), handles(num_dependents) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_single(builder, count_continuation);
+        count_procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        builder = armd_procedure_builder_create(memory_allocator, 0, 0);
+        armd_then_single(builder, gate_continuation);
+        gate_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    ~PromiseFanOutWorkload() override {
+        armd_procedure_destroy(gate_procedure);
+        armd_procedure_destroy(count_procedure);
+    }
+
+    std::string get_name() const override { return "promise_fan_out"; }
+
+    std::string get_params() const override {
+        return "n=" + std::to_string(num_dependents);
+    }
+
+    double get_num_ops() const override {
+        // The number of dependents
+        return static_cast<double>(num_dependents);
+    }
+
+    // All the dependents are added to the root while it is held by the gate
+    bool run(ARMD_Context *context) override {
+        CallbackContext callback_context;
+        callback_context.released = false;
+        std::atomic<ARMD_Size> count(0);
+
+        ARMD_Handle root = armd_invoke(context, gate_procedure,
+                                       &callback_context, 0, nullptr);
+        if (root == 0) {
+            return false;
+        }
+
+        bool correct = true;
+        for (ARMD_Size i = 0; i < num_dependents; ++i) {
+            handles[i] =
+                armd_invoke(context, count_procedure, &count, 1, &root);
+            if (handles[i] == 0) {
+                correct = false;
+            }
+        }
+        callback_context.released = true;
+
+        if (armd_await(context, root) != 0) {
+            correct = false;
+        }
+        for (ARMD_Size i = 0; i < num_dependents; ++i) {
+            if (handles[i] != 0 && armd_await(context, handles[i]) != 0) {
+                correct = false;
+            }
+        }
+
+        return correct && count == num_dependents;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        std::atomic<ARMD_Size> count(0);
+        unsigned char root = 0;
+
+#pragma omp parallel
+#pragma omp single
+        {
+#pragma omp task depend(out : root)
+            root = 1;
+            for (ARMD_Size i = 0; i < num_dependents; ++i) {
+#pragma omp task shared(count) depend(in : root)
+                count_continuation(nullptr, nullptr, &count, nullptr);
+            }
+        }
+        // GCC does not count the uses in the depend clauses
+        (void)root;
+
+        return count == num_dependents;
+    }
+#endif
+
+    // The root submits the dependents when it completes
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        std::atomic<ARMD_Size> count(0);
+
+        ThreadPool::TaskGroup group;
+        thread_pool->submit(&group, [&, thread_pool]() {
+            for (ARMD_Size i = 0; i < num_dependents; ++i) {
+                thread_pool->submit(&group, [&count]() {
+                    count_continuation(nullptr, nullptr, &count, nullptr);
+                });
+            }
+        });
+        thread_pool->wait(&group);
+
+        return count == num_dependents;
+    }
+
+private:
+    ARMD_Size num_dependents;
+    std::vector<ARMD_Handle> handles;
+    ARMD_Procedure *count_procedure;
+    ARMD_Procedure *gate_procedure;
+};
+
+} // namespace
+
+std::unique_ptr<Workload>
+create_promise_dag_workload(const ARMD_MemoryAllocator *memory_allocator,
+                            ARMD_Size num_layers, ARMD_Size width) {
+    return std::unique_ptr<Workload>(
+        new PromiseDagWorkload(memory_allocator, num_layers, width));
+}
+
+std::unique_ptr<Workload>
+create_ping_pong_workload(const ARMD_MemoryAllocator *memory_allocator,
+                          ARMD_Size num_round_trips) {
+    return std::unique_ptr<Workload>(
+        new PingPongWorkload(memory_allocator, num_round_trips));
+}
+
+std::unique_ptr<Workload>
+create_promise_callback_workload(const ARMD_MemoryAllocator *memory_allocator,
+                                 ARMD_Size num_promises,
+                                 uint64_t callback_nanoseconds) {
+    return std::unique_ptr<Workload>(new PromiseCallbackWorkload(
+        memory_allocator, num_promises, callback_nanoseconds));
+}
+
+std::unique_ptr<Workload>
+create_promise_fan_out_workload(const ARMD_MemoryAllocator *memory_allocator,
+                                ARMD_Size num_dependents) {
+    return std::unique_ptr<Workload>(
+        new PromiseFanOutWorkload(memory_allocator, num_dependents));
+}
+
+} // namespace bench
+} // namespace aramid
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <aramid/aramid.h>
+
+#include "../workloads.hpp"
+
+namespace aramid {
+namespace bench {
+
+namespace {
+
+const ARMD_Size max_num_children = 8;
+
+typedef struct TAG_UtsArgs {
+    uint64_t state;
+    uint64_t *result;
+} UtsArgs;
+
+typedef struct TAG_UtsFrame {
+    ARMD_Size num_children;
+    UtsArgs child_args[max_num_children];
+    uint64_t child_results[max_num_children];
+} UtsFrame;
+
+typedef struct TAG_UtsConstants {
+    ARMD_Procedure *node_procedure;
+    ARMD_Size num_children;
+    // Nodes whose state is below the threshold have children
+    uint64_t branch_threshold;
+} UtsConstants;
+
+// The root has too many children for UtsFrame, so they live in the workload
+typedef struct TAG_UtsRootArgs {
+    ARMD_Size num_children;
+    UtsArgs *child_args;
+    uint64_t *child_results;
+    uint64_t result;
+} UtsRootArgs;
+
+// SplitMix64, so that the tree is the same for every run
+uint64_t get_child_state(uint64_t state, ARMD_Size index) {
+    uint64_t z = state + (index + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+ARMD_Size get_num_children(const UtsConstants *constants, uint64_t state) {
+    return state < constants->branch_threshold ? constants->num_children : 0;
+}
+
+uint64_t count_nodes_serial(const UtsConstants *constants, uint64_t state) {
+    uint64_t count = 1;
+    ARMD_Size num_children = get_num_children(constants, state);
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        count += count_nodes_serial(constants, get_child_state(state, i));
+    }
+    return count;
+}
+
+int node_continuation1(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    const UtsConstants *typed_constants =
+        reinterpret_cast<const UtsConstants *>(constants);
+    UtsArgs *typed_args = reinterpret_cast<UtsArgs *>(args);
+    UtsFrame *typed_frame = reinterpret_cast<UtsFrame *>(frame);
+
+    ARMD_Size num_children =
+        get_num_children(typed_constants, typed_args->state);
+    typed_frame->num_children = num_children;
+
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        UtsArgs *child_args = &typed_frame->child_args[i];
+        child_args->state = get_child_state(typed_args->state, i);
+        child_args->result = &typed_frame->child_results[i];
+        if (armd_fork(job, typed_constants->node_procedure, child_args) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int node_continuation2(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+
+    UtsArgs *typed_args = reinterpret_cast<UtsArgs *>(args);
+    UtsFrame *typed_frame = reinterpret_cast<UtsFrame *>(frame);
+
+    uint64_t count = 1;
+    for (ARMD_Size i = 0; i < typed_frame->num_children; ++i) {
+        count += typed_frame->child_results[i];
+    }
+    *typed_args->result = count;
+
+    return 0;
+}
+
+int root_continuation1(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)frame;
+
+    const UtsConstants *typed_constants =
+        reinterpret_cast<const UtsConstants *>(constants);
+    UtsRootArgs *typed_args = reinterpret_cast<UtsRootArgs *>(args);
+
+    for (ARMD_Size i = 0; i < typed_args->num_children; ++i) {
+        if (armd_fork(job, typed_constants->node_procedure,
+                      &typed_args->child_args[i]) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int root_continuation2(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    UtsRootArgs *typed_args = reinterpret_cast<UtsRootArgs *>(args);
+
+    uint64_t count = 1;
+    for (ARMD_Size i = 0; i < typed_args->num_children; ++i) {
+        count += typed_args->child_results[i];
+    }
+    typed_args->result = count;
+
+    return 0;
+}
+
+ARMD_Procedure *build_procedure(const ARMD_MemoryAllocator *memory_allocator,
+                                ARMD_Size frame_size,
+                                ARMD_SingleContinuationFunc continuation1,
+                                ARMD_SingleContinuationFunc continuation2) {
+    ARMD_ProcedureBuilder *builder = armd_procedure_builder_create(
+        memory_allocator, sizeof(UtsConstants), frame_size);
+    armd_then_single(builder, continuation1);
+    armd_then_single(builder, continuation2);
+    return armd_procedure_builder_build_and_destroy(builder);
+}
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+uint64_t count_nodes_openmp(const UtsConstants *constants, uint64_t state) {
+    uint64_t child_results[max_num_children];
+    ARMD_Size num_children = get_num_children(constants, state);
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        uint64_t *child_result = &child_results[i];
+#pragma omp task firstprivate(child_result)
+        *child_result =
+            count_nodes_openmp(constants, get_child_state(state, i));
+    }
+#pragma omp taskwait
+
+    uint64_t count = 1;
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        count += child_results[i];
+    }
+    return count;
+}
+#endif
+
+uint64_t count_nodes_thread_pool(ThreadPool *thread_pool,
+                                 const UtsConstants *constants,
+                                 uint64_t state) {
+    uint64_t child_results[max_num_children];
+    ARMD_Size num_children = get_num_children(constants, state);
+    ThreadPool::TaskGroup group;
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        uint64_t *child_result = &child_results[i];
+        thread_pool->submit(&group, [=]() {
+            *child_result = count_nodes_thread_pool(
+                thread_pool, constants, get_child_state(state, i));
+        });
+    }
+    thread_pool->wait(&group);
+
+    uint64_t count = 1;
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        count += child_results[i];
+    }
+    return count;
+}
+
+class UtsWorkload : public Workload {
+public:
+    UtsWorkload(const ARMD_MemoryAllocator *memory_allocator,
+                ARMD_Size num_root_children, ARMD_Size num_children,
+                double branch_probability)
+        : num_children(num_children > max_num_children ? max_num_children
+                                                       : num_children),
+          branch_probability(branch_probability),
+          child_args(num_root_children), child_results(num_root_children) {
+        node_procedure =
+            build_procedure(memory_allocator, sizeof(UtsFrame),
+                            node_continuation1, node_continuation2);
+        root_procedure = build_procedure(memory_allocator, 0,
+                                         root_continuation1,
+                                         root_continuation2);
+
+        UtsConstants constants;
+        constants.node_procedure = node_procedure;
+        constants.num_children = this->num_children;
+        constants.branch_threshold =
+            static_cast<uint64_t>(branch_probability * 18446744073709551615.0);
+        *reinterpret_cast<UtsConstants *>(
+            armd_procedure_get_constants(node_procedure)) = constants;
+        *reinterpret_cast<UtsConstants *>(
+            armd_procedure_get_constants(root_procedure)) = constants;
+
+        expected = 1;
+        for (ARMD_Size i = 0; i < num_root_children; ++i) {
+            child_args[i].state = get_child_state(0, i);
+            child_args[i].result = &child_results[i];
+            expected += count_nodes_serial(&constants, child_args[i].state);
+        }
+    }
+
+    ~UtsWorkload() override {
+        armd_procedure_destroy(root_procedure);
+        armd_procedure_destroy(node_procedure);
+    }
+
+    std::string get_name() const override { return "uts"; }
+
+    std::string get_params() const override {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "b0=%u,m=%u,q=%g",
+                      (unsigned)child_args.size(), (unsigned)num_children,
+                      branch_probability);
+        return buf;
+    }
+
+    double get_num_ops() const override {
+        // The number of nodes, each of which is a task
+        return static_cast<double>(expected);
+    }
+
+    bool run(ARMD_Context *context) override {
+        std::fill(child_results.begin(), child_results.end(), 0);
+
+        UtsRootArgs args;
+        args.num_children = child_args.size();
+        args.child_args = child_args.data();
+        args.child_results = child_results.data();
+        args.result = 0;
+
+        ARMD_Handle promise =
+            armd_invoke(context, root_procedure, &args, 0, nullptr);
+        if (promise == 0 || armd_await(context, promise) != 0) {
+            return false;
+        }
+
+        return args.result == expected;
+    }
+
+#if defined(ARAMID_BENCH_ENABLE_OPENMP)
+    bool run_openmp() override {
+        std::fill(child_results.begin(), child_results.end(), 0);
+
+        const UtsConstants *constants = get_constants();
+#pragma omp parallel
+#pragma omp single
+        {
+            for (ARMD_Size i = 0; i < child_args.size(); ++i) {
+#pragma omp task firstprivate(i)
+                child_results[i] =
+                    count_nodes_openmp(constants, child_args[i].state);
+            }
+        }
+
+        return sum_root_children() == expected;
+    }
+#endif
+
+    bool run_thread_pool(ThreadPool *thread_pool) override {
+        std::fill(child_results.begin(), child_results.end(), 0);
+
+        const UtsConstants *constants = get_constants();
+        ThreadPool::TaskGroup group;
+        for (ARMD_Size i = 0; i < child_args.size(); ++i) {
+            thread_pool->submit(&group, [=]() {
+                child_results[i] = count_nodes_thread_pool(
+                    thread_pool, constants, child_args[i].state);
+            });
+        }
+        thread_pool->wait(&group);
+
+        return sum_root_children() == expected;
+    }
+
+private:
+    ARMD_Size num_children;
+    double branch_probability;
+    std::vector<UtsArgs> child_args;
+    std::vector<uint64_t> child_results;
+    uint64_t expected;
+    ARMD_Procedure *node_procedure;
+    ARMD_Procedure *root_procedure;
+
+    const UtsConstants *get_constants() const {
+        return reinterpret_cast<const UtsConstants *>(
+            armd_procedure_get_constants(node_procedure));
+    }
+
+    uint64_t sum_root_children() const {
+        uint64_t count = 1;
+        for (uint64_t child_result : child_results) {
+            count += child_result;
+        }
+        return count;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<Workload>
+create_uts_workload(const ARMD_MemoryAllocator *memory_allocator,
+                    ARMD_Size num_root_children, ARMD_Size num_children,
+                    double branch_probability) {
+    return std::unique_ptr<Workload>(new UtsWorkload(
+        memory_allocator, num_root_children, num_children, branch_probability));
+}
+
+} // namespace bench
+} // namespace aramid
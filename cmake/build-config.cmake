@@ -16,8 +16,12 @@ endif()
 # Options
 
 option(BUILD_TESTING "Build test" ON)
+option(BUILD_BENCHMARK "Build benchmark" OFF)
+option(BUILD_TOOLS "Build tools such as the binary log decoder" OFF)
 option(ENABLE_ASAN "Build with ASAN support (GCC/clang and *nix required)")
 option(DISABLE_MEMORY_REGION "Disable memory region feature")
+option(DISABLE_TRACING "Compile out the scheduler event tracing")
+option(DISABLE_TSC "Use the monotonic clock of the OS instead of the time stamp counter for timestamps")
 set(SPINLOCK_IMPLEMENTATION ${DEFAULT_SPINLOCK_IMPLEMENTATION} CACHE STRING "Spinlock implementation (GCCIntrinsic|MSVCIntrinsic)")
 set(THREAD_IMPLEMENTATION ${DEFAULT_THREAD_IMPLEMENTATION} CACHE STRING "Thread implementation (pthread|win32)")
 
@@ -42,6 +46,14 @@ if(DISABLE_MEMORY_REGION)
     list(APPEND ARAMID_COMPILE_DEFINITIONS ARAMID_DISABLE_MEMORY_REGION)
 endif()
 
+if(DISABLE_TRACING)
+    list(APPEND ARAMID_COMPILE_DEFINITIONS ARAMID_DISABLE_TRACING)
+endif()
+
+if(DISABLE_TSC)
+    list(APPEND ARAMID_COMPILE_DEFINITIONS ARAMID_DISABLE_TSC)
+endif()
+
 if(MSVC)
     list(APPEND ARAMID_COMPILE_OPTIONS /W4 /WX)
 else()
@@ -115,6 +115,30 @@ armd_memory_allocator_allocate(const ARMD_MemoryAllocator *allocator,
 ARMD_EXTERN_C void
 armd_memory_allocator_free(const ARMD_MemoryAllocator *allocator, void *buf);
 
+/**
+ * @brief Allocates aligned memory area with @ref ARMD_MemoryAllocator
+ * @details The area is carved out of a larger one allocated with @ref
+ * ARMD_MemoryAllocator.allocate, so it works with any allocator.
+ * @param allocator The memory allocator
+ * @param size Allocation size in bytes
+ * @param alignment Alignment in bytes. It must be a power of two.
+ * @return The pointer to allocated memory area. NULL if failed.
+ */
+ARMD_EXTERN_C void *
+armd_memory_allocator_allocate_aligned(const ARMD_MemoryAllocator *allocator,
+                                       ARMD_Size size, ARMD_Size alignment);
+/**
+ * @brief Free memory area allocated with @ref
+ * armd_memory_allocator_allocate_aligned
+ * @param allocator The memory allocator. It must be the same allocator used on
+ * allocation.
+ * @param buf The pointer to free. It must be the same pointer returned by @ref
+ * armd_memory_allocator_allocate_aligned.
+ */
+ARMD_EXTERN_C void
+armd_memory_allocator_free_aligned(const ARMD_MemoryAllocator *allocator,
+                                   void *buf);
+
 /**
  * @brief Initialize @ref ARMD_MemoryAllocator with default value
  * @details It initializes @ref ARMD_MemoryAllocator to use the system's malloc
@@ -124,6 +148,44 @@ armd_memory_allocator_free(const ARMD_MemoryAllocator *allocator, void *buf);
 ARMD_EXTERN_C void
 armd_memory_allocator_init_default(ARMD_MemoryAllocator *memory_allocator);
 
+/**
+ * @brief Initialize @ref ARMD_MemoryAllocator with the huge page allocator
+ * @details Allocations of 2 MiB or larger are mapped directly from the OS and
+ * backed with huge pages where possible to reduce TLB misses on large data. On
+ * Linux it tries explicit huge pages (MAP_HUGETLB), then transparent huge
+ * pages (MADV_HUGEPAGE), then normal pages. Smaller allocations are passed to
+ * calloc. Memory areas are zero-filled. It can also back @ref
+ * ARMD_MemoryRegion through @ref armd_memory_region_create.
+ * @param memory_allocator The memory allocator to initialize
+ */
+ARMD_EXTERN_C void
+armd_memory_allocator_init_huge_page(ARMD_MemoryAllocator *memory_allocator);
+
+/**
+ * @brief Initialize @ref ARMD_MemoryAllocator with the pooled allocator
+ * @details It serves allocations up to 32 KiB from size-classed free lists.
+ * Each executor thread has its own cache of free objects, which is refilled in
+ * batches from large blocks mapped from the OS. Larger allocations are passed
+ * to malloc. Call @ref armd_memory_allocator_deinit_pooled after all the users
+ * of the allocator are destroyed.
+ * @param memory_allocator The memory allocator to initialize
+ * @param zero_fill Whether to zero-fill allocated memory areas as @ref
+ * armd_memory_allocator_init_default does
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_memory_allocator_init_pooled(ARMD_MemoryAllocator *memory_allocator,
+                                  ARMD_Bool zero_fill);
+
+/**
+ * @brief Release the memory held by the pooled allocator
+ * @details Every memory area allocated with it becomes invalid.
+ * @param memory_allocator The memory allocator initialized with @ref
+ * armd_memory_allocator_init_pooled
+ */
+ARMD_EXTERN_C void
+armd_memory_allocator_deinit_pooled(ARMD_MemoryAllocator *memory_allocator);
+
 /**
  * @brief Memory region
  * @details It provides region-based memory management functionality. It is also
@@ -149,6 +211,32 @@ armd_memory_region_create(const ARMD_MemoryAllocator *memory_allocator);
 ARMD_EXTERN_C ARMD_Size
 armd_memory_region_destroy(ARMD_MemoryRegion *memory_region);
 
+/**
+ * @brief Create @ref ARMD_MemoryRegion in arena mode
+ * @details The arena carves allocations out of blocks of @ref block_size bytes
+ * with a bump pointer. @ref armd_memory_region_free is a no-op on it; all the
+ * memory is released at once by @ref armd_memory_region_reset or @ref
+ * armd_memory_region_destroy. Allocations larger than @ref block_size get a
+ * dedicated block.
+ * @param memory_allocator The memory allocator to get blocks from
+ * @param block_size The size of each block in bytes
+ * @return The new memory region. NULL if failed.
+ */
+ARMD_EXTERN_C ARMD_MemoryRegion *
+armd_memory_region_create_arena(const ARMD_MemoryAllocator *memory_allocator,
+                                ARMD_Size block_size);
+
+/**
+ * @brief Release all memory areas allocated from @ref ARMD_MemoryRegion
+ * @details All pointers returned by the region become invalid. An arena keeps
+ * its standard blocks for reuse. A non-arena region built with
+ * DISABLE_MEMORY_REGION does not track allocations and releases nothing.
+ * @param memory_region The memory region to reset
+ * @return The number of memory areas released
+ */
+ARMD_EXTERN_C ARMD_Size
+armd_memory_region_reset(ARMD_MemoryRegion *memory_region);
+
 /**
  * @brief Allocates memory area with @ref ARMD_MemoryRegion
  * @param allocator The memory region
@@ -158,6 +246,18 @@ armd_memory_region_destroy(ARMD_MemoryRegion *memory_region);
 ARMD_EXTERN_C void *
 armd_memory_region_allocate(ARMD_MemoryRegion *memory_region, ARMD_Size size);
 
+/**
+ * @brief Allocates aligned memory area with @ref ARMD_MemoryRegion
+ * @details The area is freed with @ref armd_memory_region_free as usual.
+ * @param memory_region The memory region
+ * @param size Allocation size in bytes
+ * @param alignment Alignment in bytes. It must be a power of two.
+ * @return The pointer to allocated memory area. NULL if failed.
+ */
+ARMD_EXTERN_C void *
+armd_memory_region_allocate_aligned(ARMD_MemoryRegion *memory_region,
+                                    ARMD_Size size, ARMD_Size alignment);
+
 /**
  * @brief Free memory area allocated with @ref ARMD_MemoryRegion
  * @param allocator The memory region. It must be the same region used on
@@ -199,6 +299,367 @@ armd_context_create(const ARMD_MemoryAllocator *memory_allocator,
  */
 ARMD_EXTERN_C int armd_context_destroy(ARMD_Context *context);
 
+/**
+ * @brief Get the number of executors
+ * @param context The @ref ARMD_Context
+ * @return The number of executors given on creation
+ */
+ARMD_EXTERN_C ARMD_Size armd_context_get_num_executors(ARMD_Context *context);
+
+/**
+ * @brief Scheduler counters of an executor
+ * @details Times are in nanoseconds. Idle time is spent looking for a job
+ * after the local deque ran dry, including parked time, which is spent
+ * sleeping until a job is queued somewhere. A wakeup is counted for every
+ * return from sleep, so wakeups much more than parks mean the executor was
+ * woken up for jobs taken by others.
+ */
+typedef struct TAG_ARMD_ExecutorStats {
+    ARMD_Size num_jobs_executed;
+    ARMD_Size num_forks;
+    ARMD_Size num_steals;
+    ARMD_Size num_failed_steals;
+    ARMD_Size num_parks;
+    ARMD_Size num_wakeups;
+    uint64_t idle_nanoseconds;
+    uint64_t parked_nanoseconds;
+    ARMD_Size deque_high_water_mark;
+} ARMD_ExecutorStats;
+
+/**
+ * @brief Steal counters between a pair of executors
+ */
+typedef struct TAG_ARMD_StealStats {
+    ARMD_Size num_steals;
+    ARMD_Size num_failed_steals;
+} ARMD_StealStats;
+
+/**
+ * @brief Scheduler counters of a context
+ */
+typedef struct TAG_ARMD_ContextStats {
+    ARMD_Size num_executors;
+    ARMD_Size num_promises;
+    ARMD_Size num_free_jobs;
+} ARMD_ContextStats;
+
+/**
+ * @brief Get scheduler statistics
+ * @details The counters are collected all the time by each executor without
+ * synchronization and summed up here, so they may be slightly behind while
+ * the executors are running. All the counters are cumulative from the creation
+ * of the context.
+ * @param context The @ref ARMD_Context
+ * @param context_stats Receives the context-wide counters
+ * @param executor_stats The array of @ref armd_context_get_num_executors
+ * elements to receive the counters of each executor. Nullable.
+ * @param steal_stats The row-major array of num_executors * num_executors
+ * elements; the element at [thief * num_executors + victim] receives the
+ * steals by thief from victim. Nullable.
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_get_stats(ARMD_Context *context,
+                                         ARMD_ContextStats *context_stats,
+                                         ARMD_ExecutorStats *executor_stats,
+                                         ARMD_StealStats *steal_stats);
+
+/**
+ * @brief Trace writer
+ * @details The function called with each chunk of the trace. See @ref
+ * armd_context_write_trace.
+ * @return Status code, 0 if succeeded, non-zero to abort writing
+ */
+typedef int (*ARMD_TraceWriterFunc)(void *writer_context, const char *data,
+                                    ARMD_Size size);
+
+/**
+ * @brief Start recording scheduler events
+ * @details Each executor records job steps, forks, steals, parks, promise
+ * completions and dependency releases into its own ring buffer, overwriting
+ * the oldest events once it is full. The buffers are allocated on the first
+ * call and kept until the context is destroyed, so later calls ignore
+ * num_events_per_executor. Not available if the library is built with
+ * DISABLE_TRACING.
+ * @param context The @ref ARMD_Context to trace
+ * @param num_events_per_executor The capacity of each ring buffer
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_context_enable_tracing(ARMD_Context *context,
+                            ARMD_Size num_events_per_executor);
+
+/**
+ * @brief Stop recording scheduler events
+ * @details The recorded events are kept.
+ * @param context The traced @ref ARMD_Context
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_disable_tracing(ARMD_Context *context);
+
+/**
+ * @brief Write the recorded events in Chrome Trace Event Format
+ * @details The output is a JSON object which can be loaded into Perfetto or
+ * chrome://tracing. Call this function while no job is running, for example
+ * after @ref armd_await_all or @ref armd_context_disable_tracing, otherwise
+ * the newest events may be inconsistent.
+ * @param context The traced @ref ARMD_Context
+ * @param writer_func The function to receive the output
+ * @param writer_context The pointer passed to writer_func
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_write_trace(ARMD_Context *context,
+                                           ARMD_TraceWriterFunc writer_func,
+                                           void *writer_context);
+
+/**
+ * @brief Flight recorder
+ * @details A fixed-size file mapped into memory which keeps the latest
+ * scheduler events and log records. The executors and the logger write into
+ * it with plain stores and no system call, and the OS writes the pages back,
+ * so the file can be read with the aramid_flight_decode tool after the
+ * process crashes or is killed, though not after the machine goes down.
+ */
+typedef struct TAG_ARMD_FlightRecorder ARMD_FlightRecorder;
+
+/**
+ * @brief Create a flight recorder file
+ * @details The file is created or truncated, and its size is fixed by the
+ * parameters. Each ring overwrites its oldest entry when full.
+ * @param memory_allocator The memory allocator for the management data
+ * @param path The path of the file
+ * @param num_trace_lanes The number of rings of scheduler events, at least
+ * the number of executors to record
+ * @param num_events_per_lane The capacity of each ring of scheduler events
+ * @param num_log_records The capacity of the ring of log records
+ * @return The flight recorder, NULL if failed
+ */
+ARMD_EXTERN_C ARMD_FlightRecorder *
+armd_flight_recorder_create(const ARMD_MemoryAllocator *memory_allocator,
+                            const char *path, ARMD_Size num_trace_lanes,
+                            ARMD_Size num_events_per_lane,
+                            ARMD_Size num_log_records);
+
+/**
+ * @brief Unmap the flight recorder file
+ * @details The file is kept. Destroy the contexts and the loggers writing
+ * into it first.
+ * @param flight_recorder The flight recorder
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_flight_recorder_destroy(ARMD_FlightRecorder *flight_recorder);
+
+/**
+ * @brief Start recording scheduler events into a flight recorder
+ * @details It is the same as @ref armd_context_enable_tracing except that
+ * executor i records into the lane i of the file instead of memory, and
+ * @ref armd_context_write_trace reads the file. Call it instead of, not
+ * after, @ref armd_context_enable_tracing. Not available if the library is
+ * built with DISABLE_TRACING.
+ * @param context The @ref ARMD_Context to trace
+ * @param flight_recorder The flight recorder with at least as many trace
+ * lanes as the executors
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_context_enable_flight_recorder(ARMD_Context *context,
+                                    ARMD_FlightRecorder *flight_recorder);
+
+/**
+ * @brief The number of buckets in @ref ARMD_Histogram
+ */
+#define ARMD_HISTOGRAM_NUM_BUCKETS 368
+
+/**
+ * @brief Log-linear histogram
+ * @details Values below 8 have their own buckets. Above that, each power of
+ * two range is split into 8 buckets, so a bucket is at most 12.5% wide
+ * relative to its values. Values of 2^48 and more share the last bucket.
+ * Histograms with the same layout can be merged by adding up the buckets.
+ */
+typedef struct TAG_ARMD_Histogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[ARMD_HISTOGRAM_NUM_BUCKETS];
+} ARMD_Histogram;
+
+/**
+ * @brief Initialize @ref ARMD_Histogram to empty
+ */
+ARMD_EXTERN_C void armd_histogram_init(ARMD_Histogram *histogram);
+/**
+ * @brief Record a value into @ref ARMD_Histogram
+ */
+ARMD_EXTERN_C void armd_histogram_record(ARMD_Histogram *histogram,
+                                         uint64_t value);
+/**
+ * @brief Add all the values in other to histogram
+ */
+ARMD_EXTERN_C void armd_histogram_merge(ARMD_Histogram *histogram,
+                                        const ARMD_Histogram *other);
+/**
+ * @brief Get the percentile value
+ * @details The result is the highest value of the bucket containing the
+ * percentile, but never exceeds the maximum recorded value.
+ * @param histogram The histogram
+ * @param percentile The percentile from 0 to 100
+ * @return The percentile value. 0 if the histogram is empty.
+ */
+ARMD_EXTERN_C uint64_t armd_histogram_get_percentile(
+    const ARMD_Histogram *histogram, ARMD_Real percentile);
+/**
+ * @brief Get the index of the bucket which value falls into
+ */
+ARMD_EXTERN_C ARMD_Size armd_histogram_get_bucket_index(uint64_t value);
+/**
+ * @brief Get the lowest value of the bucket
+ */
+ARMD_EXTERN_C uint64_t armd_histogram_get_bucket_lower_bound(ARMD_Size index);
+
+/**
+ * @brief Start profiling procedures
+ * @details While profiling, each executor records the invocations of each
+ * procedure, the time from a job getting ready to its setup (queueing delay),
+ * and the execution time of each continuation call in nanoseconds. The
+ * profiles are keyed by procedure pointer and are kept until the context is
+ * destroyed, even if the procedure is destroyed. If a new procedure gets the
+ * address of a destroyed one, its profile continues the old one when they
+ * have the same number of continuations, otherwise it starts over. Jobs
+ * which got ready before profiling started have no queueing delay recorded.
+ * @param context The @ref ARMD_Context to profile
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_enable_profiling(ARMD_Context *context);
+
+/**
+ * @brief Stop profiling procedures
+ * @details The recorded profiles are kept.
+ * @param context The profiled @ref ARMD_Context
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_disable_profiling(ARMD_Context *context);
+
+/**
+ * @brief Start counting hardware events while profiling
+ * @details Each executor counts the cycles, instructions, last level cache
+ * misses and branch misses in user space around each continuation call and
+ * adds them to the profile of the procedure. The counters are read with a
+ * system call before and after each call, so the overhead is around a few
+ * microseconds per call. Available only on Linux where perf events are
+ * accessible, e.g. kernel.perf_event_paranoid is 2 or lower. An executor
+ * which fails to open its counters just leaves them out. Effective only while
+ * profiling.
+ * @param context The profiled @ref ARMD_Context
+ * @return Status code, 0 if succeeded, non-zero if the counters are
+ * unavailable
+ */
+ARMD_EXTERN_C int armd_context_enable_perf_counters(ARMD_Context *context);
+
+/**
+ * @brief Stop counting hardware events
+ * @param context The profiled @ref ARMD_Context
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_disable_perf_counters(ARMD_Context *context);
+
+/**
+ * @brief Hardware events counted in continuation calls
+ * @details num_samples is the number of the counted calls. The counters
+ * which the CPU does not support stay zero.
+ */
+typedef struct TAG_ARMD_PerfCounters {
+    ARMD_Size num_samples;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cache_misses;
+    uint64_t branch_misses;
+} ARMD_PerfCounters;
+
+/**
+ * @brief Profile of a procedure merged across executors
+ */
+typedef struct TAG_ARMD_ProcedureProfile {
+    ARMD_Size num_invocations;
+    ARMD_Histogram queueing_delay;
+    ARMD_PerfCounters perf_counters;
+} ARMD_ProcedureProfile;
+
+/**
+ * @brief Get the profile of the procedure
+ * @param context The profiled @ref ARMD_Context
+ * @param procedure The procedure
+ * @param profile Receives the profile
+ * @param execution_times The array of @ref
+ * armd_procedure_get_num_continuations elements to receive the execution time
+ * of each continuation. Nullable.
+ * @return Status code, 0 if succeeded, non-zero if the procedure has not run
+ * while profiling
+ */
+ARMD_EXTERN_C int
+armd_context_get_procedure_profile(ARMD_Context *context,
+                                   const ARMD_Procedure *procedure,
+                                   ARMD_ProcedureProfile *profile,
+                                   ARMD_Histogram *execution_times);
+
+/**
+ * @brief Get the procedures which have run while profiling
+ * @param context The profiled @ref ARMD_Context
+ * @param procedures The array to receive the procedures
+ * @param max_num_procedures The number of elements of procedures
+ * @return The number of the profiled procedures, which may be more than
+ * max_num_procedures
+ */
+ARMD_EXTERN_C ARMD_Size
+armd_context_get_profiled_procedures(ARMD_Context *context,
+                                     const ARMD_Procedure **procedures,
+                                     ARMD_Size max_num_procedures);
+
+/**
+ * @brief Result of the work/span analysis in nanoseconds
+ * @details The work is the total execution time of the setups and the
+ * continuations (strands), and the span is the execution time along the
+ * longest path through the fork/join and the dependency edges. The burdened
+ * span also includes the time from getting ready to starting of the jobs on
+ * the path, which is the scheduling overhead. The parallelism is work / span,
+ * the upper bound of the speedup whatever the number of executors is.
+ */
+typedef struct TAG_ARMD_SpanAnalysis {
+    uint64_t work;
+    uint64_t span;
+    uint64_t burdened_span;
+    ARMD_Size num_strands;
+    ARMD_Real parallelism;
+    ARMD_Real burdened_parallelism;
+} ARMD_SpanAnalysis;
+
+/**
+ * @brief Start the work/span analysis
+ * @details Resets the result and analyzes the jobs which get ready after this
+ * call. Call this while no job is running for an accurate result.
+ * @param context The @ref ARMD_Context to analyze
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_enable_span_analysis(ARMD_Context *context);
+
+/**
+ * @brief Stop the work/span analysis
+ * @details The result is kept until the analysis is enabled again.
+ * @param context The analyzed @ref ARMD_Context
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_disable_span_analysis(ARMD_Context *context);
+
+/**
+ * @brief Get the result of the work/span analysis
+ * @details The span covers the completed promises only.
+ * @param context The analyzed @ref ARMD_Context
+ * @param analysis Receives the result
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_context_get_span_analysis(ARMD_Context *context,
+                                                 ARMD_SpanAnalysis *analysis);
+
 /**
  * @brief Invoke procedure
  * @param context The @ref ARMD_Context to run the @ref procedure in
@@ -213,6 +674,28 @@ ARMD_EXTERN_C ARMD_Handle armd_invoke(ARMD_Context *context,
                                       ARMD_Procedure *procedure, void *args,
                                       ARMD_Size num_dependencies,
                                       const ARMD_Handle *dependencies);
+/**
+ * @brief Invoke procedure when some of the dependencies are completed
+ * @details Same as @ref armd_invoke except that the job gets ready as soon as
+ * @ref num_required dependencies are completed, either succeeded or failed.
+ * The rest are unlinked then, so their completion and errors do not affect
+ * the job, and @ref armd_job_get_dependency_result returns NULL for them.
+ * Use @ref num_required == 1 to run the job on the first one.
+ * @param context The @ref ARMD_Context to run the @ref procedure in
+ * @param procedure The @ref ARMD_Procedure to run
+ * @param args The arguments to pass into @ref ARMD_Procedure
+ * @param num_dependencies The number of elements in @ref dependencies
+ * @param dependencies The array of handles of dependent promises
+ * @param num_required The number of the dependencies to wait for, from 1 to
+ * the number of the non-zero handles in @ref dependencies
+ * @return The new handle of promise, 0 if failure
+ */
+ARMD_EXTERN_C ARMD_Handle armd_invoke_quorum(ARMD_Context *context,
+                                             ARMD_Procedure *procedure,
+                                             void *args,
+                                             ARMD_Size num_dependencies,
+                                             const ARMD_Handle *dependencies,
+                                             ARMD_Size num_required);
 /**
  * @brief Await promise
  * @details This function locks the caller thread and it will not return until
@@ -223,6 +706,37 @@ ARMD_EXTERN_C ARMD_Handle armd_invoke(ARMD_Context *context,
  */
 ARMD_EXTERN_C int armd_await(ARMD_Context *context, ARMD_Handle handle);
 
+/**
+ * @brief Await promise and copy its result
+ * @details Same as @ref armd_await except that the result written by the job
+ * is copied into @ref result if the job succeeded. See @ref
+ * armd_procedure_builder_set_result_size.
+ * @param context The @ref ARMD_Context which promise belongs to
+ * @param handle The @ref ARMD_Handle of the promise to be awaited
+ * @param result The buffer to receive the result
+ * @param result_size The size of @ref result, which must be the result size
+ * of the procedure
+ * @return Status code, 0 if succeeded, -1 if the handle or the size is
+ * invalid, -2 if the job failed
+ */
+ARMD_EXTERN_C int armd_await_result(ARMD_Context *context, ARMD_Handle handle,
+                                    void *result, ARMD_Size result_size);
+
+/**
+ * @brief Await the first of promises
+ * @details This function locks the caller thread until any of the promises is
+ * completed. Only the completed one is consumed as with @ref armd_await; the
+ * others are still to be awaited or detached.
+ * @param context The @ref ARMD_Context which promises belong to
+ * @param num_handles The number of elements in @ref handles
+ * @param handles The array of @ref ARMD_Handle of the promises
+ * @param index Receives the index of the completed one in @ref handles
+ * @return Status code, 0 if succeeded, -1 if any handle is invalid, -2 if the
+ * completed job failed
+ */
+ARMD_EXTERN_C int armd_await_any(ARMD_Context *context, ARMD_Size num_handles,
+                                 const ARMD_Handle *handles, ARMD_Size *index);
+
 /**
  * @brief Detach promise
  * @details This function detaches the job.
@@ -237,6 +751,134 @@ ARMD_EXTERN_C int armd_detach(ARMD_Context *context, ARMD_Handle handle);
  */
 ARMD_EXTERN_C int armd_await_all(ARMD_Context *context);
 
+/**
+ * @brief Task group
+ * @details A set of jobs which can be awaited together. The jobs of a group
+ * have no promise, so waiting for them does not touch the promise table and
+ * wakes only the threads waiting for the group.
+ */
+typedef struct TAG_ARMD_TaskGroup ARMD_TaskGroup;
+
+/**
+ * @brief Create @ref ARMD_TaskGroup
+ * @param context The @ref ARMD_Context to run the jobs of the group in
+ * @return The created @ref ARMD_TaskGroup, NULL if failure
+ */
+ARMD_EXTERN_C ARMD_TaskGroup *armd_task_group_create(ARMD_Context *context);
+
+/**
+ * @brief Destroy @ref ARMD_TaskGroup
+ * @details The group must be destroyed before its @ref ARMD_Context.
+ * @param task_group The @ref ARMD_TaskGroup to destroy
+ * @return Status code, 0 if succeeded, non-zero if some jobs are still
+ * running
+ */
+ARMD_EXTERN_C int armd_task_group_destroy(ARMD_TaskGroup *task_group);
+
+/**
+ * @brief Invoke procedure in the task group
+ * @details Same as @ref armd_invoke except that the job has neither
+ * dependencies nor a handle. If the procedure has a result, the job gets
+ * storage for it as with @ref armd_invoke, and the result is discarded when
+ * the job ends.
+ * @param task_group The @ref ARMD_TaskGroup to add the job to
+ * @param procedure The @ref ARMD_Procedure to run
+ * @param args The arguments to pass into @ref ARMD_Procedure
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_task_group_invoke(ARMD_TaskGroup *task_group,
+                                         ARMD_Procedure *procedure,
+                                         void *args);
+
+/**
+ * @brief Await all jobs in the task group
+ * @details This function locks the caller thread until every job invoked in
+ * the group so far has ended. The group can be reused after that.
+ * @param task_group The @ref ARMD_TaskGroup to be awaited
+ * @return Status code, 0 if succeeded, -1 if the group is invalid, -2 if any
+ * job failed since the last wait
+ */
+ARMD_EXTERN_C int armd_task_group_wait(ARMD_TaskGroup *task_group);
+
+/**
+ * @brief Completion queue
+ * @details A queue of the completed promises for the callers which cannot
+ * block in @ref armd_await, such as event loops. The executors push the
+ * completions without locks and one thread harvests them in batches.
+ */
+typedef struct TAG_ARMD_CompletionQueue ARMD_CompletionQueue;
+
+/**
+ * @brief A completed promise, see @ref armd_completion_queue_poll
+ */
+typedef struct TAG_ARMD_Completion {
+    ARMD_Handle handle;
+    void *user_context;
+    int has_error;
+} ARMD_Completion;
+
+/**
+ * @brief Create @ref ARMD_CompletionQueue
+ * @param context The @ref ARMD_Context which the promises belong to
+ * @param uses_fd Non-zero to get a file descriptor which is readable while
+ * completions are pending, see @ref armd_completion_queue_get_fd. Only
+ * supported on Linux, where it is an eventfd.
+ * @return The created @ref ARMD_CompletionQueue, NULL if failure
+ */
+ARMD_EXTERN_C ARMD_CompletionQueue *
+armd_completion_queue_create(ARMD_Context *context, ARMD_Bool uses_fd);
+
+/**
+ * @brief Destroy @ref ARMD_CompletionQueue
+ * @details The completions not polled yet are discarded.
+ * @param completion_queue The @ref ARMD_CompletionQueue to destroy
+ * @return Status code, 0 if succeeded, non-zero if some watched promises are
+ * not completed yet
+ */
+ARMD_EXTERN_C int
+armd_completion_queue_destroy(ARMD_CompletionQueue *completion_queue);
+
+/**
+ * @brief Push the promise to the queue when it is completed
+ * @details The handle is not consumed; call @ref armd_await or @ref
+ * armd_await_result after polling it, or detach it. The await may still
+ * block until the other callbacks added to the promise with @ref
+ * armd_add_promise_callback return.
+ * @param completion_queue The @ref ARMD_CompletionQueue to push to
+ * @param handle The @ref ARMD_Handle of the promise to watch
+ * @param user_context The value returned with the completion
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_completion_queue_watch(ARMD_CompletionQueue *completion_queue,
+                            ARMD_Handle handle, void *user_context);
+
+/**
+ * @brief Take the completions from the queue without blocking
+ * @details The completions are returned in the order of the completion.
+ * Only one thread at a time may poll the queue.
+ * @param completion_queue The @ref ARMD_CompletionQueue to poll
+ * @param completions The array to receive the completions
+ * @param max_num_completions The number of elements in @ref completions
+ * @return The number of the completions received
+ */
+ARMD_EXTERN_C ARMD_Size
+armd_completion_queue_poll(ARMD_CompletionQueue *completion_queue,
+                           ARMD_Completion *completions,
+                           ARMD_Size max_num_completions);
+
+/**
+ * @brief Get the file descriptor to wait for the completions
+ * @details The descriptor becomes readable when completions are pending, to
+ * be registered to epoll and the like. It stays readable until @ref
+ * armd_completion_queue_poll takes all of them, and must not be read or
+ * closed by the caller.
+ * @param completion_queue The @ref ARMD_CompletionQueue
+ * @return The file descriptor, -1 if not created with one
+ */
+ARMD_EXTERN_C int
+armd_completion_queue_get_fd(ARMD_CompletionQueue *completion_queue);
+
 /**
  * @brief Promise callback
  * @details The function called when promise resolved. See @ref
@@ -248,9 +890,10 @@ typedef void (*ARMD_PromiseCallbackFunc)(ARMD_Handle handle,
  * @brief Add callback to the promise
  * @details Add a function to be called when the promise being resolved.
  * Note that the thread which invokes the callback is not indeterminate and the
- * promise_callback may be invoked immediately. Many API in libaramid is not
- * reentrant. If you calls any API of libaramid in this callback, a deadlock may
- * occur.
+ * promise_callback may be invoked immediately. The callback is invoked without
+ * the internal locks, so it may invoke other procedures, but awaiting the
+ * promise itself in the callback causes a deadlock because @ref armd_await
+ * returns after the callbacks.
  */
 ARMD_EXTERN_C
 int armd_add_promise_callback(ARMD_Context *context, ARMD_Handle handle,
@@ -276,6 +919,70 @@ ARMD_EXTERN_C ARMD_Size armd_job_get_num_executors(ARMD_Job *job);
  */
 ARMD_EXTERN_C ARMD_Size armd_job_get_executor_id(ARMD_Job *job);
 
+/**
+ * @brief Get the storage of the result via @ref ARMD_Job
+ * @details The storage is owned by the promise of the job invoked with @ref
+ * armd_invoke and its content is indeterminate until the job writes it.
+ * Jobs created with @ref armd_fork have no result; pass the destination in
+ * their arguments instead.
+ * @param job The current @ref ARMD_Job
+ * @return The storage of @ref armd_procedure_get_result_size bytes. NULL if
+ * the job has no result.
+ */
+ARMD_EXTERN_C void *armd_job_get_result(ARMD_Job *job);
+/**
+ * @brief Get the result of a dependency via @ref ARMD_Job
+ * @details The results of the dependencies given to @ref armd_invoke are
+ * kept alive until the job ends, so they are read in place without copies
+ * even if the dependencies have been awaited.
+ * @param job The current @ref ARMD_Job
+ * @param index The index in the dependencies given to @ref armd_invoke
+ * @return The result. NULL if the index is out of range, or the dependency
+ * has no result or failed.
+ */
+ARMD_EXTERN_C const void *armd_job_get_dependency_result(ARMD_Job *job,
+                                                         ARMD_Size index);
+
+/**
+ * @brief Get a part of static partition
+ * @details It splits [0, @ref count) into @ref num_parts contiguous ranges
+ * whose sizes differ by at most one and returns the @ref part_index -th one.
+ * @param count The number of elements to split
+ * @param num_parts The number of parts
+ * @param part_index The index of the part to get
+ * @param begin The first element of the part
+ * @param end The element next to the last one of the part
+ */
+ARMD_EXTERN_C void armd_get_static_partition(ARMD_Size count,
+                                             ARMD_Size num_parts,
+                                             ARMD_Size part_index,
+                                             ARMD_Size *begin, ARMD_Size *end);
+
+/**
+ * @brief Allocate a buffer whose pages are first touched by executors
+ * @details Operating systems usually place a page on the NUMA node of the
+ * thread which touches it first. This function splits the buffer into the
+ * byte ranges given by @ref armd_get_static_partition with one part per
+ * executor and forks the job touching part i onto executor i. Process the part
+ * of the executor returned by @ref armd_job_get_executor_id to access local
+ * memory. The placement is best-effort: a job can be stolen by another
+ * executor before its own one picks it up, for example while that executor is
+ * busy with other procedures, and a page shared by two parts goes to either
+ * of them. On a single node machine it only parallelizes page faults. The
+ * memory allocator must not touch the pages on allocation; the default and
+ * huge page allocators do not for large buffers. Do not call this function
+ * from jobs.
+ * @param context The @ref ARMD_Context whose executors touch the buffer
+ * @param memory_allocator The memory allocator to allocate the buffer with
+ * @param size The size of the buffer in bytes
+ * @return The buffer, which should be freed with @ref
+ * armd_memory_allocator_free. NULL if failed.
+ */
+ARMD_EXTERN_C void *
+armd_allocate_first_touch(ARMD_Context *context,
+                          const ARMD_MemoryAllocator *memory_allocator,
+                          ARMD_Size size);
+
 /**
  * @brief Fork and invoke procedure
  * @details This function forks the thread of execution and invoke the @ref
@@ -338,7 +1045,9 @@ typedef void (*ARMD_ContinuationConstantsDestroyer)(
 
 /**
  * @brief Continuation Frame Creator
- * @details This function allocates and initializes continuation frame.
+ * @details This function allocates and initializes continuation frame. The
+ * memory region may be local to the executor running the job, so do not use it
+ * except for allocating and freeing the continuation frame.
  * @param memory_region The memory region for the continuation frame to live in
  * @return The new continuation frame. You can return NULL if failed.
  */
@@ -428,6 +1137,20 @@ typedef struct TAG_ARMD_ProcedureBuilder ARMD_ProcedureBuilder;
 ARMD_EXTERN_C ARMD_ProcedureBuilder *
 armd_procedure_builder_create(const ARMD_MemoryAllocator *memory_allocator,
                               ARMD_Size constant_size, ARMD_Size frame_size);
+/**
+ * @brief Create @ref ARMD_ProcedureBuilder with aligned constants and frame
+ * @details Same as @ref armd_procedure_builder_create except that the constant
+ * table and every frame of the procedure are aligned to @ref alignment bytes.
+ * Use this for example to keep SIMD data or cache-line padded data in them.
+ * @param memory_allocator The memory allocator to use
+ * @param constant_size The size of constant table
+ * @param frame_size The size of frame
+ * @param alignment Alignment in bytes. It must be a power of two.
+ * @return The pointer to the new @ref ARMD_ProcedureBuilder. NULL if failed.
+ */
+ARMD_EXTERN_C ARMD_ProcedureBuilder *armd_procedure_builder_create_aligned(
+    const ARMD_MemoryAllocator *memory_allocator, ARMD_Size constant_size,
+    ARMD_Size frame_size, ARMD_Size alignment);
 /**
  * @brief Destroy @ref ARMD_ProcedureBuilder without building @ref
  * ARMD_Procedure
@@ -506,11 +1229,13 @@ ARMD_EXTERN_C int armd_then_parallel_for(
     ARMD_ParallelForContinuationFunc parallel_for_continuation_func);
 
 /**
- * @brief Add unwind callback to the procedure
- * @details Adds the unwind callback to the procedure. The unwind callback is
- * called when procedures exit independent of the execution status.
+ * @brief Add setup callback to the procedure
+ * @details Adds the setup callback to the procedure. The setup callback is
+ * called before the first continuation and it can fail the job by returning
+ * non-zero.
  */
-int armd_setup(ARMD_ProcedureBuilder *builder, ARMD_SetupFunc setup_func);
+ARMD_EXTERN_C int armd_setup(ARMD_ProcedureBuilder *builder,
+                             ARMD_SetupFunc setup_func);
 
 /**
  * @brief Add unwind callback to the procedure
@@ -520,6 +1245,22 @@ int armd_setup(ARMD_ProcedureBuilder *builder, ARMD_SetupFunc setup_func);
 ARMD_EXTERN_C int armd_unwind(ARMD_ProcedureBuilder *procedure_builder,
                               ARMD_UnwindFunc unwind_func);
 
+/**
+ * @brief Declare the size of the result of the procedure
+ * @details Each invocation of the procedure with @ref armd_invoke gets the
+ * storage of @ref result_size bytes owned by its promise, which the job
+ * writes via @ref armd_job_get_result. Small results are stored in the
+ * promise without allocation. The result is read with @ref armd_await_result
+ * or by dependent jobs with @ref armd_job_get_dependency_result. Defaults to
+ * zero, i.e. no result.
+ * @param procedure_builder The procedure builder
+ * @param result_size The size of the result in bytes
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_procedure_builder_set_result_size(ARMD_ProcedureBuilder *procedure_builder,
+                                       ARMD_Size result_size);
+
 /**
  * @brief Destroy @ref ARMD_Procedure
  * @param memory_region The procedure to destroy
@@ -534,6 +1275,40 @@ ARMD_EXTERN_C int armd_procedure_destroy(ARMD_Procedure *procedure);
  */
 ARMD_EXTERN_C void *armd_procedure_get_constants(ARMD_Procedure *procedure);
 
+/**
+ * @brief Set the name of the procedure
+ * @details The name is for users to identify the procedure in profiles.
+ * @param procedure The procedure
+ * @param name The name, which is copied. NULL to clear.
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_procedure_set_name(ARMD_Procedure *procedure,
+                                          const char *name);
+
+/**
+ * @brief Get the name of the procedure
+ * @param procedure The procedure
+ * @return The name. NULL if not set.
+ */
+ARMD_EXTERN_C const char *
+armd_procedure_get_name(const ARMD_Procedure *procedure);
+
+/**
+ * @brief Get the number of continuations
+ * @param procedure The procedure
+ * @return The number of continuations
+ */
+ARMD_EXTERN_C ARMD_Size
+armd_procedure_get_num_continuations(const ARMD_Procedure *procedure);
+
+/**
+ * @brief Get the size of the result
+ * @param procedure The procedure
+ * @return The size of the result in bytes. Zero if the procedure has none.
+ */
+ARMD_EXTERN_C ARMD_Size
+armd_procedure_get_result_size(const ARMD_Procedure *procedure);
+
 /* Time */
 
 typedef struct TAG_ARMD_Timespec {
@@ -545,6 +1320,25 @@ ARMD_EXTERN_C int armd_get_time(ARMD_Timespec *result);
 ARMD_EXTERN_C char *armd_format_time_iso8601(ARMD_MemoryRegion *memory_region,
                                              const ARMD_Timespec *timespec);
 
+/**
+ * @brief Get a timestamp of a monotonic high-resolution clock
+ * @details The clock is the invariant time stamp counter on x86 processors
+ * which have one, and the monotonic clock of the OS otherwise. The unit and
+ * the origin are unspecified, so convert the difference of two timestamps
+ * with @ref armd_timestamp_to_nanoseconds. The first call in the process may
+ * take some milliseconds to calibrate the clock.
+ * @return The timestamp
+ */
+ARMD_EXTERN_C uint64_t armd_get_timestamp(void);
+
+/**
+ * @brief Convert a timestamp to nanoseconds
+ * @param timestamp The timestamp or the difference of two timestamps of
+ * @ref armd_get_timestamp
+ * @return The nanoseconds
+ */
+ARMD_EXTERN_C uint64_t armd_timestamp_to_nanoseconds(uint64_t timestamp);
+
 /* Logger */
 
 typedef enum TAG_ARMD_LogLevel {
@@ -608,6 +1402,145 @@ void armd_logger_log_format(ARMD_Logger *logger, ARMD_LogLevel level,
 
 #undef ARMD_LOGGER_LOG_FORMAT_ATTRIBUTE
 
+/**
+ * @brief What an asynchronous logger does when a buffer is full
+ */
+typedef enum TAG_ARMD_LogOverflowPolicy {
+    /** Discard the record, see @ref armd_logger_get_num_dropped */
+    ARMD_LogOverflowPolicy_Drop,
+    /** Wait until the flusher makes room */
+    ARMD_LogOverflowPolicy_Block,
+} ARMD_LogOverflowPolicy;
+
+/**
+ * @brief Switch the logger to the asynchronous mode
+ * @details Logging then formats the message into a fixed-size record in a
+ * lock-free ring buffer without allocation, and returns. A background flusher
+ * thread moves the records into the log elements in batches and invokes the
+ * callback once per batch, so the callback, e.g. the file output, runs on the
+ * flusher thread. Messages longer than 199 bytes are truncated. The order is
+ * kept among the records from the same thread. Executors with an id below
+ * num_buffers - 1 have their own buffer and the other threads share the last
+ * one. Call it before logging from other threads. The flusher stops when the
+ * last reference to the logger is released, after writing all the records.
+ * Do not log to the logger or flush it in its callback.
+ * @param logger The logger
+ * @param num_buffers The number of buffers, usually the number of executors
+ * plus 1
+ * @param buffer_size The number of records in each buffer, rounded up to a
+ * power of 2. It bounds the memory used.
+ * @param overflow_policy What to do when a buffer is full
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_logger_enable_async(ARMD_Logger *logger, ARMD_Size num_buffers,
+                         ARMD_Size buffer_size,
+                         ARMD_LogOverflowPolicy overflow_policy);
+
+/**
+ * @brief Wait until the records logged so far are handed to the callback
+ * @details It returns immediately if the logger is not asynchronous because
+ * the callback has already been invoked.
+ * @param logger The logger
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_logger_flush(ARMD_Logger *logger);
+
+/**
+ * @brief Get the number of records discarded by the asynchronous logger
+ * @param logger The logger
+ * @return The number of records discarded with @ref
+ * ARMD_LogOverflowPolicy_Drop, or because the flusher ran out of memory
+ */
+ARMD_EXTERN_C ARMD_Size armd_logger_get_num_dropped(ARMD_Logger *logger);
+
+/**
+ * @brief Defer formatting of the asynchronous logger
+ * @details Logging with @ref armd_logger_log_format then records the format
+ * string pointer and copies the arguments into the record as raw bytes, and
+ * the flusher formats the message. Strings passed for %s are copied. The
+ * format string must stay valid until the logger is destroyed, which string
+ * literals do, e.g. with the armd_log_* macros. A call whose format uses %ls,
+ * %lc or positional arguments, or whose arguments do not fit into a record,
+ * is formatted on the spot as before. Call it after @ref
+ * armd_logger_enable_async and before logging from other threads.
+ * @param logger The asynchronous logger
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_logger_enable_deferred_format(ARMD_Logger *logger);
+
+/**
+ * @brief Binary log writer
+ * @details The function called with each chunk of the binary log. See @ref
+ * armd_logger_set_binary_writer.
+ * @return Status code, 0 if succeeded, non-zero if failed, in which case the
+ * record is counted as dropped
+ */
+typedef int (*ARMD_LogWriterFunc)(void *writer_context, const void *data,
+                                  ARMD_Size size);
+
+/**
+ * @brief Write the records of the asynchronous logger in the binary form
+ * @details It enables the deferred formatting, see @ref
+ * armd_logger_enable_deferred_format, and the flusher passes the records with
+ * the raw arguments to writer_func instead of making log elements, so the
+ * callback is not invoked for them and nothing is formatted in this process.
+ * Each format string and filename is written once. The output is decoded
+ * with @ref armd_logger_decode_binary, e.g. by the aramid_log_decode tool, on
+ * a machine with the same data model. The header is written to writer_func
+ * in this call. Call it after @ref armd_logger_enable_async and before
+ * logging from other threads.
+ * @param logger The asynchronous logger
+ * @param writer_func The function to receive the output, called on the
+ * flusher thread
+ * @param writer_context The pointer passed to writer_func
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int armd_logger_set_binary_writer(ARMD_Logger *logger,
+                                                ARMD_LogWriterFunc writer_func,
+                                                void *writer_context);
+
+/**
+ * @brief Copy the log records into a flight recorder
+ * @details The formatted records are written to the log ring of the file,
+ * by the flusher thread if the logger is asynchronous, in addition to the
+ * usual output. Messages longer than 199 bytes and filenames longer than 63
+ * bytes are truncated. Only one logger may write to a flight recorder.
+ * @param logger The logger
+ * @param flight_recorder The flight recorder
+ * @return Status code, 0 if succeeded, non-zero if otherwise
+ */
+ARMD_EXTERN_C int
+armd_logger_set_flight_recorder(ARMD_Logger *logger,
+                                ARMD_FlightRecorder *flight_recorder);
+
+/**
+ * @brief Log decoder
+ * @details The function called with each decoded log element. The element
+ * and its strings are valid only during the call. See @ref
+ * armd_logger_decode_binary.
+ * @return Status code, 0 if succeeded, non-zero to abort decoding
+ */
+typedef int (*ARMD_LogDecoderFunc)(void *decoder_context,
+                                   const ARMD_LogElement *log_element);
+
+/**
+ * @brief Format the records written by @ref armd_logger_set_binary_writer
+ * @details The data may end in the middle of a record, e.g. if the process
+ * was killed, and the incomplete record is ignored.
+ * @param memory_region The memory region for the work memory
+ * @param data The binary log
+ * @param size The size of data in bytes
+ * @param decoder_func The function to receive the log elements in order
+ * @param decoder_context The pointer passed to decoder_func
+ * @return Status code, 0 if succeeded, non-zero if the data is malformed,
+ * written on another data model or decoder_func aborted
+ */
+ARMD_EXTERN_C int armd_logger_decode_binary(ARMD_MemoryRegion *memory_region,
+                                            const void *data, ARMD_Size size,
+                                            ARMD_LogDecoderFunc decoder_func,
+                                            void *decoder_context);
+
 #define armd_log_fatal(logger, format, ...)                                    \
     armd_logger_log_format(logger, ARMD_LogLevel_Fatal, __FILE__, __LINE__,    \
                            format, __VA_ARGS__)
@@ -0,0 +1,197 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#include "arena.h"
+#include "memory_allocator.h"
+#include "spinlock.h"
+
+static const ARMD_Size arena_alignment = 16;
+
+static ARMD_Size align_size(ARMD_Size size) {
+    return (size + arena_alignment - 1) / arena_alignment * arena_alignment;
+}
+
+static ARMD_Size get_block_header_size() {
+    return align_size(sizeof(ARMD__ArenaBlock));
+}
+
+static unsigned char *get_block_data(ARMD__ArenaBlock *block) {
+    return ((unsigned char *)block) + get_block_header_size();
+}
+
+static ARMD__ArenaBlock *
+create_block(const ARMD_MemoryAllocator *memory_allocator, ARMD_Size capacity) {
+    ARMD__ArenaBlock *block = armd_memory_allocator_allocate(
+        memory_allocator, get_block_header_size() + capacity);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->used = 0;
+    block->capacity = capacity;
+
+    return block;
+}
+
+static void destroy_block_list(const ARMD_MemoryAllocator *memory_allocator,
+                               ARMD__ArenaBlock *block) {
+    while (block != NULL) {
+        ARMD__ArenaBlock *next = block->next;
+        armd_memory_allocator_free(memory_allocator, block);
+        block = next;
+    }
+}
+
+int armd__arena_init(ARMD__Arena *arena,
+                     const ARMD_MemoryAllocator *memory_allocator,
+                     ARMD_Size block_size) {
+    assert(arena != NULL);
+    assert(memory_allocator != NULL);
+
+    arena->memory_allocator = *memory_allocator;
+    arena->block_size = align_size(block_size);
+    arena->num_allocations = 0;
+    arena->blocks = NULL;
+    arena->free_blocks = NULL;
+
+    if (armd__spinlock_init(&arena->lock)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+ARMD_Size armd__arena_deinit(ARMD__Arena *arena) {
+    int res = 0;
+    (void)res;
+
+    assert(arena != NULL);
+
+    ARMD_Size num_allocations = arena->num_allocations;
+
+    destroy_block_list(&arena->memory_allocator, arena->blocks);
+    arena->blocks = NULL;
+    destroy_block_list(&arena->memory_allocator, arena->free_blocks);
+    arena->free_blocks = NULL;
+
+    res = armd__spinlock_deinit(&arena->lock);
+    assert(res == 0);
+
+    return num_allocations;
+}
+
+ARMD_Size armd__arena_reset(ARMD__Arena *arena) {
+    int res = 0;
+    (void)res;
+
+    assert(arena != NULL);
+
+    res = armd__spinlock_lock(&arena->lock);
+    assert(res == 0);
+
+    ARMD_Size num_allocations = arena->num_allocations;
+
+    ARMD__ArenaBlock *block = arena->blocks;
+    while (block != NULL) {
+        ARMD__ArenaBlock *next = block->next;
+        if (arena->block_size != 0 && block->capacity == arena->block_size) {
+            // Keep standard blocks for reuse
+            block->used = 0;
+            block->next = arena->free_blocks;
+            arena->free_blocks = block;
+        } else {
+            armd_memory_allocator_free(&arena->memory_allocator, block);
+        }
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->num_allocations = 0;
+
+    res = armd__spinlock_unlock(&arena->lock);
+    assert(res == 0);
+
+    return num_allocations;
+}
+
+/* Returns the body position in the block, or NULL if it does not fit */
+static unsigned char *fit_in_block(ARMD__ArenaBlock *block, ARMD_Size size,
+                                   ARMD_Size alignment) {
+    unsigned char *data = get_block_data(block);
+    unsigned char *body = armd__align_pointer(data + block->used, alignment);
+    if (body + size > data + block->capacity) {
+        return NULL;
+    }
+
+    block->used = (ARMD_Size)(body + size - data);
+    return body;
+}
+
+void *armd__arena_allocate(ARMD__Arena *arena, ARMD_Size size,
+                           ARMD_Size alignment) {
+    int res = 0;
+    (void)res;
+
+    assert(arena != NULL);
+    assert(armd__is_valid_alignment(alignment));
+
+    if (alignment < arena_alignment) {
+        alignment = arena_alignment;
+    }
+
+    ARMD_Size aligned_size = align_size(size == 0 ? 1 : size);
+    ARMD_Size worst_size =
+        aligned_size + (alignment > arena_alignment ? alignment - 1 : 0);
+    void *body = NULL;
+
+    res = armd__spinlock_lock(&arena->lock);
+    assert(res == 0);
+
+    ARMD__ArenaBlock *current = arena->blocks;
+    if (worst_size > arena->block_size) {
+        // Dedicated block behind the current one not to waste its space
+        ARMD__ArenaBlock *block =
+            create_block(&arena->memory_allocator, worst_size);
+        if (block == NULL) {
+            goto finally;
+        }
+
+        if (current != NULL) {
+            block->next = current->next;
+            current->next = block;
+        } else {
+            arena->blocks = block;
+        }
+        body = fit_in_block(block, aligned_size, alignment);
+    } else {
+        if (current != NULL && current->capacity == arena->block_size) {
+            body = fit_in_block(current, aligned_size, alignment);
+        }
+
+        if (body == NULL) {
+            ARMD__ArenaBlock *block = arena->free_blocks;
+            if (block != NULL) {
+                arena->free_blocks = block->next;
+            } else {
+                block =
+                    create_block(&arena->memory_allocator, arena->block_size);
+                if (block == NULL) {
+                    goto finally;
+                }
+            }
+            block->next = current;
+            arena->blocks = block;
+            body = fit_in_block(block, aligned_size, alignment);
+        }
+    }
+    assert(body != NULL);
+
+    ++arena->num_allocations;
+
+finally:
+    res = armd__spinlock_unlock(&arena->lock);
+    assert(res == 0);
+
+    return body;
+}
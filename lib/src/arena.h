@@ -0,0 +1,37 @@
+#ifndef ARAMID__ARENA_H
+#define ARAMID__ARENA_H
+
+#include <aramid/aramid.h>
+
+#include "memory_allocator.h"
+#include "spinlock.h"
+
+typedef struct TAG_ARMD__ArenaBlock {
+    struct TAG_ARMD__ArenaBlock *next;
+    ARMD_Size used;
+    ARMD_Size capacity;
+} ARMD__ArenaBlock;
+
+/*
+ * Bump allocator which releases everything at once. When block_size is zero,
+ * every allocation gets its own block so that sanitizers can check it.
+ */
+typedef struct TAG_ARMD__Arena {
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD__Spinlock lock;
+    ARMD_Size block_size;
+    ARMD_Size num_allocations;
+    ARMD__ArenaBlock *blocks;
+    ARMD__ArenaBlock *free_blocks;
+} ARMD__Arena;
+
+ARMD_EXTERN_C int armd__arena_init(ARMD__Arena *arena,
+                                   const ARMD_MemoryAllocator *memory_allocator,
+                                   ARMD_Size block_size);
+ARMD_EXTERN_C ARMD_Size armd__arena_deinit(ARMD__Arena *arena);
+ARMD_EXTERN_C ARMD_Size armd__arena_reset(ARMD__Arena *arena);
+
+ARMD_EXTERN_C void *armd__arena_allocate(ARMD__Arena *arena, ARMD_Size size,
+                                         ARMD_Size alignment);
+
+#endif // ARAMID__ARENA_H
@@ -0,0 +1,308 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#include "completion_queue.h"
+
+#include "context.h"
+#include "thread.h"
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+#if defined(__linux__)
+
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static int open_event(void) { return eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC); }
+
+static void close_event(int fd) { close(fd); }
+
+static void signal_event(int fd) {
+    uint64_t value = 1;
+    if (write(fd, &value, sizeof(value)) < 0) {
+        // The counter cannot overflow with the writes of one per poll
+        assert(0);
+    }
+}
+
+static void clear_event(int fd) {
+    uint64_t value;
+    if (read(fd, &value, sizeof(value)) < 0) {
+        // Not signaled
+    }
+}
+
+#else
+
+static int open_event(void) { return -1; }
+
+static void close_event(int fd) { (void)fd; }
+
+static void signal_event(int fd) { (void)fd; }
+
+static void clear_event(int fd) { (void)fd; }
+
+#endif
+
+static ARMD__CompletionNode *load_head(ARMD__CompletionNode *volatile *head) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(head, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    return *head;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+/* Updates expected with the current value on failure */
+static ARMD_Bool compare_exchange_head(ARMD__CompletionNode *volatile *head,
+                                       ARMD__CompletionNode **expected,
+                                       ARMD__CompletionNode *desired) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_compare_exchange_n(head, expected, desired, 1,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    ARMD__CompletionNode *previous = InterlockedCompareExchangePointer(
+        (PVOID volatile *)head, desired, *expected);
+    if (previous == *expected) {
+        return 1;
+    }
+    *expected = previous;
+    return 0;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static ARMD__CompletionNode *
+exchange_head(ARMD__CompletionNode *volatile *head,
+              ARMD__CompletionNode *desired) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_exchange_n(head, desired, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return InterlockedExchangePointer((PVOID volatile *)head, desired);
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static ARMD_Size load_count(const volatile ARMD_Size *count) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(count, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return *count;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void add_count(volatile ARMD_Size *count, ARMD_Size value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_add_fetch(count, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4127)
+    if (sizeof(ARMD_Size) == 4) {
+        InterlockedExchangeAdd((volatile LONG *)count, (LONG)value);
+    } else {
+        InterlockedExchangeAdd64((volatile LONG64 *)count, (LONG64)value);
+    }
+#pragma warning(pop)
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+/* Moves the pushed nodes to the pending list in the order of the push */
+static void take_nodes(ARMD_CompletionQueue *completion_queue) {
+    ARMD__CompletionNode *node = exchange_head(&completion_queue->head, NULL);
+    ARMD__CompletionNode *taken_head = NULL;
+    ARMD__CompletionNode *taken_tail = node;
+    while (node != NULL) {
+        ARMD__CompletionNode *next = node->next;
+        node->next = taken_head;
+        taken_head = node;
+        node = next;
+        ++completion_queue->num_taken;
+    }
+
+    if (taken_head == NULL) {
+        return;
+    }
+
+    if (completion_queue->pending_tail != NULL) {
+        completion_queue->pending_tail->next = taken_head;
+    } else {
+        completion_queue->pending_head = taken_head;
+    }
+    completion_queue->pending_tail = taken_tail;
+}
+
+ARMD_CompletionQueue *armd_completion_queue_create(ARMD_Context *context,
+                                                   ARMD_Bool uses_fd) {
+    if (context == NULL) {
+        return NULL;
+    }
+
+    ARMD_CompletionQueue *completion_queue = armd_memory_allocator_allocate(
+        &context->memory_allocator, sizeof(ARMD_CompletionQueue));
+    if (completion_queue == NULL) {
+        return NULL;
+    }
+
+    completion_queue->context = context;
+    completion_queue->memory_allocator = context->memory_allocator;
+    completion_queue->fd = -1;
+    completion_queue->num_watched = 0;
+    completion_queue->num_pushed = 0;
+    completion_queue->head = NULL;
+    completion_queue->num_taken = 0;
+    completion_queue->pending_head = NULL;
+    completion_queue->pending_tail = NULL;
+
+    if (uses_fd) {
+        completion_queue->fd = open_event();
+        if (completion_queue->fd < 0) {
+            armd_memory_allocator_free(&context->memory_allocator,
+                                       completion_queue);
+            return NULL;
+        }
+    }
+
+    return completion_queue;
+}
+
+int armd_completion_queue_destroy(ARMD_CompletionQueue *completion_queue) {
+    if (completion_queue == NULL) {
+        return -1;
+    }
+
+    take_nodes(completion_queue);
+    ARMD_Size num_watched = load_count(&completion_queue->num_watched);
+    if (completion_queue->num_taken != num_watched) {
+        // Some watched promises have not been completed yet
+        return -1;
+    }
+
+    // All are pushed but some may still be signaling the fd. The pusher may
+    // have been preempted, so let it run.
+    while (load_count(&completion_queue->num_pushed) != num_watched) {
+        armd__thread_yield();
+    }
+
+    ARMD__CompletionNode *node = completion_queue->pending_head;
+    while (node != NULL) {
+        ARMD__CompletionNode *next = node->next;
+        armd_memory_allocator_free(&completion_queue->memory_allocator, node);
+        node = next;
+    }
+
+    if (completion_queue->fd >= 0) {
+        close_event(completion_queue->fd);
+    }
+
+    ARMD_MemoryAllocator memory_allocator = completion_queue->memory_allocator;
+    armd_memory_allocator_free(&memory_allocator, completion_queue);
+
+    return 0;
+}
+
+static void push_completion(ARMD_Handle handle, void *callback_context,
+                            int has_error) {
+    ARMD__CompletionNode *node = (ARMD__CompletionNode *)callback_context;
+    ARMD_CompletionQueue *completion_queue = node->completion_queue;
+
+    node->completion.handle = handle;
+    node->completion.has_error = has_error;
+
+    ARMD__CompletionNode *head = load_head(&completion_queue->head);
+    do {
+        node->next = head;
+    } while (!compare_exchange_head(&completion_queue->head, &head, node));
+
+    // The poller has taken all the nodes, so it needs another wakeup
+    if (head == NULL && completion_queue->fd >= 0) {
+        signal_event(completion_queue->fd);
+    }
+
+    // The queue may be destroyed after this
+    add_count(&completion_queue->num_pushed, 1);
+}
+
+int armd_completion_queue_watch(ARMD_CompletionQueue *completion_queue,
+                                ARMD_Handle handle, void *user_context) {
+    if (completion_queue == NULL) {
+        return -1;
+    }
+
+    ARMD__CompletionNode *node = armd_memory_allocator_allocate(
+        &completion_queue->memory_allocator, sizeof(ARMD__CompletionNode));
+    if (node == NULL) {
+        return -1;
+    }
+
+    node->next = NULL;
+    node->completion_queue = completion_queue;
+    node->completion.handle = handle;
+    node->completion.user_context = user_context;
+    node->completion.has_error = 0;
+
+    // Counted first as the callback may be called immediately
+    add_count(&completion_queue->num_watched, 1);
+
+    int res = armd_add_promise_callback(completion_queue->context, handle,
+                                        node, push_completion);
+    if (res != 0) {
+        add_count(&completion_queue->num_watched, (ARMD_Size)-1);
+        armd_memory_allocator_free(&completion_queue->memory_allocator, node);
+        return -1;
+    }
+
+    return 0;
+}
+
+ARMD_Size armd_completion_queue_poll(ARMD_CompletionQueue *completion_queue,
+                                     ARMD_Completion *completions,
+                                     ARMD_Size max_num_completions) {
+    if (completion_queue == NULL ||
+        (completions == NULL && max_num_completions != 0)) {
+        return 0;
+    }
+
+    // Cleared before taking the nodes so that no push is missed
+    if (completion_queue->fd >= 0) {
+        clear_event(completion_queue->fd);
+    }
+
+    take_nodes(completion_queue);
+
+    ARMD_Size num_completions = 0;
+    while (num_completions < max_num_completions &&
+           completion_queue->pending_head != NULL) {
+        ARMD__CompletionNode *node = completion_queue->pending_head;
+        completion_queue->pending_head = node->next;
+        completions[num_completions++] = node->completion;
+        armd_memory_allocator_free(&completion_queue->memory_allocator, node);
+    }
+
+    if (completion_queue->pending_head == NULL) {
+        completion_queue->pending_tail = NULL;
+    } else if (completion_queue->fd >= 0) {
+        // Still readable for the rest
+        signal_event(completion_queue->fd);
+    }
+
+    return num_completions;
+}
+
+int armd_completion_queue_get_fd(ARMD_CompletionQueue *completion_queue) {
+    if (completion_queue == NULL) {
+        return -1;
+    }
+
+    return completion_queue->fd;
+}
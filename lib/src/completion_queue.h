@@ -0,0 +1,32 @@
+#ifndef ARAMID__COMPLETION_QUEUE_H
+#define ARAMID__COMPLETION_QUEUE_H
+
+#include <aramid/aramid.h>
+
+typedef struct TAG_ARMD__CompletionNode {
+    struct TAG_ARMD__CompletionNode *next;
+    ARMD_CompletionQueue *completion_queue;
+    ARMD_Completion completion;
+} ARMD__CompletionNode;
+
+/*
+ * The executors push the nodes onto the lock-free stack. The polling thread
+ * takes the whole stack at once and keeps the nodes in the order of the
+ * completion until they are returned.
+ */
+struct TAG_ARMD_CompletionQueue {
+    ARMD_Context *context;
+    ARMD_MemoryAllocator memory_allocator;
+    // -1 if not used
+    int fd;
+    volatile ARMD_Size num_watched;
+    // Counted after the push has signaled the fd
+    volatile ARMD_Size num_pushed;
+    ARMD__CompletionNode *volatile head;
+    // Owned by the polling thread
+    ARMD_Size num_taken;
+    ARMD__CompletionNode *pending_head;
+    ARMD__CompletionNode *pending_tail;
+};
+
+#endif // ARAMID__COMPLETION_QUEUE_H
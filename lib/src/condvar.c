@@ -4,7 +4,9 @@
 
 #if defined(ARAMID_USE_PTHREAD)
 
+#include <errno.h>
 #include <pthread.h>
+#include <time.h>
 
 int armd__condvar_init(ARMD__Condvar *condvar) {
     int res;
@@ -34,6 +36,26 @@ int armd__condvar_wait(ARMD__Condvar *condvar, ARMD__Mutex *mutex) {
     return pthread_cond_wait(&condvar->cond, &mutex->mutex);
 }
 
+int armd__condvar_timed_wait(ARMD__Condvar *condvar, ARMD__Mutex *mutex,
+                             ARMD_Size timeout_milliseconds) {
+    // pthread_cond_timedwait takes the deadline in CLOCK_REALTIME
+    struct timespec deadline;
+    if (clock_gettime(CLOCK_REALTIME, &deadline)) {
+        return -1;
+    }
+
+    deadline.tv_sec += timeout_milliseconds / 1000;
+    deadline.tv_nsec += (long)(timeout_milliseconds % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    int result = pthread_cond_timedwait(&condvar->cond, &mutex->mutex,
+                                        &deadline);
+    return result == ETIMEDOUT ? 0 : result;
+}
+
 int armd__condvar_signal(ARMD__Condvar *condvar) {
     return pthread_cond_signal(&condvar->cond);
 }
@@ -62,6 +84,14 @@ int armd__condvar_wait(ARMD__Condvar *condvar, ARMD__Mutex *mutex) {
     return result == 0;
 }
 
+int armd__condvar_timed_wait(ARMD__Condvar *condvar, ARMD__Mutex *mutex,
+                             ARMD_Size timeout_milliseconds) {
+    BOOL result =
+        SleepConditionVariableCS(&condvar->cond, &mutex->critical_section,
+                                 (DWORD)timeout_milliseconds);
+    return result == 0 && GetLastError() != ERROR_TIMEOUT;
+}
+
 int armd__condvar_signal(ARMD__Condvar *condvar) {
     WakeConditionVariable(&condvar->cond);
     return 0;
@@ -89,6 +119,12 @@ int armd__condvar_wait(ARMD__Condvar *condvar, ARMD__Mutex *mutex) {
     return 1;
 }
 
+int armd__condvar_timed_wait(ARMD__Condvar *condvar, ARMD__Mutex *mutex,
+                             ARMD_Size timeout_milliseconds) {
+    assert(0);
+    return 1;
+}
+
 int armd__condvar_signal(ARMD__Condvar *condvar) {
     assert(0);
     return 0;
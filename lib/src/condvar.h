@@ -11,6 +11,10 @@ ARMD_EXTERN_C int armd__condvar_init(ARMD__Condvar *condvar);
 ARMD_EXTERN_C int armd__condvar_deinit(ARMD__Condvar *condvar);
 ARMD_EXTERN_C int armd__condvar_wait(ARMD__Condvar *condvar,
                                      ARMD__Mutex *mutex);
+/* Returns 0 also on timeout */
+ARMD_EXTERN_C int armd__condvar_timed_wait(ARMD__Condvar *condvar,
+                                           ARMD__Mutex *mutex,
+                                           ARMD_Size timeout_milliseconds);
 ARMD_EXTERN_C int armd__condvar_notify(ARMD__Condvar *condvar);
 ARMD_EXTERN_C int armd__condvar_broadcast(ARMD__Condvar *condvar);
 
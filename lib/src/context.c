@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <string.h>
 
 #include <aramid/aramid.h>
 
@@ -42,7 +43,9 @@ ARMD_Context *armd_context_create(const ARMD_MemoryAllocator *memory_allocator,
 
     context->memory_allocator = *memory_allocator;
 
-    context->memory_region = armd_memory_region_create(memory_allocator);
+    // One shard per executor and one for the other threads
+    context->memory_region = armd__memory_region_create_sharded(
+        memory_allocator, num_executors + 1);
     if (context->memory_region == NULL) {
         goto error;
     }
@@ -76,6 +79,11 @@ ARMD_Context *armd_context_create(const ARMD_MemoryAllocator *memory_allocator,
     promise_manager_promises_initialized = 1;
 
     context->promise_manager.handle_counter = 0;
+    context->trace_base_timestamp = 0;
+    context->profiling = 0;
+    context->perf_counting = 0;
+    context->span_analysis = 0;
+    armd__span_point_init(&context->span_analysis_span_point);
 
     context->num_executors = num_executors;
     context->executors = armd_memory_allocator_allocate(
@@ -211,6 +219,53 @@ int armd_context_destroy(ARMD_Context *context) {
     return status;
 }
 
+ARMD_Size armd_context_get_num_executors(ARMD_Context *context) {
+    assert(context != NULL);
+
+    return context->num_executors;
+}
+
+int armd_context_get_stats(ARMD_Context *context,
+                           ARMD_ContextStats *context_stats,
+                           ARMD_ExecutorStats *executor_stats,
+                           ARMD_StealStats *steal_stats) {
+    int res = 0;
+    (void)res;
+
+    if (context == NULL || context_stats == NULL) {
+        return -1;
+    }
+
+    context_stats->num_executors = context->num_executors;
+
+    res = armd__mutex_lock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    context_stats->num_promises =
+        armd__hash_table_get_num_entries(context->promise_manager.promises);
+
+    res = armd__mutex_unlock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    res = armd__mutex_lock(&context->executor_mutex);
+    assert(res == 0);
+
+    context_stats->num_free_jobs = context->free_job_count;
+
+    res = armd__mutex_unlock(&context->executor_mutex);
+    assert(res == 0);
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        armd__executor_get_stats(
+            context->executors[i],
+            executor_stats != NULL ? &executor_stats[i] : NULL,
+            steal_stats != NULL ? &steal_stats[i * context->num_executors]
+                                : NULL);
+    }
+
+    return 0;
+}
+
 static int fork_with_executor(ARMD__Executor *executor, ARMD_Job *parent_job,
                               ARMD_Procedure *procedure, void *args) {
     int res = 0;
@@ -232,9 +287,13 @@ static int fork_with_executor(ARMD__Executor *executor, ARMD_Job *parent_job,
     res = armd__spinlock_unlock(&parent_job->lock);
     assert(res == 0);
 
+    armd__job_fork_span_point(job, parent_job);
+    armd__job_mark_ready(job);
+
     res = armd__spinlock_lock(&executor->lock);
     assert(res == 0);
     int enqueue_res = armd__deque_enqueue_forward(executor->deque, job);
+    armd__executor_record_deque_size(executor);
     res = armd__spinlock_unlock(&executor->lock);
     assert(res == 0);
 
@@ -249,6 +308,10 @@ static int fork_with_executor(ARMD__Executor *executor, ARMD_Job *parent_job,
         return -1;
     }
 
+    armd__executor_stats_add(&parent_job->executor->stats.num_forks, 1);
+    ARMD__TRACE(parent_job->executor, ARMD__TraceEventType_Fork,
+                (uintptr_t)procedure);
+
     {
         res = armd__mutex_lock(&executor->context->executor_mutex);
         assert(res == 0);
@@ -309,16 +372,120 @@ static void cleanup_dependency_graph(ARMD_Context *context,
     }
 }
 
-static int check_and_build_dependency_graph(ARMD_Context *context,
-                                            ARMD_Size num_dependencies,
-                                            const ARMD_Handle *dependencies,
-                                            ARMD_Handle target,
-                                            int *dependency_has_error) {
+/* Release the references to the dependencies kept for their results */
+static void
+release_dependency_results(ARMD_Context *context,
+                           ARMD_Size num_dependency_results,
+                           ARMD__DependencyResult *dependency_results) {
+    int res = 0;
+    (void)res;
+
+    if (dependency_results == NULL) {
+        return;
+    }
+
+    for (ARMD_Size i = 0; i < num_dependency_results; i++) {
+        ARMD__Promise *promise = dependency_results[i].promise;
+        if (promise == NULL) {
+            continue;
+        }
+
+        if (armd__promise_decrement_reference_count(promise)) {
+            res = armd__hash_table_remove(context->promise_manager.promises,
+                                          dependency_results[i].handle);
+            assert(res == 0);
+            armd__promise_destroy(promise);
+        }
+    }
+
+    armd_memory_region_free(context->memory_region, dependency_results);
+}
+
+/* Keep the dependency alive until the dependent job ends */
+static int keep_dependency_result(ARMD_Context *context,
+                                  ARMD_Size num_dependencies, ARMD_Size index,
+                                  ARMD_Handle dependency,
+                                  ARMD__Promise *promise,
+                                  ARMD__DependencyResult **dependency_results) {
+    if (promise->result_size == 0) {
+        return 0;
+    }
+
+    if (*dependency_results == NULL) {
+        *dependency_results = armd_memory_region_allocate(
+            context->memory_region,
+            sizeof(ARMD__DependencyResult) * num_dependencies);
+        if (*dependency_results == NULL) {
+            return -1;
+        }
+
+        for (ARMD_Size i = 0; i < num_dependencies; i++) {
+            (*dependency_results)[i].handle = 0;
+            (*dependency_results)[i].promise = NULL;
+        }
+    }
+
+    (*dependency_results)[index].handle = dependency;
+    (*dependency_results)[index].promise = promise;
+    armd__promise_increment_reference_count(promise);
+
+    return 0;
+}
+
+/*
+ * Returns the number of the non-zero dependencies and counts the ended ones,
+ * or -1 if any of them is invalid
+ */
+static int count_ended_dependencies(ARMD_Context *context,
+                                    ARMD_Size num_dependencies,
+                                    const ARMD_Handle *dependencies,
+                                    ARMD_Size *num_ended_dependencies) {
+    int num_valid_dependencies = 0;
+
+    *num_ended_dependencies = 0;
+    for (ARMD_Size i = 0; i < num_dependencies; i++) {
+        ARMD_Handle dependency = dependencies[i];
+        if (dependency == 0) {
+            continue;
+        }
+
+        ARMD__Promise *promise;
+        if (armd__hash_table_get(context->promise_manager.promises,
+                                 dependency, (void **)&promise) != 0) {
+            return -1;
+        }
+        assert(promise != NULL);
+
+        if (promise->detached) {
+            return -1;
+        }
+
+        if (promise->status != ARMD__PromiseStatus_NotFinished) {
+            ++*num_ended_dependencies;
+        }
+        ++num_valid_dependencies;
+    }
+
+    return num_valid_dependencies;
+}
+
+/*
+ * Links the target to the unfinished dependencies unless skips_unfinished is
+ * set, and records the links if links is not NULL. Returns the number of the
+ * links.
+ */
+static int check_and_build_dependency_graph(
+    ARMD_Context *context, ARMD_Size num_dependencies,
+    const ARMD_Handle *dependencies, ARMD_Bool skips_unfinished,
+    ARMD_Handle target, int *dependency_has_error,
+    ARMD__SpanPoint *span_point, ARMD__DependencyResult **dependency_results,
+    ARMD__PromiseLink *links) {
     int res;
 
     int num_waiting_promises = 0;
 
     *dependency_has_error = 0;
+    *dependency_results = NULL;
     for (ARMD_Size i = 0; i < num_dependencies; i++) {
         ARMD_Handle dependency = dependencies[i];
         if (dependency == 0) {
@@ -329,25 +496,36 @@ static int check_and_build_dependency_graph(ARMD_Context *context,
         res = armd__hash_table_get(context->promise_manager.promises,
                                    dependency, (void **)&promise);
         if (res != 0) {
-            cleanup_dependency_graph(context, num_dependencies, dependencies,
-                                     target);
-            return -1;
+            goto error;
         }
         assert(promise != NULL);
 
         if (promise->detached) {
-            cleanup_dependency_graph(context, num_dependencies, dependencies,
-                                     target);
-            return -1;
+            goto error;
+        }
+
+        // Enough dependencies have ended, so the job neither waits for nor
+        // reads this one
+        if (skips_unfinished &&
+            promise->status == ARMD__PromiseStatus_NotFinished) {
+            continue;
+        }
+
+        res = keep_dependency_result(context, num_dependencies, i, dependency,
+                                     promise, dependency_results);
+        if (res != 0) {
+            goto error;
         }
 
         switch (promise->status) {
         case ARMD__PromiseStatus_NotFinished:
             break;
         case ARMD__PromiseStatus_Success:
+            armd__span_point_join(span_point, &promise->span_point);
             continue;
         case ARMD__PromiseStatus_Error:
             *dependency_has_error = 1;
+            armd__span_point_join(span_point, &promise->span_point);
             continue;
         default:
             assert(0);
@@ -360,20 +538,34 @@ static int check_and_build_dependency_graph(ARMD_Context *context,
 
         res = armd__promise_add_continuation_promise(promise, target);
         if (res != 0) {
-            cleanup_dependency_graph(context, num_dependencies, dependencies,
-                                     target);
-            return -1;
+            goto error;
+        }
+
+        if (links != NULL) {
+            ARMD__PromiseLink *link = &links[num_waiting_promises];
+            link->handle = dependency;
+            link->dependency_index = i;
+            link->continuation_index = promise->num_continuation_promises - 1;
         }
 
         ++num_waiting_promises;
     }
 
     return num_waiting_promises;
+
+error:
+    cleanup_dependency_graph(context, num_dependencies, dependencies, target);
+    release_dependency_results(context, num_dependencies, *dependency_results);
+    *dependency_results = NULL;
+
+    return -1;
 }
 
-ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
-                        void *args, ARMD_Size num_dependencies,
-                        const ARMD_Handle *dependencies) {
+/* num_required is the number of the dependencies to wait for, 0 if all */
+static ARMD_Handle invoke(ARMD_Context *context, ARMD_Procedure *procedure,
+                          void *args, ARMD_Size num_dependencies,
+                          const ARMD_Handle *dependencies,
+                          ARMD_Size num_required) {
     assert(context != NULL);
     assert(procedure != NULL);
     assert(num_dependencies == 0 || dependencies != NULL);
@@ -382,6 +574,7 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
     (void)res;
 
     int promise_manager_mutex_locked = 0;
+    int links_initialized = 0;
     int promise_initialized = 0;
     int job_initialized = 0;
     int dependency_graph_initialized = 0;
@@ -390,6 +583,8 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
     ARMD__Promise *promise = NULL;
     ARMD_Job *job = NULL;
     ARMD_Handle new_handle = 0;
+    ARMD__DependencyResult *dependency_results = NULL;
+    ARMD__PromiseLink *links = NULL;
 
     res = armd__mutex_lock(&context->promise_manager.mutex);
     assert(res == 0);
@@ -399,16 +594,43 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
 
     new_handle = context->promise_manager.handle_counter + 1;
 
+    /* quorum */
+
+    ARMD_Size num_ended_dependencies = 0;
+    ARMD_Bool skips_unfinished = 0;
+    if (num_required != 0) {
+        int num_valid_dependencies = count_ended_dependencies(
+            context, num_dependencies, dependencies, &num_ended_dependencies);
+        if (num_valid_dependencies < 0 ||
+            num_required > (ARMD_Size)num_valid_dependencies) {
+            goto error;
+        }
+
+        skips_unfinished = num_ended_dependencies >= num_required;
+        if (!skips_unfinished) {
+            links = armd_memory_region_allocate(
+                context->memory_region,
+                sizeof(ARMD__PromiseLink) * num_dependencies);
+            if (links == NULL) {
+                goto error;
+            }
+            links_initialized = 1;
+        }
+    }
+
     /* dependency graph */
 
     int ended_dependency_has_error = 0;
+    ARMD__SpanPoint ended_dependency_span_point;
+    armd__span_point_init(&ended_dependency_span_point);
     int dependency_graph_res;
     if (num_dependencies == 0) {
         dependency_graph_res = 0;
     } else {
         dependency_graph_res = check_and_build_dependency_graph(
-            context, num_dependencies, dependencies, new_handle,
-            &ended_dependency_has_error);
+            context, num_dependencies, dependencies, skips_unfinished,
+            new_handle, &ended_dependency_has_error,
+            &ended_dependency_span_point, &dependency_results, links);
     }
 
     if (dependency_graph_res < 0) {
@@ -416,6 +638,12 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
     }
     dependency_graph_initialized = 1;
 
+    // The number of the links which have to end to release the job
+    ARMD_Size num_waiting_promises = (ARMD_Size)dependency_graph_res;
+    if (num_required != 0 && dependency_graph_res != 0) {
+        num_waiting_promises = num_required - num_ended_dependencies;
+    }
+
     /* awaiter */
 
     ARMD__JobAwaiter awaiter;
@@ -436,14 +664,17 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
     if (ended_dependency_has_error) {
         job->dependency_has_error = 1;
     }
+    job->span_point = ended_dependency_span_point;
 
     /* promise */
 
     if (dependency_graph_res == 0) {
-        promise = armd__promise_create_no_pending_job(context->memory_region);
+        promise = armd__promise_create_no_pending_job(context->memory_region,
+                                                      procedure->result_size);
     } else {
         promise = armd__promise_create_with_pending_job(
-            context->memory_region, dependency_graph_res, job);
+            context->memory_region, num_waiting_promises, job,
+            procedure->result_size);
         armd__promise_add_reference_count(
             promise, dependency_graph_res); // For dependency graph
     }
@@ -459,6 +690,19 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
         promise->dependency_has_error = 1;
     }
 
+    // Unlinked when the job gets ready
+    if (num_waiting_promises < (ARMD_Size)dependency_graph_res) {
+        promise->num_waiting_links = (ARMD_Size)dependency_graph_res;
+        promise->waiting_links = links;
+    } else if (links_initialized) {
+        armd_memory_region_free(context->memory_region, links);
+    }
+    links_initialized = 0;
+
+    if (procedure->result_size != 0) {
+        job->result = promise->result;
+    }
+
     int insert_res = armd__hash_table_insert(context->promise_manager.promises,
                                              new_handle, promise);
     if (insert_res != 0) {
@@ -466,12 +710,21 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
     }
     hash_table_inserted = 1;
 
+    // Released when the job ends
+    if (dependency_results != NULL) {
+        job->num_dependency_results = num_dependencies;
+        job->dependency_results = dependency_results;
+    }
+
     /* queueing */
 
     if (dependency_graph_res == 0) {
+        armd__job_mark_ready(job);
+
         res = armd__spinlock_lock(&executor->lock);
         assert(res == 0);
         int enqueue_res = armd__deque_enqueue_back(executor->deque, job);
+        armd__executor_record_deque_size(executor);
         res = armd__spinlock_unlock(&executor->lock);
         assert(res == 0);
 
@@ -514,6 +767,8 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
         if (num_dependencies != 0) {
             cleanup_dependency_graph(context, num_dependencies, dependencies,
                                      new_handle);
+            release_dependency_results(context, num_dependencies,
+                                       dependency_results);
         }
     }
 
@@ -527,6 +782,10 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
         assert(res == 0);
     }
 
+    if (links_initialized) {
+        armd_memory_region_free(context->memory_region, links);
+    }
+
     if (promise_manager_mutex_locked) {
         res = armd__mutex_unlock(&context->promise_manager.mutex);
         assert(res == 0);
@@ -535,16 +794,207 @@ ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
     return 0;
 }
 
+ARMD_Handle armd_invoke(ARMD_Context *context, ARMD_Procedure *procedure,
+                        void *args, ARMD_Size num_dependencies,
+                        const ARMD_Handle *dependencies) {
+    return invoke(context, procedure, args, num_dependencies, dependencies, 0);
+}
+
+ARMD_Handle armd_invoke_quorum(ARMD_Context *context,
+                               ARMD_Procedure *procedure, void *args,
+                               ARMD_Size num_dependencies,
+                               const ARMD_Handle *dependencies,
+                               ARMD_Size num_required) {
+    if (num_required == 0) {
+        return 0;
+    }
+
+    return invoke(context, procedure, args, num_dependencies, dependencies,
+                  num_required);
+}
+
+/* Unlinks the promise from the dependencies which have not ended yet */
+static void unlink_waiting_links(ARMD_Context *context, ARMD_Handle handle,
+                                 ARMD__Promise *promise) {
+    ARMD_Job *job = promise->pending_job;
+    ARMD_Bool destroys;
+    (void)destroys;
+    (void)handle;
+
+    for (ARMD_Size i = 0; i < promise->num_waiting_links; i++) {
+        const ARMD__PromiseLink *link = &promise->waiting_links[i];
+
+        ARMD__Promise *dependency;
+        if (armd__hash_table_get(context->promise_manager.promises,
+                                 link->handle, (void **)&dependency) != 0) {
+            continue;
+        }
+
+        // The ended ones have already notified the promise or are doing so
+        if (dependency->status != ARMD__PromiseStatus_NotFinished) {
+            continue;
+        }
+
+        assert(dependency->continuation_promises[link->continuation_index] ==
+               handle);
+        dependency->continuation_promises[link->continuation_index] = 0;
+
+        // The pending job keeps the promise alive
+        destroys = armd__promise_decrement_reference_count(promise);
+        assert(!destroys);
+
+        // The result is not written yet, so the job cannot read it
+        ARMD__DependencyResult *dependency_result =
+            job->dependency_results != NULL
+                ? &job->dependency_results[link->dependency_index]
+                : NULL;
+        if (dependency_result != NULL &&
+            dependency_result->promise == dependency) {
+            // The job of the dependency keeps it alive
+            destroys = armd__promise_decrement_reference_count(dependency);
+            assert(!destroys);
+            dependency_result->handle = 0;
+            dependency_result->promise = NULL;
+        }
+    }
+
+    armd_memory_region_free(context->memory_region, promise->waiting_links);
+    promise->num_waiting_links = 0;
+    promise->waiting_links = NULL;
+}
+
+/* Counts the ended dependency and releases the pending job if it is ready */
+static void notify_continuation_promise(
+    ARMD_Context *context, ARMD__Executor *executor,
+    ARMD_Handle continuation_promise_handle,
+    ARMD__Promise *continuation_promise, int has_error,
+    const ARMD__SpanPoint *span_point) {
+    int res = 0;
+    (void)res;
+
+    assert(continuation_promise->pending_job != NULL);
+
+    ++continuation_promise->num_ended_waiting_promises;
+    assert(continuation_promise->num_ended_waiting_promises <=
+           continuation_promise->num_all_waiting_promises);
+
+    if (has_error) {
+        continuation_promise->dependency_has_error = 1;
+    }
+
+    if (span_point != NULL) {
+        armd__span_point_join(&continuation_promise->pending_job->span_point,
+                              span_point);
+    }
+
+    if (continuation_promise->num_ended_waiting_promises >=
+        continuation_promise->num_all_waiting_promises) {
+        ARMD_Job *job = continuation_promise->pending_job;
+
+        if (continuation_promise->waiting_links != NULL) {
+            unlink_waiting_links(context, continuation_promise_handle,
+                                 continuation_promise);
+        }
+
+        ARMD__TRACE(executor, ARMD__TraceEventType_DependencyRelease,
+                    continuation_promise_handle);
+
+        if (continuation_promise->dependency_has_error) {
+            job->dependency_has_error = 1;
+        }
+
+        armd__job_mark_ready(job);
+
+        res = armd__spinlock_lock(&job->executor->lock);
+        assert(res == 0);
+        int enqueue_res = armd__deque_enqueue_back(job->executor->deque, job);
+        armd__executor_record_deque_size(job->executor);
+        res = armd__spinlock_unlock(&job->executor->lock);
+        assert(res == 0);
+
+        if (enqueue_res != 0) {
+            assert(0); // FIXME: Handle this error
+        }
+
+        {
+            res = armd__mutex_lock(&context->executor_mutex);
+            assert(res == 0);
+
+            ++context->free_job_count;
+            res = armd__condvar_broadcast(&context->executor_condvar);
+            assert(res == 0);
+
+            res = armd__mutex_unlock(&context->executor_mutex);
+            assert(res == 0);
+        }
+
+        continuation_promise->pending_job = NULL;
+    }
+}
+
+/*
+ * Runs the callbacks of the completed promise without the mutex. No callbacks
+ * are added after the completion, so the array is read in place.
+ */
+static void run_promise_callbacks(ARMD_Context *context, ARMD_Handle handle,
+                                  ARMD__Promise *promise, int has_error) {
+    int res = 0;
+    (void)res;
+
+    ARMD_Size num_promise_callbacks = promise->num_promise_callbacks;
+    const ARMD__PromiseCallback *promise_callbacks =
+        promise->promise_callbacks;
+    for (ARMD_Size i = 0; i < num_promise_callbacks; i++) {
+        promise_callbacks[i].func(handle, promise_callbacks[i].context,
+                                  has_error);
+    }
+
+    res = armd__mutex_lock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    // The awaiters return after the callbacks
+    promise->running_promise_callbacks = 0;
+
+    int promise_to_destroy = 0;
+    for (ARMD_Size i = 0; i < num_promise_callbacks; i++) {
+        promise_to_destroy |= armd__promise_decrement_reference_count(promise);
+    }
+
+    if (promise_to_destroy) {
+        res = armd__hash_table_remove(context->promise_manager.promises,
+                                      handle);
+        assert(res == 0);
+        armd__promise_destroy(promise);
+    }
+
+    res = armd__condvar_broadcast(&context->promise_manager.condvar);
+    assert(res == 0);
+
+    res = armd__mutex_unlock(&context->promise_manager.mutex);
+    assert(res == 0);
+}
+
 int armd__context_complete_promise(ARMD_Context *context,
-                                   ARMD_Handle promise_handle, int has_error) {
+                                   ARMD__Executor *executor, ARMD_Job *job,
+                                   int has_error) {
     int res = 0;
     int mutex_locked = 0;
     int promise_to_destroy = 0;
 
+    assert(job->awaiter.type == JobAwaiterType_Promise);
+    ARMD_Handle promise_handle = job->awaiter.body.promise.handle;
+    const ARMD__SpanPoint *span_point =
+        job->span_analyzed ? &job->span_point : NULL;
+
     res = armd__mutex_lock(&context->promise_manager.mutex);
     assert(res == 0);
     mutex_locked = 1;
 
+    release_dependency_results(context, job->num_dependency_results,
+                               job->dependency_results);
+    job->num_dependency_results = 0;
+    job->dependency_results = NULL;
+
     ARMD__Promise *promise = NULL;
     res = armd__hash_table_get(context->promise_manager.promises,
                                promise_handle, (void **)&promise);
@@ -558,15 +1008,22 @@ int armd__context_complete_promise(ARMD_Context *context,
         promise->status = ARMD__PromiseStatus_Success;
     }
 
+    ARMD__TRACE(executor, ARMD__TraceEventType_PromiseComplete, promise_handle);
+
+    if (span_point != NULL) {
+        promise->span_point = *span_point;
+        armd__span_analysis_record_completion(context, span_point);
+    }
+
     promise_to_destroy |=
         armd__promise_decrement_reference_count(promise); // For internal job
 
-    for (ARMD_Size i = 0; i < promise->num_promise_callbacks; i++) {
-        ARMD__PromiseCallback *promise_callback =
-            &promise->promise_callbacks[i];
-        promise_callback->func(promise_handle, promise_callback->context,
-                               has_error);
-        promise_to_destroy |= armd__promise_decrement_reference_count(promise);
+    // Called after the mutex is released so that slow callbacks do not stall
+    // the other invocations and completions. The callbacks keep the promise
+    // until then.
+    int has_promise_callbacks = promise->num_promise_callbacks != 0;
+    if (has_promise_callbacks) {
+        promise->running_promise_callbacks = 1;
     }
 
     for (ARMD_Size i = 0; i < promise->num_continuation_promises; i++) {
@@ -581,48 +1038,12 @@ int armd__context_complete_promise(ARMD_Context *context,
                                    (void **)&continuation_promise);
         assert(res == 0);
 
-        assert(continuation_promise->pending_job != NULL);
-
-        ++continuation_promise->num_ended_waiting_promises;
-        assert(continuation_promise->num_ended_waiting_promises <=
-               continuation_promise->num_all_waiting_promises);
-
-        if (has_error) {
-            continuation_promise->dependency_has_error = 1;
-        }
-
-        if (continuation_promise->num_ended_waiting_promises >=
-            continuation_promise->num_all_waiting_promises) {
-            ARMD_Job *job = continuation_promise->pending_job;
-
-            if (continuation_promise->dependency_has_error) {
-                job->dependency_has_error = 1;
-            }
-
-            res = armd__spinlock_lock(&job->executor->lock);
-            assert(res == 0);
-            int enqueue_res =
-                armd__deque_enqueue_back(job->executor->deque, job);
-            res = armd__spinlock_unlock(&job->executor->lock);
-            assert(res == 0);
-
-            if (enqueue_res != 0) {
-                assert(0); // FIXME: Handle this error
-            }
-
-            {
-                res = armd__mutex_lock(&context->executor_mutex);
-                assert(res == 0);
-
-                ++context->free_job_count;
-                res = armd__condvar_broadcast(&context->executor_condvar);
-                assert(res == 0);
-
-                res = armd__mutex_unlock(&context->executor_mutex);
-                assert(res == 0);
-            }
-
-            continuation_promise->pending_job = NULL;
+        // Skipped if released by the other dependencies
+        if (continuation_promise->pending_job != NULL) {
+            notify_continuation_promise(context, executor,
+                                        continuation_promise_handle,
+                                        continuation_promise, has_error,
+                                        span_point);
         }
 
         if (armd__promise_decrement_reference_count(continuation_promise)) {
@@ -646,6 +1067,10 @@ int armd__context_complete_promise(ARMD_Context *context,
     assert(res == 0);
     mutex_locked = 0; // NOLINT(clang-analyzer-deadcode.DeadStores)
 
+    if (has_promise_callbacks) {
+        run_promise_callbacks(context, promise_handle, promise, has_error);
+    }
+
     return 0;
 
 error:
@@ -657,7 +1082,9 @@ int armd__context_complete_promise(ARMD_Context *context,
     return -1;
 }
 
-int armd_await(ARMD_Context *context, ARMD_Handle handle) {
+static int await_promise(ARMD_Context *context, ARMD_Handle handle,
+                         ARMD_Bool copies_result, void *result,
+                         ARMD_Size result_size) {
     int res = 0;
     (void)res;
 
@@ -672,7 +1099,8 @@ int armd_await(ARMD_Context *context, ARMD_Handle handle) {
         return -1;
     }
 
-    if (promise->detached) {
+    if (promise->detached ||
+        (copies_result && result_size != promise->result_size)) {
         res = armd__mutex_unlock(&context->promise_manager.mutex);
         assert(res == 0);
         return -1;
@@ -681,7 +1109,98 @@ int armd_await(ARMD_Context *context, ARMD_Handle handle) {
     ARMD__PromiseStatus status;
     while (1) {
         status = promise->status;
-        if (status != ARMD__PromiseStatus_NotFinished) {
+        if (status != ARMD__PromiseStatus_NotFinished &&
+            !promise->running_promise_callbacks) {
+            break;
+        }
+
+        res = armd__condvar_wait(&context->promise_manager.condvar,
+                                 &context->promise_manager.mutex);
+        assert(res == 0);
+    }
+
+    if (copies_result && status == ARMD__PromiseStatus_Success &&
+        result_size != 0) {
+        memcpy(result, promise->result, result_size);
+    }
+
+    if (armd__promise_decrement_reference_count(promise)) {
+        armd__hash_table_remove(context->promise_manager.promises, handle);
+        armd__promise_destroy(promise);
+    }
+
+    res = armd__mutex_unlock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    if (status == ARMD__PromiseStatus_Success) {
+        return 0;
+    } else {
+        return -2;
+    }
+}
+
+int armd_await(ARMD_Context *context, ARMD_Handle handle) {
+    return await_promise(context, handle, 0, NULL, 0);
+}
+
+int armd_await_result(ARMD_Context *context, ARMD_Handle handle, void *result,
+                      ARMD_Size result_size) {
+    if (result == NULL && result_size != 0) {
+        return -1;
+    }
+
+    return await_promise(context, handle, 1, result, result_size);
+}
+
+/* Returns the index of the first ended promise, or num_handles if none */
+static ARMD_Size find_ended_promise(ARMD_Context *context,
+                                    ARMD_Size num_handles,
+                                    const ARMD_Handle *handles) {
+    int res = 0;
+    (void)res;
+
+    for (ARMD_Size i = 0; i < num_handles; i++) {
+        ARMD__Promise *promise;
+        res = armd__hash_table_get(context->promise_manager.promises,
+                                   handles[i], (void **)&promise);
+        assert(res == 0);
+
+        if (promise->status != ARMD__PromiseStatus_NotFinished &&
+            !promise->running_promise_callbacks) {
+            return i;
+        }
+    }
+
+    return num_handles;
+}
+
+int armd_await_any(ARMD_Context *context, ARMD_Size num_handles,
+                   const ARMD_Handle *handles, ARMD_Size *index) {
+    if (num_handles == 0 || handles == NULL || index == NULL) {
+        return -1;
+    }
+
+    int res = 0;
+    (void)res;
+
+    res = armd__mutex_lock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    for (ARMD_Size i = 0; i < num_handles; i++) {
+        ARMD__Promise *promise;
+        if (armd__hash_table_get(context->promise_manager.promises,
+                                 handles[i], (void **)&promise) ||
+            promise->detached) {
+            res = armd__mutex_unlock(&context->promise_manager.mutex);
+            assert(res == 0);
+            return -1;
+        }
+    }
+
+    ARMD_Size ended_index;
+    while (1) {
+        ended_index = find_ended_promise(context, num_handles, handles);
+        if (ended_index != num_handles) {
             break;
         }
 
@@ -690,6 +1209,15 @@ int armd_await(ARMD_Context *context, ARMD_Handle handle) {
         assert(res == 0);
     }
 
+    // Only the ended one is consumed
+    ARMD_Handle handle = handles[ended_index];
+    ARMD__Promise *promise;
+    res = armd__hash_table_get(context->promise_manager.promises, handle,
+                               (void **)&promise);
+    assert(res == 0);
+
+    ARMD__PromiseStatus status = promise->status;
+
     if (armd__promise_decrement_reference_count(promise)) {
         armd__hash_table_remove(context->promise_manager.promises, handle);
         armd__promise_destroy(promise);
@@ -698,6 +1226,8 @@ int armd_await(ARMD_Context *context, ARMD_Handle handle) {
     res = armd__mutex_unlock(&context->promise_manager.mutex);
     assert(res == 0);
 
+    *index = ended_index;
+
     if (status == ARMD__PromiseStatus_Success) {
         return 0;
     } else {
@@ -790,7 +1320,8 @@ int armd_add_promise_callback(ARMD_Context *context, ARMD_Handle handle,
         return -1;
     }
 
-    if (promise->status == ARMD__PromiseStatus_NotFinished) {
+    ARMD__PromiseStatus status = promise->status;
+    if (status == ARMD__PromiseStatus_NotFinished) {
         ARMD__PromiseCallback promise_callback;
         promise_callback.func = callback_func;
         promise_callback.context = callback_context;
@@ -801,13 +1332,16 @@ int armd_add_promise_callback(ARMD_Context *context, ARMD_Handle handle,
             return -1;
         }
         armd__promise_increment_reference_count(promise);
-    } else {
-        callback_func(handle, callback_context,
-                      promise->status != ARMD__PromiseStatus_Success);
     }
 
     res = armd__mutex_unlock(&context->promise_manager.mutex);
     assert(res == 0);
 
+    // Already completed, so called here without the mutex
+    if (status != ARMD__PromiseStatus_NotFinished) {
+        callback_func(handle, callback_context,
+                      status != ARMD__PromiseStatus_Success);
+    }
+
     return 0;
 }
@@ -7,6 +7,7 @@
 #include "hash_table.h"
 #include "memory_region.h"
 #include "mutex.h"
+#include "span_analysis.h"
 #include "types.h"
 
 struct TAG_ARMD_Context {
@@ -23,10 +24,17 @@ struct TAG_ARMD_Context {
         ARMD__HashTable *promises;
         ARMD_Handle handle_counter;
     } promise_manager;
+    uint64_t trace_base_timestamp;
+    volatile ARMD_Bool profiling;
+    volatile ARMD_Bool perf_counting;
+    volatile ARMD_Bool span_analysis;
+    // Guarded by the promise manager mutex
+    ARMD__SpanPoint span_analysis_span_point;
 };
 
+/* Completes the promise of the job which was invoked with armd_invoke */
 ARMD_EXTERN_C int armd__context_complete_promise(ARMD_Context *context,
-                                                 ARMD_Handle promise_handle,
-                                                 int has_error);
+                                                 ARMD__Executor *executor,
+                                                 ARMD_Job *job, int has_error);
 
 #endif // ARAMID__CONTEXT_H
@@ -10,6 +10,41 @@
 #include "promise.h"
 #include "random.h"
 #include "spinlock.h"
+#include "task_group.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static ARMD_Size load_counter(const ARMD_Size *counter) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    return *(const volatile ARMD_Size *)counter;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void add_nanoseconds(uint64_t *counter, uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(counter, *counter + value, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    *(volatile uint64_t *)counter += value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static uint64_t load_nanoseconds(const uint64_t *counter) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    return *(const volatile uint64_t *)counter;
+#else
+#error Atomic implementation is not specified
+#endif
+}
 
 static ARMD_Bool wait_for_context_ready(ARMD_Context *context,
                                         ARMD__Executor *executor) {
@@ -41,6 +76,9 @@ static ARMD_Bool get_free_job(ARMD_Context *context, ARMD__Executor *executor,
     int res = 0;
     (void)res;
 
+    ARMD__ExecutorStats *stats = &executor->stats;
+    uint64_t idle_begin = 0;
+
     // Get free job
     while (1) {
         if (!executor->thread_should_continue_running) {
@@ -64,6 +102,12 @@ static ARMD_Bool get_free_job(ARMD_Context *context, ARMD__Executor *executor,
 
             res = armd__mutex_unlock(&context->executor_mutex);
             assert(res == 0);
+
+            if (idle_begin != 0) {
+                add_nanoseconds(&stats->idle_nanoseconds,
+                                armd_timestamp_to_nanoseconds(
+                                    armd_get_timestamp() - idle_begin));
+            }
             return 1;
         }
 
@@ -71,16 +115,33 @@ static ARMD_Bool get_free_job(ARMD_Context *context, ARMD__Executor *executor,
             return 0;
         }
 
+        if (idle_begin == 0) {
+            idle_begin = armd_get_timestamp();
+        }
+
         // Waiting for job
         {
             res = armd__mutex_lock(&context->executor_mutex);
             assert(res == 0);
 
-            while (context->free_job_count == 0 &&
-                   executor->thread_should_continue_running) {
-                res = armd__condvar_wait(&context->executor_condvar,
-                                         &context->executor_mutex);
-                assert(res == 0);
+            if (context->free_job_count == 0 &&
+                executor->thread_should_continue_running) {
+                uint64_t park_begin = armd_get_timestamp();
+                armd__executor_stats_add(&stats->num_parks, 1);
+                ARMD__TRACE(executor, ARMD__TraceEventType_Park, 0);
+
+                do {
+                    res = armd__condvar_wait(&context->executor_condvar,
+                                             &context->executor_mutex);
+                    assert(res == 0);
+                    armd__executor_stats_add(&stats->num_wakeups, 1);
+                } while (context->free_job_count == 0 &&
+                         executor->thread_should_continue_running);
+
+                ARMD__TRACE(executor, ARMD__TraceEventType_Unpark, 0);
+                add_nanoseconds(&stats->parked_nanoseconds,
+                                armd_timestamp_to_nanoseconds(
+                                    armd_get_timestamp() - park_begin));
             }
 
             ARMD_Bool thread_should_continue_running =
@@ -109,21 +170,33 @@ static ARMD_Bool get_free_job(ARMD_Context *context, ARMD__Executor *executor,
         res = armd__spinlock_unlock(&victim_executor->lock);
         assert(res == 0);
 
-        if (*job != NULL) {
-            (*job)->executor = executor;
+        if (*job == NULL) {
+            armd__executor_stats_add(&stats->num_failed_steals, 1);
+            armd__executor_stats_add(
+                &stats->num_failed_steals_by_victim[victim_index], 1);
+            continue;
+        }
 
-            // implicit memory fence
+        (*job)->executor = executor;
 
-            res = armd__mutex_lock(&context->executor_mutex);
-            assert(res == 0);
+        // implicit memory fence
 
-            --executor->context->free_job_count;
+        res = armd__mutex_lock(&context->executor_mutex);
+        assert(res == 0);
 
-            res = armd__mutex_unlock(&context->executor_mutex);
-            assert(res == 0);
+        --executor->context->free_job_count;
 
-            return 1;
-        }
+        res = armd__mutex_unlock(&context->executor_mutex);
+        assert(res == 0);
+
+        armd__executor_stats_add(&stats->num_steals, 1);
+        ARMD__TRACE(executor, ARMD__TraceEventType_Steal, victim_index);
+        armd__executor_stats_add(&stats->num_steals_by_victim[victim_index], 1);
+        add_nanoseconds(&stats->idle_nanoseconds,
+                        armd_timestamp_to_nanoseconds(armd_get_timestamp() -
+                                                      idle_begin));
+
+        return 1;
     }
 }
 
@@ -193,6 +266,7 @@ static ARMD_Job *propagate_error(ARMD_Context *context,
     switch (job->awaiter.type) {
     case JobAwaiterType_ParentJob: {
         ARMD_Job *next_job;
+        armd__executor_stats_add(&executor->stats.num_jobs_executed, 1);
         ARMD_Bool stole =
             armd__job_notify_to_parent_and_steal(job, executor, &next_job);
         armd__job_destroy(job);
@@ -204,13 +278,18 @@ static ARMD_Job *propagate_error(ARMD_Context *context,
         }
     } break;
     case JobAwaiterType_Promise: {
-        ARMD_Handle handle = job->awaiter.body.promise.handle;
-        res = armd__context_complete_promise(context, handle, 1);
+        armd__executor_stats_add(&executor->stats.num_jobs_executed, 1);
+        res = armd__context_complete_promise(context, executor, job, 1);
         assert(res == 0);
 
         armd__job_destroy(job);
         job = NULL;
     } break;
+    case JobAwaiterType_TaskGroup: {
+        armd__executor_stats_add(&executor->stats.num_jobs_executed, 1);
+        armd__task_group_end_job(job, 1);
+        job = NULL;
+    } break;
     default:
         assert(0);
         break;
@@ -248,6 +327,8 @@ static void *executor_thread_main(void *args) {
     ARMD__Random rand;
     armd__random_init(&rand, (uint32_t)executor->id);
 
+    armd__thread_set_slot(executor->id);
+
     if (!wait_for_context_ready(context, executor)) {
         return NULL;
     }
@@ -290,6 +371,8 @@ static void *executor_thread_main(void *args) {
                 switch (job->awaiter.type) {
                 case JobAwaiterType_ParentJob: {
                     ARMD_Job *next_job;
+                    armd__executor_stats_add(
+                        &executor->stats.num_jobs_executed, 1);
                     ARMD_Bool stole = armd__job_notify_to_parent_and_steal(
                         job, executor, &next_job);
                     armd__job_destroy(job);
@@ -302,13 +385,22 @@ static void *executor_thread_main(void *args) {
                     }
                 } break;
                 case JobAwaiterType_Promise: {
-                    ARMD_Handle handle = job->awaiter.body.promise.handle;
-                    res = armd__context_complete_promise(context, handle, 0);
+                    armd__executor_stats_add(
+                        &executor->stats.num_jobs_executed, 1);
+                    res = armd__context_complete_promise(context, executor,
+                                                         job, 0);
                     assert(res == 0);
                     armd__job_destroy(job);
 
                     job = NULL;
                 } break;
+                case JobAwaiterType_TaskGroup: {
+                    armd__executor_stats_add(
+                        &executor->stats.num_jobs_executed, 1);
+                    armd__task_group_end_job(job, 0);
+
+                    job = NULL;
+                } break;
                 default:
                     assert(0);
                     break;
@@ -328,6 +420,7 @@ ARMD__Executor *armd__executor_create(ARMD_Context *context, ARMD_Size id) {
     assert(context != NULL);
 
     const ARMD_Size initial_deque_size = 128;
+    const ARMD_Size frame_stack_chunk_size = 64 * 1024;
     int res = 0;
     (void)res;
 
@@ -335,6 +428,8 @@ ARMD__Executor *armd__executor_create(ARMD_Context *context, ARMD_Size id) {
 
     int executor_initialized = 0;
     int deque_initialized = 0;
+    int frame_memory_region_initialized = 0;
+    int stats_initialized = 0;
     int spinlock_initialized = 0;
     int thread_initialized = 0;
 
@@ -358,6 +453,46 @@ ARMD__Executor *armd__executor_create(ARMD_Context *context, ARMD_Size id) {
     }
     deque_initialized = 1;
 
+    executor->frame_memory_region = armd__memory_region_create_frame_stack(
+        &context->memory_allocator, context->memory_region,
+        frame_stack_chunk_size);
+    if (executor->frame_memory_region == NULL) {
+        goto error;
+    }
+    frame_memory_region_initialized = 1;
+
+    {
+        ARMD__ExecutorStats *stats = &executor->stats;
+        stats->num_jobs_executed = 0;
+        stats->num_forks = 0;
+        stats->num_steals = 0;
+        stats->num_failed_steals = 0;
+        stats->num_parks = 0;
+        stats->num_wakeups = 0;
+        stats->idle_nanoseconds = 0;
+        stats->parked_nanoseconds = 0;
+        stats->deque_high_water_mark = 0;
+
+        // Both counter arrays in one allocation
+        stats->num_steals_by_victim = armd_memory_region_allocate(
+            memory_region, 2 * context->num_executors * sizeof(ARMD_Size));
+        if (stats->num_steals_by_victim == NULL) {
+            goto error;
+        }
+        stats->num_failed_steals_by_victim =
+            stats->num_steals_by_victim + context->num_executors;
+        for (ARMD_Size i = 0; i < 2 * context->num_executors; ++i) {
+            stats->num_steals_by_victim[i] = 0;
+        }
+    }
+    stats_initialized = 1;
+
+    executor->trace_buffer_storage = NULL;
+    executor->trace_buffer = NULL;
+    executor->profiler_storage = NULL;
+    executor->profiler = NULL;
+    armd__span_analysis_counters_init(&executor->span_analysis);
+
     if (armd__spinlock_init(&executor->lock)) {
         goto error;
     }
@@ -395,6 +530,15 @@ ARMD__Executor *armd__executor_create(ARMD_Context *context, ARMD_Size id) {
         assert(res == 0);
     }
 
+    if (stats_initialized) {
+        armd_memory_region_free(memory_region,
+                                executor->stats.num_steals_by_victim);
+    }
+
+    if (frame_memory_region_initialized) {
+        armd_memory_region_destroy(executor->frame_memory_region);
+    }
+
     if (deque_initialized) {
         res = armd__deque_destroy(executor->deque);
         assert(res == 0);
@@ -444,9 +588,84 @@ int armd__executor_destroy(ARMD__Executor *executor) {
     status = armd__deque_destroy(executor->deque);
     executor->deque = NULL;
 
+    armd_memory_region_destroy(executor->frame_memory_region);
+    executor->frame_memory_region = NULL;
+
+    armd_memory_region_free(memory_region,
+                            executor->stats.num_steals_by_victim);
+    executor->stats.num_steals_by_victim = NULL;
+    executor->stats.num_failed_steals_by_victim = NULL;
+
+    if (executor->trace_buffer_storage != NULL) {
+        armd__trace_buffer_destroy(executor->trace_buffer_storage);
+        executor->trace_buffer_storage = NULL;
+        executor->trace_buffer = NULL;
+    }
+
+    if (executor->profiler_storage != NULL) {
+        armd__profiler_destroy(executor->profiler_storage);
+        executor->profiler_storage = NULL;
+        executor->profiler = NULL;
+    }
+
     res = armd__spinlock_deinit(&executor->lock);
     assert(res == 0);
 
     armd_memory_region_free(memory_region, executor);
     return status;
 }
+
+void armd__executor_stats_add(ARMD_Size *counter, ARMD_Size value) {
+    // Only the owner writes, so a plain read-modify-write is enough. The store
+    // is atomic just not to tear for the readers.
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(counter, *counter + value, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    *(volatile ARMD_Size *)counter += value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+void armd__executor_record_deque_size(ARMD__Executor *executor) {
+    assert(executor != NULL);
+
+    // Called with the executor lock held
+    ARMD_Size num_entries = armd__deque_get_num_entries(executor->deque);
+    if (num_entries > executor->stats.deque_high_water_mark) {
+        armd__executor_stats_add(&executor->stats.deque_high_water_mark,
+                                 num_entries -
+                                     executor->stats.deque_high_water_mark);
+    }
+}
+
+void armd__executor_get_stats(ARMD__Executor *executor,
+                              ARMD_ExecutorStats *stats,
+                              ARMD_StealStats *steal_stats) {
+    assert(executor != NULL);
+
+    const ARMD__ExecutorStats *source = &executor->stats;
+
+    if (stats != NULL) {
+        stats->num_jobs_executed = load_counter(&source->num_jobs_executed);
+        stats->num_forks = load_counter(&source->num_forks);
+        stats->num_steals = load_counter(&source->num_steals);
+        stats->num_failed_steals = load_counter(&source->num_failed_steals);
+        stats->num_parks = load_counter(&source->num_parks);
+        stats->num_wakeups = load_counter(&source->num_wakeups);
+        stats->idle_nanoseconds = load_nanoseconds(&source->idle_nanoseconds);
+        stats->parked_nanoseconds =
+            load_nanoseconds(&source->parked_nanoseconds);
+        stats->deque_high_water_mark =
+            load_counter(&source->deque_high_water_mark);
+    }
+
+    if (steal_stats != NULL) {
+        for (ARMD_Size i = 0; i < executor->context->num_executors; ++i) {
+            steal_stats[i].num_steals =
+                load_counter(&source->num_steals_by_victim[i]);
+            steal_stats[i].num_failed_steals =
+                load_counter(&source->num_failed_steals_by_victim[i]);
+        }
+    }
+}
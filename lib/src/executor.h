@@ -4,19 +4,52 @@
 #include <aramid/aramid.h>
 
 #include "deque.h"
+#include "memory_region.h"
+#include "profiler.h"
+#include "span_analysis.h"
 #include "spinlock.h"
 #include "thread.h"
+#include "trace.h"
 #include "types.h"
 
+/*
+ * Counters written only by the owning executor thread without locks. Readers
+ * on other threads load them relaxed, so the values may be slightly stale.
+ * deque_high_water_mark is the exception; it is updated under the executor
+ * lock by whichever thread enqueues.
+ */
+typedef struct TAG_ARMD__ExecutorStats {
+    ARMD_Size num_jobs_executed;
+    ARMD_Size num_forks;
+    ARMD_Size num_steals;
+    ARMD_Size num_failed_steals;
+    ARMD_Size num_parks;
+    ARMD_Size num_wakeups;
+    uint64_t idle_nanoseconds;
+    uint64_t parked_nanoseconds;
+    ARMD_Size deque_high_water_mark;
+    ARMD_Size *num_steals_by_victim;
+    ARMD_Size *num_failed_steals_by_victim;
+} ARMD__ExecutorStats;
+
 struct TAG_ARMD__Executor {
     ARMD_Context *context;
     ARMD_Size id;
     ARMD__Spinlock lock;
     ARMD__Thread thread;
     ARMD__Deque *deque;
+    ARMD_MemoryRegion *frame_memory_region;
     volatile ARMD_Bool thread_should_continue_running;
     volatile ARMD_Bool context_ready;
     ARMD_Bool stopped;
+    ARMD__ExecutorStats stats;
+    // trace_buffer is trace_buffer_storage while tracing, otherwise NULL
+    ARMD__TraceBuffer *trace_buffer_storage;
+    ARMD__TraceBuffer *volatile trace_buffer;
+    // profiler is profiler_storage while profiling, otherwise NULL
+    ARMD__Profiler *profiler_storage;
+    ARMD__Profiler *volatile profiler;
+    ARMD__SpanAnalysisCounters span_analysis;
 };
 
 ARMD_EXTERN_C ARMD__Executor *armd__executor_create(ARMD_Context *context,
@@ -25,4 +58,11 @@ ARMD_EXTERN_C
 void armd__executor_stop(ARMD__Executor *executor);
 ARMD_EXTERN_C int armd__executor_destroy(ARMD__Executor *executor);
 
+ARMD_EXTERN_C void armd__executor_stats_add(ARMD_Size *counter,
+                                            ARMD_Size value);
+ARMD_EXTERN_C void armd__executor_record_deque_size(ARMD__Executor *executor);
+ARMD_EXTERN_C void armd__executor_get_stats(ARMD__Executor *executor,
+                                            ARMD_ExecutorStats *stats,
+                                            ARMD_StealStats *steal_stats);
+
 #endif // ARAMID__EXECUTOR_H
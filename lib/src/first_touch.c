@@ -0,0 +1,190 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#include "first_touch.h"
+
+#include "context.h"
+#include "os_memory.h"
+
+typedef struct {
+    unsigned char *buf;
+    ARMD_Size begin;
+    ARMD_Size end;
+    ARMD_Size page_size;
+    ARMD_Size *executor_id;
+} TouchArgs;
+
+typedef struct {
+    ARMD_Size num_parts;
+    ARMD_Procedure *touch_procedure;
+    TouchArgs *touch_args;
+} FirstTouchArgs;
+
+static int touch_continuation(ARMD_Job *job, const void *constants, void *args,
+                              void *frame) {
+    (void)constants;
+    (void)frame;
+
+    TouchArgs *typed_args = (TouchArgs *)args;
+    if (typed_args->executor_id != NULL) {
+        *typed_args->executor_id = armd_job_get_executor_id(job);
+    }
+
+    if (typed_args->begin == typed_args->end) {
+        return 0;
+    }
+
+    // The page of begin may be shared with the previous part
+    volatile unsigned char *buf = typed_args->buf;
+    ARMD_Size page_size = typed_args->page_size;
+    buf[typed_args->begin] = 0;
+    for (ARMD_Size offset = (typed_args->begin / page_size + 1) * page_size;
+         offset < typed_args->end; offset += page_size) {
+        buf[offset] = 0;
+    }
+
+    return 0;
+}
+
+static int fork_continuation(ARMD_Job *job, const void *constants, void *args,
+                             void *frame) {
+    (void)constants;
+    (void)frame;
+
+    FirstTouchArgs *typed_args = (FirstTouchArgs *)args;
+    for (ARMD_Size i = 0; i < typed_args->num_parts; ++i) {
+        // Queued into the deque of executor i, but idle executors can steal it
+        if (armd_fork_with_id(i, job, typed_args->touch_procedure,
+                              &typed_args->touch_args[i])) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static ARMD_Procedure *
+build_single_procedure(const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD_SingleContinuationFunc continuation_func) {
+    ARMD_ProcedureBuilder *builder =
+        armd_procedure_builder_create(memory_allocator, 0, 0);
+    if (builder == NULL) {
+        return NULL;
+    }
+
+    if (armd_then_single(builder, continuation_func)) {
+        armd_procedure_builder_destroy(builder);
+        return NULL;
+    }
+
+    return armd_procedure_builder_build_and_destroy(builder);
+}
+
+void armd_get_static_partition(ARMD_Size count, ARMD_Size num_parts,
+                               ARMD_Size part_index, ARMD_Size *begin,
+                               ARMD_Size *end) {
+    assert(num_parts != 0);
+    assert(part_index < num_parts);
+
+    ARMD_Size quotient = count / num_parts;
+    ARMD_Size remainder = count % num_parts;
+
+    // The first remainder parts get one more element
+    *begin = part_index * quotient +
+             (part_index < remainder ? part_index : remainder);
+    *end = *begin + quotient + (part_index < remainder ? 1 : 0);
+}
+
+int armd__first_touch(ARMD_Context *context, void *buf, ARMD_Size size,
+                      ARMD_Size *executor_ids) {
+    int touch_args_initialized = 0;
+    int touch_procedure_initialized = 0;
+    int procedure_initialized = 0;
+
+    FirstTouchArgs args;
+    ARMD_Procedure *procedure = NULL;
+
+    args.num_parts = context->num_executors;
+    args.touch_args = armd_memory_allocator_allocate(
+        &context->memory_allocator, sizeof(TouchArgs) * args.num_parts);
+    if (args.touch_args == NULL) {
+        goto error;
+    }
+    touch_args_initialized = 1;
+
+    ARMD_Size page_size = armd__os_memory_get_page_size();
+    for (ARMD_Size i = 0; i < args.num_parts; ++i) {
+        TouchArgs *touch_args = &args.touch_args[i];
+        touch_args->buf = buf;
+        armd_get_static_partition(size, args.num_parts, i, &touch_args->begin,
+                                  &touch_args->end);
+        touch_args->page_size = page_size;
+        touch_args->executor_id =
+            executor_ids != NULL ? &executor_ids[i] : NULL;
+    }
+
+    args.touch_procedure =
+        build_single_procedure(&context->memory_allocator, touch_continuation);
+    if (args.touch_procedure == NULL) {
+        goto error;
+    }
+    touch_procedure_initialized = 1;
+
+    procedure =
+        build_single_procedure(&context->memory_allocator, fork_continuation);
+    if (procedure == NULL) {
+        goto error;
+    }
+    procedure_initialized = 1;
+
+    // The forked jobs are joined before the promise is completed
+    ARMD_Handle promise = armd_invoke(context, procedure, &args, 0, NULL);
+    if (promise == 0) {
+        goto error;
+    }
+    if (armd_await(context, promise)) {
+        goto error;
+    }
+
+    armd_procedure_destroy(procedure);
+    armd_procedure_destroy(args.touch_procedure);
+    armd_memory_allocator_free(&context->memory_allocator, args.touch_args);
+
+    return 0;
+
+error:
+    if (procedure_initialized) {
+        armd_procedure_destroy(procedure);
+    }
+
+    if (touch_procedure_initialized) {
+        armd_procedure_destroy(args.touch_procedure);
+    }
+
+    if (touch_args_initialized) {
+        armd_memory_allocator_free(&context->memory_allocator,
+                                   args.touch_args);
+    }
+
+    return -1;
+}
+
+void *armd_allocate_first_touch(ARMD_Context *context,
+                                const ARMD_MemoryAllocator *memory_allocator,
+                                ARMD_Size size) {
+    assert(context != NULL);
+    assert(memory_allocator != NULL);
+
+    void *buf = armd_memory_allocator_allocate(memory_allocator, size);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    if (armd__first_touch(context, buf, size, NULL)) {
+        armd_memory_allocator_free(memory_allocator, buf);
+        return NULL;
+    }
+
+    return buf;
+}
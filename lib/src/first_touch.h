@@ -0,0 +1,15 @@
+#ifndef ARAMID__FIRST_TOUCH_H
+#define ARAMID__FIRST_TOUCH_H
+
+#include <aramid/aramid.h>
+
+/*
+ * Touches every page of the buffer with one job per executor. The job for
+ * part i of armd_get_static_partition is forked onto executor i, and the id
+ * of the executor which actually ran it is stored into executor_ids[i]. It
+ * differs from i only if the job was stolen. executor_ids is nullable.
+ */
+ARMD_EXTERN_C int armd__first_touch(ARMD_Context *context, void *buf,
+                                    ARMD_Size size, ARMD_Size *executor_ids);
+
+#endif // ARAMID__FIRST_TOUCH_H
@@ -0,0 +1,70 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "first_touch.h"
+
+namespace {
+
+const ARMD_Size num_executors = 4;
+
+class FirstTouchPartTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+
+    FirstTouchPartTest() {}
+
+    ~FirstTouchPartTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator, num_executors);
+    }
+
+    void TearDown() override {
+        int res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+
+    std::vector<ARMD_StealStats> get_steal_stats() {
+        ARMD_ContextStats context_stats;
+        std::vector<ARMD_StealStats> steal_stats(num_executors *
+                                                 num_executors);
+        int res = armd_context_get_stats(context, &context_stats, nullptr,
+                                         steal_stats.data());
+        EXPECT_EQ(res, 0);
+        return steal_stats;
+    }
+};
+
+TEST_F(FirstTouchPartTest, MapPartToExecutor) {
+    const ARMD_Size size = 1024 * 1024 + 3;
+    std::vector<unsigned char> buf(size);
+
+    for (int trial = 0; trial < 16; ++trial) {
+        std::vector<ARMD_Size> executor_ids(num_executors, num_executors);
+        std::vector<ARMD_StealStats> steal_stats_before = get_steal_stats();
+        int res = armd__first_touch(context, buf.data(), size,
+                                    executor_ids.data());
+        ASSERT_EQ(res, 0);
+        std::vector<ARMD_StealStats> steal_stats_after = get_steal_stats();
+
+        for (ARMD_Size i = 0; i < num_executors; ++i) {
+            ARMD_Size executor_id = executor_ids[i];
+            ASSERT_LT(executor_id, num_executors);
+            if (executor_id == i) {
+                continue;
+            }
+
+            // Part i goes elsewhere only if its job was stolen from executor i
+            ARMD_Size stats_index = executor_id * num_executors + i;
+            ASSERT_GT(steal_stats_after[stats_index].num_steals,
+                      steal_stats_before[stats_index].num_steals);
+        }
+    }
+}
+
+} // namespace
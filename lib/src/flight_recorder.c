@@ -0,0 +1,390 @@
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <aramid/aramid.h>
+
+#include "flight_recorder.h"
+
+#include "context.h"
+#include "executor.h"
+#include "os_memory.h"
+#include "time.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const unsigned char magic[8] = {'A', 'R', 'M', 'D', 'F', 'L', 'T', '1'};
+
+static ARMD_Size align_lane(ARMD_Size size) {
+    return (size + 63) & ~(ARMD_Size)63;
+}
+
+static void store_num_recorded(volatile uint64_t *num_recorded,
+                               uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(num_recorded, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _ReadWriteBarrier();
+    *num_recorded = value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+ARMD_FlightRecorder *
+armd_flight_recorder_create(const ARMD_MemoryAllocator *memory_allocator,
+                            const char *path, ARMD_Size num_trace_lanes,
+                            ARMD_Size num_events_per_lane,
+                            ARMD_Size num_log_records) {
+    if (memory_allocator == NULL || path == NULL ||
+        (num_trace_lanes != 0 && num_events_per_lane == 0)) {
+        return NULL;
+    }
+
+    ARMD_Size header_size = align_lane(sizeof(ARMD__FlightRecorderHeader));
+    ARMD_Size trace_lane_size =
+        align_lane(sizeof(ARMD__FlightRecorderLaneHeader) +
+                   sizeof(ARMD__TraceEvent) * num_events_per_lane);
+    ARMD_Size log_lane_size =
+        align_lane(sizeof(ARMD__FlightRecorderLaneHeader) +
+                   sizeof(ARMD__FlightLogRecord) * num_log_records);
+    ARMD_Size size =
+        header_size + trace_lane_size * num_trace_lanes + log_lane_size;
+
+    ARMD_FlightRecorder *flight_recorder = armd_memory_allocator_allocate(
+        memory_allocator, sizeof(ARMD_FlightRecorder));
+    if (flight_recorder == NULL) {
+        return NULL;
+    }
+
+    flight_recorder->buf = armd__os_memory_map_file(path, size);
+    if (flight_recorder->buf == NULL) {
+        armd_memory_allocator_free(memory_allocator, flight_recorder);
+        return NULL;
+    }
+
+    flight_recorder->memory_allocator = *memory_allocator;
+    flight_recorder->size = size;
+    flight_recorder->header =
+        (ARMD__FlightRecorderHeader *)flight_recorder->buf;
+
+    // The rest of the file is zero-filled, so every lane is empty
+    ARMD__FlightRecorderHeader *header = flight_recorder->header;
+    header->byte_order = 0x01020304;
+    header->trace_event_size = sizeof(ARMD__TraceEvent);
+    header->log_record_size = sizeof(ARMD__FlightLogRecord);
+    ARMD__TimestampScale timestamp_scale;
+    armd__time_get_timestamp_scale(&timestamp_scale);
+    header->timestamp_multiplier = timestamp_scale.multiplier;
+    header->timestamp_shift = timestamp_scale.shift;
+    header->reserved = 0;
+    header->file_size = size;
+    header->num_trace_lanes = num_trace_lanes;
+    header->num_events_per_lane = num_events_per_lane;
+    header->num_log_records = num_log_records;
+    header->trace_lanes_offset = header_size;
+    header->trace_lane_size = trace_lane_size;
+    header->log_lane_offset = header_size + trace_lane_size * num_trace_lanes;
+
+    ARMD_Timespec timespec;
+    armd_get_time(&timespec);
+    header->base_timestamp = armd_get_timestamp();
+    header->base_seconds = timespec.seconds;
+    header->base_nanoseconds = timespec.nanoseconds;
+
+    // Written last, so that a file with the magic has a valid header
+    memcpy(header->magic, magic, sizeof(magic));
+
+    return flight_recorder;
+}
+
+int armd_flight_recorder_destroy(ARMD_FlightRecorder *flight_recorder) {
+    if (flight_recorder == NULL) {
+        return -1;
+    }
+
+    armd__os_memory_unmap_file(flight_recorder->buf, flight_recorder->size);
+
+    ARMD_MemoryAllocator memory_allocator = flight_recorder->memory_allocator;
+    armd_memory_allocator_free(&memory_allocator, flight_recorder);
+
+    return 0;
+}
+
+ARMD__FlightRecorderLaneHeader *
+armd__flight_recorder_get_trace_lane(ARMD_FlightRecorder *flight_recorder,
+                                     ARMD_Size index) {
+    const ARMD__FlightRecorderHeader *header = flight_recorder->header;
+    assert(index < header->num_trace_lanes);
+
+    return (ARMD__FlightRecorderLaneHeader *)(flight_recorder->buf +
+                                              header->trace_lanes_offset +
+                                              header->trace_lane_size * index);
+}
+
+ARMD__TraceEvent *
+armd__flight_recorder_get_trace_events(ARMD_FlightRecorder *flight_recorder,
+                                       ARMD_Size index) {
+    return (ARMD__TraceEvent *)(armd__flight_recorder_get_trace_lane(
+                                    flight_recorder, index) +
+                                1);
+}
+
+static ARMD__FlightRecorderLaneHeader *
+get_log_lane(ARMD_FlightRecorder *flight_recorder) {
+    return (ARMD__FlightRecorderLaneHeader *)(flight_recorder->buf +
+                                              flight_recorder->header
+                                                  ->log_lane_offset);
+}
+
+static void copy_string(char *dest, ARMD_Size dest_size, const char *src,
+                        ARMD_Bool keep_tail) {
+    if (src == NULL) {
+        dest[0] = '\0';
+        return;
+    }
+
+    ARMD_Size length = strlen(src);
+    if (length >= dest_size) {
+        if (keep_tail) {
+            src += length - (dest_size - 1);
+        }
+        length = dest_size - 1;
+    }
+    memcpy(dest, src, length);
+    dest[length] = '\0';
+}
+
+ARMD__FlightLogRecord *
+armd__flight_recorder_begin_log(ARMD_FlightRecorder *flight_recorder,
+                                const ARMD_Timespec *timespec,
+                                ARMD_LogLevel level, const char *filename,
+                                ARMD_Size lineno) {
+    const ARMD__FlightRecorderHeader *header = flight_recorder->header;
+    if (header->num_log_records == 0) {
+        return NULL;
+    }
+
+    ARMD__FlightRecorderLaneHeader *lane = get_log_lane(flight_recorder);
+    ARMD__FlightLogRecord *records = (ARMD__FlightLogRecord *)(lane + 1);
+    ARMD__FlightLogRecord *record =
+        &records[lane->num_recorded % header->num_log_records];
+
+    record->seconds = timespec->seconds;
+    record->nanoseconds = timespec->nanoseconds;
+    record->level = (uint32_t)level;
+    record->lineno = (uint32_t)lineno;
+    copy_string(record->filename, sizeof(record->filename), filename, 1);
+    record->message[0] = '\0';
+
+    return record;
+}
+
+void armd__flight_recorder_end_log(ARMD_FlightRecorder *flight_recorder) {
+    ARMD__FlightRecorderLaneHeader *lane = get_log_lane(flight_recorder);
+    store_num_recorded(&lane->num_recorded, lane->num_recorded + 1);
+}
+
+void armd__flight_recorder_record_log(ARMD_FlightRecorder *flight_recorder,
+                                      const ARMD_LogElement *log_element) {
+    ARMD__FlightLogRecord *record = armd__flight_recorder_begin_log(
+        flight_recorder, &log_element->timespec, log_element->level,
+        log_element->filename, log_element->lineno);
+    if (record == NULL) {
+        return;
+    }
+
+    copy_string(record->message, sizeof(record->message),
+                log_element->message, 0);
+
+    armd__flight_recorder_end_log(flight_recorder);
+}
+
+int armd_context_enable_flight_recorder(ARMD_Context *context,
+                                        ARMD_FlightRecorder *flight_recorder) {
+#ifndef ARAMID_DISABLE_TRACING
+    if (context == NULL || flight_recorder == NULL ||
+        flight_recorder->header->num_trace_lanes < context->num_executors) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        if (context->executors[i]->trace_buffer_storage != NULL) {
+            // Already traced into memory
+            return -1;
+        }
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Executor *executor = context->executors[i];
+        ARMD__FlightRecorderLaneHeader *lane =
+            armd__flight_recorder_get_trace_lane(flight_recorder, i);
+        executor->trace_buffer_storage = armd__trace_buffer_create_mapped(
+            &context->memory_allocator,
+            flight_recorder->header->num_events_per_lane,
+            armd__flight_recorder_get_trace_events(flight_recorder, i),
+            &lane->num_recorded);
+        if (executor->trace_buffer_storage == NULL) {
+            goto error;
+        }
+    }
+
+    // Publishes the buffers created above
+    if (armd_context_enable_tracing(
+            context, flight_recorder->header->num_events_per_lane) != 0) {
+        goto error;
+    }
+
+    return 0;
+
+error:
+    // All the buffers were created above; leaving them would make later
+    // armd_context_enable_tracing calls record into this file
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Executor *executor = context->executors[i];
+        if (executor->trace_buffer_storage != NULL) {
+            armd__trace_buffer_destroy(executor->trace_buffer_storage);
+            executor->trace_buffer_storage = NULL;
+        }
+    }
+
+    return -1;
+#else
+    (void)context;
+    (void)flight_recorder;
+    return -1;
+#endif
+}
+
+static ARMD_Bool is_valid_header(const ARMD__FlightRecorderHeader *header,
+                                 ARMD_Size size) {
+    if (memcmp(header->magic, magic, sizeof(magic)) != 0 ||
+        header->byte_order != 0x01020304 ||
+        header->trace_event_size != sizeof(ARMD__TraceEvent) ||
+        header->log_record_size != sizeof(ARMD__FlightLogRecord) ||
+        header->timestamp_shift > 32 || header->file_size != size) {
+        return 0;
+    }
+
+    // Reject the sizes which would read beyond the data
+    const uint64_t lane_header_size = sizeof(ARMD__FlightRecorderLaneHeader);
+    if (header->trace_lanes_offset > size ||
+        (header->num_trace_lanes != 0 &&
+         (header->trace_lane_size < lane_header_size ||
+          header->num_events_per_lane >
+              (header->trace_lane_size - lane_header_size) /
+                  sizeof(ARMD__TraceEvent) ||
+          header->trace_lane_size > (size - header->trace_lanes_offset) /
+                                        header->num_trace_lanes)) ||
+        header->log_lane_offset > size ||
+        size - header->log_lane_offset < lane_header_size ||
+        header->num_log_records >
+            (size - header->log_lane_offset - lane_header_size) /
+                sizeof(ARMD__FlightLogRecord)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/* A torn entry may be left at the oldest position of a full ring */
+static uint64_t get_first_valid(uint64_t num_recorded, uint64_t capacity) {
+    return num_recorded >= capacity ? num_recorded - capacity + 1 : 0;
+}
+
+int armd__flight_recorder_decode(const void *data, ARMD_Size size,
+                                 ARMD__FlightTraceDecoderFunc trace_func,
+                                 ARMD_LogDecoderFunc log_func,
+                                 void *decoder_context) {
+    const unsigned char *buf = data;
+
+    ARMD__FlightRecorderHeader header;
+    if (size < sizeof(header)) {
+        return -1;
+    }
+    memcpy(&header, buf, sizeof(header));
+    if (!is_valid_header(&header, size)) {
+        return -1;
+    }
+
+    ARMD__TimestampScale timestamp_scale;
+    timestamp_scale.multiplier = header.timestamp_multiplier;
+    timestamp_scale.shift = header.timestamp_shift;
+
+    for (ARMD_Size i = 0; i < header.num_trace_lanes; ++i) {
+        const unsigned char *lane = buf + header.trace_lanes_offset +
+                                    header.trace_lane_size * i;
+        ARMD__FlightRecorderLaneHeader lane_header;
+        memcpy(&lane_header, lane, sizeof(lane_header));
+
+        uint64_t end = lane_header.num_recorded;
+        uint64_t capacity = header.num_events_per_lane;
+        for (uint64_t j = get_first_valid(end, capacity); j < end; ++j) {
+            ARMD__TraceEvent event;
+            memcpy(&event,
+                   lane + sizeof(lane_header) +
+                       sizeof(ARMD__TraceEvent) * (j % capacity),
+                   sizeof(event));
+
+            // Relative to the creation of the file, which may be negative
+            // for events recorded by another context
+            int64_t offset =
+                event.timestamp >= header.base_timestamp
+                    ? (int64_t)armd__time_scale_timestamp(
+                          &timestamp_scale,
+                          event.timestamp - header.base_timestamp)
+                    : -(int64_t)armd__time_scale_timestamp(
+                          &timestamp_scale,
+                          header.base_timestamp - event.timestamp);
+            int64_t nanoseconds = header.base_nanoseconds + offset;
+            ARMD__FlightTraceEvent trace_event;
+            trace_event.executor_id = i;
+            trace_event.timespec.seconds =
+                header.base_seconds + nanoseconds / 1000000000;
+            trace_event.timespec.nanoseconds = nanoseconds % 1000000000;
+            if (trace_event.timespec.nanoseconds < 0) {
+                trace_event.timespec.seconds -= 1;
+                trace_event.timespec.nanoseconds += 1000000000;
+            }
+            trace_event.type = event.type;
+            trace_event.arg = event.arg;
+
+            if (trace_func(decoder_context, &trace_event)) {
+                return 0;
+            }
+        }
+    }
+
+    const unsigned char *lane = buf + header.log_lane_offset;
+    ARMD__FlightRecorderLaneHeader lane_header;
+    memcpy(&lane_header, lane, sizeof(lane_header));
+
+    uint64_t end = lane_header.num_recorded;
+    uint64_t capacity = header.num_log_records;
+    for (uint64_t j = get_first_valid(end, capacity); j < end; ++j) {
+        ARMD__FlightLogRecord record;
+        memcpy(&record,
+               lane + sizeof(lane_header) +
+                   sizeof(ARMD__FlightLogRecord) * (j % capacity),
+               sizeof(record));
+        // Terminate in case the record is corrupted
+        record.filename[sizeof(record.filename) - 1] = '\0';
+        record.message[sizeof(record.message) - 1] = '\0';
+
+        ARMD_LogElement log_element;
+        log_element.timespec.seconds = record.seconds;
+        log_element.timespec.nanoseconds = record.nanoseconds;
+        log_element.level = (ARMD_LogLevel)record.level;
+        log_element.filename = record.filename;
+        log_element.lineno = record.lineno;
+        log_element.message = record.message;
+
+        if (log_func(decoder_context, &log_element)) {
+            return 0;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#ifndef ARAMID__FLIGHT_RECORDER_H
+#define ARAMID__FLIGHT_RECORDER_H
+
+#include <stdint.h>
+
+#include <aramid/aramid.h>
+
+#include "trace.h"
+
+/*
+ * The file is the header, the trace lanes, one per executor, and the log
+ * lane, each starting on a 64-byte boundary. A lane is its header and a ring
+ * of fixed-size entries. Each lane has a single writer which overwrites the
+ * oldest entry with plain stores and then publishes it by incrementing
+ * num_recorded, so after a crash the oldest entry in a full ring may be torn
+ * and the decoder skips it.
+ */
+
+#define ARMD__FLIGHT_RECORDER_FILENAME_SIZE 64
+#define ARMD__FLIGHT_RECORDER_MESSAGE_SIZE 200
+
+typedef struct TAG_ARMD__FlightRecorderHeader {
+    unsigned char magic[8];
+    // Written as 0x01020304 to check the byte order
+    uint32_t byte_order;
+    uint32_t trace_event_size;
+    uint32_t log_record_size;
+    // Converts the timestamps of the trace events to nanoseconds
+    uint32_t timestamp_multiplier;
+    uint32_t timestamp_shift;
+    uint32_t reserved;
+    uint64_t file_size;
+    uint64_t num_trace_lanes;
+    uint64_t num_events_per_lane;
+    uint64_t num_log_records;
+    uint64_t trace_lanes_offset;
+    uint64_t trace_lane_size;
+    uint64_t log_lane_offset;
+    // Pairs the timestamps of the trace events with the wall clock
+    uint64_t base_timestamp;
+    int64_t base_seconds;
+    int64_t base_nanoseconds;
+} ARMD__FlightRecorderHeader;
+
+typedef struct TAG_ARMD__FlightRecorderLaneHeader {
+    volatile uint64_t num_recorded;
+    unsigned char padding[56];
+} ARMD__FlightRecorderLaneHeader;
+
+typedef struct TAG_ARMD__FlightLogRecord {
+    int64_t seconds;
+    int64_t nanoseconds;
+    uint32_t level;
+    uint32_t lineno;
+    // The tail of the path if it is too long
+    char filename[ARMD__FLIGHT_RECORDER_FILENAME_SIZE];
+    char message[ARMD__FLIGHT_RECORDER_MESSAGE_SIZE];
+} ARMD__FlightLogRecord;
+
+struct TAG_ARMD_FlightRecorder {
+    ARMD_MemoryAllocator memory_allocator;
+    unsigned char *buf;
+    ARMD_Size size;
+    ARMD__FlightRecorderHeader *header;
+};
+
+ARMD_EXTERN_C ARMD__FlightRecorderLaneHeader *
+armd__flight_recorder_get_trace_lane(ARMD_FlightRecorder *flight_recorder,
+                                     ARMD_Size index);
+ARMD_EXTERN_C ARMD__TraceEvent *
+armd__flight_recorder_get_trace_events(ARMD_FlightRecorder *flight_recorder,
+                                       ARMD_Size index);
+
+/*
+ * Only one thread at a time may write log records. Fill the record returned
+ * by begin and publish it with end.
+ */
+ARMD_EXTERN_C ARMD__FlightLogRecord *
+armd__flight_recorder_begin_log(ARMD_FlightRecorder *flight_recorder,
+                                const ARMD_Timespec *timespec,
+                                ARMD_LogLevel level, const char *filename,
+                                ARMD_Size lineno);
+ARMD_EXTERN_C void
+armd__flight_recorder_end_log(ARMD_FlightRecorder *flight_recorder);
+ARMD_EXTERN_C void
+armd__flight_recorder_record_log(ARMD_FlightRecorder *flight_recorder,
+                                 const ARMD_LogElement *log_element);
+
+typedef struct TAG_ARMD__FlightTraceEvent {
+    ARMD_Size executor_id;
+    ARMD_Timespec timespec;
+    ARMD__TraceEventType type;
+    uint64_t arg;
+} ARMD__FlightTraceEvent;
+
+/*
+ * Reads a flight recorder file. The callbacks receive the surviving entries
+ * of each lane from the oldest and return non-zero to stop. Returns non-zero
+ * if the data is not a flight recorder file of this platform.
+ */
+typedef int (*ARMD__FlightTraceDecoderFunc)(
+    void *decoder_context, const ARMD__FlightTraceEvent *trace_event);
+ARMD_EXTERN_C int armd__flight_recorder_decode(
+    const void *data, ARMD_Size size, ARMD__FlightTraceDecoderFunc trace_func,
+    ARMD_LogDecoderFunc log_func, void *decoder_context);
+
+#endif // ARAMID__FLIGHT_RECORDER_H
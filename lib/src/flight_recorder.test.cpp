@@ -0,0 +1,302 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "context.h"
+#include "executor.h"
+#include "flight_recorder.h"
+
+namespace {
+
+struct DecodedEntries {
+    std::vector<ARMD__FlightTraceEvent> trace_events;
+    std::vector<std::string> messages;
+};
+
+int collect_trace_event(void *decoder_context,
+                        const ARMD__FlightTraceEvent *trace_event) {
+    reinterpret_cast<DecodedEntries *>(decoder_context)
+        ->trace_events.push_back(*trace_event);
+    return 0;
+}
+
+int collect_log_element(void *decoder_context,
+                        const ARMD_LogElement *log_element) {
+    reinterpret_cast<DecodedEntries *>(decoder_context)
+        ->messages.push_back(log_element->message);
+    return 0;
+}
+
+class FlightRecorderTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    std::string path;
+
+    FlightRecorderTest() {}
+
+    ~FlightRecorderTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        path = ::testing::TempDir() + "aramid_flight_recorder.bin";
+    }
+
+    void TearDown() override { std::remove(path.c_str()); }
+
+    std::vector<char> read_file() {
+        std::vector<char> data;
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        EXPECT_NE(file, nullptr);
+        if (file == nullptr) {
+            return data;
+        }
+
+        char buf[4096];
+        std::size_t size;
+        while ((size = std::fread(buf, 1, sizeof(buf), file)) != 0) {
+            data.insert(data.end(), buf, buf + size);
+        }
+        std::fclose(file);
+        return data;
+    }
+};
+
+TEST_F(FlightRecorderTest, RecordLogs) {
+    ARMD_FlightRecorder *flight_recorder =
+        armd_flight_recorder_create(&memory_allocator, path.c_str(), 0, 0, 4);
+    ASSERT_NE(flight_recorder, nullptr);
+
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create(&memory_allocator);
+    ARMD_Logger *logger = armd_logger_create(memory_region, ARMD_LogLevel_Info);
+    int res = armd_logger_set_flight_recorder(logger, flight_recorder);
+    ASSERT_EQ(res, 0);
+
+    // Filtered out by the level
+    armd_logger_log_string(logger, ARMD_LogLevel_Debug, __FILE__, __LINE__,
+                           armd_memory_region_strdup(memory_region, "debug"));
+    for (int i = 0; i < 6; ++i) {
+        std::string message = "message " + std::to_string(i);
+        armd_logger_log_string(
+            logger, ARMD_LogLevel_Info, __FILE__, __LINE__,
+            armd_memory_region_strdup(memory_region, message.c_str()));
+    }
+
+    // Still readable after the process has gone
+    std::vector<char> data = read_file();
+    DecodedEntries entries;
+    res = armd__flight_recorder_decode(data.data(), data.size(),
+                                       collect_trace_event,
+                                       collect_log_element, &entries);
+    ASSERT_EQ(res, 0);
+
+    // The oldest record of the full ring is regarded as torn
+    ASSERT_TRUE(entries.trace_events.empty());
+    ASSERT_EQ(entries.messages.size(), 3u);
+    ASSERT_EQ(entries.messages[0], "message 3");
+    ASSERT_EQ(entries.messages[1], "message 4");
+    ASSERT_EQ(entries.messages[2], "message 5");
+
+    armd_logger_decrement_reference_count(logger);
+    armd_memory_region_destroy(memory_region);
+    res = armd_flight_recorder_destroy(flight_recorder);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(FlightRecorderTest, DecodeMalformed) {
+    ARMD_FlightRecorder *flight_recorder =
+        armd_flight_recorder_create(&memory_allocator, path.c_str(), 2, 8, 8);
+    ASSERT_NE(flight_recorder, nullptr);
+
+    std::vector<char> data = read_file();
+    DecodedEntries entries;
+    int res = armd__flight_recorder_decode(data.data(), data.size(),
+                                           collect_trace_event,
+                                           collect_log_element, &entries);
+    ASSERT_EQ(res, 0);
+    ASSERT_TRUE(entries.trace_events.empty());
+    ASSERT_TRUE(entries.messages.empty());
+
+    // Truncated
+    res = armd__flight_recorder_decode(data.data(), data.size() - 1,
+                                       collect_trace_event,
+                                       collect_log_element, &entries);
+    ASSERT_NE(res, 0);
+
+    // Not a flight recorder file
+    data[0] = 'X';
+    res = armd__flight_recorder_decode(data.data(), data.size(),
+                                       collect_trace_event,
+                                       collect_log_element, &entries);
+    ASSERT_NE(res, 0);
+
+    res = armd_flight_recorder_destroy(flight_recorder);
+    ASSERT_EQ(res, 0);
+}
+
+#ifndef ARAMID_DISABLE_TRACING
+
+int noop_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)job;
+    (void)constants;
+    (void)args;
+    (void)frame;
+    return 0;
+}
+
+#endif
+
+TEST_F(FlightRecorderTest, RecordSchedulerEvents) {
+    const ARMD_Size num_executors = 2;
+    ARMD_Context *context =
+        armd_context_create(&memory_allocator, num_executors);
+
+    ARMD_FlightRecorder *flight_recorder = armd_flight_recorder_create(
+        &memory_allocator, path.c_str(), num_executors, 1024, 0);
+    ASSERT_NE(flight_recorder, nullptr);
+
+#ifndef ARAMID_DISABLE_TRACING
+    {
+        // Too few lanes for the executors
+        std::string small_path = path + ".small";
+        ARMD_FlightRecorder *small_flight_recorder =
+            armd_flight_recorder_create(&memory_allocator, small_path.c_str(),
+                                        1, 1024, 0);
+        ASSERT_NE(small_flight_recorder, nullptr);
+        ASSERT_NE(armd_context_enable_flight_recorder(context,
+                                                      small_flight_recorder),
+                  0);
+        ASSERT_EQ(armd_flight_recorder_destroy(small_flight_recorder), 0);
+        std::remove(small_path.c_str());
+    }
+
+    int res = armd_context_enable_flight_recorder(context, flight_recorder);
+    ASSERT_EQ(res, 0);
+
+    ARMD_ProcedureBuilder *builder =
+        armd_procedure_builder_create(&memory_allocator, 0, 0);
+    armd_then_single(builder, noop_continuation);
+    ARMD_Procedure *procedure =
+        armd_procedure_builder_build_and_destroy(builder);
+
+    ARMD_Handle promise = armd_invoke(context, procedure, nullptr, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+
+    res = armd_context_disable_tracing(context);
+    ASSERT_EQ(res, 0);
+
+    std::vector<char> data = read_file();
+    DecodedEntries entries;
+    res = armd__flight_recorder_decode(data.data(), data.size(),
+                                       collect_trace_event,
+                                       collect_log_element, &entries);
+    ASSERT_EQ(res, 0);
+
+    ARMD_Size num_job_begins = 0;
+    ARMD_Size num_job_ends = 0;
+    ARMD_Size num_promise_completes = 0;
+    for (const ARMD__FlightTraceEvent &trace_event : entries.trace_events) {
+        ASSERT_LT(trace_event.executor_id, num_executors);
+        switch (trace_event.type) {
+        case ARMD__TraceEventType_JobBegin:
+            ++num_job_begins;
+            break;
+        case ARMD__TraceEventType_JobEnd:
+            ++num_job_ends;
+            break;
+        case ARMD__TraceEventType_PromiseComplete:
+            ++num_promise_completes;
+            break;
+        default:
+            break;
+        }
+    }
+    ASSERT_EQ(num_job_begins, 1u);
+    ASSERT_EQ(num_job_ends, 1u);
+    ASSERT_EQ(num_promise_completes, 1u);
+
+    res = armd_procedure_destroy(procedure);
+    ASSERT_EQ(res, 0);
+#else
+    int res = armd_context_enable_flight_recorder(context, flight_recorder);
+    ASSERT_NE(res, 0);
+#endif
+
+    // The executors write to the file until they are stopped
+    res = armd_context_destroy(context);
+    ASSERT_EQ(res, 0);
+    res = armd_flight_recorder_destroy(flight_recorder);
+    ASSERT_EQ(res, 0);
+}
+
+#ifndef ARAMID_DISABLE_TRACING
+
+struct FailingAllocatorContext {
+    bool armed;
+    ARMD_Size num_trace_buffers_left;
+};
+
+void *failing_allocate(void *context, ARMD_Size size) {
+    FailingAllocatorContext *failing_context =
+        reinterpret_cast<FailingAllocatorContext *>(context);
+    if (failing_context->armed && size == sizeof(ARMD__TraceBuffer)) {
+        if (failing_context->num_trace_buffers_left == 0) {
+            return nullptr;
+        }
+        --failing_context->num_trace_buffers_left;
+    }
+    return std::calloc(1, size);
+}
+
+void failing_free(void *context, void *buf) {
+    (void)context;
+    std::free(buf);
+}
+
+TEST_F(FlightRecorderTest, EnableFailure) {
+    const ARMD_Size num_executors = 2;
+    FailingAllocatorContext failing_context = {false, 0};
+    ARMD_MemoryAllocator failing_allocator;
+    failing_allocator.context = &failing_context;
+    failing_allocator.allocate = failing_allocate;
+    failing_allocator.free = failing_free;
+
+    ARMD_Context *context =
+        armd_context_create(&failing_allocator, num_executors);
+    ASSERT_NE(context, nullptr);
+
+    ARMD_FlightRecorder *flight_recorder = armd_flight_recorder_create(
+        &memory_allocator, path.c_str(), num_executors, 1024, 0);
+    ASSERT_NE(flight_recorder, nullptr);
+
+    // The buffer of the first executor is created before the failure
+    failing_context.armed = true;
+    failing_context.num_trace_buffers_left = 1;
+    int res = armd_context_enable_flight_recorder(context, flight_recorder);
+    ASSERT_NE(res, 0);
+    for (ARMD_Size i = 0; i < num_executors; ++i) {
+        ASSERT_EQ(context->executors[i]->trace_buffer_storage, nullptr);
+    }
+
+    // Nothing is left behind to block another attempt
+    failing_context.armed = false;
+    res = armd_context_enable_flight_recorder(context, flight_recorder);
+    ASSERT_EQ(res, 0);
+    res = armd_context_disable_tracing(context);
+    ASSERT_EQ(res, 0);
+
+    res = armd_context_destroy(context);
+    ASSERT_EQ(res, 0);
+    res = armd_flight_recorder_destroy(flight_recorder);
+    ASSERT_EQ(res, 0);
+}
+
+#endif
+
+} // namespace
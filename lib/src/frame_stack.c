@@ -0,0 +1,261 @@
+#include <assert.h>
+#include <string.h>
+
+#include <aramid/aramid.h>
+
+#include "frame_stack.h"
+#include "memory_allocator.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const ARMD_Size frame_stack_alignment = 16;
+
+static ARMD_Size align_size(ARMD_Size size) {
+    return (size + frame_stack_alignment - 1) / frame_stack_alignment *
+           frame_stack_alignment;
+}
+
+static ARMD_Size get_entry_size() {
+    return align_size(sizeof(ARMD__FrameStackEntry));
+}
+
+static ARMD_Size get_chunk_header_size() {
+    return align_size(sizeof(ARMD__FrameStackChunk));
+}
+
+static void mark_freed(ARMD__FrameStackEntry *entry) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&entry->freed, 1, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchange((volatile long *)&entry->freed, 1);
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static ARMD_Bool is_freed(ARMD__FrameStackEntry *entry) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&entry->freed, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return _InterlockedOr((volatile long *)&entry->freed, 0);
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static unsigned char *get_chunk_data(ARMD__FrameStackChunk *chunk) {
+    return ((unsigned char *)chunk) + get_chunk_header_size();
+}
+
+static ARMD__FrameStackChunk *
+create_chunk(const ARMD_MemoryAllocator *memory_allocator,
+             ARMD_Size chunk_size) {
+    ARMD__FrameStackChunk *chunk = armd_memory_allocator_allocate(
+        memory_allocator, get_chunk_header_size() + chunk_size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+
+    chunk->prev = NULL;
+    chunk->next = NULL;
+    chunk->top_entry = NULL;
+    chunk->used = 0;
+    chunk->capacity = chunk_size;
+
+    return chunk;
+}
+
+static void destroy_chunk_chain(const ARMD_MemoryAllocator *memory_allocator,
+                                ARMD__FrameStackChunk *chunk) {
+    while (chunk != NULL) {
+        ARMD__FrameStackChunk *next = chunk->next;
+        armd_memory_allocator_free(memory_allocator, chunk);
+        chunk = next;
+    }
+}
+
+/* Pops freed entries from the top. Only the owner may call this. */
+static void reclaim(ARMD__FrameStack *frame_stack) {
+    ARMD__FrameStackChunk *chunk = frame_stack->current_chunk;
+
+    while (1) {
+        while (chunk->top_entry != NULL && is_freed(chunk->top_entry)) {
+            chunk->used =
+                (ARMD_Size)((unsigned char *)chunk->top_entry -
+                            get_chunk_data(chunk));
+            chunk->top_entry = chunk->top_entry->prev;
+        }
+
+        if (chunk->top_entry != NULL || chunk->prev == NULL) {
+            break;
+        }
+
+        // Keep the emptied chunk as the only spare
+        destroy_chunk_chain(&frame_stack->memory_allocator, chunk->next);
+        chunk->next = NULL;
+        chunk = chunk->prev;
+    }
+
+    frame_stack->current_chunk = chunk;
+}
+
+static void *allocate_on_fallback(ARMD__FrameStack *frame_stack,
+                                  ARMD_Size size, ARMD_Size alignment) {
+    ARMD_Size entry_size = get_entry_size();
+    ARMD_Size prefix_size = armd__align_size(entry_size, alignment);
+
+    unsigned char *buf = armd_memory_region_allocate_aligned(
+        frame_stack->fallback_memory_region, prefix_size + size, alignment);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    unsigned char *body = buf + prefix_size;
+
+    // prev is not needed outside the chunks; it keeps the allocated pointer
+    ARMD__FrameStackEntry *entry = (ARMD__FrameStackEntry *)(body - entry_size);
+    entry->prev = (ARMD__FrameStackEntry *)buf;
+    entry->freed = 0;
+    entry->on_fallback = 1;
+
+    // Frames are expected to be zero-filled wherever they are placed
+    memset(body, 0, size);
+
+    return body;
+}
+
+/* Returns the body position for an allocation at the top of the chunk */
+static unsigned char *get_next_body(ARMD__FrameStackChunk *chunk,
+                                    ARMD_Size alignment) {
+    return armd__align_pointer(get_chunk_data(chunk) + chunk->used +
+                                   get_entry_size(),
+                               alignment);
+}
+
+static ARMD_Bool fits_in_chunk(ARMD__FrameStackChunk *chunk,
+                               ARMD_Size body_size, ARMD_Size alignment) {
+    unsigned char *end = get_next_body(chunk, alignment) + body_size;
+    return end <= get_chunk_data(chunk) + chunk->capacity;
+}
+
+int armd__frame_stack_init(ARMD__FrameStack *frame_stack,
+                           const ARMD_MemoryAllocator *memory_allocator,
+                           ARMD_MemoryRegion *fallback_memory_region,
+                           ARMD_Size chunk_size) {
+    assert(frame_stack != NULL);
+    assert(memory_allocator != NULL);
+    assert(fallback_memory_region != NULL);
+
+    if (chunk_size == 0) {
+        return -1;
+    }
+
+    frame_stack->memory_allocator = *memory_allocator;
+    frame_stack->fallback_memory_region = fallback_memory_region;
+    frame_stack->chunk_size = align_size(chunk_size);
+    frame_stack->current_chunk =
+        create_chunk(memory_allocator, frame_stack->chunk_size);
+    if (frame_stack->current_chunk == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+ARMD_Size armd__frame_stack_deinit(ARMD__FrameStack *frame_stack) {
+    assert(frame_stack != NULL);
+
+    ARMD_Size non_freed_count = 0;
+
+    ARMD__FrameStackChunk *chunk = frame_stack->current_chunk;
+    while (chunk->prev != NULL) {
+        chunk = chunk->prev;
+    }
+
+    for (ARMD__FrameStackChunk *c = chunk; c != NULL; c = c->next) {
+        for (ARMD__FrameStackEntry *entry = c->top_entry; entry != NULL;
+             entry = entry->prev) {
+            if (!is_freed(entry)) {
+                ++non_freed_count;
+            }
+        }
+    }
+
+    destroy_chunk_chain(&frame_stack->memory_allocator, chunk);
+    frame_stack->current_chunk = NULL;
+
+    return non_freed_count;
+}
+
+void *armd__frame_stack_allocate(ARMD__FrameStack *frame_stack,
+                                 ARMD_Size size, ARMD_Size alignment) {
+    assert(frame_stack != NULL);
+    assert(armd__is_valid_alignment(alignment));
+
+    if (alignment < frame_stack_alignment) {
+        alignment = frame_stack_alignment;
+    }
+
+    ARMD_Size body_size = align_size(size == 0 ? 1 : size);
+    ARMD_Size worst_size = get_entry_size() + body_size + alignment - 1;
+
+    if (worst_size > frame_stack->chunk_size / 4) {
+        return allocate_on_fallback(frame_stack, body_size, alignment);
+    }
+
+    reclaim(frame_stack);
+
+    ARMD__FrameStackChunk *chunk = frame_stack->current_chunk;
+    if (!fits_in_chunk(chunk, body_size, alignment)) {
+        if (chunk->next != NULL) {
+            chunk = chunk->next;
+        } else {
+            ARMD__FrameStackChunk *new_chunk = create_chunk(
+                &frame_stack->memory_allocator, frame_stack->chunk_size);
+            if (new_chunk == NULL) {
+                return NULL;
+            }
+
+            new_chunk->prev = chunk;
+            chunk->next = new_chunk;
+            chunk = new_chunk;
+        }
+        assert(chunk->used == 0);
+        frame_stack->current_chunk = chunk;
+    }
+
+    unsigned char *body = get_next_body(chunk, alignment);
+    ARMD__FrameStackEntry *entry =
+        (ARMD__FrameStackEntry *)(body - get_entry_size());
+    entry->prev = chunk->top_entry;
+    entry->freed = 0;
+    entry->on_fallback = 0;
+
+    chunk->top_entry = entry;
+    chunk->used = (ARMD_Size)(body + body_size - get_chunk_data(chunk));
+
+    memset(body, 0, body_size);
+
+    return body;
+}
+
+void armd__frame_stack_free(ARMD__FrameStack *frame_stack, void *buf) {
+    assert(frame_stack != NULL);
+
+    if (buf == NULL) {
+        return;
+    }
+
+    ARMD__FrameStackEntry *entry =
+        (ARMD__FrameStackEntry *)(((unsigned char *)buf) - get_entry_size());
+
+    if (entry->on_fallback) {
+        armd_memory_region_free(frame_stack->fallback_memory_region,
+                                entry->prev);
+        return;
+    }
+
+    mark_freed(entry);
+}
@@ -0,0 +1,48 @@
+#ifndef ARAMID__FRAME_STACK_H
+#define ARAMID__FRAME_STACK_H
+
+#include <aramid/aramid.h>
+
+#include "memory_allocator.h"
+
+typedef struct TAG_ARMD__FrameStackEntry {
+    struct TAG_ARMD__FrameStackEntry *prev;
+    volatile ARMD_Bool freed;
+    ARMD_Bool on_fallback;
+} ARMD__FrameStackEntry;
+
+typedef struct TAG_ARMD__FrameStackChunk {
+    struct TAG_ARMD__FrameStackChunk *prev;
+    struct TAG_ARMD__FrameStackChunk *next;
+    ARMD__FrameStackEntry *top_entry;
+    ARMD_Size used;
+    ARMD_Size capacity;
+} ARMD__FrameStackChunk;
+
+/*
+ * Segmented LIFO allocator owned by a single executor. Only the owner
+ * allocates; frees may come from any thread and are reclaimed lazily by the
+ * owner once everything above them is gone. Oversized requests go to the
+ * fallback region.
+ */
+typedef struct TAG_ARMD__FrameStack {
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_MemoryRegion *fallback_memory_region;
+    ARMD_Size chunk_size;
+    ARMD__FrameStackChunk *current_chunk;
+} ARMD__FrameStack;
+
+ARMD_EXTERN_C int
+armd__frame_stack_init(ARMD__FrameStack *frame_stack,
+                       const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD_MemoryRegion *fallback_memory_region,
+                       ARMD_Size chunk_size);
+ARMD_EXTERN_C ARMD_Size armd__frame_stack_deinit(ARMD__FrameStack *frame_stack);
+
+ARMD_EXTERN_C void *armd__frame_stack_allocate(ARMD__FrameStack *frame_stack,
+                                               ARMD_Size size,
+                                               ARMD_Size alignment);
+ARMD_EXTERN_C void armd__frame_stack_free(ARMD__FrameStack *frame_stack,
+                                          void *buf);
+
+#endif // ARAMID__FRAME_STACK_H
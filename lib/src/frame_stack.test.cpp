@@ -0,0 +1,200 @@
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "memory_region.h"
+
+// Frame stacks pass every allocation through to the allocator when memory
+// region feature is disabled
+#ifndef ARAMID_DISABLE_MEMORY_REGION
+
+namespace {
+
+class FrameStackTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_MemoryRegion *fallback_memory_region;
+    ARMD_MemoryRegion *memory_region;
+
+    FrameStackTest() {}
+
+    ~FrameStackTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        fallback_memory_region = armd_memory_region_create(&memory_allocator);
+        memory_region = armd__memory_region_create_frame_stack(
+            &memory_allocator, fallback_memory_region, 1024);
+    }
+
+    void TearDown() override {
+        armd_memory_region_destroy(memory_region);
+        armd_memory_region_destroy(fallback_memory_region);
+    }
+};
+
+TEST_F(FrameStackTest, AllocateAndFreeInLifoOrder) {
+    unsigned char *a = static_cast<unsigned char *>(
+        armd_memory_region_allocate(memory_region, 24));
+    ASSERT_NE(a, nullptr);
+    unsigned char *b = static_cast<unsigned char *>(
+        armd_memory_region_allocate(memory_region, 24));
+    ASSERT_NE(b, nullptr);
+    ASSERT_GT(b, a);
+
+    for (int i = 0; i < 24; i++) {
+        ASSERT_EQ(a[i], 0);
+        ASSERT_EQ(b[i], 0);
+        a[i] = 0xff;
+        b[i] = 0xff;
+    }
+
+    armd_memory_region_free(memory_region, b);
+    armd_memory_region_free(memory_region, a);
+
+    // Freed entries are reused and cleared
+    unsigned char *c = static_cast<unsigned char *>(
+        armd_memory_region_allocate(memory_region, 24));
+    ASSERT_EQ(c, a);
+    for (int i = 0; i < 24; i++) {
+        ASSERT_EQ(c[i], 0);
+    }
+    armd_memory_region_free(memory_region, c);
+}
+
+TEST_F(FrameStackTest, FreeOutOfOrder) {
+    void *a = armd_memory_region_allocate(memory_region, 16);
+    void *b = armd_memory_region_allocate(memory_region, 16);
+    void *c = armd_memory_region_allocate(memory_region, 16);
+
+    armd_memory_region_free(memory_region, a);
+    armd_memory_region_free(memory_region, c);
+
+    // b still pins the stack, so c is reclaimed but a is not
+    void *d = armd_memory_region_allocate(memory_region, 16);
+    ASSERT_EQ(d, c);
+
+    armd_memory_region_free(memory_region, b);
+    armd_memory_region_free(memory_region, d);
+
+    void *e = armd_memory_region_allocate(memory_region, 16);
+    ASSERT_EQ(e, a);
+    armd_memory_region_free(memory_region, e);
+}
+
+TEST_F(FrameStackTest, GrowAcrossChunks) {
+    const int num_allocations = 256;
+    void *bufs[num_allocations];
+
+    for (int i = 0; i < num_allocations; i++) {
+        bufs[i] = armd_memory_region_allocate(memory_region, 32);
+        ASSERT_NE(bufs[i], nullptr);
+    }
+
+    for (int i = num_allocations - 1; i >= 0; i--) {
+        armd_memory_region_free(memory_region, bufs[i]);
+    }
+
+    void *buf = armd_memory_region_allocate(memory_region, 32);
+    ASSERT_EQ(buf, bufs[0]);
+    armd_memory_region_free(memory_region, buf);
+}
+
+TEST_F(FrameStackTest, FallbackForLargeAllocation) {
+    void *small = armd_memory_region_allocate(memory_region, 16);
+    void *large = armd_memory_region_allocate(memory_region, 4096);
+    ASSERT_NE(large, nullptr);
+
+    armd_memory_region_free(memory_region, large);
+    armd_memory_region_free(memory_region, small);
+}
+
+TEST_F(FrameStackTest, AllocateAligned) {
+    void *a = armd_memory_region_allocate(memory_region, 8);
+    void *b = armd_memory_region_allocate_aligned(memory_region, 24, 64);
+    void *c = armd_memory_region_allocate_aligned(memory_region, 100, 128);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(b) % 64, 0u);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(c) % 128, 0u);
+
+    // Too large alignment for the chunk goes to the fallback region
+    void *d = armd_memory_region_allocate_aligned(memory_region, 16, 512);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(d) % 512, 0u);
+
+    armd_memory_region_free(memory_region, d);
+    armd_memory_region_free(memory_region, c);
+    armd_memory_region_free(memory_region, b);
+
+    // Space after a is reclaimed including the padding
+    void *e = armd_memory_region_allocate_aligned(memory_region, 24, 64);
+    ASSERT_EQ(e, b);
+
+    armd_memory_region_free(memory_region, e);
+    armd_memory_region_free(memory_region, a);
+}
+
+TEST_F(FrameStackTest, FreeFromAnotherThread) {
+    void *a = armd_memory_region_allocate(memory_region, 16);
+    void *b = armd_memory_region_allocate(memory_region, 16);
+
+    std::thread th([this, a, b] {
+        armd_memory_region_free(memory_region, b);
+        armd_memory_region_free(memory_region, a);
+    });
+    th.join();
+
+    void *c = armd_memory_region_allocate(memory_region, 16);
+    ASSERT_EQ(c, a);
+    armd_memory_region_free(memory_region, c);
+}
+
+TEST(FrameStackCreationTest, ClearFallbackAllocation) {
+    // The pooled allocator hands out freed memory as it is
+    ARMD_MemoryAllocator memory_allocator;
+    int res = armd_memory_allocator_init_pooled(&memory_allocator, 0);
+    ASSERT_EQ(res, 0);
+    ARMD_MemoryRegion *fallback_memory_region =
+        armd_memory_region_create(&memory_allocator);
+    ARMD_MemoryRegion *memory_region = armd__memory_region_create_frame_stack(
+        &memory_allocator, fallback_memory_region, 1024);
+
+    for (int i = 0; i < 4; i++) {
+        unsigned char *large = static_cast<unsigned char *>(
+            armd_memory_region_allocate(memory_region, 4096));
+        ASSERT_NE(large, nullptr);
+        for (int j = 0; j < 4096; j++) {
+            ASSERT_EQ(large[j], 0);
+        }
+        memset(large, 0xff, 4096);
+        armd_memory_region_free(memory_region, large);
+    }
+
+    armd_memory_region_destroy(memory_region);
+    armd_memory_region_destroy(fallback_memory_region);
+    armd_memory_allocator_deinit_pooled(&memory_allocator);
+}
+
+TEST(FrameStackCreationTest, DestroyCountsLiveEntries) {
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+    ARMD_MemoryRegion *fallback_memory_region =
+        armd_memory_region_create(&memory_allocator);
+    ARMD_MemoryRegion *memory_region = armd__memory_region_create_frame_stack(
+        &memory_allocator, fallback_memory_region, 1024);
+
+    void *a = armd_memory_region_allocate(memory_region, 16);
+    armd_memory_region_allocate(memory_region, 16);
+    armd_memory_region_free(memory_region, a);
+
+    ARMD_Size non_freed_count = armd_memory_region_destroy(memory_region);
+    armd_memory_region_destroy(fallback_memory_region);
+
+    ASSERT_EQ(non_freed_count, 1u);
+}
+
+} // namespace
+
+#endif
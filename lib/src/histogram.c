@@ -0,0 +1,129 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const ARMD_Size sub_bucket_bits = 3;
+static const ARMD_Size num_sub_buckets = 8;
+
+static ARMD_Size get_highest_bit(uint64_t value) {
+    assert(value != 0);
+
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - (ARMD_Size)__builtin_clzll(value);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+#error Bit operation implementation is not specified
+#endif
+}
+
+ARMD_Size armd_histogram_get_bucket_index(uint64_t value) {
+    if (value < num_sub_buckets) {
+        return (ARMD_Size)value;
+    }
+
+    ARMD_Size highest_bit = get_highest_bit(value);
+    ARMD_Size sub_bucket =
+        (ARMD_Size)(value >> (highest_bit - sub_bucket_bits)) - num_sub_buckets;
+    ARMD_Size index =
+        (highest_bit - sub_bucket_bits + 1) * num_sub_buckets + sub_bucket;
+
+    if (index >= ARMD_HISTOGRAM_NUM_BUCKETS) {
+        return ARMD_HISTOGRAM_NUM_BUCKETS - 1;
+    }
+
+    return index;
+}
+
+uint64_t armd_histogram_get_bucket_lower_bound(ARMD_Size index) {
+    assert(index < ARMD_HISTOGRAM_NUM_BUCKETS);
+
+    if (index < num_sub_buckets) {
+        return index;
+    }
+
+    ARMD_Size shift = index / num_sub_buckets - 1;
+    ARMD_Size sub_bucket = index % num_sub_buckets;
+    return ((uint64_t)(num_sub_buckets + sub_bucket)) << shift;
+}
+
+void armd_histogram_init(ARMD_Histogram *histogram) {
+    assert(histogram != NULL);
+
+    histogram->count = 0;
+    histogram->sum = 0;
+    histogram->max = 0;
+    for (ARMD_Size i = 0; i < ARMD_HISTOGRAM_NUM_BUCKETS; ++i) {
+        histogram->buckets[i] = 0;
+    }
+}
+
+void armd_histogram_record(ARMD_Histogram *histogram, uint64_t value) {
+    assert(histogram != NULL);
+
+    ++histogram->count;
+    histogram->sum += value;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+    ++histogram->buckets[armd_histogram_get_bucket_index(value)];
+}
+
+void armd_histogram_merge(ARMD_Histogram *histogram,
+                          const ARMD_Histogram *other) {
+    assert(histogram != NULL);
+    assert(other != NULL);
+
+    histogram->count += other->count;
+    histogram->sum += other->sum;
+    if (other->max > histogram->max) {
+        histogram->max = other->max;
+    }
+    for (ARMD_Size i = 0; i < ARMD_HISTOGRAM_NUM_BUCKETS; ++i) {
+        histogram->buckets[i] += other->buckets[i];
+    }
+}
+
+uint64_t armd_histogram_get_percentile(const ARMD_Histogram *histogram,
+                                       ARMD_Real percentile) {
+    assert(histogram != NULL);
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    uint64_t rank =
+        (uint64_t)(percentile / 100.0 * (ARMD_Real)histogram->count);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t accumulated = 0;
+    for (ARMD_Size i = 0; i < ARMD_HISTOGRAM_NUM_BUCKETS; ++i) {
+        accumulated += histogram->buckets[i];
+        if (accumulated >= rank) {
+            if (i + 1 == ARMD_HISTOGRAM_NUM_BUCKETS) {
+                return histogram->max;
+            }
+
+            // The highest value in the bucket
+            uint64_t upper_bound =
+                armd_histogram_get_bucket_lower_bound(i + 1) - 1;
+            return upper_bound < histogram->max ? upper_bound : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
@@ -8,6 +8,9 @@
 #include "job_awaiter.h"
 #include "memory_region.h"
 #include "procedure.h"
+#include "profiler.h"
+#include "promise.h"
+#include "span_analysis.h"
 
 ARMD_Job *armd__job_create(ARMD_MemoryRegion *memory_region,
                            ARMD__Executor *executor,
@@ -21,7 +24,6 @@ ARMD_Job *armd__job_create(ARMD_MemoryRegion *memory_region,
     int res = 0;
     (void)res;
     int job_initialized = 0;
-    int frame_initialized = 0;
     int spinlock_initialized = 0;
     ARMD_Job *job;
 
@@ -34,10 +36,11 @@ ARMD_Job *armd__job_create(ARMD_MemoryRegion *memory_region,
     job->memory_region = memory_region;
     job->procedure = procedure;
     job->awaiter = *awaiter;
+    job->frame_memory_region = NULL;
     job->frame = NULL;
-    frame_initialized = 1;
     job->args = args;
     job->continuation_index = 0;
+    job->continuation_frame_memory_region = NULL;
     job->continuation_frame = NULL;
     job->executor = executor;
     if (armd__spinlock_init(&job->lock)) {
@@ -45,6 +48,14 @@ ARMD_Job *armd__job_create(ARMD_MemoryRegion *memory_region,
     }
     job->setup_executed = 0;
     job->dependency_has_error = 0;
+    job->num_dependency_results = 0;
+    job->dependency_results = NULL;
+    job->result = NULL;
+    job->ready_timestamp = 0;
+    job->span_analyzed = 0;
+    armd__span_point_init(&job->span_point);
+    armd__span_point_init(&job->children_span_point);
+    job->strand_timestamp = 0;
     spinlock_initialized = 1; // NOLINT(clang-analyzer-deadcode.DeadStores)
 
     return job;
@@ -55,10 +66,6 @@ ARMD_Job *armd__job_create(ARMD_MemoryRegion *memory_region,
         assert(res == 0);
     }
 
-    if (frame_initialized) {
-        armd_memory_region_free(memory_region, job->frame);
-    }
-
     if (job_initialized) {
         armd_memory_region_free(memory_region, job);
     }
@@ -78,8 +85,10 @@ int armd__job_destroy(ARMD_Job *job) {
     // args are owned by owner
     job->args = NULL;
 
-    armd_memory_region_free(job->memory_region, job->frame);
-    job->frame = NULL;
+    if (job->frame != NULL) {
+        armd_memory_region_free(job->frame_memory_region, job->frame);
+        job->frame = NULL;
+    }
 
     armd_memory_region_free(job->memory_region, job);
 
@@ -92,15 +101,53 @@ ARMD_Size armd_job_get_num_executors(ARMD_Job *job) {
 
 ARMD_Size armd_job_get_executor_id(ARMD_Job *job) { return job->executor->id; }
 
+void *armd_job_get_result(ARMD_Job *job) { return job->result; }
+
+const void *armd_job_get_dependency_result(ARMD_Job *job, ARMD_Size index) {
+    if (index >= job->num_dependency_results) {
+        return NULL;
+    }
+
+    // The dependency has ended before the job got ready
+    const ARMD__Promise *promise = job->dependency_results[index].promise;
+    if (promise == NULL || promise->status != ARMD__PromiseStatus_Success) {
+        return NULL;
+    }
+
+    return promise->result;
+}
+
+void armd__job_fork_span_point(ARMD_Job *job, const ARMD_Job *parent_job) {
+    if (!parent_job->span_analyzed) {
+        return;
+    }
+
+    // The child starts at the fork point in the middle of the parent strand
+    job->span_point = parent_job->span_point;
+    armd__span_point_advance(
+        &job->span_point,
+        armd_timestamp_to_nanoseconds(armd_get_timestamp() -
+                                      parent_job->strand_timestamp));
+}
+
+void armd__job_mark_ready(ARMD_Job *job) {
+    ARMD_Context *context = job->executor->context;
+    job->span_analyzed = context->span_analysis;
+    if (context->profiling || job->span_analyzed) {
+        job->ready_timestamp = armd_get_timestamp();
+    }
+}
+
 void armd__job_cleanup_continuation_frame(ARMD_Job *job) {
     assert(job->continuation_frame != NULL);
 
     ARMD__Continuation *continuation =
         &job->procedure->continuations[job->continuation_index];
 
-    continuation->continuation_frame_destroyer(job->memory_region,
-                                               job->continuation_frame);
+    continuation->continuation_frame_destroyer(
+        job->continuation_frame_memory_region, job->continuation_frame);
     job->continuation_frame = NULL;
+    job->continuation_frame_memory_region = NULL;
 }
 
 void armd__job_increment_continuation_index(ARMD_Job *job) {
@@ -127,6 +174,11 @@ ARMD_Bool armd__job_notify_to_parent_and_steal(ARMD_Job *job,
         parent_job->has_error = 1;
     }
 
+    if (job->span_analyzed) {
+        armd__span_point_join(&parent_job->children_span_point,
+                              &job->span_point);
+    }
+
     ARMD_Bool parent_enabled =
         parent_finished && num_ended_waiting_jobs >= num_all_waiting_jobs;
     if (parent_enabled) {
@@ -143,17 +195,37 @@ ARMD_Bool armd__job_notify_to_parent_and_steal(ARMD_Job *job,
 }
 
 ARMD_Bool armd__job_execute_setup(ARMD_Job *job, ARMD__Executor *executor) {
-    (void)executor;
-
     assert(!job->setup_executed);
     assert(job->continuation_index == 0);
     assert(job->frame == NULL);
 
     const ARMD_Procedure *procedure = job->procedure;
 
-    job->frame = armd_memory_region_allocate(
-        job->memory_region,
-        procedure->frame_size == 0 ? 1 : procedure->frame_size);
+    ARMD__Profiler *profiler = executor->profiler;
+    uint64_t begin_timestamp =
+        profiler != NULL || job->span_analyzed ? armd_get_timestamp() : 0;
+    ARMD_Bool has_queueing_delay = job->ready_timestamp != 0;
+    uint64_t queueing_delay =
+        has_queueing_delay ? armd_timestamp_to_nanoseconds(
+                                 begin_timestamp - job->ready_timestamp)
+                           : 0;
+
+    if (profiler != NULL) {
+        armd__profiler_record_invocation(profiler, procedure,
+                                         has_queueing_delay, queueing_delay);
+    }
+
+    if (job->span_analyzed) {
+        armd__span_point_add_burden(&job->span_point, queueing_delay);
+    }
+
+    // Frames are mostly released in LIFO order, so they live on the stack of
+    // the executor which runs the setup
+    job->frame_memory_region = executor->frame_memory_region;
+    job->frame = armd_memory_region_allocate_aligned(
+        job->frame_memory_region,
+        procedure->frame_size == 0 ? 1 : procedure->frame_size,
+        procedure->alignment);
     if (job->frame == NULL) {
         job->has_error = 1;
         return 1;
@@ -161,9 +233,23 @@ ARMD_Bool armd__job_execute_setup(ARMD_Job *job, ARMD__Executor *executor) {
 
     ARMD_Bool setup_result;
     if (procedure->setup_func != NULL) {
+        uint64_t setup_timestamp =
+            job->span_analyzed ? armd_get_timestamp() : 0;
+
+        ARMD__TRACE(executor, ARMD__TraceEventType_JobBegin,
+                    (uintptr_t)procedure);
         setup_result =
             procedure->setup_func(job, procedure->constants, job->args,
                                   job->frame, job->dependency_has_error);
+        ARMD__TRACE(executor, ARMD__TraceEventType_JobEnd,
+                    (uintptr_t)procedure);
+
+        if (job->span_analyzed) {
+            uint64_t elapsed = armd_timestamp_to_nanoseconds(
+                armd_get_timestamp() - setup_timestamp);
+            armd__span_point_advance(&job->span_point, elapsed);
+            armd__span_analysis_record_strand(executor, elapsed);
+        }
     } else {
         setup_result = job->dependency_has_error;
     }
@@ -179,8 +265,6 @@ ARMD_Bool armd__job_execute_setup(ARMD_Job *job, ARMD__Executor *executor) {
 
 ARMD__JobExecuteStepStatus armd__job_execute_step(ARMD_Job *job,
                                                   ARMD__Executor *executor) {
-    (void)executor;
-
     int res = 0;
     (void)res;
 
@@ -189,6 +273,12 @@ ARMD__JobExecuteStepStatus armd__job_execute_step(ARMD_Job *job,
     assert(job->num_all_waiting_jobs <=
            job->num_ended_waiting_jobs); // Other jobs are already ended
 
+    if (job->span_analyzed) {
+        // The children forked in the previous step have joined
+        armd__span_point_join(&job->span_point, &job->children_span_point);
+        armd__span_point_init(&job->children_span_point);
+    }
+
     if (job->continuation_index == job->procedure->num_continuations) {
         return ARMD__JobExecuteStepStatus_Ended;
     }
@@ -202,14 +292,48 @@ ARMD__JobExecuteStepStatus armd__job_execute_step(ARMD_Job *job,
         &job->procedure->continuations[job->continuation_index];
 
     if (job->continuation_frame == NULL) {
-        job->continuation_frame =
-            continuation->continuation_frame_creator(job->memory_region);
+        job->continuation_frame_memory_region = executor->frame_memory_region;
+        job->continuation_frame = continuation->continuation_frame_creator(
+            job->continuation_frame_memory_region);
         assert(job->continuation_frame != NULL);
     }
 
+    ARMD__Profiler *profiler = executor->profiler;
+    uint64_t perf_counter_values[ARMD__PerfCounterType_Count];
+    ARMD_Bool perf_counting =
+        profiler != NULL && executor->context->perf_counting &&
+        armd__profiler_read_perf_counters(profiler, perf_counter_values);
+    uint64_t begin_timestamp =
+        profiler != NULL || job->span_analyzed ? armd_get_timestamp() : 0;
+    job->strand_timestamp = begin_timestamp;
+
+    ARMD__TRACE(executor, ARMD__TraceEventType_JobBegin,
+                (uintptr_t)job->procedure);
     ARMD_ContinuationResult result = continuation->continuation_func(
         job, job->procedure->constants, job->args, job->frame,
         continuation->continuation_constants, job->continuation_frame);
+    ARMD__TRACE(executor, ARMD__TraceEventType_JobEnd,
+                (uintptr_t)job->procedure);
+
+    if (profiler != NULL || job->span_analyzed) {
+        uint64_t elapsed = armd_timestamp_to_nanoseconds(armd_get_timestamp() -
+                                                         begin_timestamp);
+
+        if (profiler != NULL) {
+            armd__profiler_record_execution(profiler, job->procedure,
+                                            job->continuation_index, elapsed);
+        }
+
+        if (job->span_analyzed) {
+            armd__span_point_advance(&job->span_point, elapsed);
+            armd__span_analysis_record_strand(executor, elapsed);
+        }
+    }
+
+    if (perf_counting) {
+        armd__profiler_record_perf_counters(profiler, job->procedure,
+                                            perf_counter_values);
+    }
 
     res = armd__spinlock_lock(&job->lock);
     assert(res == 0);
@@ -6,9 +6,20 @@
 #include "job_awaiter.h"
 #include "memory_region.h"
 #include "procedure.h"
+#include "span_analysis.h"
 #include "spinlock.h"
 #include "types.h"
 
+/*
+ * A dependency whose result the job may read. The job holds a reference to
+ * the promise until it ends. promise is NULL for the dependencies without a
+ * result.
+ */
+typedef struct TAG_ARMD__DependencyResult {
+    ARMD_Handle handle;
+    struct TAG_ARMD__Promise *promise;
+} ARMD__DependencyResult;
+
 struct TAG_ARMD_Job {
     ARMD_MemoryRegion *memory_region;
     // procedure
@@ -16,10 +27,12 @@ struct TAG_ARMD_Job {
     // awaiter
     ARMD__JobAwaiter awaiter;
     // frame & args
+    ARMD_MemoryRegion *frame_memory_region;
     void *frame;
     void *args;
     // continuation
     ARMD_Size continuation_index;
+    ARMD_MemoryRegion *continuation_frame_memory_region;
     void *continuation_frame;
     // waiting for child jobs
     ARMD__Spinlock lock;
@@ -34,6 +47,17 @@ struct TAG_ARMD_Job {
     ARMD_Bool setup_executed;
     // dependency promise
     ARMD_Bool dependency_has_error;
+    ARMD_Size num_dependency_results;
+    ARMD__DependencyResult *dependency_results;
+    // result, owned by the promise, NULL for forked jobs
+    void *result;
+    // profiling, 0 if the job got ready while neither profiling nor analyzing
+    uint64_t ready_timestamp;
+    // span analysis, span_point is at the beginning of the current strand
+    ARMD_Bool span_analyzed;
+    ARMD__SpanPoint span_point;
+    ARMD__SpanPoint children_span_point;
+    uint64_t strand_timestamp;
 };
 
 typedef enum TAG_ARMD__JobExecuteStepStatus {
@@ -50,6 +74,9 @@ ARMD_EXTERN_C ARMD_Job *armd__job_create(ARMD_MemoryRegion *memory_region,
                                          void *args);
 ARMD_EXTERN_C int armd__job_destroy(ARMD_Job *job);
 
+ARMD_EXTERN_C void armd__job_fork_span_point(ARMD_Job *job,
+                                             const ARMD_Job *parent_job);
+ARMD_EXTERN_C void armd__job_mark_ready(ARMD_Job *job);
 ARMD_EXTERN_C void armd__job_cleanup_continuation_frame(ARMD_Job *job);
 ARMD_EXTERN_C void armd__job_increment_continuation_index(ARMD_Job *job);
 ARMD_EXTERN_C ARMD_Bool armd__job_notify_to_parent_and_steal(
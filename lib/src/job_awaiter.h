@@ -6,6 +6,7 @@
 typedef enum TAG_ARMD__JobAwaiterType {
     JobAwaiterType_Promise,
     JobAwaiterType_ParentJob,
+    JobAwaiterType_TaskGroup,
 } ARMD__JobAwaiterType;
 
 typedef struct TAG_ARMD__JobAwaiter {
@@ -17,6 +18,9 @@ typedef struct TAG_ARMD__JobAwaiter {
         struct {
             ARMD_Job *parent_job;
         } parent_job;
+        struct {
+            ARMD_TaskGroup *task_group;
+        } task_group;
     } body;
 } ARMD__JobAwaiter;
 
@@ -0,0 +1,547 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <aramid/aramid.h>
+
+#include "log_args.h"
+
+typedef enum TAG_ARMD__LogArgType {
+    ARMD__LogArgType_Int,
+    ARMD__LogArgType_UnsignedInt,
+    ARMD__LogArgType_Long,
+    ARMD__LogArgType_UnsignedLong,
+    ARMD__LogArgType_LongLong,
+    ARMD__LogArgType_UnsignedLongLong,
+    ARMD__LogArgType_IntMax,
+    ARMD__LogArgType_UIntMax,
+    ARMD__LogArgType_Size,
+    ARMD__LogArgType_PtrDiff,
+    ARMD__LogArgType_Double,
+    ARMD__LogArgType_LongDouble,
+    ARMD__LogArgType_Pointer,
+    ARMD__LogArgType_String,
+    // %n, which takes an argument but prints nothing
+    ARMD__LogArgType_Count,
+    // %%, which takes no argument
+    ARMD__LogArgType_Percent,
+} ARMD__LogArgType;
+
+typedef enum TAG_ARMD__LogArgLength {
+    ARMD__LogArgLength_None,
+    ARMD__LogArgLength_Char,
+    ARMD__LogArgLength_Short,
+    ARMD__LogArgLength_Long,
+    ARMD__LogArgLength_LongLong,
+    ARMD__LogArgLength_IntMax,
+    ARMD__LogArgLength_Size,
+    ARMD__LogArgLength_PtrDiff,
+    ARMD__LogArgLength_LongDouble,
+} ARMD__LogArgLength;
+
+typedef struct TAG_ARMD__LogArgSpec {
+    // The conversion specification to pass to snprintf
+    char text[32];
+    ARMD__LogArgType type;
+    // The number of '*' in the width and the precision
+    int num_stars;
+    ARMD_Bool precision_is_star;
+    // Negative if the precision is not given in digits
+    int precision;
+} ARMD__LogArgSpec;
+
+static ARMD_Bool is_flag(char c) {
+    return c == '-' || c == '+' || c == ' ' || c == '#' || c == '0';
+}
+
+static ARMD_Bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+static ARMD__LogArgLength parse_length(const char **cursor) {
+    const char *p = *cursor;
+    ARMD__LogArgLength length = ARMD__LogArgLength_None;
+
+    switch (*p) {
+    case 'h':
+        if (p[1] == 'h') {
+            ++p;
+            length = ARMD__LogArgLength_Char;
+        } else {
+            length = ARMD__LogArgLength_Short;
+        }
+        break;
+    case 'l':
+        if (p[1] == 'l') {
+            ++p;
+            length = ARMD__LogArgLength_LongLong;
+        } else {
+            length = ARMD__LogArgLength_Long;
+        }
+        break;
+    case 'j':
+        length = ARMD__LogArgLength_IntMax;
+        break;
+    case 'z':
+        length = ARMD__LogArgLength_Size;
+        break;
+    case 't':
+        length = ARMD__LogArgLength_PtrDiff;
+        break;
+    case 'L':
+        length = ARMD__LogArgLength_LongDouble;
+        break;
+    default:
+        return ARMD__LogArgLength_None;
+    }
+
+    *cursor = p + 1;
+    return length;
+}
+
+static int get_integer_type(ARMD__LogArgLength length, ARMD_Bool is_signed,
+                            ARMD__LogArgType *type) {
+    switch (length) {
+    case ARMD__LogArgLength_None:
+    case ARMD__LogArgLength_Char:
+    case ARMD__LogArgLength_Short:
+        // Promoted to int when passed
+        *type =
+            is_signed ? ARMD__LogArgType_Int : ARMD__LogArgType_UnsignedInt;
+        return 0;
+    case ARMD__LogArgLength_Long:
+        *type =
+            is_signed ? ARMD__LogArgType_Long : ARMD__LogArgType_UnsignedLong;
+        return 0;
+    case ARMD__LogArgLength_LongLong:
+        *type = is_signed ? ARMD__LogArgType_LongLong
+                          : ARMD__LogArgType_UnsignedLongLong;
+        return 0;
+    case ARMD__LogArgLength_IntMax:
+        *type = is_signed ? ARMD__LogArgType_IntMax : ARMD__LogArgType_UIntMax;
+        return 0;
+    case ARMD__LogArgLength_Size:
+        *type = ARMD__LogArgType_Size;
+        return 0;
+    case ARMD__LogArgLength_PtrDiff:
+        *type = ARMD__LogArgType_PtrDiff;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+/* format points to '%'. Returns the end of the spec or NULL if unsupported. */
+static const char *parse_spec(const char *format, ARMD__LogArgSpec *spec) {
+    const char *p = format + 1;
+
+    spec->num_stars = 0;
+    spec->precision_is_star = 0;
+    spec->precision = -1;
+
+    if (*p == '%') {
+        spec->type = ARMD__LogArgType_Percent;
+        return p + 1;
+    }
+
+    while (is_flag(*p)) {
+        ++p;
+    }
+
+    if (*p == '*') {
+        ++spec->num_stars;
+        ++p;
+    } else {
+        while (is_digit(*p)) {
+            ++p;
+        }
+    }
+
+    if (*p == '.') {
+        ++p;
+        if (*p == '*') {
+            ++spec->num_stars;
+            spec->precision_is_star = 1;
+            ++p;
+        } else {
+            spec->precision = 0;
+            while (is_digit(*p)) {
+                if (spec->precision < 100000000) {
+                    spec->precision = spec->precision * 10 + (*p - '0');
+                }
+                ++p;
+            }
+        }
+    }
+
+    ARMD__LogArgLength length = parse_length(&p);
+
+    switch (*p) {
+    case 'd':
+    case 'i':
+        if (get_integer_type(length, 1, &spec->type)) {
+            return NULL;
+        }
+        break;
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        if (get_integer_type(length, 0, &spec->type)) {
+            return NULL;
+        }
+        break;
+    case 'c':
+        if (length != ARMD__LogArgLength_None) {
+            return NULL;
+        }
+        spec->type = ARMD__LogArgType_Int;
+        break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (length == ARMD__LogArgLength_None ||
+            length == ARMD__LogArgLength_Long) {
+            spec->type = ARMD__LogArgType_Double;
+        } else if (length == ARMD__LogArgLength_LongDouble) {
+            spec->type = ARMD__LogArgType_LongDouble;
+        } else {
+            return NULL;
+        }
+        break;
+    case 's':
+        if (length != ARMD__LogArgLength_None) {
+            return NULL;
+        }
+        spec->type = ARMD__LogArgType_String;
+        break;
+    case 'p':
+        spec->type = ARMD__LogArgType_Pointer;
+        break;
+    case 'n':
+        spec->type = ARMD__LogArgType_Count;
+        break;
+    default:
+        // Including positional arguments and the end of the string
+        return NULL;
+    }
+    ++p;
+
+    ARMD_Size spec_length = (ARMD_Size)(p - format);
+    if (spec_length >= sizeof(spec->text)) {
+        return NULL;
+    }
+    memcpy(spec->text, format, spec_length);
+    spec->text[spec_length] = '\0';
+
+    return p;
+}
+
+static int write_bytes(unsigned char *payload, ARMD_Size payload_capacity,
+                       ARMD_Size *payload_size, const void *value,
+                       ARMD_Size size) {
+    if (payload_capacity - *payload_size < size) {
+        return -1;
+    }
+    memcpy(payload + *payload_size, value, size);
+    *payload_size += size;
+    return 0;
+}
+
+static int read_bytes(const unsigned char *payload, ARMD_Size payload_size,
+                      ARMD_Size *position, void *value, ARMD_Size size) {
+    if (payload_size - *position < size) {
+        return -1;
+    }
+    memcpy(value, payload + *position, size);
+    *position += size;
+    return 0;
+}
+
+int armd__log_args_encode(unsigned char *payload, ARMD_Size payload_capacity,
+                          const char *format, va_list args,
+                          ARMD_Size *payload_size) {
+    ARMD_Size size = 0;
+
+#define ARMD__LOG_ARGS_ENCODE(type)                                            \
+    do {                                                                       \
+        type value = va_arg(args, type);                                       \
+        if (write_bytes(payload, payload_capacity, &size, &value,              \
+                        sizeof(value))) {                                      \
+            return -1;                                                         \
+        }                                                                      \
+    } while (0)
+
+    const char *p = format;
+    while ((p = strchr(p, '%')) != NULL) {
+        ARMD__LogArgSpec spec;
+        p = parse_spec(p, &spec);
+        if (p == NULL) {
+            return -1;
+        }
+
+        int stars[2];
+        for (int i = 0; i < spec.num_stars; ++i) {
+            stars[i] = va_arg(args, int);
+            if (write_bytes(payload, payload_capacity, &size, &stars[i],
+                            sizeof(int))) {
+                return -1;
+            }
+        }
+
+        switch (spec.type) {
+        case ARMD__LogArgType_Int:
+            ARMD__LOG_ARGS_ENCODE(int);
+            break;
+        case ARMD__LogArgType_UnsignedInt:
+            ARMD__LOG_ARGS_ENCODE(unsigned int);
+            break;
+        case ARMD__LogArgType_Long:
+            ARMD__LOG_ARGS_ENCODE(long);
+            break;
+        case ARMD__LogArgType_UnsignedLong:
+            ARMD__LOG_ARGS_ENCODE(unsigned long);
+            break;
+        case ARMD__LogArgType_LongLong:
+            ARMD__LOG_ARGS_ENCODE(long long);
+            break;
+        case ARMD__LogArgType_UnsignedLongLong:
+            ARMD__LOG_ARGS_ENCODE(unsigned long long);
+            break;
+        case ARMD__LogArgType_IntMax:
+            ARMD__LOG_ARGS_ENCODE(intmax_t);
+            break;
+        case ARMD__LogArgType_UIntMax:
+            ARMD__LOG_ARGS_ENCODE(uintmax_t);
+            break;
+        case ARMD__LogArgType_Size:
+            ARMD__LOG_ARGS_ENCODE(size_t);
+            break;
+        case ARMD__LogArgType_PtrDiff:
+            ARMD__LOG_ARGS_ENCODE(ptrdiff_t);
+            break;
+        case ARMD__LogArgType_Double:
+            ARMD__LOG_ARGS_ENCODE(double);
+            break;
+        case ARMD__LogArgType_LongDouble:
+            ARMD__LOG_ARGS_ENCODE(long double);
+            break;
+        case ARMD__LogArgType_Pointer:
+            ARMD__LOG_ARGS_ENCODE(void *);
+            break;
+        case ARMD__LogArgType_String: {
+            const char *value = va_arg(args, const char *);
+            if (value == NULL) {
+                value = "(null)";
+            }
+
+            // The string need not be terminated within the precision
+            int precision = spec.precision;
+            if (spec.precision_is_star) {
+                precision = stars[spec.num_stars - 1];
+            }
+
+            ARMD_Size length = 0;
+            while ((precision < 0 || length < (ARMD_Size)precision) &&
+                   value[length] != '\0') {
+                ++length;
+            }
+
+            if (write_bytes(payload, payload_capacity, &size, &length,
+                            sizeof(length)) ||
+                write_bytes(payload, payload_capacity, &size, value,
+                            length) ||
+                write_bytes(payload, payload_capacity, &size, "", 1)) {
+                return -1;
+            }
+            break;
+        }
+        case ARMD__LogArgType_Count:
+            (void)va_arg(args, void *);
+            break;
+        case ARMD__LogArgType_Percent:
+            break;
+        }
+    }
+
+#undef ARMD__LOG_ARGS_ENCODE
+
+    *payload_size = size;
+    return 0;
+}
+
+static void append_text(char *buffer, ARMD_Size buffer_size,
+                        ARMD_Size *length, const char *text,
+                        ARMD_Size text_length) {
+    if (*length < buffer_size) {
+        // Leave room for the NUL
+        ARMD_Size available = buffer_size - *length - 1;
+        memcpy(buffer + *length, text,
+               text_length < available ? text_length : available);
+    }
+    *length += text_length;
+}
+
+int armd__log_args_format(char *buffer, ARMD_Size buffer_size,
+                          const char *format, const unsigned char *payload,
+                          ARMD_Size payload_size, ARMD_Size *length) {
+    ARMD_Size total = 0;
+    ARMD_Size position = 0;
+
+#define ARMD__LOG_ARGS_PRINT(value)                                            \
+    (spec.num_stars == 0                                                       \
+         ? snprintf(out, out_size, spec.text, value)                           \
+         : spec.num_stars == 1                                                 \
+               ? snprintf(out, out_size, spec.text, stars[0], value)           \
+               : snprintf(out, out_size, spec.text, stars[0], stars[1],        \
+                          value))
+
+#define ARMD__LOG_ARGS_DECODE(type)                                            \
+    do {                                                                       \
+        type value;                                                            \
+        if (read_bytes(payload, payload_size, &position, &value,               \
+                       sizeof(value))) {                                       \
+            return -1;                                                         \
+        }                                                                      \
+        written = ARMD__LOG_ARGS_PRINT(value);                                 \
+    } while (0)
+
+    const char *p = format;
+    while (*p != '\0') {
+        const char *percent = strchr(p, '%');
+        ARMD_Size literal_length =
+            percent == NULL ? strlen(p) : (ARMD_Size)(percent - p);
+        append_text(buffer, buffer_size, &total, p, literal_length);
+        if (percent == NULL) {
+            break;
+        }
+
+        ARMD__LogArgSpec spec;
+        p = parse_spec(percent, &spec);
+        if (p == NULL) {
+            return -1;
+        }
+
+        int stars[2];
+        for (int i = 0; i < spec.num_stars; ++i) {
+            if (read_bytes(payload, payload_size, &position, &stars[i],
+                           sizeof(int))) {
+                return -1;
+            }
+        }
+
+        char *out = total < buffer_size ? buffer + total : NULL;
+        size_t out_size = total < buffer_size ? buffer_size - total : 0;
+        int written = 0;
+
+        switch (spec.type) {
+        case ARMD__LogArgType_Int:
+            ARMD__LOG_ARGS_DECODE(int);
+            break;
+        case ARMD__LogArgType_UnsignedInt:
+            ARMD__LOG_ARGS_DECODE(unsigned int);
+            break;
+        case ARMD__LogArgType_Long:
+            ARMD__LOG_ARGS_DECODE(long);
+            break;
+        case ARMD__LogArgType_UnsignedLong:
+            ARMD__LOG_ARGS_DECODE(unsigned long);
+            break;
+        case ARMD__LogArgType_LongLong:
+            ARMD__LOG_ARGS_DECODE(long long);
+            break;
+        case ARMD__LogArgType_UnsignedLongLong:
+            ARMD__LOG_ARGS_DECODE(unsigned long long);
+            break;
+        case ARMD__LogArgType_IntMax:
+            ARMD__LOG_ARGS_DECODE(intmax_t);
+            break;
+        case ARMD__LogArgType_UIntMax:
+            ARMD__LOG_ARGS_DECODE(uintmax_t);
+            break;
+        case ARMD__LogArgType_Size:
+            ARMD__LOG_ARGS_DECODE(size_t);
+            break;
+        case ARMD__LogArgType_PtrDiff:
+            ARMD__LOG_ARGS_DECODE(ptrdiff_t);
+            break;
+        case ARMD__LogArgType_Double:
+            ARMD__LOG_ARGS_DECODE(double);
+            break;
+        case ARMD__LogArgType_LongDouble:
+            ARMD__LOG_ARGS_DECODE(long double);
+            break;
+        case ARMD__LogArgType_Pointer:
+            ARMD__LOG_ARGS_DECODE(void *);
+            break;
+        case ARMD__LogArgType_String: {
+            ARMD_Size string_length;
+            if (read_bytes(payload, payload_size, &position, &string_length,
+                           sizeof(string_length))) {
+                return -1;
+            }
+            if (payload_size - position <= string_length ||
+                payload[position + string_length] != '\0') {
+                return -1;
+            }
+            const char *value = (const char *)payload + position;
+            position += string_length + 1;
+            written = ARMD__LOG_ARGS_PRINT(value);
+            break;
+        }
+        case ARMD__LogArgType_Count:
+            break;
+        case ARMD__LogArgType_Percent:
+            append_text(buffer, buffer_size, &total, "%", 1);
+            break;
+        }
+
+        if (written < 0) {
+            return -1;
+        }
+        total += (ARMD_Size)written;
+    }
+
+#undef ARMD__LOG_ARGS_DECODE
+#undef ARMD__LOG_ARGS_PRINT
+
+    if (position != payload_size) {
+        return -1;
+    }
+
+    if (buffer_size > 0) {
+        buffer[total < buffer_size ? total : buffer_size - 1] = '\0';
+    }
+    *length = total;
+
+    return 0;
+}
+
+char *armd__log_args_format_allocate(ARMD_MemoryRegion *memory_region,
+                                     const char *format,
+                                     const unsigned char *payload,
+                                     ARMD_Size payload_size) {
+    ARMD_Size length;
+    if (armd__log_args_format(NULL, 0, format, payload, payload_size,
+                              &length)) {
+        return NULL;
+    }
+
+    char *message = armd_memory_region_allocate(memory_region, length + 1);
+    if (message == NULL) {
+        return NULL;
+    }
+
+    if (armd__log_args_format(message, length + 1, format, payload,
+                              payload_size, &length)) {
+        armd_memory_region_free(memory_region, message);
+        return NULL;
+    }
+
+    return message;
+}
@@ -0,0 +1,43 @@
+#ifndef ARAMID__LOG_ARGS_H
+#define ARAMID__LOG_ARGS_H
+
+#include <stdarg.h>
+
+#include <aramid/aramid.h>
+
+/*
+ * Captures the arguments of a printf-style call as raw bytes so that the
+ * message can be formatted later, possibly in another process. The payload
+ * is the values of the conversions in order, copied in the native
+ * representation. A string is stored as its length and the characters with
+ * the terminating NUL.
+ *
+ * Wide characters and strings (%lc, %ls) are not supported, for which the
+ * encoding fails and the caller falls back to formatting immediately.
+ */
+
+/* Returns non-zero if the format is not supported or the payload is full */
+ARMD_EXTERN_C int armd__log_args_encode(unsigned char *payload,
+                                        ARMD_Size payload_capacity,
+                                        const char *format, va_list args,
+                                        ARMD_Size *payload_size);
+
+/*
+ * Writes at most buffer_size bytes including the NUL like snprintf. length
+ * receives the length of the whole message. Returns non-zero if the payload
+ * does not match the format.
+ */
+ARMD_EXTERN_C int armd__log_args_format(char *buffer, ARMD_Size buffer_size,
+                                        const char *format,
+                                        const unsigned char *payload,
+                                        ARMD_Size payload_size,
+                                        ARMD_Size *length);
+
+/* Returns NULL on failure */
+ARMD_EXTERN_C char *
+armd__log_args_format_allocate(ARMD_MemoryRegion *memory_region,
+                               const char *format,
+                               const unsigned char *payload,
+                               ARMD_Size payload_size);
+
+#endif // ARAMID__LOG_ARGS_H
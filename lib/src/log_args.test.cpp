@@ -0,0 +1,126 @@
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "log_args.h"
+
+namespace {
+
+class LogArgsTest : public ::testing::Test {
+protected:
+    unsigned char payload[256];
+    ARMD_Size payload_size;
+
+    LogArgsTest() {}
+
+    ~LogArgsTest() override {}
+
+    void SetUp() override { payload_size = 0; }
+
+    void TearDown() override {}
+
+    int encode(ARMD_Size payload_capacity, const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        int res = armd__log_args_encode(payload, payload_capacity, format,
+                                        args, &payload_size);
+        va_end(args);
+        return res;
+    }
+
+    std::string format(const char *format) {
+        ARMD_Size length;
+        int res = armd__log_args_format(nullptr, 0, format, payload,
+                                        payload_size, &length);
+        EXPECT_EQ(res, 0);
+
+        std::string message(length + 1, '\0');
+        res = armd__log_args_format(&message[0], message.size(), format,
+                                    payload, payload_size, &length);
+        EXPECT_EQ(res, 0);
+        message.resize(length);
+        return message;
+    }
+};
+
+#define EXPECT_SAME_AS_SNPRINTF(...)                                           \
+    do {                                                                       \
+        char expected[256];                                                    \
+        std::snprintf(expected, sizeof(expected), __VA_ARGS__);                \
+        ASSERT_EQ(encode(sizeof(payload), __VA_ARGS__), 0);                    \
+        ASSERT_EQ(format(GET_FORMAT(__VA_ARGS__, 0)), expected);               \
+    } while (0)
+
+#define GET_FORMAT(format, ...) format
+
+TEST_F(LogArgsTest, Integers) {
+    EXPECT_SAME_AS_SNPRINTF("%d %i %u %x %X %o", -1, 2, 3u, 255u, 255u, 8u);
+    EXPECT_SAME_AS_SNPRINTF("%hhd %hd %ld %lld", 'a', (short)-3, -4l, -5ll);
+    EXPECT_SAME_AS_SNPRINTF("%lu %llu %jd %ju", 6ul, 7ull, (intmax_t)-8,
+                            (uintmax_t)9);
+    EXPECT_SAME_AS_SNPRINTF("%zu %td", (size_t)10, (ptrdiff_t)-11);
+    EXPECT_SAME_AS_SNPRINTF("[%-5d] [%+05d] [%#x] [%*d] [%.*d]", 1, 2, 3u, 6,
+                            4, 3, 5);
+}
+
+TEST_F(LogArgsTest, FloatingPoints) {
+    EXPECT_SAME_AS_SNPRINTF("%f %e %g %a", 1.5, -2.25, 1e-10, 0.5);
+    EXPECT_SAME_AS_SNPRINTF("%Lf %.3f %*.*f", (long double)3.75, 3.14159, 10,
+                            2, 2.5);
+}
+
+TEST_F(LogArgsTest, StringsAndOthers) {
+    int count = 0;
+    EXPECT_SAME_AS_SNPRINTF("%s %c %% %5s|%-5s|%n", "abc", 'x', "de", "fg",
+                            &count);
+    EXPECT_SAME_AS_SNPRINTF("%p %s", (void *)&count, "");
+    EXPECT_SAME_AS_SNPRINTF("no arguments");
+}
+
+TEST_F(LogArgsTest, StringWithPrecision) {
+    // Not terminated within the precision
+    char chars[3] = {'a', 'b', 'c'};
+    EXPECT_SAME_AS_SNPRINTF("%.2s %.*s", chars, 1, chars);
+}
+
+TEST_F(LogArgsTest, Unsupported) {
+    ASSERT_NE(encode(sizeof(payload), "%ls", L"wide"), 0);
+    ASSERT_NE(encode(sizeof(payload), "%1$d", 1), 0);
+    ASSERT_NE(encode(sizeof(payload), "%"), 0);
+}
+
+TEST_F(LogArgsTest, Overflow) {
+    ASSERT_NE(encode(4, "%d %d", 1, 2), 0);
+    ASSERT_NE(encode(16, "%s", "a string longer than the payload"), 0);
+    ASSERT_EQ(encode(sizeof(int) * 2, "%d %d", 1, 2), 0);
+}
+
+TEST_F(LogArgsTest, Truncate) {
+    ASSERT_EQ(encode(sizeof(payload), "%s-%d", "abcdef", 12345), 0);
+
+    char buffer[5];
+    ARMD_Size length;
+    int res = armd__log_args_format(buffer, sizeof(buffer), "%s-%d", payload,
+                                    payload_size, &length);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(length, 12u);
+    ASSERT_STREQ(buffer, "abcd");
+}
+
+TEST_F(LogArgsTest, Mismatch) {
+    ASSERT_EQ(encode(sizeof(payload), "%d", 1), 0);
+
+    ARMD_Size length;
+    ASSERT_NE(armd__log_args_format(nullptr, 0, "%d %d", payload,
+                                    payload_size, &length),
+              0);
+    ASSERT_NE(armd__log_args_format(nullptr, 0, "no arguments", payload,
+                                    payload_size, &length),
+              0);
+}
+
+} // namespace
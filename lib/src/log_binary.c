@@ -0,0 +1,300 @@
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <aramid/aramid.h>
+
+#include "hash_table.h"
+#include "log_args.h"
+#include "logger.h"
+
+/*
+ * The binary log stream is a header followed by entries. Integers are in the
+ * native byte order and the payloads hold native types, so a stream can be
+ * decoded only on a machine with the same ABI, which the header records.
+ *
+ * Header: magic (8), sizeof long, void *, long double, ARMD_Size (1 each),
+ *         reserved (4)
+ * String: 'S', id (8), length (8), characters without NUL
+ * Record: 'R', seconds (8), nanoseconds (8), level (4), filename id (8),
+ *         lineno (8), format id (8), payload size (8), payload
+ *
+ * The id of a string is its address in the logging process and 0 stands for
+ * NULL. A string entry precedes the first record using it. A record whose
+ * format id is 0 holds the formatted message without NUL as its payload.
+ */
+
+static const unsigned char magic[8] = {'A', 'R', 'M', 'D', 'L', 'O', 'G', '1'};
+
+#define ARMD__LOG_BINARY_HEADER_SIZE 16
+#define ARMD__LOG_BINARY_STRING_SIZE 17
+#define ARMD__LOG_BINARY_RECORD_SIZE 53
+
+static unsigned char *put_u8(unsigned char *cursor, uint8_t value) {
+    *cursor = value;
+    return cursor + 1;
+}
+
+static unsigned char *put_u32(unsigned char *cursor, uint32_t value) {
+    memcpy(cursor, &value, sizeof(value));
+    return cursor + sizeof(value);
+}
+
+static unsigned char *put_u64(unsigned char *cursor, uint64_t value) {
+    memcpy(cursor, &value, sizeof(value));
+    return cursor + sizeof(value);
+}
+
+static const unsigned char *get_u32(const unsigned char *cursor,
+                                    uint32_t *value) {
+    memcpy(value, cursor, sizeof(*value));
+    return cursor + sizeof(*value);
+}
+
+static const unsigned char *get_u64(const unsigned char *cursor,
+                                    uint64_t *value) {
+    memcpy(value, cursor, sizeof(*value));
+    return cursor + sizeof(*value);
+}
+
+static void get_abi(unsigned char *abi) {
+    abi[0] = (unsigned char)sizeof(long);
+    abi[1] = (unsigned char)sizeof(void *);
+    abi[2] = (unsigned char)sizeof(long double);
+    abi[3] = (unsigned char)sizeof(ARMD_Size);
+}
+
+int armd__log_binary_write_header(ARMD_LogWriterFunc writer_func,
+                                  void *writer_context) {
+    unsigned char header[ARMD__LOG_BINARY_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, magic, sizeof(magic));
+    get_abi(header + sizeof(magic));
+
+    return writer_func(writer_context, header, sizeof(header));
+}
+
+static uint64_t get_string_id(const char *str) {
+    return (uint64_t)(uintptr_t)str;
+}
+
+static int write_string(ARMD__AsyncLogger *async, const char *str) {
+    if (str == NULL) {
+        return 0;
+    }
+
+    uint64_t id = get_string_id(str);
+    if (armd__hash_table_exists(async->written_strings, id)) {
+        return 0;
+    }
+
+    ARMD_Size length = strlen(str);
+
+    unsigned char entry[ARMD__LOG_BINARY_STRING_SIZE];
+    unsigned char *cursor = entry;
+    cursor = put_u8(cursor, 'S');
+    cursor = put_u64(cursor, id);
+    cursor = put_u64(cursor, length);
+    assert(cursor == entry + sizeof(entry));
+
+    if (async->binary_writer_func(async->binary_writer_context, entry,
+                                  sizeof(entry)) ||
+        async->binary_writer_func(async->binary_writer_context, str,
+                                  length)) {
+        return -1;
+    }
+
+    // Written again next time if it fails, which is harmless
+    armd__hash_table_insert(async->written_strings, id, (void *)str);
+
+    return 0;
+}
+
+int armd__log_binary_write_record(ARMD__AsyncLogger *async,
+                                  const ARMD__LogRecord *record) {
+    if (write_string(async, record->filename) ||
+        write_string(async, record->format)) {
+        return -1;
+    }
+
+    // The text payload is terminated with NUL, which is not written
+    ARMD_Size payload_size = record->format != NULL
+                                 ? record->payload_size
+                                 : strlen((const char *)record->payload);
+
+    unsigned char
+        entry[ARMD__LOG_BINARY_RECORD_SIZE + ARMD__LOG_RECORD_PAYLOAD_SIZE];
+    unsigned char *cursor = entry;
+    cursor = put_u8(cursor, 'R');
+    cursor = put_u64(cursor, (uint64_t)record->timespec.seconds);
+    cursor = put_u64(cursor, (uint64_t)record->timespec.nanoseconds);
+    cursor = put_u32(cursor, (uint32_t)record->level);
+    cursor = put_u64(cursor, get_string_id(record->filename));
+    cursor = put_u64(cursor, record->lineno);
+    cursor = put_u64(cursor, get_string_id(record->format));
+    cursor = put_u64(cursor, payload_size);
+    assert(cursor == entry + ARMD__LOG_BINARY_RECORD_SIZE);
+    memcpy(cursor, record->payload, payload_size);
+
+    return async->binary_writer_func(async->binary_writer_context, entry,
+                                     ARMD__LOG_BINARY_RECORD_SIZE +
+                                         payload_size);
+}
+
+/* The strings read so far, chained to free them at the end */
+typedef struct TAG_ARMD__LogBinaryString {
+    struct TAG_ARMD__LogBinaryString *next;
+    char *str;
+} ARMD__LogBinaryString;
+
+static const char *find_string(ARMD__HashTable *strings, uint64_t id) {
+    void *value;
+    if (id == 0 || armd__hash_table_get(strings, id, &value)) {
+        return NULL;
+    }
+    return ((ARMD__LogBinaryString *)value)->str;
+}
+
+int armd_logger_decode_binary(ARMD_MemoryRegion *memory_region,
+                              const void *data, ARMD_Size size,
+                              ARMD_LogDecoderFunc decoder_func,
+                              void *decoder_context) {
+    int res = 0;
+    (void)res;
+
+    int result = -1;
+    const unsigned char *cursor = data;
+    const unsigned char *end = cursor + size;
+
+    unsigned char abi[4];
+    get_abi(abi);
+    if (size < ARMD__LOG_BINARY_HEADER_SIZE ||
+        memcmp(cursor, magic, sizeof(magic)) != 0 ||
+        memcmp(cursor + sizeof(magic), abi, sizeof(abi)) != 0) {
+        return -1;
+    }
+    cursor += ARMD__LOG_BINARY_HEADER_SIZE;
+
+    ARMD__HashTable *strings = armd__hash_table_create(memory_region, 16, 0.5f);
+    if (strings == NULL) {
+        return -1;
+    }
+    ARMD__LogBinaryString *string_list = NULL;
+
+    while (cursor < end) {
+        ARMD_Size remaining = (ARMD_Size)(end - cursor);
+
+        if (*cursor == 'S') {
+            uint64_t id;
+            uint64_t length;
+            if (remaining < ARMD__LOG_BINARY_STRING_SIZE) {
+                // Cut off in the middle of writing
+                break;
+            }
+            cursor = get_u64(cursor + 1, &id);
+            cursor = get_u64(cursor, &length);
+            if ((uint64_t)(end - cursor) < length) {
+                break;
+            }
+
+            ARMD__LogBinaryString *string = armd_memory_region_allocate(
+                memory_region, sizeof(ARMD__LogBinaryString));
+            if (string == NULL) {
+                goto finally;
+            }
+            string->str =
+                armd_memory_region_allocate(memory_region, length + 1);
+            if (string->str == NULL) {
+                armd_memory_region_free(memory_region, string);
+                goto finally;
+            }
+            memcpy(string->str, cursor, length);
+            string->str[length] = '\0';
+            cursor += length;
+
+            string->next = string_list;
+            string_list = string;
+
+            void *old_value;
+            // Returns 1 if inserted
+            if (armd__hash_table_upsert(strings, id, string, &old_value) <
+                0) {
+                goto finally;
+            }
+        } else if (*cursor == 'R') {
+            uint64_t seconds;
+            uint64_t nanoseconds;
+            uint32_t level;
+            uint64_t filename_id;
+            uint64_t lineno;
+            uint64_t format_id;
+            uint64_t payload_size;
+            if (remaining < ARMD__LOG_BINARY_RECORD_SIZE) {
+                break;
+            }
+            cursor = get_u64(cursor + 1, &seconds);
+            cursor = get_u64(cursor, &nanoseconds);
+            cursor = get_u32(cursor, &level);
+            cursor = get_u64(cursor, &filename_id);
+            cursor = get_u64(cursor, &lineno);
+            cursor = get_u64(cursor, &format_id);
+            cursor = get_u64(cursor, &payload_size);
+            if ((uint64_t)(end - cursor) < payload_size) {
+                break;
+            }
+            const unsigned char *payload = cursor;
+            cursor += payload_size;
+
+            char *message;
+            if (format_id == 0) {
+                message = armd_memory_region_allocate(memory_region,
+                                                      payload_size + 1);
+                if (message != NULL) {
+                    memcpy(message, payload, payload_size);
+                    message[payload_size] = '\0';
+                }
+            } else {
+                const char *format = find_string(strings, format_id);
+                if (format == NULL) {
+                    goto finally;
+                }
+                message = armd__log_args_format_allocate(
+                    memory_region, format, payload, payload_size);
+            }
+            if (message == NULL) {
+                goto finally;
+            }
+
+            ARMD_LogElement log_element;
+            log_element.timespec.seconds = (int64_t)seconds;
+            log_element.timespec.nanoseconds = (int64_t)nanoseconds;
+            log_element.level = (ARMD_LogLevel)level;
+            log_element.filename = find_string(strings, filename_id);
+            log_element.lineno = (ARMD_Size)lineno;
+            log_element.message = message;
+
+            res = decoder_func(decoder_context, &log_element);
+            armd_memory_region_free(memory_region, message);
+            if (res != 0) {
+                goto finally;
+            }
+        } else {
+            goto finally;
+        }
+    }
+
+    result = 0;
+
+finally:
+
+    while (string_list != NULL) {
+        ARMD__LogBinaryString *next = string_list->next;
+        armd_memory_region_free(memory_region, string_list->str);
+        armd_memory_region_free(memory_region, string_list);
+        string_list = next;
+    }
+
+    armd__hash_table_destroy(strings);
+
+    return result;
+}
@@ -1,11 +1,92 @@
 #include <assert.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <aramid/aramid.h>
 
+#include "log_args.h"
 #include "logger.h"
 
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+/* How long the flusher sleeps when nobody asks it to flush */
+static const ARMD_Size flush_interval_milliseconds = 10;
+
+static ARMD_Size load_relaxed(const volatile ARMD_Size *value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    return *value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static ARMD_Size load_acquire(const volatile ARMD_Size *value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    // Volatile accesses have acquire/release semantics on MSVC
+    return *value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void store_release(volatile ARMD_Size *target, ARMD_Size value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    *target = value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+/* Updates expected with the current value on failure */
+static ARMD_Bool compare_exchange(volatile ARMD_Size *target,
+                                  ARMD_Size *expected, ARMD_Size desired) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_compare_exchange_n(target, expected, desired, 1,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    ARMD_Size previous;
+#pragma warning(push)
+#pragma warning(disable : 4127)
+    if (sizeof(ARMD_Size) == 4) {
+        previous = (ARMD_Size)InterlockedCompareExchange(
+            (volatile LONG *)target, (LONG)desired, (LONG)*expected);
+    } else {
+        previous = (ARMD_Size)InterlockedCompareExchange64(
+            (volatile LONG64 *)target, (LONG64)desired, (LONG64)*expected);
+    }
+#pragma warning(pop)
+    if (previous == *expected) {
+        return 1;
+    }
+    *expected = previous;
+    return 0;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void increment_relaxed(volatile ARMD_Size *target) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_fetch_add(target, 1, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    ARMD_Size expected = *target;
+    while (!compare_exchange(target, &expected, expected + 1)) {
+    }
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
 static void destroy_element(ARMD_MemoryRegion *memory_region,
                             ARMD_LogElement *element) {
     armd_memory_region_free(memory_region, element->message);
@@ -52,6 +133,8 @@ ARMD_Logger *armd_logger_create(ARMD_MemoryRegion *memory_region,
 
     logger->callback.func = NULL;
     logger->callback.context = NULL;
+    logger->async = NULL;
+    logger->flight_recorder = NULL;
 
     res = armd__mutex_init(&logger->mutex);
     if (res != 0) {
@@ -77,6 +160,623 @@ ARMD_Logger *armd_logger_create(ARMD_MemoryRegion *memory_region,
     return NULL;
 }
 
+static int log_buffer_init(ARMD_MemoryRegion *memory_region,
+                           ARMD__LogBuffer *buffer, ARMD_Size buffer_size) {
+    ARMD_Size capacity = 1;
+    while (capacity < buffer_size) {
+        capacity *= 2;
+    }
+
+    buffer->records = armd_memory_region_allocate(
+        memory_region, sizeof(ARMD__LogRecord) * capacity);
+    if (buffer->records == NULL) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < capacity; ++i) {
+        buffer->records[i].sequence = i;
+    }
+    buffer->mask = capacity - 1;
+    buffer->tail = 0;
+    buffer->head = 0;
+
+    return 0;
+}
+
+/* Returns NULL if the buffer is full */
+static ARMD__LogRecord *log_buffer_claim(ARMD__LogBuffer *buffer,
+                                         ARMD_Size *position) {
+    ARMD_Size current = load_relaxed(&buffer->tail);
+    while (1) {
+        ARMD__LogRecord *record = &buffer->records[current & buffer->mask];
+        ARMD_Size sequence = load_acquire(&record->sequence);
+        intptr_t difference = (intptr_t)(sequence - current);
+        if (difference == 0) {
+            if (compare_exchange(&buffer->tail, &current, current + 1)) {
+                *position = current;
+                return record;
+            }
+        } else if (difference < 0) {
+            // The flusher has not consumed the record of the last round
+            return NULL;
+        } else {
+            current = load_relaxed(&buffer->tail);
+        }
+    }
+}
+
+static void log_buffer_publish(ARMD__LogRecord *record, ARMD_Size position) {
+    store_release(&record->sequence, position + 1);
+}
+
+/* Only the flusher calls. Returns NULL if the next record is not published. */
+static ARMD__LogRecord *log_buffer_peek(ARMD__LogBuffer *buffer) {
+    ARMD__LogRecord *record = &buffer->records[buffer->head & buffer->mask];
+    if (load_acquire(&record->sequence) != buffer->head + 1) {
+        return NULL;
+    }
+    return record;
+}
+
+static void log_buffer_release(ARMD__LogBuffer *buffer,
+                               ARMD__LogRecord *record) {
+    store_release(&record->sequence, buffer->head + buffer->mask + 1);
+    ++buffer->head;
+}
+
+/* Executors have their own buffer; the other threads share the last one */
+static ARMD__LogBuffer *get_current_log_buffer(ARMD__AsyncLogger *async) {
+    ARMD_Size slot = armd__thread_get_slot();
+    ARMD_Size index =
+        slot < async->num_buffers - 1 ? slot : async->num_buffers - 1;
+    return &async->buffers[index];
+}
+
+static ARMD__LogRecord *claim_record(ARMD__AsyncLogger *async,
+                                     ARMD_Size *position) {
+    int res = 0;
+    (void)res;
+
+    ARMD__LogBuffer *buffer = get_current_log_buffer(async);
+    ARMD__LogRecord *record = log_buffer_claim(buffer, position);
+    if (record != NULL) {
+        return record;
+    }
+
+    if (async->overflow_policy == ARMD_LogOverflowPolicy_Drop) {
+        increment_relaxed(&async->num_dropped);
+        return NULL;
+    }
+
+    res = armd__mutex_lock(&async->mutex);
+    assert(res == 0);
+
+    while ((record = log_buffer_claim(buffer, position)) == NULL) {
+        // Ask for a pass instead of waiting for the interval
+        ++async->num_flush_requests;
+        res = armd__condvar_broadcast(&async->request_condvar);
+        assert(res == 0);
+
+        res = armd__condvar_wait(&async->progress_condvar, &async->mutex);
+        assert(res == 0);
+    }
+
+    res = armd__mutex_unlock(&async->mutex);
+    assert(res == 0);
+
+    return record;
+}
+
+static void log_async(ARMD_Logger *logger, ARMD_LogLevel level,
+                      const char *filename, ARMD_Size lineno,
+                      const char *format, va_list args) {
+    ARMD_Size position;
+    ARMD__LogRecord *record = claim_record(logger->async, &position);
+    if (record == NULL) {
+        return;
+    }
+
+    armd_get_time(&record->timespec);
+    record->level = level;
+    record->filename = filename;
+    record->lineno = lineno;
+    record->format = NULL;
+
+    if (logger->async->deferred_format) {
+        va_list args_copy;
+        va_copy(args_copy, args);
+        if (armd__log_args_encode(record->payload,
+                                  ARMD__LOG_RECORD_PAYLOAD_SIZE, format,
+                                  args_copy, &record->payload_size) == 0) {
+            record->format = format;
+        }
+        va_end(args_copy);
+    }
+
+    if (record->format == NULL) {
+        if (vsnprintf((char *)record->payload, ARMD__LOG_RECORD_PAYLOAD_SIZE,
+                      format, args) < 0) {
+            record->payload[0] = '\0';
+        }
+        record->payload_size = strlen((const char *)record->payload);
+    }
+
+    log_buffer_publish(record, position);
+}
+
+static void log_async_format(ARMD_Logger *logger, ARMD_LogLevel level,
+                             const char *filename, ARMD_Size lineno,
+                             const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_async(logger, level, filename, lineno, format, args);
+    va_end(args);
+}
+
+static ARMD_LogElement *create_element(ARMD_MemoryRegion *memory_region,
+                                       const ARMD__LogRecord *record) {
+    ARMD_LogElement *element =
+        armd_memory_region_allocate(memory_region, sizeof(ARMD_LogElement));
+    if (element == NULL) {
+        return NULL;
+    }
+
+    if (record->format == NULL) {
+        element->message = armd_memory_region_strdup(
+            memory_region, (const char *)record->payload);
+    } else {
+        // Deferred formatting
+        element->message = armd__log_args_format_allocate(
+            memory_region, record->format, record->payload,
+            record->payload_size);
+    }
+    if (element->message == NULL) {
+        armd_memory_region_free(memory_region, element);
+        return NULL;
+    }
+
+    element->timespec = record->timespec;
+    element->level = record->level;
+    element->filename = record->filename;
+    element->lineno = record->lineno;
+
+    return element;
+}
+
+/* Formats the record directly into the file without allocation */
+static void record_to_flight_recorder(ARMD_FlightRecorder *flight_recorder,
+                                      const ARMD__LogRecord *record) {
+    ARMD__FlightLogRecord *flight_record = armd__flight_recorder_begin_log(
+        flight_recorder, &record->timespec, record->level, record->filename,
+        record->lineno);
+    if (flight_record == NULL) {
+        return;
+    }
+
+    if (record->format == NULL) {
+        snprintf(flight_record->message, sizeof(flight_record->message),
+                 "%s", (const char *)record->payload);
+    } else {
+        ARMD_Size length;
+        if (armd__log_args_format(flight_record->message,
+                                  sizeof(flight_record->message),
+                                  record->format, record->payload,
+                                  record->payload_size, &length)) {
+            flight_record->message[0] = '\0';
+        }
+    }
+
+    armd__flight_recorder_end_log(flight_recorder);
+}
+
+/* Logger mutex must be held */
+static void push_element(ARMD_Logger *logger, ARMD__LogNode *log_node) {
+    ARMD__LogNode *next = logger->ring->next;
+    logger->ring->next = log_node;
+    next->prev = log_node;
+    log_node->next = next;
+    log_node->prev = logger->ring;
+}
+
+/*
+ * Moves all the published records into the element ring and invokes the
+ * callback once for the batch, or writes them to the binary writer. Records
+ * from the same thread keep their order.
+ */
+static void drain_records(ARMD_Logger *logger, ARMD_Bool binary) {
+    int res = 0;
+    (void)res;
+
+    ARMD__AsyncLogger *async = logger->async;
+    ARMD_MemoryRegion *memory_region = logger->memory_region;
+
+    // Chained through next, oldest first
+    ARMD__LogNode *first = NULL;
+    ARMD__LogNode *last = NULL;
+
+    res = armd__mutex_lock(&logger->mutex);
+    assert(res == 0);
+
+    ARMD_FlightRecorder *flight_recorder = logger->flight_recorder;
+
+    res = armd__mutex_unlock(&logger->mutex);
+    assert(res == 0);
+
+    for (ARMD_Size i = 0; i < async->num_buffers; ++i) {
+        ARMD__LogBuffer *buffer = &async->buffers[i];
+        ARMD__LogRecord *record;
+        while ((record = log_buffer_peek(buffer)) != NULL) {
+            if (binary) {
+                if (flight_recorder != NULL) {
+                    record_to_flight_recorder(flight_recorder, record);
+                }
+                if (armd__log_binary_write_record(async, record)) {
+                    increment_relaxed(&async->num_dropped);
+                }
+                log_buffer_release(buffer, record);
+                continue;
+            }
+
+            ARMD__LogNode *log_node = NULL;
+            ARMD_LogElement *log_element =
+                create_element(memory_region, record);
+            if (log_element != NULL) {
+                log_node = armd_memory_region_allocate(memory_region,
+                                                       sizeof(ARMD__LogNode));
+                if (log_node == NULL) {
+                    destroy_element(memory_region, log_element);
+                }
+            }
+            log_buffer_release(buffer, record);
+
+            if (log_node == NULL) {
+                increment_relaxed(&async->num_dropped);
+                continue;
+            }
+
+            if (flight_recorder != NULL) {
+                armd__flight_recorder_record_log(flight_recorder, log_element);
+            }
+
+            log_node->log_element = log_element;
+            log_node->next = NULL;
+            if (last == NULL) {
+                first = log_node;
+            } else {
+                last->next = log_node;
+            }
+            last = log_node;
+        }
+    }
+
+    if (first == NULL) {
+        return;
+    }
+
+    res = armd__mutex_lock(&logger->mutex);
+    assert(res == 0);
+
+    while (first != NULL) {
+        ARMD__LogNode *next = first->next;
+        push_element(logger, first);
+        first = next;
+    }
+
+    ARMD_LoggerCallbackFunc callback_func = logger->callback.func;
+    void *callback_context = logger->callback.context;
+
+    res = armd__mutex_unlock(&logger->mutex);
+    assert(res == 0);
+
+    if (callback_func != NULL) {
+        callback_func(callback_context, logger);
+    }
+}
+
+static void *flusher_main(void *arg) {
+    int res = 0;
+    (void)res;
+
+    ARMD_Logger *logger = arg;
+    ARMD__AsyncLogger *async = logger->async;
+
+    res = armd__mutex_lock(&async->mutex);
+    assert(res == 0);
+
+    while (1) {
+        ARMD_Size num_flush_requests = async->num_flush_requests;
+        ARMD_Bool stopping = async->stopping;
+        ARMD_Bool binary = async->binary_writer_func != NULL;
+
+        res = armd__mutex_unlock(&async->mutex);
+        assert(res == 0);
+
+        drain_records(logger, binary);
+
+        res = armd__mutex_lock(&async->mutex);
+        assert(res == 0);
+
+        async->num_flushes_done = num_flush_requests;
+        res = armd__condvar_broadcast(&async->progress_condvar);
+        assert(res == 0);
+
+        // The records logged before stopping are drained in the last pass
+        if (stopping) {
+            break;
+        }
+
+        if (async->num_flush_requests == num_flush_requests &&
+            !async->stopping) {
+            res = armd__condvar_timed_wait(&async->request_condvar,
+                                           &async->mutex,
+                                           flush_interval_milliseconds);
+            assert(res == 0);
+        }
+    }
+
+    res = armd__mutex_unlock(&async->mutex);
+    assert(res == 0);
+
+    return NULL;
+}
+
+static void free_async_logger(ARMD_MemoryRegion *memory_region,
+                              ARMD__AsyncLogger *async,
+                              ARMD_Size num_buffers_initialized) {
+    if (async->written_strings != NULL) {
+        armd__hash_table_destroy(async->written_strings);
+    }
+    for (ARMD_Size i = 0; i < num_buffers_initialized; ++i) {
+        armd_memory_region_free(memory_region, async->buffers[i].records);
+    }
+    armd_memory_region_free(memory_region, async->buffers);
+    armd_memory_region_free(memory_region, async);
+}
+
+int armd_logger_enable_async(ARMD_Logger *logger, ARMD_Size num_buffers,
+                             ARMD_Size buffer_size,
+                             ARMD_LogOverflowPolicy overflow_policy) {
+    int res = 0;
+    (void)res;
+
+    int mutex_initialized = 0;
+    int request_condvar_initialized = 0;
+    int progress_condvar_initialized = 0;
+    ARMD_Size num_buffers_initialized = 0;
+
+    if (logger->async != NULL || num_buffers == 0 || buffer_size == 0) {
+        return -1;
+    }
+
+    ARMD_MemoryRegion *memory_region = logger->memory_region;
+
+    ARMD__AsyncLogger *async =
+        armd_memory_region_allocate(memory_region, sizeof(ARMD__AsyncLogger));
+    if (async == NULL) {
+        return -1;
+    }
+
+    async->overflow_policy = overflow_policy;
+    async->num_buffers = num_buffers;
+    async->num_dropped = 0;
+    async->num_flush_requests = 0;
+    async->num_flushes_done = 0;
+    async->stopping = 0;
+    async->deferred_format = 0;
+    async->binary_writer_func = NULL;
+    async->binary_writer_context = NULL;
+    async->written_strings = NULL;
+
+    async->buffers = armd_memory_region_allocate(
+        memory_region, sizeof(ARMD__LogBuffer) * num_buffers);
+    if (async->buffers == NULL) {
+        goto error;
+    }
+
+    for (; num_buffers_initialized < num_buffers; ++num_buffers_initialized) {
+        if (log_buffer_init(memory_region,
+                            &async->buffers[num_buffers_initialized],
+                            buffer_size)) {
+            goto error;
+        }
+    }
+
+    if (armd__mutex_init(&async->mutex)) {
+        goto error;
+    }
+    mutex_initialized = 1;
+
+    if (armd__condvar_init(&async->request_condvar)) {
+        goto error;
+    }
+    request_condvar_initialized = 1;
+
+    if (armd__condvar_init(&async->progress_condvar)) {
+        goto error;
+    }
+    progress_condvar_initialized = 1;
+
+    // Published before the flusher starts, which reads it
+    logger->async = async;
+
+    if (armd__thread_create(&async->flusher, flusher_main, logger)) {
+        logger->async = NULL;
+        goto error;
+    }
+
+    return 0;
+
+error:
+
+    if (progress_condvar_initialized) {
+        res = armd__condvar_deinit(&async->progress_condvar);
+        assert(res == 0);
+    }
+
+    if (request_condvar_initialized) {
+        res = armd__condvar_deinit(&async->request_condvar);
+        assert(res == 0);
+    }
+
+    if (mutex_initialized) {
+        res = armd__mutex_deinit(&async->mutex);
+        assert(res == 0);
+    }
+
+    if (async->buffers != NULL) {
+        free_async_logger(memory_region, async, num_buffers_initialized);
+    } else {
+        armd_memory_region_free(memory_region, async);
+    }
+
+    return -1;
+}
+
+/* Drains the remaining records and stops the flusher */
+static void disable_async(ARMD_Logger *logger) {
+    int res = 0;
+    (void)res;
+
+    ARMD__AsyncLogger *async = logger->async;
+
+    res = armd__mutex_lock(&async->mutex);
+    assert(res == 0);
+
+    async->stopping = 1;
+    res = armd__condvar_broadcast(&async->request_condvar);
+    assert(res == 0);
+
+    res = armd__mutex_unlock(&async->mutex);
+    assert(res == 0);
+
+    res = armd__thread_join(&async->flusher, NULL);
+    assert(res == 0);
+
+    logger->async = NULL;
+    logger->flight_recorder = NULL;
+
+    res = armd__condvar_deinit(&async->progress_condvar);
+    assert(res == 0);
+    res = armd__condvar_deinit(&async->request_condvar);
+    assert(res == 0);
+    res = armd__mutex_deinit(&async->mutex);
+    assert(res == 0);
+
+    free_async_logger(logger->memory_region, async, async->num_buffers);
+}
+
+int armd_logger_flush(ARMD_Logger *logger) {
+    int res = 0;
+    (void)res;
+
+    ARMD__AsyncLogger *async = logger->async;
+    if (async == NULL) {
+        // The callback has been invoked on every log
+        return 0;
+    }
+
+    res = armd__mutex_lock(&async->mutex);
+    assert(res == 0);
+
+    ARMD_Size request = ++async->num_flush_requests;
+    res = armd__condvar_broadcast(&async->request_condvar);
+    assert(res == 0);
+
+    while (async->num_flushes_done < request) {
+        res = armd__condvar_wait(&async->progress_condvar, &async->mutex);
+        assert(res == 0);
+    }
+
+    res = armd__mutex_unlock(&async->mutex);
+    assert(res == 0);
+
+    return 0;
+}
+
+int armd_logger_enable_deferred_format(ARMD_Logger *logger) {
+    if (logger->async == NULL) {
+        return -1;
+    }
+
+    logger->async->deferred_format = 1;
+
+    return 0;
+}
+
+int armd_logger_set_binary_writer(ARMD_Logger *logger,
+                                  ARMD_LogWriterFunc writer_func,
+                                  void *writer_context) {
+    int res = 0;
+    (void)res;
+
+    int result = -1;
+
+    ARMD__AsyncLogger *async = logger->async;
+    if (async == NULL || writer_func == NULL) {
+        return -1;
+    }
+
+    res = armd__mutex_lock(&async->mutex);
+    assert(res == 0);
+
+    if (async->binary_writer_func != NULL) {
+        goto finally;
+    }
+
+    async->written_strings =
+        armd__hash_table_create(logger->memory_region, 64, 0.5f);
+    if (async->written_strings == NULL) {
+        goto finally;
+    }
+
+    if (armd__log_binary_write_header(writer_func, writer_context)) {
+        armd__hash_table_destroy(async->written_strings);
+        async->written_strings = NULL;
+        goto finally;
+    }
+
+    // The flusher reads them with the mutex held
+    async->binary_writer_func = writer_func;
+    async->binary_writer_context = writer_context;
+    async->deferred_format = 1;
+
+    result = 0;
+
+finally:
+
+    res = armd__mutex_unlock(&async->mutex);
+    assert(res == 0);
+
+    return result;
+}
+
+int armd_logger_set_flight_recorder(ARMD_Logger *logger,
+                                    ARMD_FlightRecorder *flight_recorder) {
+    int res = 0;
+    (void)res;
+
+    if (flight_recorder == NULL) {
+        return -1;
+    }
+
+    res = armd__mutex_lock(&logger->mutex);
+    assert(res == 0);
+
+    logger->flight_recorder = flight_recorder;
+
+    res = armd__mutex_unlock(&logger->mutex);
+    assert(res == 0);
+
+    return 0;
+}
+
+ARMD_Size armd_logger_get_num_dropped(ARMD_Logger *logger) {
+    if (logger->async == NULL) {
+        return 0;
+    }
+    return load_relaxed(&logger->async->num_dropped);
+}
+
 static void destroy_logger(ARMD_Logger *logger) {
     int res = 0;
     (void)res;
@@ -128,6 +828,19 @@ ARMD_Bool armd_logger_decrement_reference_count(ARMD_Logger *logger) {
     assert(res == 0);
 
     assert(logger->reference_count >= 1);
+
+    // Nobody else can take a reference anymore. Stop the flusher while the
+    // logger is still alive, so that its last callback can read the logger.
+    if (logger->reference_count == 1 && logger->async != NULL) {
+        res = armd__mutex_unlock(&logger->mutex);
+        assert(res == 0);
+
+        disable_async(logger);
+
+        res = armd__mutex_lock(&logger->mutex);
+        assert(res == 0);
+    }
+
     --logger->reference_count;
 
     ARMD_Bool to_destroy = logger->reference_count == 0;
@@ -278,6 +991,15 @@ void armd_logger_log_string(ARMD_Logger *logger, ARMD_LogLevel level,
     int res = 0;
     (void)res;
 
+    // The level is immutable, so it is read without the lock
+    if (logger->async != NULL) {
+        if (level <= logger->level) {
+            log_async_format(logger, level, filename, lineno, "%s", message);
+        }
+        armd_memory_region_free(logger->memory_region, message);
+        return;
+    }
+
     res = armd__mutex_lock(&logger->mutex);
     assert(res == 0);
 
@@ -311,11 +1033,11 @@ void armd_logger_log_string(ARMD_Logger *logger, ARMD_LogLevel level,
         logger->memory_region, sizeof(ARMD__LogNode));
     log_node->log_element = log_element;
 
-    ARMD__LogNode *next = logger->ring->next;
-    logger->ring->next = log_node;
-    next->prev = log_node;
-    log_node->next = next;
-    log_node->prev = logger->ring;
+    push_element(logger, log_node);
+
+    if (logger->flight_recorder != NULL) {
+        armd__flight_recorder_record_log(logger->flight_recorder, log_element);
+    }
 
     res = armd__mutex_unlock(&logger->mutex);
     assert(res == 0);
@@ -332,6 +1054,18 @@ void armd_logger_log_format(ARMD_Logger *logger, ARMD_LogLevel level,
     int res = 0;
     (void)res;
 
+    va_list args;
+
+    // Format into the record without the lock and allocations
+    if (logger->async != NULL) {
+        if (level <= logger->level) {
+            va_start(args, format);
+            log_async(logger, level, filename, lineno, format, args);
+            va_end(args);
+        }
+        return;
+    }
+
     // Check log level
 
     res = armd__mutex_lock(&logger->mutex);
@@ -350,8 +1084,6 @@ void armd_logger_log_format(ARMD_Logger *logger, ARMD_LogLevel level,
 
     // Format
 
-    va_list args;
-
     va_start(args, format);
     int length = vsnprintf(NULL, 0, format, args);
     va_end(args);
@@ -4,7 +4,13 @@
 #include <aramid/aramid.h>
 
 #include "condvar.h"
+#include "flight_recorder.h"
+#include "hash_table.h"
 #include "mutex.h"
+#include "thread.h"
+
+/* Longer messages are truncated in the asynchronous mode */
+#define ARMD__LOG_RECORD_PAYLOAD_SIZE 200
 
 typedef struct TAG_ARMD__LogNode {
     struct TAG_ARMD__LogNode *prev;
@@ -12,6 +18,61 @@ typedef struct TAG_ARMD__LogNode {
     ARMD_LogElement *log_element;
 } ARMD__LogNode;
 
+typedef struct TAG_ARMD__LogRecord {
+    /* Equals the position of the slot when the record is written */
+    volatile ARMD_Size sequence;
+    ARMD_Timespec timespec;
+    ARMD_LogLevel level;
+    const char *filename;
+    ARMD_Size lineno;
+    // NULL if the payload is the formatted message terminated with NUL,
+    // otherwise the payload is the arguments encoded by log_args.h
+    const char *format;
+    ARMD_Size payload_size;
+    unsigned char payload[ARMD__LOG_RECORD_PAYLOAD_SIZE];
+} ARMD__LogRecord;
+
+/*
+ * A bounded multi-producer queue of records with a sequence number per slot.
+ * Producers claim slots with CAS on tail and only the flusher advances head.
+ * Each executor writes to the buffer of its thread slot, so the producers
+ * rarely contend.
+ */
+typedef struct TAG_ARMD__LogBuffer {
+    ARMD__LogRecord *records;
+    ARMD_Size mask;
+    volatile ARMD_Size tail;
+    // Keep tail and head of neighboring buffers on separate cache lines
+    unsigned char padding1[64];
+    ARMD_Size head;
+    unsigned char padding2[64];
+} ARMD__LogBuffer;
+
+typedef struct TAG_ARMD__AsyncLogger {
+    ARMD_LogOverflowPolicy overflow_policy;
+    ARMD_Size num_buffers;
+    ARMD__LogBuffer *buffers;
+    volatile ARMD_Size num_dropped;
+    // Set before logging, so the producers read it without the lock
+    ARMD_Bool deferred_format;
+
+    ARMD__Thread flusher;
+    ARMD__Mutex mutex;
+    // Wakes the flusher
+    ARMD__Condvar request_condvar;
+    // Notified after every pass of the flusher
+    ARMD__Condvar progress_condvar;
+    ARMD_Size num_flush_requests;
+    ARMD_Size num_flushes_done;
+    ARMD_Bool stopping;
+
+    // The flusher writes the records here instead of making log elements
+    ARMD_LogWriterFunc binary_writer_func;
+    void *binary_writer_context;
+    // Format strings and filenames already written, keyed by address
+    ARMD__HashTable *written_strings;
+} ARMD__AsyncLogger;
+
 struct TAG_ARMD_Logger {
     ARMD_MemoryRegion *memory_region;
     ARMD_LogLevel level;
@@ -22,6 +83,16 @@ struct TAG_ARMD_Logger {
         ARMD_LoggerCallbackFunc func;
         void *context;
     } callback;
+    // NULL unless armd_logger_enable_async is called
+    ARMD__AsyncLogger *async;
+    ARMD_FlightRecorder *flight_recorder;
 };
 
+/* Binary log stream, see log_binary.c for the layout */
+ARMD_EXTERN_C int armd__log_binary_write_header(ARMD_LogWriterFunc writer_func,
+                                               void *writer_context);
+/* Called only by the flusher */
+ARMD_EXTERN_C int armd__log_binary_write_record(ARMD__AsyncLogger *async,
+                                               const ARMD__LogRecord *record);
+
 #endif // ARAMID__LOGGER_H
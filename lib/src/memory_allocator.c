@@ -1,6 +1,10 @@
 #include <aramid/aramid.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "memory_allocator.h"
+#include "os_memory.h"
+
 static void *default_allocate(void *context, ARMD_Size size) {
     (void)context;
     return calloc(1, size);
@@ -18,6 +22,64 @@ void armd_memory_allocator_init_default(
     memory_allocator->context = NULL;
 }
 
+/* Huge page allocator */
+
+typedef struct {
+    // Zero if allocated with calloc
+    ARMD_Size mapped_size;
+} HugePageHeader;
+
+// Keep bodies on cache line boundaries
+static const ARMD_Size huge_page_header_size = 64;
+
+static void *huge_page_allocate(void *context, ARMD_Size size) {
+    (void)context;
+
+    ARMD_Size total_size = huge_page_header_size + size;
+
+    unsigned char *buf;
+    ARMD_Size mapped_size;
+    if (total_size < ARMD__HUGE_PAGE_SIZE) {
+        buf = calloc(1, total_size);
+        mapped_size = 0;
+    } else {
+        mapped_size = armd__align_size(total_size, ARMD__HUGE_PAGE_SIZE);
+        buf = armd__os_memory_map_huge(mapped_size);
+    }
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    ((HugePageHeader *)buf)->mapped_size = mapped_size;
+
+    return buf + huge_page_header_size;
+}
+
+static void huge_page_free(void *context, void *buf) {
+    (void)context;
+
+    if (buf == NULL) {
+        return;
+    }
+
+    unsigned char *base = ((unsigned char *)buf) - huge_page_header_size;
+    ARMD_Size mapped_size = ((HugePageHeader *)base)->mapped_size;
+    if (mapped_size == 0) {
+        free(base);
+    } else {
+        armd__os_memory_unmap(base, mapped_size);
+    }
+}
+
+void armd_memory_allocator_init_huge_page(
+    ARMD_MemoryAllocator *memory_allocator) {
+    memory_allocator->allocate = huge_page_allocate;
+    memory_allocator->free = huge_page_free;
+    memory_allocator->context = NULL;
+}
+
+/* Utilities */
+
 void *armd_memory_allocator_allocate(const ARMD_MemoryAllocator *allocator,
                                      ARMD_Size size) {
     return allocator->allocate(allocator->context, size);
@@ -27,3 +89,45 @@ void armd_memory_allocator_free(const ARMD_MemoryAllocator *allocator,
                                 void *buf) {
     allocator->free(allocator->context, buf);
 }
+
+ARMD_Bool armd__is_valid_alignment(ARMD_Size alignment) {
+    return alignment != 0 && (alignment & (alignment - 1)) == 0;
+}
+
+ARMD_Size armd__align_size(ARMD_Size size, ARMD_Size alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+void *armd__align_pointer(void *ptr, ARMD_Size alignment) {
+    return (void *)armd__align_size((uintptr_t)ptr, alignment);
+}
+
+void *armd_memory_allocator_allocate_aligned(
+    const ARMD_MemoryAllocator *allocator, ARMD_Size size,
+    ARMD_Size alignment) {
+    if (!armd__is_valid_alignment(alignment)) {
+        return NULL;
+    }
+
+    // Keep the original pointer just before the aligned body
+    ARMD_Size prefix_size = sizeof(void *) + alignment - 1;
+    unsigned char *buf = armd_memory_allocator_allocate(
+        allocator, prefix_size + (size == 0 ? 1 : size));
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    void **body = (void **)armd__align_pointer(buf + sizeof(void *), alignment);
+    body[-1] = buf;
+
+    return body;
+}
+
+void armd_memory_allocator_free_aligned(const ARMD_MemoryAllocator *allocator,
+                                        void *buf) {
+    if (buf == NULL) {
+        return;
+    }
+
+    armd_memory_allocator_free(allocator, ((void **)buf)[-1]);
+}
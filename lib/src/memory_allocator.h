@@ -3,4 +3,11 @@
 
 #include <aramid/aramid.h>
 
+/* The alignment every allocation in the library satisfies by default */
+#define ARMD__DEFAULT_ALIGNMENT 16
+
+ARMD_EXTERN_C ARMD_Bool armd__is_valid_alignment(ARMD_Size alignment);
+ARMD_EXTERN_C ARMD_Size armd__align_size(ARMD_Size size, ARMD_Size alignment);
+ARMD_EXTERN_C void *armd__align_pointer(void *ptr, ARMD_Size alignment);
+
 #endif // ARAMID__MEMORY_ALLOCATOR_H
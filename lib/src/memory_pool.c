@@ -0,0 +1,331 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <aramid/aramid.h>
+
+#include "memory_pool.h"
+#include "os_memory.h"
+#include "spinlock.h"
+#include "thread.h"
+
+static const ARMD_Size object_alignment = 16;
+static const ARMD_Size chunk_size = 1024 * 1024;
+static const ARMD_Size refill_bytes = 8192;
+static const ARMD_Size max_batch_count = 32;
+
+/* Objects larger than the largest size class are allocated individually */
+static const ARMD_Size large_size_class = ARMD__MEMORY_POOL_NUM_SIZE_CLASSES;
+
+typedef struct {
+    ARMD_Size size_class;
+} ObjectHeader;
+
+static ARMD_Size get_header_size() {
+    return (sizeof(ObjectHeader) + object_alignment - 1) / object_alignment *
+           object_alignment;
+}
+
+/*
+ * Size classes are 16 bytes apart up to 128 bytes, then four classes per
+ * doubling up to 32 KiB.
+ */
+static ARMD_Size get_size_class(ARMD_Size size) {
+    ARMD_Size s = size == 0 ? 1 : size;
+    if (s <= 128) {
+        return (s + 15) / 16 - 1;
+    }
+
+    ARMD_Size p = 7;
+    while (((s - 1) >> (p + 1)) != 0) {
+        ++p;
+    }
+
+    return 8 + (p - 7) * 4 + ((s - 1 - ((ARMD_Size)1 << p)) >> (p - 2));
+}
+
+static ARMD_Size get_class_size(ARMD_Size size_class) {
+    if (size_class < 8) {
+        return (size_class + 1) * 16;
+    }
+
+    ARMD_Size p = 7 + (size_class - 8) / 4;
+    ARMD_Size r = (size_class - 8) % 4;
+    return ((ARMD_Size)1 << p) + ((r + 1) << (p - 2));
+}
+
+static ARMD_Size get_max_class_size() {
+    return get_class_size(ARMD__MEMORY_POOL_NUM_SIZE_CLASSES - 1);
+}
+
+static ARMD_Size get_stride(ARMD_Size size_class) {
+    return get_header_size() + get_class_size(size_class);
+}
+
+static ARMD_Size get_batch_count(ARMD_Size size_class) {
+    ARMD_Size count = refill_bytes / get_stride(size_class);
+    if (count < 2) {
+        return 2;
+    }
+    if (count > max_batch_count) {
+        return max_batch_count;
+    }
+    return count;
+}
+
+static ARMD__MemoryPoolCache *get_current_cache(ARMD__MemoryPool *pool) {
+    ARMD_Size slot = armd__thread_get_slot();
+    ARMD_Size last = ARMD__MEMORY_POOL_NUM_CACHES - 1;
+    return &pool->caches[slot < last ? slot : last];
+}
+
+/* Pool lock must be held */
+static int add_chunk(ARMD__MemoryPool *pool) {
+    unsigned char *buf = armd__os_memory_map(chunk_size);
+    if (buf == NULL) {
+        return -1;
+    }
+
+    ARMD__MemoryPoolChunk *chunk = (ARMD__MemoryPoolChunk *)buf;
+    chunk->next = pool->chunks;
+    chunk->size = chunk_size;
+    pool->chunks = chunk;
+
+    ARMD_Size chunk_header_size =
+        (sizeof(ARMD__MemoryPoolChunk) + object_alignment - 1) /
+        object_alignment * object_alignment;
+    pool->chunk_cursor = buf + chunk_header_size;
+    pool->chunk_remaining = chunk_size - chunk_header_size;
+
+    return 0;
+}
+
+/* Moves a batch of objects into the cache. Cache lock must be held. */
+static void refill(ARMD__MemoryPool *pool, ARMD__MemoryPoolCache *cache,
+                   ARMD_Size size_class) {
+    int res = 0;
+    (void)res;
+
+    ARMD_Size batch_count = get_batch_count(size_class);
+    ARMD_Size stride = get_stride(size_class);
+
+    res = armd__spinlock_lock(&pool->lock);
+    assert(res == 0);
+
+    ARMD_Size count = 0;
+    while (count < batch_count) {
+        ARMD__MemoryPoolFreeObject *object =
+            pool->central_free_lists[size_class];
+        if (object != NULL) {
+            pool->central_free_lists[size_class] = object->next;
+        } else {
+            if (pool->chunk_remaining < stride) {
+                if (add_chunk(pool)) {
+                    break;
+                }
+            }
+            object = (ARMD__MemoryPoolFreeObject *)pool->chunk_cursor;
+            pool->chunk_cursor += stride;
+            pool->chunk_remaining -= stride;
+        }
+
+        object->next = cache->free_lists[size_class];
+        cache->free_lists[size_class] = object;
+        ++count;
+    }
+
+    res = armd__spinlock_unlock(&pool->lock);
+    assert(res == 0);
+
+    cache->free_counts[size_class] += count;
+}
+
+/* Returns a batch of objects to the central list. Cache lock must be held. */
+static void flush(ARMD__MemoryPool *pool, ARMD__MemoryPoolCache *cache,
+                  ARMD_Size size_class) {
+    int res = 0;
+    (void)res;
+
+    ARMD_Size batch_count = get_batch_count(size_class);
+
+    ARMD__MemoryPoolFreeObject *first = cache->free_lists[size_class];
+    ARMD__MemoryPoolFreeObject *last = first;
+    for (ARMD_Size i = 1; i < batch_count; ++i) {
+        last = last->next;
+    }
+    cache->free_lists[size_class] = last->next;
+    cache->free_counts[size_class] -= batch_count;
+
+    res = armd__spinlock_lock(&pool->lock);
+    assert(res == 0);
+
+    last->next = pool->central_free_lists[size_class];
+    pool->central_free_lists[size_class] = first;
+
+    res = armd__spinlock_unlock(&pool->lock);
+    assert(res == 0);
+}
+
+static void *allocate_large(ARMD__MemoryPool *pool, ARMD_Size size) {
+    ARMD_Size total_size = get_header_size() + size;
+    unsigned char *buf =
+        pool->zero_fill ? calloc(1, total_size) : malloc(total_size);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    ((ObjectHeader *)buf)->size_class = large_size_class;
+
+    return buf + get_header_size();
+}
+
+static void *pooled_allocate(void *context, ARMD_Size size) {
+    int res = 0;
+    (void)res;
+
+    ARMD__MemoryPool *pool = (ARMD__MemoryPool *)context;
+
+    if (size > get_max_class_size()) {
+        return allocate_large(pool, size);
+    }
+
+    ARMD_Size size_class = get_size_class(size);
+    ARMD__MemoryPoolCache *cache = get_current_cache(pool);
+
+    res = armd__spinlock_lock(&cache->lock);
+    assert(res == 0);
+
+    if (cache->free_lists[size_class] == NULL) {
+        refill(pool, cache, size_class);
+    }
+
+    ARMD__MemoryPoolFreeObject *object = cache->free_lists[size_class];
+    if (object != NULL) {
+        cache->free_lists[size_class] = object->next;
+        --cache->free_counts[size_class];
+    }
+
+    res = armd__spinlock_unlock(&cache->lock);
+    assert(res == 0);
+
+    if (object == NULL) {
+        return NULL;
+    }
+
+    unsigned char *buf = (unsigned char *)object;
+    ((ObjectHeader *)buf)->size_class = size_class;
+
+    void *body = buf + get_header_size();
+    if (pool->zero_fill) {
+        memset(body, 0, size);
+    }
+
+    return body;
+}
+
+static void pooled_free(void *context, void *buf) {
+    int res = 0;
+    (void)res;
+
+    ARMD__MemoryPool *pool = (ARMD__MemoryPool *)context;
+
+    if (buf == NULL) {
+        return;
+    }
+
+    unsigned char *object_buf = ((unsigned char *)buf) - get_header_size();
+    ARMD_Size size_class = ((ObjectHeader *)object_buf)->size_class;
+
+    if (size_class == large_size_class) {
+        free(object_buf);
+        return;
+    }
+
+    ARMD__MemoryPoolFreeObject *object =
+        (ARMD__MemoryPoolFreeObject *)object_buf;
+    ARMD__MemoryPoolCache *cache = get_current_cache(pool);
+
+    res = armd__spinlock_lock(&cache->lock);
+    assert(res == 0);
+
+    object->next = cache->free_lists[size_class];
+    cache->free_lists[size_class] = object;
+    ++cache->free_counts[size_class];
+
+    if (cache->free_counts[size_class] >= 2 * get_batch_count(size_class)) {
+        flush(pool, cache, size_class);
+    }
+
+    res = armd__spinlock_unlock(&cache->lock);
+    assert(res == 0);
+}
+
+int armd_memory_allocator_init_pooled(ARMD_MemoryAllocator *memory_allocator,
+                                      ARMD_Bool zero_fill) {
+    int res = 0;
+    (void)res;
+
+    assert(memory_allocator != NULL);
+
+    ARMD__MemoryPool *pool = calloc(1, sizeof(ARMD__MemoryPool));
+    if (pool == NULL) {
+        return -1;
+    }
+
+    pool->zero_fill = zero_fill;
+
+    if (armd__spinlock_init(&pool->lock)) {
+        free(pool);
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < ARMD__MEMORY_POOL_NUM_CACHES; ++i) {
+        if (armd__spinlock_init(&pool->caches[i].lock)) {
+            for (ARMD_Size j = 0; j < i; ++j) {
+                res = armd__spinlock_deinit(&pool->caches[j].lock);
+                assert(res == 0);
+            }
+            res = armd__spinlock_deinit(&pool->lock);
+            assert(res == 0);
+            free(pool);
+            return -1;
+        }
+    }
+
+    memory_allocator->allocate = pooled_allocate;
+    memory_allocator->free = pooled_free;
+    memory_allocator->context = pool;
+
+    return 0;
+}
+
+void armd_memory_allocator_deinit_pooled(
+    ARMD_MemoryAllocator *memory_allocator) {
+    int res = 0;
+    (void)res;
+
+    assert(memory_allocator != NULL);
+    assert(memory_allocator->allocate == pooled_allocate);
+
+    ARMD__MemoryPool *pool = (ARMD__MemoryPool *)memory_allocator->context;
+
+    for (ARMD_Size i = 0; i < ARMD__MEMORY_POOL_NUM_CACHES; ++i) {
+        res = armd__spinlock_deinit(&pool->caches[i].lock);
+        assert(res == 0);
+    }
+    res = armd__spinlock_deinit(&pool->lock);
+    assert(res == 0);
+
+    ARMD__MemoryPoolChunk *chunk = pool->chunks;
+    while (chunk != NULL) {
+        ARMD__MemoryPoolChunk *next = chunk->next;
+        armd__os_memory_unmap(chunk, chunk->size);
+        chunk = next;
+    }
+
+    free(pool);
+
+    memory_allocator->allocate = NULL;
+    memory_allocator->free = NULL;
+    memory_allocator->context = NULL;
+}
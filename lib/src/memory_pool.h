@@ -0,0 +1,46 @@
+#ifndef ARAMID__MEMORY_POOL_H
+#define ARAMID__MEMORY_POOL_H
+
+#include <aramid/aramid.h>
+
+#include "spinlock.h"
+
+#define ARMD__MEMORY_POOL_NUM_SIZE_CLASSES 40
+#define ARMD__MEMORY_POOL_NUM_CACHES 64
+
+typedef struct TAG_ARMD__MemoryPoolFreeObject {
+    struct TAG_ARMD__MemoryPoolFreeObject *next;
+} ARMD__MemoryPoolFreeObject;
+
+/*
+ * Free objects kept per thread slot. Executors mostly hit their own cache, so
+ * its lock is rarely contended. The last cache is shared by the other threads.
+ */
+typedef struct TAG_ARMD__MemoryPoolCache {
+    ARMD__Spinlock lock;
+    ARMD__MemoryPoolFreeObject *free_lists[ARMD__MEMORY_POOL_NUM_SIZE_CLASSES];
+    ARMD_Size free_counts[ARMD__MEMORY_POOL_NUM_SIZE_CLASSES];
+    // Keep neighboring caches on separate cache lines
+    unsigned char padding[64];
+} ARMD__MemoryPoolCache;
+
+typedef struct TAG_ARMD__MemoryPoolChunk {
+    struct TAG_ARMD__MemoryPoolChunk *next;
+    ARMD_Size size;
+} ARMD__MemoryPoolChunk;
+
+typedef struct TAG_ARMD__MemoryPool {
+    ARMD_Bool zero_fill;
+
+    // Guards the central free lists and the chunks
+    ARMD__Spinlock lock;
+    ARMD__MemoryPoolFreeObject
+        *central_free_lists[ARMD__MEMORY_POOL_NUM_SIZE_CLASSES];
+    ARMD__MemoryPoolChunk *chunks;
+    unsigned char *chunk_cursor;
+    ARMD_Size chunk_remaining;
+
+    ARMD__MemoryPoolCache caches[ARMD__MEMORY_POOL_NUM_CACHES];
+} ARMD__MemoryPool;
+
+#endif // ARAMID__MEMORY_POOL_H
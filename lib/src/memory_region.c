@@ -1,45 +1,45 @@
 #include <assert.h>
 #include <string.h>
 
+#include "arena.h"
+#include "frame_stack.h"
 #include "memory_allocator.h"
 #include "memory_region.h"
 #include "spinlock.h"
+#include "thread.h"
 
-#ifdef ARAMID_DISABLE_MEMORY_REGION
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
-ARMD_MemoryRegion *
-armd_memory_region_create(const ARMD_MemoryAllocator *memory_allocator) {
-    ARMD_MemoryRegion *memory_region = armd_memory_allocator_allocate(
-        memory_allocator, sizeof(ARMD_MemoryRegion));
+#ifdef ARAMID_DISABLE_MEMORY_REGION
 
-    memory_region->memory_allocator = *memory_allocator;
+/* Ring: every allocation is passed through to the allocator */
 
-    return memory_region;
+static int ring_init(ARMD_MemoryRegion *memory_region, ARMD_Size num_shards) {
+    (void)memory_region;
+    (void)num_shards;
+    return 0;
 }
 
-ARMD_Size armd_memory_region_destroy(ARMD_MemoryRegion *memory_region) {
-    int res = 0;
-    (void)res;
-
-    if (memory_region == NULL) {
-        return 0;
-    }
-
-    ARMD_MemoryAllocator memory_allocator = memory_region->memory_allocator;
-
-    armd_memory_allocator_free(&memory_allocator, memory_region);
+static ARMD_Size ring_deinit(ARMD_MemoryRegion *memory_region) {
+    (void)memory_region;
+    return 0;
+}
 
+static ARMD_Size ring_reset(ARMD_MemoryRegion *memory_region) {
+    (void)memory_region;
     return 0;
 }
 
-void *armd_memory_region_allocate(ARMD_MemoryRegion *memory_region,
-                                  ARMD_Size size) {
-    return armd_memory_allocator_allocate(&memory_region->memory_allocator,
-                                          size);
+static void *ring_allocate(ARMD_MemoryRegion *memory_region, ARMD_Size size,
+                           ARMD_Size alignment) {
+    return armd_memory_allocator_allocate_aligned(
+        &memory_region->memory_allocator, size, alignment);
 }
 
-void armd_memory_region_free(ARMD_MemoryRegion *memory_region, void *buf) {
-    armd_memory_allocator_free(&memory_region->memory_allocator, buf);
+static void ring_free(ARMD_MemoryRegion *memory_region, void *buf) {
+    armd_memory_allocator_free_aligned(&memory_region->memory_allocator, buf);
 }
 
 #else
@@ -52,11 +52,12 @@ static ARMD_Size get_header_size() {
 }
 
 static int allocate_with_header(const ARMD_MemoryAllocator *memory_allocator,
-                                ARMD_Size body_size,
+                                ARMD_Size body_size, ARMD_Size alignment,
                                 ARMD__MemoryAllocationHeader **header,
                                 void **body) {
     ARMD_Size header_size = get_header_size();
-    ARMD_Size total_size = header_size + body_size;
+    ARMD_Size padding_size = alignment > header_alignment ? alignment - 1 : 0;
+    ARMD_Size total_size = header_size + padding_size + body_size;
 
     unsigned char *buf =
         armd_memory_allocator_allocate(memory_allocator, total_size);
@@ -66,8 +67,14 @@ static int allocate_with_header(const ARMD_MemoryAllocator *memory_allocator,
         return -1;
     }
 
-    *header = (ARMD__MemoryAllocationHeader *)buf;
-    *body = (void *)(buf + header_size);
+    unsigned char *body_buf = buf + header_size;
+    if (padding_size != 0) {
+        body_buf = armd__align_pointer(body_buf, alignment);
+    }
+
+    *header = (ARMD__MemoryAllocationHeader *)(body_buf - header_size);
+    (*header)->base_offset = (uint32_t)((unsigned char *)*header - buf);
+    *body = (void *)body_buf;
     return 0;
 }
 
@@ -79,124 +86,470 @@ static ARMD__MemoryAllocationHeader *get_header_by_body(void *body) {
 
 static void free_by_header(const ARMD_MemoryAllocator *memory_allocator,
                            ARMD__MemoryAllocationHeader *header) {
-    armd_memory_allocator_free(memory_allocator, header);
+    armd_memory_allocator_free(memory_allocator, ((unsigned char *)header) -
+                                                     header->base_offset);
 }
 
-ARMD_MemoryRegion *
-armd_memory_region_create(const ARMD_MemoryAllocator *memory_allocator) {
-    ARMD_MemoryRegion *memory_region = armd_memory_allocator_allocate(
-        memory_allocator, sizeof(ARMD_MemoryRegion));
-    if (memory_region == NULL) {
+/* Ring: allocations are linked into per-thread shards */
+
+static ARMD__MemoryRegionShard *get_shard(ARMD_MemoryRegion *memory_region,
+                                          ARMD_Size shard_index) {
+    return &memory_region->body.ring.shards[shard_index];
+}
+
+static ARMD_Size get_current_shard_index(ARMD_MemoryRegion *memory_region) {
+    ARMD_Size num_shards = memory_region->body.ring.num_shards;
+    ARMD_Size slot = armd__thread_get_slot();
+
+    // The last shard is shared by the threads other than executors
+    return slot < num_shards - 1 ? slot : num_shards - 1;
+}
+
+static void push_remote_free(ARMD__MemoryRegionShard *shard,
+                             ARMD__MemoryAllocationHeader *header) {
+#if defined(__GNUC__) || defined(__clang__)
+    ARMD__MemoryAllocationHeader *head =
+        __atomic_load_n(&shard->remote_frees, __ATOMIC_RELAXED);
+    do {
+        header->remote_next = head;
+    } while (!__atomic_compare_exchange_n(&shard->remote_frees, &head, header,
+                                          1, __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED));
+#elif defined(_MSC_VER)
+    ARMD__MemoryAllocationHeader *head;
+    do {
+        head = shard->remote_frees;
+        header->remote_next = head;
+    } while (_InterlockedCompareExchangePointer(
+                 (void *volatile *)&shard->remote_frees, header, head) != head);
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static ARMD__MemoryAllocationHeader *
+take_remote_frees(ARMD__MemoryRegionShard *shard) {
+#if defined(__GNUC__) || defined(__clang__)
+    if (__atomic_load_n(&shard->remote_frees, __ATOMIC_RELAXED) == NULL) {
         return NULL;
     }
-
-    ARMD__MemoryAllocationHeader *sentinel_header;
-    void *sentinel_body;
-    if (allocate_with_header(memory_allocator, 1, &sentinel_header,
-                             &sentinel_body)) {
-        armd_memory_allocator_free(memory_allocator, memory_region);
+    return __atomic_exchange_n(&shard->remote_frees, NULL, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    if (shard->remote_frees == NULL) {
         return NULL;
     }
+    return _InterlockedExchangePointer((void *volatile *)&shard->remote_frees,
+                                       NULL);
+#else
+#error Atomic implementation is not specified
+#endif
+}
 
-    sentinel_header->next = sentinel_header;
-    sentinel_header->prev = sentinel_header;
+/* Shard lock must be held */
+static void unlink_header(ARMD__MemoryAllocationHeader *header) {
+    ARMD__MemoryAllocationHeader *next = header->next;
+    ARMD__MemoryAllocationHeader *prev = header->prev;
 
-    memory_region->memory_allocator = *memory_allocator;
-    memory_region->ring = sentinel_header;
+    prev->next = next;
+    next->prev = prev;
 
-    if (armd__spinlock_init(&memory_region->lock)) {
-        armd_memory_allocator_free(memory_allocator, memory_region);
-        return NULL;
-    }
+    header->next = NULL;
+    header->prev = NULL;
+}
 
-    return memory_region;
+/* Shard lock must be held */
+static void unlink_remote_frees(ARMD__MemoryAllocationHeader *remote_frees) {
+    for (ARMD__MemoryAllocationHeader *header = remote_frees; header != NULL;
+         header = header->remote_next) {
+        unlink_header(header);
+    }
 }
 
-ARMD_Size armd_memory_region_destroy(ARMD_MemoryRegion *memory_region) {
-    int res = 0;
-    (void)res;
+static void free_remote_frees(const ARMD_MemoryAllocator *memory_allocator,
+                              ARMD__MemoryAllocationHeader *remote_frees) {
+    ARMD__MemoryAllocationHeader *header = remote_frees;
+    while (header != NULL) {
+        ARMD__MemoryAllocationHeader *next = header->remote_next;
+        free_by_header(memory_allocator, header);
+        header = next;
+    }
+}
 
-    if (memory_region == NULL) {
-        return 0;
+static ARMD_Size
+count_remote_frees(ARMD__MemoryAllocationHeader *remote_frees) {
+    ARMD_Size count = 0;
+    for (ARMD__MemoryAllocationHeader *header = remote_frees; header != NULL;
+         header = header->remote_next) {
+        ++count;
     }
+    return count;
+}
 
-    ARMD_MemoryAllocator memory_allocator = memory_region->memory_allocator;
+/* Frees all allocations in the shard and returns the number of them which
+ * were not freed by the user */
+static ARMD_Size clear_shard(const ARMD_MemoryAllocator *memory_allocator,
+                             ARMD__MemoryRegionShard *shard) {
+    int res = 0;
+    (void)res;
 
-    res = armd__spinlock_lock(&memory_region->lock);
+    res = armd__spinlock_lock(&shard->lock);
     assert(res == 0);
 
-    ARMD_Size non_freed_count = 0;
+    // Remote frees are still linked in the ring and freed below
+    ARMD_Size num_remote_frees = count_remote_frees(take_remote_frees(shard));
 
-    ARMD__MemoryAllocationHeader *header = memory_region->ring->next;
-    while (header != memory_region->ring) {
+    ARMD_Size num_allocations = 0;
+
+    ARMD__MemoryAllocationHeader *sentinel = &shard->sentinel;
+    ARMD__MemoryAllocationHeader *header = sentinel->next;
+    while (header != sentinel) {
         ARMD__MemoryAllocationHeader *next = header->next;
-        free_by_header(&memory_allocator, header);
+        free_by_header(memory_allocator, header);
         header = next;
 
-        ++non_freed_count;
+        ++num_allocations;
     }
-    free_by_header(&memory_allocator, memory_region->ring);
+    sentinel->next = sentinel;
+    sentinel->prev = sentinel;
 
-    res = armd__spinlock_unlock(&memory_region->lock);
+    res = armd__spinlock_unlock(&shard->lock);
     assert(res == 0);
 
-    armd_memory_allocator_free(&memory_allocator, memory_region);
+    return num_allocations - num_remote_frees;
+}
+
+static int ring_init(ARMD_MemoryRegion *memory_region, ARMD_Size num_shards) {
+    int res = 0;
+    (void)res;
+
+    if (num_shards == 0) {
+        return -1;
+    }
+
+    ARMD__MemoryRegionShard *shards = armd_memory_allocator_allocate(
+        &memory_region->memory_allocator,
+        sizeof(ARMD__MemoryRegionShard) * num_shards);
+    if (shards == NULL) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < num_shards; ++i) {
+        ARMD__MemoryRegionShard *shard = &shards[i];
+
+        if (armd__spinlock_init(&shard->lock)) {
+            for (ARMD_Size j = 0; j < i; ++j) {
+                res = armd__spinlock_deinit(&shards[j].lock);
+                assert(res == 0);
+            }
+            armd_memory_allocator_free(&memory_region->memory_allocator,
+                                       shards);
+            return -1;
+        }
+
+        shard->sentinel.next = &shard->sentinel;
+        shard->sentinel.prev = &shard->sentinel;
+        shard->sentinel.remote_next = NULL;
+        shard->sentinel.shard_index = (uint32_t)i;
+        shard->sentinel.base_offset = 0;
+        shard->remote_frees = NULL;
+    }
+
+    memory_region->body.ring.num_shards = num_shards;
+    memory_region->body.ring.shards = shards;
+
+    return 0;
+}
+
+static ARMD_Size ring_deinit(ARMD_MemoryRegion *memory_region) {
+    int res = 0;
+    (void)res;
+
+    ARMD_Size non_freed_count = 0;
+
+    for (ARMD_Size i = 0; i < memory_region->body.ring.num_shards; ++i) {
+        ARMD__MemoryRegionShard *shard = get_shard(memory_region, i);
+
+        non_freed_count +=
+            clear_shard(&memory_region->memory_allocator, shard);
+
+        res = armd__spinlock_deinit(&shard->lock);
+        assert(res == 0);
+    }
+
+    armd_memory_allocator_free(&memory_region->memory_allocator,
+                               memory_region->body.ring.shards);
+    memory_region->body.ring.shards = NULL;
 
     return non_freed_count;
 }
 
-void *armd_memory_region_allocate(ARMD_MemoryRegion *memory_region,
-                                  ARMD_Size size) {
+static ARMD_Size ring_reset(ARMD_MemoryRegion *memory_region) {
+    ARMD_Size freed_count = 0;
+
+    for (ARMD_Size i = 0; i < memory_region->body.ring.num_shards; ++i) {
+        freed_count += clear_shard(&memory_region->memory_allocator,
+                                   get_shard(memory_region, i));
+    }
+
+    return freed_count;
+}
+
+static void *ring_allocate(ARMD_MemoryRegion *memory_region, ARMD_Size size,
+                           ARMD_Size alignment) {
     int res = 0;
     (void)res;
 
     ARMD__MemoryAllocationHeader *header;
     void *body;
-    if (allocate_with_header(&memory_region->memory_allocator, size, &header,
-                             &body)) {
+    if (allocate_with_header(&memory_region->memory_allocator, size, alignment,
+                             &header, &body)) {
         return NULL;
     }
 
-    res = armd__spinlock_lock(&memory_region->lock);
+    ARMD_Size shard_index = get_current_shard_index(memory_region);
+    ARMD__MemoryRegionShard *shard = get_shard(memory_region, shard_index);
+    ARMD__MemoryAllocationHeader *sentinel = &shard->sentinel;
+
+    header->remote_next = NULL;
+    header->shard_index = (uint32_t)shard_index;
+
+    ARMD__MemoryAllocationHeader *remote_frees = take_remote_frees(shard);
+
+    res = armd__spinlock_lock(&shard->lock);
     assert(res == 0);
 
-    header->prev = memory_region->ring;
-    header->next = memory_region->ring->next;
+    header->prev = sentinel;
+    header->next = sentinel->next;
 
-    memory_region->ring->next = header;
+    sentinel->next = header;
     header->next->prev = header;
 
-    res = armd__spinlock_unlock(&memory_region->lock);
+    unlink_remote_frees(remote_frees);
+
+    res = armd__spinlock_unlock(&shard->lock);
     assert(res == 0);
 
+    free_remote_frees(&memory_region->memory_allocator, remote_frees);
+
     return body;
 }
 
-void armd_memory_region_free(ARMD_MemoryRegion *memory_region, void *buf) {
+static void ring_free(ARMD_MemoryRegion *memory_region, void *buf) {
     int res = 0;
     (void)res;
 
     ARMD__MemoryAllocationHeader *header = get_header_by_body(buf);
+    ARMD__MemoryRegionShard *shard =
+        get_shard(memory_region, header->shard_index);
 
-    res = armd__spinlock_lock(&memory_region->lock);
-    assert(res == 0);
+    if (header->shard_index != get_current_shard_index(memory_region)) {
+        push_remote_free(shard, header);
+        return;
+    }
 
-    ARMD__MemoryAllocationHeader *next = header->next;
-    ARMD__MemoryAllocationHeader *prev = header->prev;
+    ARMD__MemoryAllocationHeader *remote_frees = take_remote_frees(shard);
+
+    res = armd__spinlock_lock(&shard->lock);
+    assert(res == 0);
 
-    header->prev->next = next;
-    header->next->prev = prev;
+    unlink_header(header);
+    unlink_remote_frees(remote_frees);
 
-    res = armd__spinlock_unlock(&memory_region->lock);
+    res = armd__spinlock_unlock(&shard->lock);
     assert(res == 0);
 
-    header->next = NULL;
-    header->prev = NULL;
     free_by_header(&memory_region->memory_allocator, header);
+    free_remote_frees(&memory_region->memory_allocator, remote_frees);
+}
+
+#endif
+
+/* Public API */
+
+static ARMD_MemoryRegion *
+allocate_memory_region(const ARMD_MemoryAllocator *memory_allocator,
+                       ARMD__MemoryRegionType type) {
+    ARMD_MemoryRegion *memory_region = armd_memory_allocator_allocate(
+        memory_allocator, sizeof(ARMD_MemoryRegion));
+    if (memory_region == NULL) {
+        return NULL;
+    }
+
+    memory_region->type = type;
+    memory_region->memory_allocator = *memory_allocator;
+
+    return memory_region;
+}
+
+ARMD_MemoryRegion *
+armd_memory_region_create(const ARMD_MemoryAllocator *memory_allocator) {
+    ARMD_MemoryRegion *memory_region = allocate_memory_region(
+        memory_allocator, ARMD__MemoryRegionType_Ring);
+    if (memory_region == NULL) {
+        return NULL;
+    }
+
+    if (ring_init(memory_region, 1)) {
+        armd_memory_allocator_free(memory_allocator, memory_region);
+        return NULL;
+    }
+
+    return memory_region;
+}
+
+ARMD_MemoryRegion *
+armd__memory_region_create_sharded(const ARMD_MemoryAllocator *memory_allocator,
+                                   ARMD_Size num_shards) {
+    ARMD_MemoryRegion *memory_region = allocate_memory_region(
+        memory_allocator, ARMD__MemoryRegionType_Ring);
+    if (memory_region == NULL) {
+        return NULL;
+    }
+
+    if (ring_init(memory_region, num_shards)) {
+        armd_memory_allocator_free(memory_allocator, memory_region);
+        return NULL;
+    }
+
+    return memory_region;
 }
 
+ARMD_MemoryRegion *
+armd_memory_region_create_arena(const ARMD_MemoryAllocator *memory_allocator,
+                                ARMD_Size block_size) {
+    ARMD_MemoryRegion *memory_region = allocate_memory_region(
+        memory_allocator, ARMD__MemoryRegionType_Arena);
+    if (memory_region == NULL) {
+        return NULL;
+    }
+
+#ifdef ARAMID_DISABLE_MEMORY_REGION
+    // Give every allocation its own block
+    block_size = 0;
 #endif
 
+    if (armd__arena_init(&memory_region->body.arena, memory_allocator,
+                         block_size)) {
+        armd_memory_allocator_free(memory_allocator, memory_region);
+        return NULL;
+    }
+
+    return memory_region;
+}
+
+ARMD_MemoryRegion *armd__memory_region_create_frame_stack(
+    const ARMD_MemoryAllocator *memory_allocator,
+    ARMD_MemoryRegion *fallback_memory_region, ARMD_Size chunk_size) {
+#ifdef ARAMID_DISABLE_MEMORY_REGION
+    (void)fallback_memory_region;
+    (void)chunk_size;
+
+    return armd_memory_region_create(memory_allocator);
+#else
+    ARMD_MemoryRegion *memory_region = allocate_memory_region(
+        memory_allocator, ARMD__MemoryRegionType_FrameStack);
+    if (memory_region == NULL) {
+        return NULL;
+    }
+
+    if (armd__frame_stack_init(&memory_region->body.frame_stack,
+                               memory_allocator, fallback_memory_region,
+                               chunk_size)) {
+        armd_memory_allocator_free(memory_allocator, memory_region);
+        return NULL;
+    }
+
+    return memory_region;
+#endif
+}
+
+ARMD_Size armd_memory_region_destroy(ARMD_MemoryRegion *memory_region) {
+    if (memory_region == NULL) {
+        return 0;
+    }
+
+    ARMD_MemoryAllocator memory_allocator = memory_region->memory_allocator;
+
+    ARMD_Size non_freed_count = 0;
+    switch (memory_region->type) {
+    case ARMD__MemoryRegionType_Ring:
+        non_freed_count = ring_deinit(memory_region);
+        break;
+    case ARMD__MemoryRegionType_FrameStack:
+        non_freed_count =
+            armd__frame_stack_deinit(&memory_region->body.frame_stack);
+        break;
+    case ARMD__MemoryRegionType_Arena:
+        non_freed_count = armd__arena_deinit(&memory_region->body.arena);
+        break;
+    default:
+        assert(0);
+        break;
+    }
+
+    armd_memory_allocator_free(&memory_allocator, memory_region);
+
+    return non_freed_count;
+}
+
+ARMD_Size armd_memory_region_reset(ARMD_MemoryRegion *memory_region) {
+    switch (memory_region->type) {
+    case ARMD__MemoryRegionType_Ring:
+        return ring_reset(memory_region);
+    case ARMD__MemoryRegionType_Arena:
+        return armd__arena_reset(&memory_region->body.arena);
+    case ARMD__MemoryRegionType_FrameStack:
+        // Frames are owned by jobs
+    default:
+        assert(0);
+        return 0;
+    }
+}
+
+void *armd_memory_region_allocate(ARMD_MemoryRegion *memory_region,
+                                  ARMD_Size size) {
+    return armd_memory_region_allocate_aligned(memory_region, size,
+                                               ARMD__DEFAULT_ALIGNMENT);
+}
+
+void *armd_memory_region_allocate_aligned(ARMD_MemoryRegion *memory_region,
+                                          ARMD_Size size, ARMD_Size alignment) {
+    if (!armd__is_valid_alignment(alignment)) {
+        return NULL;
+    }
+
+    switch (memory_region->type) {
+    case ARMD__MemoryRegionType_Ring:
+        return ring_allocate(memory_region, size, alignment);
+    case ARMD__MemoryRegionType_FrameStack:
+        return armd__frame_stack_allocate(&memory_region->body.frame_stack,
+                                          size, alignment);
+    case ARMD__MemoryRegionType_Arena:
+        return armd__arena_allocate(&memory_region->body.arena, size,
+                                    alignment);
+    default:
+        assert(0);
+        return NULL;
+    }
+}
+
+void armd_memory_region_free(ARMD_MemoryRegion *memory_region, void *buf) {
+    switch (memory_region->type) {
+    case ARMD__MemoryRegionType_Ring:
+        ring_free(memory_region, buf);
+        break;
+    case ARMD__MemoryRegionType_FrameStack:
+        armd__frame_stack_free(&memory_region->body.frame_stack, buf);
+        break;
+    case ARMD__MemoryRegionType_Arena:
+        // Released all at once on reset or destroy
+        break;
+    default:
+        assert(0);
+        break;
+    }
+}
+
 char *armd_memory_region_strdup(ARMD_MemoryRegion *memory_region,
                                 const char *str) {
     size_t length = strlen(str);
@@ -3,19 +3,58 @@
 
 #include <aramid/aramid.h>
 
+#include "arena.h"
+#include "frame_stack.h"
 #include "memory_allocator.h"
 #include "spinlock.h"
 
 typedef struct TAG_ARMD__MemoryAllocationHeader {
     struct TAG_ARMD__MemoryAllocationHeader *prev;
     struct TAG_ARMD__MemoryAllocationHeader *next;
+    struct TAG_ARMD__MemoryAllocationHeader *remote_next;
+    uint32_t shard_index;
+    // Distance from the pointer returned by the allocator
+    uint32_t base_offset;
 } ARMD__MemoryAllocationHeader;
 
+/*
+ * A ring of allocations guarded by its own lock. Frees from threads which do
+ * not own the shard are pushed onto remote_frees without locking and unlinked
+ * later by the owner.
+ */
+typedef struct TAG_ARMD__MemoryRegionShard {
+    ARMD__Spinlock lock;
+    ARMD__MemoryAllocationHeader sentinel;
+    ARMD__MemoryAllocationHeader *volatile remote_frees;
+    // Keep the hot fields of neighboring shards on separate cache lines
+    unsigned char padding[64];
+} ARMD__MemoryRegionShard;
+
+typedef enum TAG_ARMD__MemoryRegionType {
+    ARMD__MemoryRegionType_Ring,
+    ARMD__MemoryRegionType_FrameStack,
+    ARMD__MemoryRegionType_Arena,
+} ARMD__MemoryRegionType;
+
 struct TAG_ARMD_MemoryRegion {
+    ARMD__MemoryRegionType type;
     ARMD_MemoryAllocator memory_allocator;
 
-    ARMD__Spinlock lock;
-    ARMD__MemoryAllocationHeader *ring;
+    union {
+        struct {
+            ARMD_Size num_shards;
+            ARMD__MemoryRegionShard *shards;
+        } ring;
+        ARMD__FrameStack frame_stack;
+        ARMD__Arena arena;
+    } body;
 };
 
+ARMD_EXTERN_C ARMD_MemoryRegion *
+armd__memory_region_create_sharded(const ARMD_MemoryAllocator *memory_allocator,
+                                   ARMD_Size num_shards);
+ARMD_EXTERN_C ARMD_MemoryRegion *armd__memory_region_create_frame_stack(
+    const ARMD_MemoryAllocator *memory_allocator,
+    ARMD_MemoryRegion *fallback_memory_region, ARMD_Size chunk_size);
+
 #endif // ARAMID__MEMORY_REGION_H
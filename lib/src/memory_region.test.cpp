@@ -0,0 +1,112 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "memory_region.h"
+#include "thread.h"
+
+// Memory regions pass every allocation through to the allocator when memory
+// region feature is disabled
+#ifndef ARAMID_DISABLE_MEMORY_REGION
+
+namespace {
+
+class ShardedMemoryRegionTest : public ::testing::Test {
+protected:
+    static const ARMD_Size num_threads = 4;
+
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_MemoryRegion *memory_region;
+
+    ShardedMemoryRegionTest() {}
+
+    ~ShardedMemoryRegionTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        memory_region = armd__memory_region_create_sharded(&memory_allocator,
+                                                           num_threads + 1);
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(ShardedMemoryRegionTest, AllocateOnEachShard) {
+    std::vector<std::thread> threads;
+    for (ARMD_Size i = 0; i < num_threads; ++i) {
+        threads.emplace_back([this, i] {
+            armd__thread_set_slot(i);
+            for (int j = 0; j < 100; ++j) {
+                armd_memory_region_allocate(memory_region, 16);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (ARMD_Size i = 0; i < num_threads; ++i) {
+        ARMD__MemoryRegionShard *shard = &memory_region->body.ring.shards[i];
+        ARMD_Size count = 0;
+        for (ARMD__MemoryAllocationHeader *header = shard->sentinel.next;
+             header != &shard->sentinel; header = header->next) {
+            ASSERT_EQ(header->shard_index, i);
+            ++count;
+        }
+        ASSERT_EQ(count, 100u);
+    }
+
+    ASSERT_EQ(armd_memory_region_destroy(memory_region), num_threads * 100);
+}
+
+TEST_F(ShardedMemoryRegionTest, RemoteFree) {
+    std::vector<void *> bufs;
+    for (int i = 0; i < 64; ++i) {
+        bufs.push_back(armd_memory_region_allocate(memory_region, 16));
+    }
+
+    // Free from executor threads so that all of them are remote
+    std::vector<std::thread> threads;
+    for (ARMD_Size i = 0; i < num_threads; ++i) {
+        threads.emplace_back([this, i, &bufs] {
+            armd__thread_set_slot(i);
+            for (ARMD_Size j = i; j < bufs.size(); j += num_threads) {
+                armd_memory_region_free(memory_region, bufs[j]);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    ARMD__MemoryRegionShard *shard =
+        &memory_region->body.ring.shards[num_threads];
+    ASSERT_NE(shard->remote_frees, nullptr);
+
+    // The owner drains remote frees on its next operation
+    ASSERT_NE(armd_memory_region_allocate(memory_region, 16), nullptr);
+    ASSERT_EQ(shard->remote_frees, nullptr);
+    ASSERT_EQ(shard->sentinel.next->next, &shard->sentinel);
+
+    ASSERT_EQ(armd_memory_region_destroy(memory_region), 1u);
+}
+
+TEST_F(ShardedMemoryRegionTest, DestroyCountsRemoteFreesAsFreed) {
+    void *a = armd_memory_region_allocate(memory_region, 16);
+    armd_memory_region_allocate(memory_region, 16);
+
+    std::thread thread([this, a] {
+        armd__thread_set_slot(0);
+        armd_memory_region_free(memory_region, a);
+    });
+    thread.join();
+
+    ASSERT_EQ(armd_memory_region_destroy(memory_region), 1u);
+}
+
+} // namespace
+
+#endif
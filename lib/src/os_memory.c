@@ -0,0 +1,151 @@
+#include <aramid/aramid.h>
+
+#include "os_memory.h"
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+void *armd__os_memory_map(ARMD_Size size) {
+    return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void armd__os_memory_unmap(void *buf, ARMD_Size size) {
+    (void)size;
+    VirtualFree(buf, 0, MEM_RELEASE);
+}
+
+ARMD_Size armd__os_memory_get_page_size(void) {
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return (ARMD_Size)system_info.dwPageSize;
+}
+
+void *armd__os_memory_map_huge(ARMD_Size size) {
+    // Large pages need SeLockMemoryPrivilege, so use normal pages
+    return armd__os_memory_map(size);
+}
+
+void *armd__os_memory_map_file(const char *path, ARMD_Size size) {
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    HANDLE mapping =
+        CreateFileMappingA(file, NULL, PAGE_READWRITE,
+                           (DWORD)((unsigned long long)size >> 32),
+                           (DWORD)(size & 0xffffffffu), NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return NULL;
+    }
+
+    // The view keeps the mapping and the file open
+    void *buf = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    CloseHandle(mapping);
+
+    return buf;
+}
+
+void armd__os_memory_unmap_file(void *buf, ARMD_Size size) {
+    (void)size;
+    UnmapViewOfFile(buf);
+}
+
+#elif defined(unix) || defined(__unix__) || defined(__unix) ||                 \
+    defined(__APPLE__)
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+void *armd__os_memory_map(ARMD_Size size) {
+    void *buf = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {
+        return NULL;
+    }
+
+    return buf;
+}
+
+void armd__os_memory_unmap(void *buf, ARMD_Size size) { munmap(buf, size); }
+
+ARMD_Size armd__os_memory_get_page_size(void) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) {
+        return 4096;
+    }
+
+    return (ARMD_Size)page_size;
+}
+
+void *armd__os_memory_map_huge(ARMD_Size size) {
+#if defined(MAP_HUGETLB)
+    void *huge_buf = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (huge_buf != MAP_FAILED) {
+        return huge_buf;
+    }
+#endif
+
+    // Map extra space and trim it so that huge pages can cover the whole area
+    ARMD_Size mapped_size = size + ARMD__HUGE_PAGE_SIZE;
+    unsigned char *buf = armd__os_memory_map(mapped_size);
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    unsigned char *aligned_buf =
+        (unsigned char *)(((uintptr_t)buf + ARMD__HUGE_PAGE_SIZE - 1) &
+                          ~(uintptr_t)(ARMD__HUGE_PAGE_SIZE - 1));
+    ARMD_Size head_size = (ARMD_Size)(aligned_buf - buf);
+    ARMD_Size tail_size = mapped_size - head_size - size;
+    if (head_size != 0) {
+        munmap(buf, head_size);
+    }
+    if (tail_size != 0) {
+        munmap(aligned_buf + size, tail_size);
+    }
+
+#if defined(MADV_HUGEPAGE)
+    // Failure only means transparent huge pages are not available
+    madvise(aligned_buf, size, MADV_HUGEPAGE);
+#endif
+
+    return aligned_buf;
+}
+
+void *armd__os_memory_map_file(const char *path, ARMD_Size size) {
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void *buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping keeps the file open
+    close(fd);
+    if (buf == MAP_FAILED) {
+        return NULL;
+    }
+
+    return buf;
+}
+
+void armd__os_memory_unmap_file(void *buf, ARMD_Size size) {
+    munmap(buf, size);
+}
+
+#elif ARAMID_EDITOR
+#else
+#error OS not supported
+#endif
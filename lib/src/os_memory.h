@@ -0,0 +1,34 @@
+#ifndef ARAMID__OS_MEMORY_H
+#define ARAMID__OS_MEMORY_H
+
+#include <aramid/aramid.h>
+
+/*
+ * Maps zero-filled pages directly from the OS. The size should be a multiple
+ * of the page size. Returns NULL if failed.
+ */
+ARMD_EXTERN_C void *armd__os_memory_map(ARMD_Size size);
+ARMD_EXTERN_C void armd__os_memory_unmap(void *buf, ARMD_Size size);
+
+/* The granularity in which the OS places pages, not the huge page size */
+ARMD_EXTERN_C ARMD_Size armd__os_memory_get_page_size(void);
+
+#define ARMD__HUGE_PAGE_SIZE ((ARMD_Size)2 * 1024 * 1024)
+
+/*
+ * Same as armd__os_memory_map but tries to back the pages with huge pages.
+ * It uses explicit huge pages if the system has reserved ones, then
+ * transparent huge pages, and normal pages at last. The size should be a
+ * multiple of ARMD__HUGE_PAGE_SIZE. Free it with armd__os_memory_unmap.
+ */
+ARMD_EXTERN_C void *armd__os_memory_map_huge(ARMD_Size size);
+
+/*
+ * Creates or truncates the file and maps it shared, so that the stores reach
+ * the file even if the process is killed. The file is zero-filled. Returns
+ * NULL if failed.
+ */
+ARMD_EXTERN_C void *armd__os_memory_map_file(const char *path, ARMD_Size size);
+ARMD_EXTERN_C void armd__os_memory_unmap_file(void *buf, ARMD_Size size);
+
+#endif // ARAMID__OS_MEMORY_H
@@ -0,0 +1,120 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#include "perf_counter.h"
+
+#if defined(__linux__)
+
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int open_counter(uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // Counting user space only works with perf_event_paranoid up to 2
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // The calling thread on any CPU
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+int armd__perf_counter_group_open(ARMD__PerfCounterGroup *group) {
+    assert(group != NULL);
+
+    static const uint64_t configs[ARMD__PerfCounterType_Count] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    for (ARMD_Size i = 0; i < ARMD__PerfCounterType_Count; ++i) {
+        group->fds[i] = -1;
+    }
+
+    group->fds[0] = open_counter(configs[0], -1);
+    if (group->fds[0] < 0) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 1; i < ARMD__PerfCounterType_Count; ++i) {
+        group->fds[i] = open_counter(configs[i], group->fds[0]);
+    }
+
+    return 0;
+}
+
+void armd__perf_counter_group_close(ARMD__PerfCounterGroup *group) {
+    assert(group != NULL);
+
+    // Members first, then the leader
+    for (ARMD_Size i = ARMD__PerfCounterType_Count; i > 0; --i) {
+        if (group->fds[i - 1] >= 0) {
+            close(group->fds[i - 1]);
+            group->fds[i - 1] = -1;
+        }
+    }
+}
+
+int armd__perf_counter_group_read(ARMD__PerfCounterGroup *group,
+                                  uint64_t *values) {
+    assert(group != NULL);
+    assert(values != NULL);
+
+    // The number of counters followed by the values of the opened ones
+    uint64_t buf[1 + ARMD__PerfCounterType_Count];
+    ssize_t read_size = read(group->fds[0], buf, sizeof(buf));
+    if (read_size < (ssize_t)sizeof(uint64_t)) {
+        return -1;
+    }
+
+    ARMD_Size value_index = 1;
+    for (ARMD_Size i = 0; i < ARMD__PerfCounterType_Count; ++i) {
+        if (group->fds[i] < 0) {
+            values[i] = 0;
+            continue;
+        }
+
+        assert(value_index <= buf[0]);
+        values[i] = buf[value_index++];
+    }
+
+    return 0;
+}
+
+#else
+
+int armd__perf_counter_group_open(ARMD__PerfCounterGroup *group) {
+    assert(group != NULL);
+
+    for (ARMD_Size i = 0; i < ARMD__PerfCounterType_Count; ++i) {
+        group->fds[i] = -1;
+    }
+
+    return -1;
+}
+
+void armd__perf_counter_group_close(ARMD__PerfCounterGroup *group) {
+    assert(group != NULL);
+    (void)group;
+}
+
+int armd__perf_counter_group_read(ARMD__PerfCounterGroup *group,
+                                  uint64_t *values) {
+    assert(group != NULL);
+    assert(values != NULL);
+    (void)group;
+    (void)values;
+
+    return -1;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef ARAMID__PERF_COUNTER_H
+#define ARAMID__PERF_COUNTER_H
+
+#include <aramid/aramid.h>
+
+typedef enum TAG_ARMD__PerfCounterType {
+    ARMD__PerfCounterType_Cycles,
+    ARMD__PerfCounterType_Instructions,
+    ARMD__PerfCounterType_CacheMisses,
+    ARMD__PerfCounterType_BranchMisses,
+    ARMD__PerfCounterType_Count,
+} ARMD__PerfCounterType;
+
+/*
+ * Hardware counters of the thread which opened them, scheduled onto the PMU
+ * as one group so that the ratios stay meaningful under multiplexing. The
+ * first counter is the group leader; the others are -1 if the PMU does not
+ * support them and read as zero.
+ */
+typedef struct TAG_ARMD__PerfCounterGroup {
+    int fds[ARMD__PerfCounterType_Count];
+} ARMD__PerfCounterGroup;
+
+/* Fails unless on Linux with perf events accessible to the process */
+ARMD_EXTERN_C int armd__perf_counter_group_open(ARMD__PerfCounterGroup *group);
+ARMD_EXTERN_C void
+armd__perf_counter_group_close(ARMD__PerfCounterGroup *group);
+ARMD_EXTERN_C int armd__perf_counter_group_read(ARMD__PerfCounterGroup *group,
+                                                uint64_t *values);
+
+#endif // ARAMID__PERF_COUNTER_H
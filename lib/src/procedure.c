@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <string.h>
 
 #include <aramid/aramid.h>
 
@@ -10,7 +11,7 @@ int armd_procedure_destroy(ARMD_Procedure *procedure) {
 
     ARMD_MemoryAllocator memory_allocator = procedure->memory_allocator;
 
-    armd_memory_allocator_free(&memory_allocator, procedure->constants);
+    armd_memory_allocator_free_aligned(&memory_allocator, procedure->constants);
     procedure->constants = NULL;
 
     for (ARMD_Size i = 0; i < procedure->num_continuations; i++) {
@@ -23,6 +24,11 @@ int armd_procedure_destroy(ARMD_Procedure *procedure) {
     armd_memory_allocator_free(&memory_allocator, procedure->continuations);
     procedure->continuations = NULL;
 
+    if (procedure->name != NULL) {
+        armd_memory_allocator_free(&memory_allocator, procedure->name);
+        procedure->name = NULL;
+    }
+
     armd_memory_allocator_free(&memory_allocator, procedure);
 
     return 0;
@@ -31,3 +37,45 @@ int armd_procedure_destroy(ARMD_Procedure *procedure) {
 void *armd_procedure_get_constants(ARMD_Procedure *procedure) {
     return procedure->constants;
 }
+
+int armd_procedure_set_name(ARMD_Procedure *procedure, const char *name) {
+    assert(procedure != NULL);
+
+    char *new_name = NULL;
+    if (name != NULL) {
+        ARMD_Size size = strlen(name) + 1;
+        new_name =
+            armd_memory_allocator_allocate(&procedure->memory_allocator, size);
+        if (new_name == NULL) {
+            return -1;
+        }
+        memcpy(new_name, name, size);
+    }
+
+    if (procedure->name != NULL) {
+        armd_memory_allocator_free(&procedure->memory_allocator,
+                                   procedure->name);
+    }
+    procedure->name = new_name;
+
+    return 0;
+}
+
+const char *armd_procedure_get_name(const ARMD_Procedure *procedure) {
+    assert(procedure != NULL);
+
+    return procedure->name;
+}
+
+ARMD_Size
+armd_procedure_get_num_continuations(const ARMD_Procedure *procedure) {
+    assert(procedure != NULL);
+
+    return procedure->num_continuations;
+}
+
+ARMD_Size armd_procedure_get_result_size(const ARMD_Procedure *procedure) {
+    assert(procedure != NULL);
+
+    return procedure->result_size;
+}
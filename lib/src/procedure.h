@@ -18,6 +18,8 @@ struct TAG_ARMD_Procedure {
     ARMD_MemoryAllocator memory_allocator;
     // frame
     ARMD_Size frame_size;
+    // alignment of frame and constants
+    ARMD_Size alignment;
     // constants
     void *constants;
     // continuations
@@ -27,6 +29,10 @@ struct TAG_ARMD_Procedure {
     ARMD_SetupFunc setup_func;
     // unwind
     ARMD_UnwindFunc unwind_func;
+    // size of the result stored in the promise
+    ARMD_Size result_size;
+    // name for profiling, nullable
+    char *name;
 };
 
 #endif // ARAMID__PROCEDURE_H
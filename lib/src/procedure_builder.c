@@ -9,8 +9,19 @@
 ARMD_ProcedureBuilder *
 armd_procedure_builder_create(const ARMD_MemoryAllocator *memory_allocator,
                               ARMD_Size constant_size, ARMD_Size frame_size) {
+    return armd_procedure_builder_create_aligned(
+        memory_allocator, constant_size, frame_size, ARMD__DEFAULT_ALIGNMENT);
+}
+
+ARMD_ProcedureBuilder *armd_procedure_builder_create_aligned(
+    const ARMD_MemoryAllocator *memory_allocator, ARMD_Size constant_size,
+    ARMD_Size frame_size, ARMD_Size alignment) {
     const ARMD_Size initial_size = 8;
 
+    if (!armd__is_valid_alignment(alignment)) {
+        return NULL;
+    }
+
     int builder_initialized = 0;
     int constants_initialized = 0;
     int continuation_buffer_initialized = 0;
@@ -26,8 +37,9 @@ armd_procedure_builder_create(const ARMD_MemoryAllocator *memory_allocator,
 
     builder->memory_allocator = *memory_allocator;
     builder->frame_size = frame_size;
-    builder->constants = armd_memory_allocator_allocate(
-        memory_allocator, constant_size == 0 ? 1 : constant_size);
+    builder->alignment = alignment;
+    builder->constants = armd_memory_allocator_allocate_aligned(
+        memory_allocator, constant_size == 0 ? 1 : constant_size, alignment);
     if (builder->constants == NULL) {
         goto error;
     }
@@ -43,13 +55,16 @@ armd_procedure_builder_create(const ARMD_MemoryAllocator *memory_allocator,
     continuation_buffer_initialized =
         1; // NOLINT(clang-analyzer-deadcode.DeadStores)
 
+    builder->setup_func = NULL;
     builder->unwind_func = NULL;
+    builder->result_size = 0;
 
     return builder;
 
 error:
     if (constants_initialized) {
-        armd_memory_allocator_free(memory_allocator, builder->constants);
+        armd_memory_allocator_free_aligned(memory_allocator,
+                                           builder->constants);
     }
 
     if (continuation_buffer_initialized) {
@@ -69,7 +84,7 @@ int armd_procedure_builder_destroy(ARMD_ProcedureBuilder *builder) {
 
     ARMD_MemoryAllocator memory_allocator = builder->memory_allocator;
 
-    armd_memory_allocator_free(&memory_allocator, builder->constants);
+    armd_memory_allocator_free_aligned(&memory_allocator, builder->constants);
     builder->constants = NULL;
 
     for (ARMD_Size i = 0; i < builder->num_continuations; i++) {
@@ -218,6 +233,15 @@ int armd_unwind(ARMD_ProcedureBuilder *builder, ARMD_UnwindFunc unwind_func) {
     return 0;
 }
 
+int armd_procedure_builder_set_result_size(ARMD_ProcedureBuilder *builder,
+                                           ARMD_Size result_size) {
+    assert(builder != NULL);
+
+    builder->result_size = result_size;
+
+    return 0;
+}
+
 ARMD_Procedure *
 armd_procedure_builder_build_and_destroy(ARMD_ProcedureBuilder *builder) {
     assert(builder != NULL);
@@ -232,9 +256,13 @@ armd_procedure_builder_build_and_destroy(ARMD_ProcedureBuilder *builder) {
     procedure->memory_allocator = builder->memory_allocator;
     procedure->continuations = builder->continuation_buffer;
     procedure->frame_size = builder->frame_size;
+    procedure->alignment = builder->alignment;
     procedure->constants = builder->constants;
     procedure->num_continuations = builder->num_continuations;
+    procedure->setup_func = builder->setup_func;
     procedure->unwind_func = builder->unwind_func;
+    procedure->result_size = builder->result_size;
+    procedure->name = NULL;
 
     armd_memory_allocator_free(&procedure->memory_allocator, builder);
 
@@ -10,6 +10,8 @@ struct TAG_ARMD_ProcedureBuilder {
     ARMD_MemoryAllocator memory_allocator;
     // frame
     ARMD_Size frame_size;
+    // alignment of frame and constants
+    ARMD_Size alignment;
     // constants
     void *constants;
     // continuations
@@ -18,6 +20,7 @@ struct TAG_ARMD_ProcedureBuilder {
     ARMD__Continuation *continuation_buffer;
     ARMD_SetupFunc setup_func;
     ARMD_UnwindFunc unwind_func;
+    ARMD_Size result_size;
 };
 
 #endif
@@ -0,0 +1,520 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#include "profiler.h"
+
+#include "context.h"
+#include "executor.h"
+#include "procedure.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static ARMD_Handle get_key(const ARMD_Procedure *procedure) {
+    return (ARMD_Handle)(uintptr_t)procedure;
+}
+
+static void publish_profiler(ARMD__Executor *executor,
+                             ARMD__Profiler *profiler) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&executor->profiler, profiler, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchangePointer((void *volatile *)&executor->profiler,
+                                profiler);
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+ARMD__Profiler *
+armd__profiler_create(const ARMD_MemoryAllocator *memory_allocator) {
+    assert(memory_allocator != NULL);
+
+    const ARMD_Size initial_table_size = 16;
+    int res = 0;
+    (void)res;
+
+    int memory_region_initialized = 0;
+    int profiler_initialized = 0;
+    int procedure_profiles_initialized = 0;
+
+    ARMD__Profiler *profiler = NULL;
+
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create(memory_allocator);
+    if (memory_region == NULL) {
+        goto error;
+    }
+    memory_region_initialized = 1;
+
+    profiler =
+        armd_memory_region_allocate(memory_region, sizeof(ARMD__Profiler));
+    if (profiler == NULL) {
+        goto error;
+    }
+    profiler_initialized = 1;
+
+    profiler->memory_region = memory_region;
+    profiler->first_profile = NULL;
+    profiler->perf_counter_state = ARMD__PerfCounterState_NotOpened;
+
+    profiler->procedure_profiles =
+        armd__hash_table_create(memory_region, initial_table_size, 0.5f);
+    if (profiler->procedure_profiles == NULL) {
+        goto error;
+    }
+    procedure_profiles_initialized = 1;
+
+    if (armd__spinlock_init(&profiler->lock)) {
+        goto error;
+    }
+
+    return profiler;
+
+error:
+    if (procedure_profiles_initialized) {
+        res = armd__hash_table_destroy(profiler->procedure_profiles);
+        assert(res == 0);
+    }
+
+    if (profiler_initialized) {
+        armd_memory_region_free(memory_region, profiler);
+    }
+
+    if (memory_region_initialized) {
+        armd_memory_region_destroy(memory_region);
+    }
+
+    return NULL;
+}
+
+void armd__profiler_destroy(ARMD__Profiler *profiler) {
+    assert(profiler != NULL);
+
+    int res = 0;
+    (void)res;
+
+    ARMD_MemoryRegion *memory_region = profiler->memory_region;
+
+    ARMD__ProcedureProfile *profile = profiler->first_profile;
+    while (profile != NULL) {
+        ARMD__ProcedureProfile *next = profile->next;
+        res = armd__hash_table_remove(profiler->procedure_profiles,
+                                      get_key(profile->procedure));
+        assert(res == 0);
+        armd_memory_region_free(memory_region, profile->execution_times);
+        armd_memory_region_free(memory_region, profile);
+        profile = next;
+    }
+
+    res = armd__hash_table_destroy(profiler->procedure_profiles);
+    assert(res == 0);
+
+    if (profiler->perf_counter_state == ARMD__PerfCounterState_Opened) {
+        armd__perf_counter_group_close(&profiler->perf_counter_group);
+    }
+
+    res = armd__spinlock_deinit(&profiler->lock);
+    assert(res == 0);
+
+    armd_memory_region_free(memory_region, profiler);
+    armd_memory_region_destroy(memory_region);
+}
+
+static void init_perf_counters(ARMD_PerfCounters *perf_counters) {
+    perf_counters->num_samples = 0;
+    perf_counters->cycles = 0;
+    perf_counters->instructions = 0;
+    perf_counters->cache_misses = 0;
+    perf_counters->branch_misses = 0;
+}
+
+static void merge_perf_counters(ARMD_PerfCounters *perf_counters,
+                                const ARMD_PerfCounters *other) {
+    perf_counters->num_samples += other->num_samples;
+    perf_counters->cycles += other->cycles;
+    perf_counters->instructions += other->instructions;
+    perf_counters->cache_misses += other->cache_misses;
+    perf_counters->branch_misses += other->branch_misses;
+}
+
+/*
+ * Clears the profile for a procedure with num_continuations continuations.
+ * Returns non-zero if the execution times cannot be allocated.
+ */
+static int reset_profile(ARMD__Profiler *profiler,
+                         ARMD__ProcedureProfile *profile,
+                         ARMD_Size num_continuations) {
+    ARMD_Histogram *execution_times = armd_memory_region_allocate(
+        profiler->memory_region,
+        (num_continuations == 0 ? 1 : num_continuations) *
+            sizeof(ARMD_Histogram));
+    if (execution_times == NULL) {
+        return -1;
+    }
+
+    if (profile->execution_times != NULL) {
+        armd_memory_region_free(profiler->memory_region,
+                                profile->execution_times);
+    }
+
+    profile->num_invocations = 0;
+    armd_histogram_init(&profile->queueing_delay);
+    profile->num_continuations = num_continuations;
+    profile->execution_times = execution_times;
+    for (ARMD_Size i = 0; i < num_continuations; ++i) {
+        armd_histogram_init(&profile->execution_times[i]);
+    }
+    init_perf_counters(&profile->perf_counters);
+
+    return 0;
+}
+
+/* Called by the owner with the lock held */
+static ARMD__ProcedureProfile *get_profile(ARMD__Profiler *profiler,
+                                           const ARMD_Procedure *procedure) {
+    ARMD__ProcedureProfile *profile;
+    if (armd__hash_table_get(profiler->procedure_profiles, get_key(procedure),
+                             (void **)&profile) == 0) {
+        // The address of a destroyed procedure is reused by another one
+        if (profile->num_continuations != procedure->num_continuations &&
+            reset_profile(profiler, profile, procedure->num_continuations) !=
+                0) {
+            return NULL;
+        }
+
+        return profile;
+    }
+
+    profile = armd_memory_region_allocate(profiler->memory_region,
+                                          sizeof(ARMD__ProcedureProfile));
+    if (profile == NULL) {
+        return NULL;
+    }
+
+    profile->procedure = procedure;
+    profile->execution_times = NULL;
+    if (reset_profile(profiler, profile, procedure->num_continuations) != 0) {
+        armd_memory_region_free(profiler->memory_region, profile);
+        return NULL;
+    }
+
+    if (armd__hash_table_insert(profiler->procedure_profiles,
+                                get_key(procedure), profile) != 0) {
+        armd_memory_region_free(profiler->memory_region,
+                                profile->execution_times);
+        armd_memory_region_free(profiler->memory_region, profile);
+        return NULL;
+    }
+
+    profile->next = profiler->first_profile;
+    profiler->first_profile = profile;
+
+    return profile;
+}
+
+void armd__profiler_record_invocation(ARMD__Profiler *profiler,
+                                      const ARMD_Procedure *procedure,
+                                      ARMD_Bool has_queueing_delay,
+                                      uint64_t queueing_delay) {
+    int res = 0;
+    (void)res;
+
+    res = armd__spinlock_lock(&profiler->lock);
+    assert(res == 0);
+
+    // Profiling is best effort; drop the record on allocation failure
+    ARMD__ProcedureProfile *profile = get_profile(profiler, procedure);
+    if (profile != NULL) {
+        ++profile->num_invocations;
+        if (has_queueing_delay) {
+            armd_histogram_record(&profile->queueing_delay, queueing_delay);
+        }
+    }
+
+    res = armd__spinlock_unlock(&profiler->lock);
+    assert(res == 0);
+}
+
+void armd__profiler_record_execution(ARMD__Profiler *profiler,
+                                     const ARMD_Procedure *procedure,
+                                     ARMD_Size continuation_index,
+                                     uint64_t execution_time) {
+    int res = 0;
+    (void)res;
+
+    res = armd__spinlock_lock(&profiler->lock);
+    assert(res == 0);
+
+    ARMD__ProcedureProfile *profile = get_profile(profiler, procedure);
+    if (profile != NULL) {
+        assert(continuation_index < profile->num_continuations);
+        armd_histogram_record(&profile->execution_times[continuation_index],
+                              execution_time);
+    }
+
+    res = armd__spinlock_unlock(&profiler->lock);
+    assert(res == 0);
+}
+
+ARMD_Bool armd__profiler_read_perf_counters(ARMD__Profiler *profiler,
+                                            uint64_t *values) {
+    if (profiler->perf_counter_state == ARMD__PerfCounterState_NotOpened) {
+        profiler->perf_counter_state =
+            armd__perf_counter_group_open(&profiler->perf_counter_group) == 0
+                ? ARMD__PerfCounterState_Opened
+                : ARMD__PerfCounterState_Unavailable;
+    }
+
+    if (profiler->perf_counter_state != ARMD__PerfCounterState_Opened) {
+        return 0;
+    }
+
+    return armd__perf_counter_group_read(&profiler->perf_counter_group,
+                                         values) == 0;
+}
+
+void armd__profiler_record_perf_counters(ARMD__Profiler *profiler,
+                                         const ARMD_Procedure *procedure,
+                                         const uint64_t *begin_values) {
+    int res = 0;
+    (void)res;
+
+    uint64_t values[ARMD__PerfCounterType_Count];
+    if (armd__perf_counter_group_read(&profiler->perf_counter_group, values) !=
+        0) {
+        return;
+    }
+
+    res = armd__spinlock_lock(&profiler->lock);
+    assert(res == 0);
+
+    ARMD__ProcedureProfile *profile = get_profile(profiler, procedure);
+    if (profile != NULL) {
+        ARMD_PerfCounters *perf_counters = &profile->perf_counters;
+        ++perf_counters->num_samples;
+        perf_counters->cycles += values[ARMD__PerfCounterType_Cycles] -
+                                 begin_values[ARMD__PerfCounterType_Cycles];
+        perf_counters->instructions +=
+            values[ARMD__PerfCounterType_Instructions] -
+            begin_values[ARMD__PerfCounterType_Instructions];
+        perf_counters->cache_misses +=
+            values[ARMD__PerfCounterType_CacheMisses] -
+            begin_values[ARMD__PerfCounterType_CacheMisses];
+        perf_counters->branch_misses +=
+            values[ARMD__PerfCounterType_BranchMisses] -
+            begin_values[ARMD__PerfCounterType_BranchMisses];
+    }
+
+    res = armd__spinlock_unlock(&profiler->lock);
+    assert(res == 0);
+}
+
+int armd_context_enable_profiling(ARMD_Context *context) {
+    if (context == NULL) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Executor *executor = context->executors[i];
+        if (executor->profiler_storage != NULL) {
+            continue;
+        }
+
+        executor->profiler_storage =
+            armd__profiler_create(&context->memory_allocator);
+        if (executor->profiler_storage == NULL) {
+            // Keep the profilers already created; they are destroyed with
+            // the executors
+            return -1;
+        }
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Executor *executor = context->executors[i];
+        publish_profiler(executor, executor->profiler_storage);
+    }
+
+    context->profiling = 1;
+
+    return 0;
+}
+
+int armd_context_disable_profiling(ARMD_Context *context) {
+    if (context == NULL) {
+        return -1;
+    }
+
+    context->profiling = 0;
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        publish_profiler(context->executors[i], NULL);
+    }
+
+    return 0;
+}
+
+int armd_context_enable_perf_counters(ARMD_Context *context) {
+    if (context == NULL) {
+        return -1;
+    }
+
+    // The executors open their own counters later; this only checks that
+    // the process may open them at all
+    ARMD__PerfCounterGroup group;
+    if (armd__perf_counter_group_open(&group) != 0) {
+        return -1;
+    }
+    armd__perf_counter_group_close(&group);
+
+    context->perf_counting = 1;
+
+    return 0;
+}
+
+int armd_context_disable_perf_counters(ARMD_Context *context) {
+    if (context == NULL) {
+        return -1;
+    }
+
+    context->perf_counting = 0;
+
+    return 0;
+}
+
+int armd_context_get_procedure_profile(ARMD_Context *context,
+                                       const ARMD_Procedure *procedure,
+                                       ARMD_ProcedureProfile *profile,
+                                       ARMD_Histogram *execution_times) {
+    int res = 0;
+    (void)res;
+
+    if (context == NULL || procedure == NULL || profile == NULL) {
+        return -1;
+    }
+
+    ARMD_Bool found = 0;
+
+    profile->num_invocations = 0;
+    armd_histogram_init(&profile->queueing_delay);
+    init_perf_counters(&profile->perf_counters);
+
+    // The procedure is alive if the execution times are requested
+    ARMD_Size num_continuations = 0;
+    if (execution_times != NULL) {
+        num_continuations = procedure->num_continuations;
+        for (ARMD_Size j = 0; j < num_continuations; ++j) {
+            armd_histogram_init(&execution_times[j]);
+        }
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Profiler *profiler = context->executors[i]->profiler_storage;
+        if (profiler == NULL) {
+            continue;
+        }
+
+        res = armd__spinlock_lock(&profiler->lock);
+        assert(res == 0);
+
+        ARMD__ProcedureProfile *source;
+        // Skips the profile left by a destroyed procedure at the same
+        // address, which the executor resets when it runs the new one
+        if (armd__hash_table_get(profiler->procedure_profiles,
+                                 get_key(procedure), (void **)&source) == 0 &&
+            (execution_times == NULL ||
+             source->num_continuations == num_continuations)) {
+            found = 1;
+
+            profile->num_invocations += source->num_invocations;
+            armd_histogram_merge(&profile->queueing_delay,
+                                 &source->queueing_delay);
+            merge_perf_counters(&profile->perf_counters,
+                                &source->perf_counters);
+            if (execution_times != NULL) {
+                for (ARMD_Size j = 0; j < num_continuations; ++j) {
+                    armd_histogram_merge(&execution_times[j],
+                                         &source->execution_times[j]);
+                }
+            }
+        }
+
+        res = armd__spinlock_unlock(&profiler->lock);
+        assert(res == 0);
+    }
+
+    return found ? 0 : -1;
+}
+
+/* Whether an executor before executor_index has profiled the procedure */
+static ARMD_Bool is_profiled_before(ARMD_Context *context,
+                                    ARMD_Size executor_index,
+                                    const ARMD_Procedure *procedure) {
+    int res = 0;
+    (void)res;
+
+    for (ARMD_Size i = 0; i < executor_index; ++i) {
+        ARMD__Profiler *profiler = context->executors[i]->profiler_storage;
+        if (profiler == NULL) {
+            continue;
+        }
+
+        // Readers lock the profilers in descending order, so this never
+        // deadlocks
+        res = armd__spinlock_lock(&profiler->lock);
+        assert(res == 0);
+
+        ARMD_Bool exists = armd__hash_table_exists(
+            profiler->procedure_profiles, get_key(procedure));
+
+        res = armd__spinlock_unlock(&profiler->lock);
+        assert(res == 0);
+
+        if (exists) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+ARMD_Size
+armd_context_get_profiled_procedures(ARMD_Context *context,
+                                     const ARMD_Procedure **procedures,
+                                     ARMD_Size max_num_procedures) {
+    int res = 0;
+    (void)res;
+
+    assert(context != NULL);
+
+    ARMD_Size num_procedures = 0;
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Profiler *profiler = context->executors[i]->profiler_storage;
+        if (profiler == NULL) {
+            continue;
+        }
+
+        res = armd__spinlock_lock(&profiler->lock);
+        assert(res == 0);
+
+        for (ARMD__ProcedureProfile *profile = profiler->first_profile;
+             profile != NULL; profile = profile->next) {
+            if (is_profiled_before(context, i, profile->procedure)) {
+                continue;
+            }
+
+            if (num_procedures < max_num_procedures) {
+                procedures[num_procedures] = profile->procedure;
+            }
+            ++num_procedures;
+        }
+
+        res = armd__spinlock_unlock(&profiler->lock);
+        assert(res == 0);
+    }
+
+    return num_procedures;
+}
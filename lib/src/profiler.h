@@ -0,0 +1,59 @@
+#ifndef ARAMID__PROFILER_H
+#define ARAMID__PROFILER_H
+
+#include <aramid/aramid.h>
+
+#include "hash_table.h"
+#include "memory_region.h"
+#include "perf_counter.h"
+#include "spinlock.h"
+
+typedef struct TAG_ARMD__ProcedureProfile {
+    struct TAG_ARMD__ProcedureProfile *next;
+    const ARMD_Procedure *procedure;
+    ARMD_Size num_invocations;
+    ARMD_Histogram queueing_delay;
+    ARMD_Size num_continuations;
+    ARMD_Histogram *execution_times;
+    ARMD_PerfCounters perf_counters;
+} ARMD__ProcedureProfile;
+
+typedef enum TAG_ARMD__PerfCounterState {
+    ARMD__PerfCounterState_NotOpened,
+    ARMD__PerfCounterState_Opened,
+    ARMD__PerfCounterState_Unavailable,
+} ARMD__PerfCounterState;
+
+/*
+ * Per-executor profile of procedures. Only the owning executor records; the
+ * lock is for readers on other threads and is never contended otherwise. The
+ * perf counters count the owner thread, so the owner opens them lazily.
+ */
+typedef struct TAG_ARMD__Profiler {
+    ARMD__Spinlock lock;
+    ARMD_MemoryRegion *memory_region;
+    ARMD__HashTable *procedure_profiles;
+    ARMD__ProcedureProfile *first_profile;
+    ARMD__PerfCounterState perf_counter_state;
+    ARMD__PerfCounterGroup perf_counter_group;
+} ARMD__Profiler;
+
+ARMD_EXTERN_C ARMD__Profiler *
+armd__profiler_create(const ARMD_MemoryAllocator *memory_allocator);
+ARMD_EXTERN_C void armd__profiler_destroy(ARMD__Profiler *profiler);
+
+ARMD_EXTERN_C void armd__profiler_record_invocation(
+    ARMD__Profiler *profiler, const ARMD_Procedure *procedure,
+    ARMD_Bool has_queueing_delay, uint64_t queueing_delay);
+ARMD_EXTERN_C void armd__profiler_record_execution(
+    ARMD__Profiler *profiler, const ARMD_Procedure *procedure,
+    ARMD_Size continuation_index, uint64_t execution_time);
+/* Returns 0 if the counters are unavailable */
+ARMD_EXTERN_C ARMD_Bool
+armd__profiler_read_perf_counters(ARMD__Profiler *profiler, uint64_t *values);
+/* Accumulates the difference from begin_values read above */
+ARMD_EXTERN_C void armd__profiler_record_perf_counters(
+    ARMD__Profiler *profiler, const ARMD_Procedure *procedure,
+    const uint64_t *begin_values);
+
+#endif // ARAMID__PROFILER_H
@@ -1,81 +1,58 @@
 #include <assert.h>
+#include <string.h>
 
 #include "memory_region.h"
 #include "promise.h"
 
-ARMD__Promise *
-armd__promise_create_no_pending_job(ARMD_MemoryRegion *memory_region) {
-    assert(memory_region != NULL);
-
-    int promise_initialized = 0;
-    int continuation_promises_initialized = 0;
-    int promise_callbacks_initialized = 0;
-
-    ARMD__Promise *promise;
-
-    promise = armd_memory_region_allocate(memory_region, sizeof(ARMD__Promise));
-    if (promise == NULL) {
-        goto error;
+static void *allocate_result(ARMD__Promise *promise, ARMD_Size result_size) {
+    promise->result_size = result_size;
+    if (result_size <= sizeof(promise->inline_result)) {
+        return promise->inline_result.bytes;
     }
-    promise_initialized = 1;
 
-    promise->detached = 0;
-    promise->reference_count = 1;
-    promise->status = ARMD__PromiseStatus_NotFinished;
-
-    promise->memory_region = memory_region;
-
-    promise->num_all_waiting_promises = 0;
-    promise->num_ended_waiting_promises = 0;
-    promise->dependency_has_error = 0;
-    promise->pending_job = NULL;
-
-    promise->num_continuation_promises = 0;
-    promise->continuation_promises =
-        armd_memory_region_allocate(memory_region, sizeof(ARMD_Handle) * 1);
-    if (promise->continuation_promises == NULL) {
-        goto error;
-    }
-    continuation_promises_initialized = 1;
+    return armd_memory_region_allocate(promise->memory_region, result_size);
+}
 
-    promise->num_promise_callbacks = 0;
-    promise->promise_callbacks = armd_memory_region_allocate(
-        memory_region, sizeof(ARMD__PromiseCallback) * 1);
-    if (promise->promise_callbacks == NULL) {
-        goto error;
+static void free_result(ARMD__Promise *promise) {
+    if (promise->result != promise->inline_result.bytes) {
+        armd_memory_region_free(promise->memory_region, promise->result);
     }
-    promise_callbacks_initialized =
-        1; // NOLINT(clang-analyzer-deadcode.DeadStores)
-
-    return promise;
+}
 
-error:
-    if (promise_callbacks_initialized) {
-        armd_memory_region_free(memory_region, promise->promise_callbacks);
+/*
+ * Makes room for one more element in the array starting from the inline
+ * slots by doubling the capacity, so that adding n elements costs O(n) in
+ * total.
+ */
+static void *reserve_element(ARMD_MemoryRegion *memory_region,
+                             void *inline_elements, void *elements,
+                             ARMD_Size num_elements, ARMD_Size *capacity,
+                             ARMD_Size element_size) {
+    if (num_elements < *capacity) {
+        return elements;
     }
 
-    if (continuation_promises_initialized) {
-        armd_memory_region_free(memory_region, promise->continuation_promises);
+    ARMD_Size new_capacity = *capacity * 2;
+    void *new_elements =
+        armd_memory_region_allocate(memory_region, element_size * new_capacity);
+    if (new_elements == NULL) {
+        return NULL;
     }
 
-    if (promise_initialized) {
-        armd_memory_region_free(memory_region, promise);
+    memcpy(new_elements, elements, element_size * num_elements);
+    if (elements != inline_elements) {
+        armd_memory_region_free(memory_region, elements);
     }
 
-    return NULL;
+    *capacity = new_capacity;
+    return new_elements;
 }
 
-ARMD__Promise *
-armd__promise_create_with_pending_job(ARMD_MemoryRegion *memory_region,
-                                      ARMD_Size num_waiting_promises,
-                                      ARMD_Job *pending_job) {
-    assert(memory_region != NULL);
-    assert(num_waiting_promises != 0);
-    assert(pending_job != NULL);
-
+static ARMD__Promise *create_promise(ARMD_MemoryRegion *memory_region,
+                                     ARMD_Size num_waiting_promises,
+                                     ARMD_Job *pending_job,
+                                     ARMD_Size result_size) {
     int promise_initialized = 0;
-    int continuation_promises_initialized = 0;
-    int promise_callbacks_initialized = 0;
 
     ARMD__Promise *promise;
 
@@ -85,45 +62,38 @@ armd__promise_create_with_pending_job(ARMD_MemoryRegion *memory_region,
     }
     promise_initialized = 1;
 
-    promise->detached = 0;
+    promise->memory_region = memory_region;
     promise->reference_count = 1;
     promise->status = ARMD__PromiseStatus_NotFinished;
-
-    promise->memory_region = memory_region;
+    promise->detached = 0;
+    promise->dependency_has_error = 0;
+    promise->running_promise_callbacks = 0;
 
     promise->num_all_waiting_promises = num_waiting_promises;
     promise->num_ended_waiting_promises = 0;
-    promise->dependency_has_error = 0;
     promise->pending_job = pending_job;
+    promise->num_waiting_links = 0;
+    promise->waiting_links = NULL;
 
     promise->num_continuation_promises = 0;
-    promise->continuation_promises =
-        armd_memory_region_allocate(memory_region, sizeof(ARMD_Handle) * 1);
-    if (promise->continuation_promises == NULL) {
-        goto error;
-    }
-    continuation_promises_initialized = 1;
+    promise->continuation_promises_capacity =
+        ARMD__PROMISE_INLINE_CONTINUATIONS;
+    promise->continuation_promises = promise->inline_continuation_promises;
 
     promise->num_promise_callbacks = 0;
-    promise->promise_callbacks = armd_memory_region_allocate(
-        memory_region, sizeof(ARMD__PromiseCallback) * 1);
-    if (promise->promise_callbacks == NULL) {
+    promise->promise_callbacks_capacity = ARMD__PROMISE_INLINE_CALLBACKS;
+    promise->promise_callbacks = promise->inline_promise_callbacks;
+
+    armd__span_point_init(&promise->span_point);
+
+    promise->result = allocate_result(promise, result_size);
+    if (promise->result == NULL) {
         goto error;
     }
-    promise_callbacks_initialized =
-        1; // NOLINT(clang-analyzer-deadcode.DeadStores)
 
     return promise;
 
 error:
-    if (promise_callbacks_initialized) {
-        armd_memory_region_free(memory_region, promise->promise_callbacks);
-    }
-
-    if (continuation_promises_initialized) {
-        armd_memory_region_free(memory_region, promise->continuation_promises);
-    }
-
     if (promise_initialized) {
         armd_memory_region_free(memory_region, promise);
     }
@@ -131,6 +101,27 @@ armd__promise_create_with_pending_job(ARMD_MemoryRegion *memory_region,
     return NULL;
 }
 
+ARMD__Promise *
+armd__promise_create_no_pending_job(ARMD_MemoryRegion *memory_region,
+                                    ARMD_Size result_size) {
+    assert(memory_region != NULL);
+
+    return create_promise(memory_region, 0, NULL, result_size);
+}
+
+ARMD__Promise *
+armd__promise_create_with_pending_job(ARMD_MemoryRegion *memory_region,
+                                      ARMD_Size num_waiting_promises,
+                                      ARMD_Job *pending_job,
+                                      ARMD_Size result_size) {
+    assert(memory_region != NULL);
+    assert(num_waiting_promises != 0);
+    assert(pending_job != NULL);
+
+    return create_promise(memory_region, num_waiting_promises, pending_job,
+                          result_size);
+}
+
 int armd__promise_destroy(ARMD__Promise *promise) {
     assert(promise != NULL);
 
@@ -138,8 +129,17 @@ int armd__promise_destroy(ARMD__Promise *promise) {
 
     ARMD_MemoryRegion *memory_region = promise->memory_region;
 
-    armd_memory_region_free(memory_region, promise->continuation_promises);
-    armd_memory_region_free(memory_region, promise->promise_callbacks);
+    if (promise->continuation_promises !=
+        promise->inline_continuation_promises) {
+        armd_memory_region_free(memory_region, promise->continuation_promises);
+    }
+    if (promise->promise_callbacks != promise->inline_promise_callbacks) {
+        armd_memory_region_free(memory_region, promise->promise_callbacks);
+    }
+    if (promise->waiting_links != NULL) {
+        armd_memory_region_free(memory_region, promise->waiting_links);
+    }
+    free_result(promise);
     armd_memory_region_free(memory_region, promise);
 
     return 0;
@@ -152,27 +152,18 @@ int armd__promise_add_continuation_promise(ARMD__Promise *promise,
     assert(!promise->detached);
     assert(promise->reference_count >= 1);
 
-    ARMD_Size new_num_continuation_promises =
-        promise->num_continuation_promises + 1;
-    ARMD_Handle *new_continuation_promises = armd_memory_region_allocate(
-        promise->memory_region,
-        sizeof(ARMD_Handle) * new_num_continuation_promises);
-
-    if (new_continuation_promises == NULL) {
+    ARMD_Handle *continuation_promises = reserve_element(
+        promise->memory_region, promise->inline_continuation_promises,
+        promise->continuation_promises, promise->num_continuation_promises,
+        &promise->continuation_promises_capacity, sizeof(ARMD_Handle));
+    if (continuation_promises == NULL) {
         return -1;
     }
 
-    for (ARMD_Size i = 0; i < promise->num_continuation_promises; i++) {
-        new_continuation_promises[i] = promise->continuation_promises[i];
-    }
-    new_continuation_promises[promise->num_continuation_promises] =
+    continuation_promises[promise->num_continuation_promises] =
         continuation_promise;
-
-    armd_memory_region_free(promise->memory_region,
-                            promise->continuation_promises);
-
-    promise->num_continuation_promises = new_num_continuation_promises;
-    promise->continuation_promises = new_continuation_promises;
+    promise->continuation_promises = continuation_promises;
+    ++promise->num_continuation_promises;
 
     return 0;
 }
@@ -203,24 +194,17 @@ int armd__promise_add_promise_callback(
     assert(!promise->detached);
     assert(promise->reference_count >= 1);
 
-    ARMD_Size new_num_promise_callbacks = promise->num_promise_callbacks + 1;
-    ARMD__PromiseCallback *new_promise_callbacks = armd_memory_region_allocate(
-        promise->memory_region,
-        sizeof(ARMD__PromiseCallback) * new_num_promise_callbacks);
-
-    if (new_promise_callbacks == NULL) {
+    ARMD__PromiseCallback *promise_callbacks = reserve_element(
+        promise->memory_region, promise->inline_promise_callbacks,
+        promise->promise_callbacks, promise->num_promise_callbacks,
+        &promise->promise_callbacks_capacity, sizeof(ARMD__PromiseCallback));
+    if (promise_callbacks == NULL) {
         return -1;
     }
 
-    for (ARMD_Size i = 0; i < promise->num_promise_callbacks; i++) {
-        new_promise_callbacks[i] = promise->promise_callbacks[i];
-    }
-    new_promise_callbacks[promise->num_promise_callbacks] = *promise_callback;
-
-    armd_memory_region_free(promise->memory_region, promise->promise_callbacks);
-
-    promise->num_promise_callbacks = new_num_promise_callbacks;
-    promise->promise_callbacks = new_promise_callbacks;
+    promise_callbacks[promise->num_promise_callbacks] = *promise_callback;
+    promise->promise_callbacks = promise_callbacks;
+    ++promise->num_promise_callbacks;
 
     return 0;
 }
@@ -5,6 +5,7 @@
 
 #include "hash_table.h"
 #include "memory_region.h"
+#include "span_analysis.h"
 
 typedef enum TAG_ARMD__PromiseStatus {
     ARMD__PromiseStatus_NotFinished,
@@ -12,32 +13,79 @@ typedef enum TAG_ARMD__PromiseStatus {
     ARMD__PromiseStatus_Error,
 } ARMD__PromiseStatus;
 
+/* Results up to this size are stored in the promise without allocation */
+#define ARMD__PROMISE_INLINE_RESULT_SIZE 32
+
 typedef struct TAG_ARMD__PromiseCallback {
     ARMD_PromiseCallbackFunc func;
     void *context;
 } ARMD__PromiseCallback;
 
+/* Where a dependent promise is linked from one of its dependencies */
+typedef struct TAG_ARMD__PromiseLink {
+    ARMD_Handle handle;
+    // The index in the dependencies given on invocation
+    ARMD_Size dependency_index;
+    // The index in continuation_promises of the dependency
+    ARMD_Size continuation_index;
+} ARMD__PromiseLink;
+
+/*
+ * The continuations and the callbacks are stored in the inline slots first
+ * and then in the arrays growing geometrically. Their indices do not change
+ * since the entries are only appended or zeroed.
+ */
+#define ARMD__PROMISE_INLINE_CONTINUATIONS 4
+#define ARMD__PROMISE_INLINE_CALLBACKS 2
+
+/* The fields are ordered to avoid padding */
 typedef struct TAG_ARMD__Promise {
-    ARMD_Bool detached;
+    ARMD_MemoryRegion *memory_region;
     ARMD_Size reference_count;
     ARMD__PromiseStatus status;
-    ARMD_MemoryRegion *memory_region;
+    ARMD_Bool detached;
+    ARMD_Bool dependency_has_error;
+    // Set while the callbacks run outside the mutex after the completion
+    ARMD_Bool running_promise_callbacks;
     ARMD_Size num_all_waiting_promises;
     ARMD_Size num_ended_waiting_promises;
-    ARMD_Bool dependency_has_error;
     ARMD_Job *pending_job;
+    // Set if the job gets ready before all the dependencies end, to unlink
+    // the rest of them
+    ARMD_Size num_waiting_links;
+    ARMD__PromiseLink *waiting_links;
     ARMD_Size num_continuation_promises;
+    ARMD_Size continuation_promises_capacity;
     ARMD_Handle *continuation_promises;
     ARMD_Size num_promise_callbacks;
+    ARMD_Size promise_callbacks_capacity;
     ARMD__PromiseCallback *promise_callbacks;
+    // The span at the completion if analyzed, otherwise zero
+    ARMD__SpanPoint span_point;
+    // result, written by the job and points to inline_result if small enough
+    ARMD_Size result_size;
+    void *result;
+    ARMD_Handle
+        inline_continuation_promises[ARMD__PROMISE_INLINE_CONTINUATIONS];
+    ARMD__PromiseCallback
+        inline_promise_callbacks[ARMD__PROMISE_INLINE_CALLBACKS];
+    union {
+        unsigned char bytes[ARMD__PROMISE_INLINE_RESULT_SIZE];
+        // for alignment
+        long double long_double_value;
+        uint64_t uint64_value;
+        void *pointer_value;
+    } inline_result;
 } ARMD__Promise;
 
 ARMD_EXTERN_C ARMD__Promise *
-armd__promise_create_no_pending_job(ARMD_MemoryRegion *memory_region);
+armd__promise_create_no_pending_job(ARMD_MemoryRegion *memory_region,
+                                    ARMD_Size result_size);
 ARMD_EXTERN_C ARMD__Promise *
 armd__promise_create_with_pending_job(ARMD_MemoryRegion *memory_region,
                                       ARMD_Size num_waiting_promises,
-                                      ARMD_Job *pending_job);
+                                      ARMD_Job *pending_job,
+                                      ARMD_Size result_size);
 ARMD_EXTERN_C int armd__promise_destroy(ARMD__Promise *promise);
 
 ARMD_EXTERN_C int
@@ -0,0 +1,182 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#include "context.h"
+#include "executor.h"
+#include "mutex.h"
+#include "span_analysis.h"
+
+static void store_nanoseconds(uint64_t *counter, uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    *(volatile uint64_t *)counter = value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static uint64_t load_nanoseconds(const uint64_t *counter) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    return *(const volatile uint64_t *)counter;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void store_counter(ARMD_Size *counter, ARMD_Size value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    *(volatile ARMD_Size *)counter = value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static ARMD_Size load_counter(const ARMD_Size *counter) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    return *(const volatile ARMD_Size *)counter;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+void armd__span_point_init(ARMD__SpanPoint *span_point) {
+    assert(span_point != NULL);
+
+    span_point->span = 0;
+    span_point->burdened_span = 0;
+}
+
+void armd__span_point_join(ARMD__SpanPoint *span_point,
+                           const ARMD__SpanPoint *other) {
+    assert(span_point != NULL);
+    assert(other != NULL);
+
+    if (other->span > span_point->span) {
+        span_point->span = other->span;
+    }
+    if (other->burdened_span > span_point->burdened_span) {
+        span_point->burdened_span = other->burdened_span;
+    }
+}
+
+void armd__span_point_advance(ARMD__SpanPoint *span_point, uint64_t elapsed) {
+    assert(span_point != NULL);
+
+    span_point->span += elapsed;
+    span_point->burdened_span += elapsed;
+}
+
+void armd__span_point_add_burden(ARMD__SpanPoint *span_point,
+                                 uint64_t burden) {
+    assert(span_point != NULL);
+
+    span_point->burdened_span += burden;
+}
+
+void armd__span_analysis_counters_init(ARMD__SpanAnalysisCounters *counters) {
+    assert(counters != NULL);
+
+    store_nanoseconds(&counters->work, 0);
+    store_counter(&counters->num_strands, 0);
+}
+
+void armd__span_analysis_record_strand(ARMD__Executor *executor,
+                                       uint64_t elapsed) {
+    assert(executor != NULL);
+
+    // Only the owner writes, so a plain read-modify-write is enough
+    ARMD__SpanAnalysisCounters *counters = &executor->span_analysis;
+    store_nanoseconds(&counters->work, counters->work + elapsed);
+    store_counter(&counters->num_strands, counters->num_strands + 1);
+}
+
+void armd__span_analysis_record_completion(ARMD_Context *context,
+                                           const ARMD__SpanPoint *span_point) {
+    assert(context != NULL);
+    assert(span_point != NULL);
+
+    armd__span_point_join(&context->span_analysis_span_point, span_point);
+}
+
+int armd_context_enable_span_analysis(ARMD_Context *context) {
+    int res = 0;
+    (void)res;
+
+    if (context == NULL) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        armd__span_analysis_counters_init(
+            &context->executors[i]->span_analysis);
+    }
+
+    res = armd__mutex_lock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    armd__span_point_init(&context->span_analysis_span_point);
+
+    res = armd__mutex_unlock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    context->span_analysis = 1;
+
+    return 0;
+}
+
+int armd_context_disable_span_analysis(ARMD_Context *context) {
+    if (context == NULL) {
+        return -1;
+    }
+
+    context->span_analysis = 0;
+
+    return 0;
+}
+
+int armd_context_get_span_analysis(ARMD_Context *context,
+                                   ARMD_SpanAnalysis *analysis) {
+    int res = 0;
+    (void)res;
+
+    if (context == NULL || analysis == NULL) {
+        return -1;
+    }
+
+    analysis->work = 0;
+    analysis->num_strands = 0;
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        const ARMD__SpanAnalysisCounters *counters =
+            &context->executors[i]->span_analysis;
+        analysis->work += load_nanoseconds(&counters->work);
+        analysis->num_strands += load_counter(&counters->num_strands);
+    }
+
+    res = armd__mutex_lock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    analysis->span = context->span_analysis_span_point.span;
+    analysis->burdened_span = context->span_analysis_span_point.burdened_span;
+
+    res = armd__mutex_unlock(&context->promise_manager.mutex);
+    assert(res == 0);
+
+    analysis->parallelism =
+        analysis->span != 0
+            ? (ARMD_Real)analysis->work / (ARMD_Real)analysis->span
+            : 0.0;
+    analysis->burdened_parallelism =
+        analysis->burdened_span != 0
+            ? (ARMD_Real)analysis->work / (ARMD_Real)analysis->burdened_span
+            : 0.0;
+
+    return 0;
+}
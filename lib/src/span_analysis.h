@@ -0,0 +1,44 @@
+#ifndef ARAMID__SPAN_ANALYSIS_H
+#define ARAMID__SPAN_ANALYSIS_H
+
+#include <aramid/aramid.h>
+
+#include "types.h"
+
+/*
+ * Length of the longest path of strands from the start of the graph to a
+ * point. The burdened span also includes the time the jobs on the path spent
+ * from getting ready to starting, which is the scheduling overhead.
+ */
+typedef struct TAG_ARMD__SpanPoint {
+    uint64_t span;
+    uint64_t burdened_span;
+} ARMD__SpanPoint;
+
+/* Written only by the owning executor, read relaxed by the others */
+typedef struct TAG_ARMD__SpanAnalysisCounters {
+    uint64_t work;
+    ARMD_Size num_strands;
+} ARMD__SpanAnalysisCounters;
+
+ARMD_EXTERN_C void armd__span_point_init(ARMD__SpanPoint *span_point);
+/* Take the longer of the two paths */
+ARMD_EXTERN_C void armd__span_point_join(ARMD__SpanPoint *span_point,
+                                         const ARMD__SpanPoint *other);
+/* Extend the path by a strand */
+ARMD_EXTERN_C void armd__span_point_advance(ARMD__SpanPoint *span_point,
+                                            uint64_t elapsed);
+/* Extend only the burdened path by a scheduling overhead */
+ARMD_EXTERN_C void armd__span_point_add_burden(ARMD__SpanPoint *span_point,
+                                               uint64_t burden);
+
+ARMD_EXTERN_C void
+armd__span_analysis_counters_init(ARMD__SpanAnalysisCounters *counters);
+ARMD_EXTERN_C void armd__span_analysis_record_strand(ARMD__Executor *executor,
+                                                     uint64_t elapsed);
+/* Called with the promise manager mutex held */
+ARMD_EXTERN_C void
+armd__span_analysis_record_completion(ARMD_Context *context,
+                                      const ARMD__SpanPoint *span_point);
+
+#endif // ARAMID__SPAN_ANALYSIS_H
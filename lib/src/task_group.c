@@ -0,0 +1,291 @@
+#include <assert.h>
+
+#include <aramid/aramid.h>
+
+#include "task_group.h"
+
+#include "context.h"
+#include "deque.h"
+#include "executor.h"
+#include "job.h"
+#include "job_awaiter.h"
+#include "memory_allocator.h"
+#include "spinlock.h"
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+static ARMD_Size load_acquire(const volatile ARMD_Size *value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    // Volatile accesses have acquire/release semantics on MSVC
+    return *value;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+/* Updates expected with the current value on failure */
+static ARMD_Bool compare_exchange(volatile ARMD_Size *target,
+                                  ARMD_Size *expected, ARMD_Size desired) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_compare_exchange_n(target, expected, desired, 1,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    ARMD_Size previous;
+#pragma warning(push)
+#pragma warning(disable : 4127)
+    if (sizeof(ARMD_Size) == 4) {
+        previous = (ARMD_Size)InterlockedCompareExchange(
+            (volatile LONG *)target, (LONG)desired, (LONG)*expected);
+    } else {
+        previous = (ARMD_Size)InterlockedCompareExchange64(
+            (volatile LONG64 *)target, (LONG64)desired, (LONG64)*expected);
+    }
+#pragma warning(pop)
+    if (previous == *expected) {
+        return 1;
+    }
+    *expected = previous;
+    return 0;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void add(volatile ARMD_Size *target, ARMD_Size value) {
+    ARMD_Size expected = load_acquire(target);
+    while (!compare_exchange(target, &expected, expected + value)) {
+    }
+}
+
+static void set_error(volatile ARMD_Bool *has_error) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(has_error, 1, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+    *has_error = 1;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+ARMD_TaskGroup *armd_task_group_create(ARMD_Context *context) {
+    if (context == NULL) {
+        return NULL;
+    }
+
+    int res = 0;
+    (void)res;
+
+    int task_group_initialized = 0;
+    int mutex_initialized = 0;
+    int condvar_initialized = 0;
+
+    ARMD_TaskGroup *task_group = armd_memory_allocator_allocate(
+        &context->memory_allocator, sizeof(ARMD_TaskGroup));
+    if (task_group == NULL) {
+        goto error;
+    }
+    task_group_initialized = 1;
+
+    task_group->context = context;
+    task_group->num_pending_jobs = 0;
+    task_group->has_error = 0;
+
+    if (armd__mutex_init(&task_group->mutex)) {
+        goto error;
+    }
+    mutex_initialized = 1;
+
+    if (armd__condvar_init(&task_group->condvar)) {
+        goto error;
+    }
+    condvar_initialized = 1; // NOLINT(clang-analyzer-deadcode.DeadStores)
+
+    return task_group;
+
+error:
+    if (condvar_initialized) {
+        res = armd__condvar_deinit(&task_group->condvar);
+        assert(res == 0);
+    }
+
+    if (mutex_initialized) {
+        res = armd__mutex_deinit(&task_group->mutex);
+        assert(res == 0);
+    }
+
+    if (task_group_initialized) {
+        armd_memory_allocator_free(&context->memory_allocator, task_group);
+    }
+
+    return NULL;
+}
+
+int armd_task_group_destroy(ARMD_TaskGroup *task_group) {
+    if (task_group == NULL) {
+        return -1;
+    }
+
+    int res = 0;
+    (void)res;
+
+    // The last job touches the group until it releases the mutex
+    res = armd__mutex_lock(&task_group->mutex);
+    assert(res == 0);
+    ARMD_Size num_pending_jobs = load_acquire(&task_group->num_pending_jobs);
+    res = armd__mutex_unlock(&task_group->mutex);
+    assert(res == 0);
+
+    if (num_pending_jobs != 0) {
+        return -1;
+    }
+
+    res = armd__condvar_deinit(&task_group->condvar);
+    assert(res == 0);
+    res = armd__mutex_deinit(&task_group->mutex);
+    assert(res == 0);
+
+    armd_memory_allocator_free(&task_group->context->memory_allocator,
+                               task_group);
+
+    return 0;
+}
+
+static void complete_job(ARMD_TaskGroup *task_group, ARMD_Bool has_error) {
+    int res = 0;
+    (void)res;
+
+    if (has_error) {
+        set_error(&task_group->has_error);
+    }
+
+    // Only the last job takes the mutex, so that the waiter cannot destroy
+    // the group while it is being notified
+    ARMD_Size num_pending_jobs = load_acquire(&task_group->num_pending_jobs);
+    while (num_pending_jobs > 1) {
+        if (compare_exchange(&task_group->num_pending_jobs, &num_pending_jobs,
+                             num_pending_jobs - 1)) {
+            return;
+        }
+    }
+
+    res = armd__mutex_lock(&task_group->mutex);
+    assert(res == 0);
+
+    // Other jobs may have been added since
+    add(&task_group->num_pending_jobs, (ARMD_Size)-1);
+    if (load_acquire(&task_group->num_pending_jobs) == 0) {
+        res = armd__condvar_broadcast(&task_group->condvar);
+        assert(res == 0);
+    }
+
+    res = armd__mutex_unlock(&task_group->mutex);
+    assert(res == 0);
+}
+
+int armd_task_group_invoke(ARMD_TaskGroup *task_group,
+                           ARMD_Procedure *procedure, void *args) {
+    if (task_group == NULL || procedure == NULL) {
+        return -1;
+    }
+
+    int res = 0;
+    (void)res;
+
+    ARMD_Context *context = task_group->context;
+
+    ARMD__JobAwaiter awaiter;
+    awaiter.type = JobAwaiterType_TaskGroup;
+    awaiter.body.task_group.task_group = task_group;
+
+    assert(context->num_executors >= 1);
+    ARMD__Executor *executor = context->executors[0];
+    ARMD_Job *job = armd__job_create(context->memory_region, executor,
+                                     procedure, &awaiter, args);
+    if (job == NULL) {
+        return -1;
+    }
+
+    // Continuations written for armd_invoke may write the result, so give
+    // them storage to be discarded when the job ends
+    if (procedure->result_size != 0) {
+        job->result = armd_memory_region_allocate(context->memory_region,
+                                                  procedure->result_size);
+        if (job->result == NULL) {
+            armd__job_destroy(job);
+            return -1;
+        }
+    }
+
+    // Counted before the job can end
+    add(&task_group->num_pending_jobs, 1);
+
+    armd__job_mark_ready(job);
+
+    res = armd__spinlock_lock(&executor->lock);
+    assert(res == 0);
+    int enqueue_res = armd__deque_enqueue_back(executor->deque, job);
+    armd__executor_record_deque_size(executor);
+    res = armd__spinlock_unlock(&executor->lock);
+    assert(res == 0);
+
+    if (enqueue_res != 0) {
+        armd__task_group_end_job(job, 0);
+        return -1;
+    }
+
+    {
+        res = armd__mutex_lock(&context->executor_mutex);
+        assert(res == 0);
+
+        ++context->free_job_count;
+        res = armd__condvar_broadcast(&context->executor_condvar);
+        assert(res == 0);
+
+        res = armd__mutex_unlock(&context->executor_mutex);
+        assert(res == 0);
+    }
+
+    return 0;
+}
+
+int armd_task_group_wait(ARMD_TaskGroup *task_group) {
+    if (task_group == NULL) {
+        return -1;
+    }
+
+    int res = 0;
+    (void)res;
+
+    res = armd__mutex_lock(&task_group->mutex);
+    assert(res == 0);
+
+    while (load_acquire(&task_group->num_pending_jobs) != 0) {
+        res = armd__condvar_wait(&task_group->condvar, &task_group->mutex);
+        assert(res == 0);
+    }
+
+    ARMD_Bool has_error = task_group->has_error;
+    task_group->has_error = 0;
+
+    res = armd__mutex_unlock(&task_group->mutex);
+    assert(res == 0);
+
+    return has_error ? -2 : 0;
+}
+
+void armd__task_group_end_job(ARMD_Job *job, ARMD_Bool has_error) {
+    assert(job->awaiter.type == JobAwaiterType_TaskGroup);
+    ARMD_TaskGroup *task_group = job->awaiter.body.task_group.task_group;
+
+    if (job->result != NULL) {
+        armd_memory_region_free(job->memory_region, job->result);
+        job->result = NULL;
+    }
+    armd__job_destroy(job);
+
+    complete_job(task_group, has_error);
+}
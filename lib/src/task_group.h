@@ -0,0 +1,21 @@
+#ifndef ARAMID__TASK_GROUP_H
+#define ARAMID__TASK_GROUP_H
+
+#include <aramid/aramid.h>
+
+#include "condvar.h"
+#include "mutex.h"
+
+struct TAG_ARMD_TaskGroup {
+    ARMD_Context *context;
+    // The last job to end takes the mutex to wake the waiters
+    ARMD__Mutex mutex;
+    ARMD__Condvar condvar;
+    volatile ARMD_Size num_pending_jobs;
+    volatile ARMD_Bool has_error;
+};
+
+/* Destroys the ended job and notifies its group */
+ARMD_EXTERN_C void armd__task_group_end_job(ARMD_Job *job, ARMD_Bool has_error);
+
+#endif // ARAMID__TASK_GROUP_H
@@ -5,6 +5,7 @@
 #if defined(ARAMID_USE_PTHREAD)
 
 #include <pthread.h>
+#include <sched.h>
 
 int armd__thread_create(ARMD__Thread *thread, ThreadMainFunc thread_main_func,
                         void *arg) {
@@ -28,6 +29,8 @@ int armd__thread_join(ARMD__Thread *thread, void **result) {
     return pthread_join(thread->thread, result);
 }
 
+void armd__thread_yield(void) { sched_yield(); }
+
 #elif defined(ARAMID_USE_WIN32THREAD)
 
 #include <windows.h>
@@ -57,6 +60,8 @@ int armd__thread_join(ARMD__Thread *thread, void **result) {
     return ret;
 }
 
+void armd__thread_yield(void) { SwitchToThread(); }
+
 #elif defined(ARAMID_EDITOR)
 
 int armd__thread_create(ARMD__Thread *thread, ThreadMainFunc thread_main_func,
@@ -70,6 +75,20 @@ int armd__thread_join(ARMD__Thread *thread, void **result) {
     return 0;
 }
 
+void armd__thread_yield(void) { assert(0); }
+
 #else
 #error Thread implementation is not specified
 #endif
+
+#if defined(__GNUC__) || defined(__clang__)
+static __thread ARMD_Size thread_slot = ARMD__THREAD_SLOT_NONE;
+#elif defined(_MSC_VER)
+static __declspec(thread) ARMD_Size thread_slot = ARMD__THREAD_SLOT_NONE;
+#else
+#error Thread local storage implementation is not specified
+#endif
+
+void armd__thread_set_slot(ARMD_Size slot) { thread_slot = slot; }
+
+ARMD_Size armd__thread_get_slot(void) { return thread_slot; }
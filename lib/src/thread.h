@@ -11,6 +11,18 @@ ARMD_EXTERN_C int armd__thread_create(ARMD__Thread *thread,
                                       ThreadMainFunc thread_main_func,
                                       void *arg);
 ARMD_EXTERN_C int armd__thread_join(ARMD__Thread *thread, void **result);
+/* Gives up the rest of the timeslice to the other threads */
+ARMD_EXTERN_C void armd__thread_yield(void);
+
+/* The slot of the thread not running as an executor */
+#define ARMD__THREAD_SLOT_NONE ((ARMD_Size)-1)
+
+/*
+ * Thread slot is a thread-local index used to pick per-thread data such as
+ * memory region shards. Executors use their id.
+ */
+ARMD_EXTERN_C void armd__thread_set_slot(ARMD_Size slot);
+ARMD_EXTERN_C ARMD_Size armd__thread_get_slot(void);
 
 #if defined(ARAMID_USE_PTHREAD)
 
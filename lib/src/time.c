@@ -1,5 +1,7 @@
 #include <aramid/aramid.h>
 
+#include "time.h"
+
 #if defined(_WIN32)
 
 #include <stdio.h>
@@ -21,6 +23,18 @@ int armd_get_time(ARMD_Timespec *result) {
     return 0;
 }
 
+uint64_t armd__time_get_monotonic_nanoseconds(void) {
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+    uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+    return seconds * 1000000000ull +
+           remainder * 1000000000ull / (uint64_t)frequency.QuadPart;
+}
+
 char *armd_format_time_iso8601(ARMD_MemoryRegion *memory_region,
                                const ARMD_Timespec *timespec) {
     time_t time = timespec->seconds;
@@ -53,6 +67,13 @@ int armd_get_time(ARMD_Timespec *result) {
     return 0;
 }
 
+uint64_t armd__time_get_monotonic_nanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
 char *armd_format_time_iso8601(ARMD_MemoryRegion *memory_region,
                                const ARMD_Timespec *timespec) {
     time_t time = timespec->seconds;
@@ -73,3 +94,198 @@ char *armd_format_time_iso8601(ARMD_MemoryRegion *memory_region,
 #else
 #error OS not supported
 #endif
+
+/*
+ * Timestamps for the instrumentation. The invariant time stamp counter is
+ * used where available, since it is a few times cheaper to read than the
+ * monotonic clock. Its frequency is calibrated against the monotonic clock
+ * by the first caller.
+ */
+
+#if !defined(ARAMID_DISABLE_TSC) &&                                            \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||            \
+     defined(_M_IX86))
+#define ARMD__TIME_USE_TSC
+#endif
+
+#ifdef ARMD__TIME_USE_TSC
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#else
+#error TSC implementation is not specified
+#endif
+
+#define ARMD__TIME_CALIBRATION_NANOSECONDS 10000000ull
+
+typedef enum TAG_ARMD__TimestampState {
+    ARMD__TimestampState_Uncalibrated = 0,
+    ARMD__TimestampState_Calibrating,
+    ARMD__TimestampState_Calibrated,
+} ARMD__TimestampState;
+
+static volatile long timestamp_state = ARMD__TimestampState_Uncalibrated;
+// Written once before timestamp_state becomes Calibrated
+static ARMD_Bool uses_tsc;
+static ARMD__TimestampScale timestamp_scale;
+
+static long load_timestamp_state(void) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&timestamp_state, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    long state = timestamp_state;
+    _ReadWriteBarrier();
+    return state;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void store_timestamp_state(long state) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&timestamp_state, state, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _ReadWriteBarrier();
+    timestamp_state = state;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static ARMD_Bool begin_calibration(void) {
+#if defined(__GNUC__) || defined(__clang__)
+    long expected = ARMD__TimestampState_Uncalibrated;
+    return __atomic_compare_exchange_n(
+        &timestamp_state, &expected, ARMD__TimestampState_Calibrating, 0,
+        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchange(&timestamp_state,
+                                       ARMD__TimestampState_Calibrating,
+                                       ARMD__TimestampState_Uncalibrated) ==
+           ARMD__TimestampState_Uncalibrated;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void get_cpuid(unsigned int leaf, unsigned int regs[4]) {
+#if defined(__GNUC__) || defined(__clang__)
+    __cpuid(leaf, regs[0], regs[1], regs[2], regs[3]);
+#elif defined(_MSC_VER)
+    int int_regs[4];
+    __cpuid(int_regs, (int)leaf);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = (unsigned int)int_regs[i];
+    }
+#else
+#error TSC implementation is not specified
+#endif
+}
+
+static ARMD_Bool has_invariant_tsc(void) {
+    unsigned int regs[4];
+    get_cpuid(0x80000000u, regs);
+    if (regs[0] < 0x80000007u) {
+        return 0;
+    }
+
+    get_cpuid(0x80000007u, regs);
+    return (regs[3] & (1u << 8)) != 0;
+}
+
+static uint64_t read_tsc(void) { return (uint64_t)__rdtsc(); }
+
+static uint64_t get_tsc_frequency(void) {
+    // Measured rather than read from CPUID, which is missing or inexact on
+    // many processors and virtual machines
+    uint64_t begin_nanoseconds = armd__time_get_monotonic_nanoseconds();
+    uint64_t begin_ticks = read_tsc();
+    uint64_t end_nanoseconds;
+    do {
+        end_nanoseconds = armd__time_get_monotonic_nanoseconds();
+    } while (end_nanoseconds - begin_nanoseconds <
+             ARMD__TIME_CALIBRATION_NANOSECONDS);
+    uint64_t end_ticks = read_tsc();
+
+    return (end_ticks - begin_ticks) * 1000000000ull /
+           (end_nanoseconds - begin_nanoseconds);
+}
+
+static void calibrate(void) {
+    if (!begin_calibration()) {
+        // Another thread is calibrating
+        while (load_timestamp_state() != ARMD__TimestampState_Calibrated) {
+        }
+        return;
+    }
+
+    uint64_t frequency = has_invariant_tsc() ? get_tsc_frequency() : 0;
+    if (frequency != 0) {
+        // The finest scale whose multiplier fits in 32 bits
+        uint32_t shift = 32;
+        while (shift > 0 &&
+               (1000000000ull << shift) / frequency > UINT32_MAX) {
+            --shift;
+        }
+        uint64_t multiplier = (1000000000ull << shift) / frequency;
+        if (multiplier != 0 && multiplier <= UINT32_MAX) {
+            uses_tsc = 1;
+            timestamp_scale.multiplier = (uint32_t)multiplier;
+            timestamp_scale.shift = shift;
+        }
+    }
+
+    if (!uses_tsc) {
+        timestamp_scale.multiplier = 1;
+        timestamp_scale.shift = 0;
+    }
+
+    store_timestamp_state(ARMD__TimestampState_Calibrated);
+}
+
+uint64_t armd_get_timestamp(void) {
+    if (load_timestamp_state() != ARMD__TimestampState_Calibrated) {
+        calibrate();
+    }
+
+    return uses_tsc ? read_tsc() : armd__time_get_monotonic_nanoseconds();
+}
+
+void armd__time_get_timestamp_scale(ARMD__TimestampScale *scale) {
+    if (load_timestamp_state() != ARMD__TimestampState_Calibrated) {
+        calibrate();
+    }
+
+    *scale = timestamp_scale;
+}
+
+#else
+
+uint64_t armd_get_timestamp(void) {
+    return armd__time_get_monotonic_nanoseconds();
+}
+
+void armd__time_get_timestamp_scale(ARMD__TimestampScale *scale) {
+    scale->multiplier = 1;
+    scale->shift = 0;
+}
+
+#endif
+
+uint64_t armd__time_scale_timestamp(const ARMD__TimestampScale *scale,
+                                    uint64_t timestamp) {
+    // Split so that each product fits in 64 bits
+    uint64_t high = timestamp >> 32;
+    uint64_t low = timestamp & 0xffffffffull;
+    return ((high * scale->multiplier) << (32 - scale->shift)) +
+           ((low * scale->multiplier) >> scale->shift);
+}
+
+uint64_t armd_timestamp_to_nanoseconds(uint64_t timestamp) {
+    ARMD__TimestampScale scale;
+    armd__time_get_timestamp_scale(&scale);
+    return armd__time_scale_timestamp(&scale, timestamp);
+}
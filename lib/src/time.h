@@ -0,0 +1,24 @@
+#ifndef ARAMID__TIME_H
+#define ARAMID__TIME_H
+
+#include <aramid/aramid.h>
+
+/* Monotonic clock for measuring intervals. The origin is unspecified. */
+ARMD_EXTERN_C uint64_t armd__time_get_monotonic_nanoseconds(void);
+
+/*
+ * Converts timestamps of armd_get_timestamp to nanoseconds as
+ * (ticks * multiplier) >> shift without overflowing 64 bits. The scale is
+ * kept with the timestamps which are decoded by another process.
+ */
+typedef struct TAG_ARMD__TimestampScale {
+    uint32_t multiplier;
+    uint32_t shift;
+} ARMD__TimestampScale;
+
+ARMD_EXTERN_C void armd__time_get_timestamp_scale(ARMD__TimestampScale *scale);
+ARMD_EXTERN_C uint64_t
+armd__time_scale_timestamp(const ARMD__TimestampScale *scale,
+                           uint64_t timestamp);
+
+#endif // ARAMID__TIME_H
@@ -0,0 +1,56 @@
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include "time.h"
+
+namespace {
+
+TEST(TimestampScaleTest, Identity) {
+    ARMD__TimestampScale scale;
+    scale.multiplier = 1;
+    scale.shift = 0;
+
+    ASSERT_EQ(armd__time_scale_timestamp(&scale, 0), 0u);
+    ASSERT_EQ(armd__time_scale_timestamp(&scale, 123456789u), 123456789u);
+    ASSERT_EQ(armd__time_scale_timestamp(&scale, UINT64_MAX), UINT64_MAX);
+}
+
+TEST(TimestampScaleTest, Fraction) {
+    // 0.25 nanoseconds per tick, as a 4 GHz counter
+    ARMD__TimestampScale scale;
+    scale.multiplier = UINT32_C(1) << 30;
+    scale.shift = 32;
+
+    ASSERT_EQ(armd__time_scale_timestamp(&scale, 4000000000u), 1000000000u);
+    // Beyond 64 bits if multiplied at once
+    ASSERT_EQ(armd__time_scale_timestamp(&scale, UINT64_C(1) << 60),
+              UINT64_C(1) << 58);
+}
+
+TEST(TimestampScaleTest, Coarse) {
+    // 41.666... nanoseconds per tick, as a 24 MHz counter
+    ARMD__TimestampScale scale;
+    scale.multiplier = 2796202666u;
+    scale.shift = 26;
+
+    // Within the error of truncating the multiplier
+    ASSERT_NEAR(static_cast<double>(
+                    armd__time_scale_timestamp(&scale, 24000000u)),
+                1e9, 1.0);
+    ASSERT_NEAR(static_cast<double>(armd__time_scale_timestamp(
+                    &scale, UINT64_C(24000000) * 86400)),
+                86400e9, 86400e9 * 1e-9);
+}
+
+TEST(TimestampScaleTest, SameAsPublic) {
+    ARMD__TimestampScale scale;
+    armd__time_get_timestamp_scale(&scale);
+    ASSERT_LE(scale.shift, 32u);
+    ASSERT_NE(scale.multiplier, 0u);
+
+    ASSERT_EQ(armd__time_scale_timestamp(&scale, 1000000u),
+              armd_timestamp_to_nanoseconds(1000000u));
+}
+
+} // namespace
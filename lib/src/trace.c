@@ -0,0 +1,318 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <aramid/aramid.h>
+
+#include "trace.h"
+
+#include "context.h"
+#include "executor.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static void store_num_recorded(ARMD__TraceBuffer *trace_buffer,
+                               uint64_t num_recorded) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(trace_buffer->num_recorded, num_recorded,
+                     __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _ReadWriteBarrier();
+    *trace_buffer->num_recorded = num_recorded;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+ARMD__TraceBuffer *
+armd__trace_buffer_create(const ARMD_MemoryAllocator *memory_allocator,
+                          ARMD_Size capacity) {
+    assert(memory_allocator != NULL);
+    assert(capacity != 0);
+
+    ARMD__TraceBuffer *trace_buffer = armd_memory_allocator_allocate(
+        memory_allocator, sizeof(ARMD__TraceBuffer));
+    if (trace_buffer == NULL) {
+        return NULL;
+    }
+
+    trace_buffer->events = armd_memory_allocator_allocate(
+        memory_allocator, capacity * sizeof(ARMD__TraceEvent));
+    if (trace_buffer->events == NULL) {
+        armd_memory_allocator_free(memory_allocator, trace_buffer);
+        return NULL;
+    }
+
+    trace_buffer->memory_allocator = *memory_allocator;
+    trace_buffer->capacity = capacity;
+    trace_buffer->num_recorded_storage = 0;
+    trace_buffer->num_recorded = &trace_buffer->num_recorded_storage;
+    trace_buffer->owns_events = 1;
+
+    return trace_buffer;
+}
+
+ARMD__TraceBuffer *
+armd__trace_buffer_create_mapped(const ARMD_MemoryAllocator *memory_allocator,
+                                 ARMD_Size capacity, ARMD__TraceEvent *events,
+                                 volatile uint64_t *num_recorded) {
+    assert(memory_allocator != NULL);
+    assert(capacity != 0);
+
+    ARMD__TraceBuffer *trace_buffer = armd_memory_allocator_allocate(
+        memory_allocator, sizeof(ARMD__TraceBuffer));
+    if (trace_buffer == NULL) {
+        return NULL;
+    }
+
+    trace_buffer->memory_allocator = *memory_allocator;
+    trace_buffer->capacity = capacity;
+    trace_buffer->num_recorded_storage = 0;
+    trace_buffer->num_recorded = num_recorded;
+    trace_buffer->events = events;
+    trace_buffer->owns_events = 0;
+
+    return trace_buffer;
+}
+
+void armd__trace_buffer_destroy(ARMD__TraceBuffer *trace_buffer) {
+    assert(trace_buffer != NULL);
+
+    ARMD_MemoryAllocator memory_allocator = trace_buffer->memory_allocator;
+    if (trace_buffer->owns_events) {
+        armd_memory_allocator_free(&memory_allocator, trace_buffer->events);
+    }
+    armd_memory_allocator_free(&memory_allocator, trace_buffer);
+}
+
+void armd__trace_buffer_record(ARMD__TraceBuffer *trace_buffer,
+                               ARMD__TraceEventType type, uint64_t arg) {
+    uint64_t num_recorded = *trace_buffer->num_recorded;
+
+    ARMD__TraceEvent *event =
+        &trace_buffer->events[num_recorded % trace_buffer->capacity];
+    event->timestamp = armd_get_timestamp();
+    event->arg = arg;
+    event->type = type;
+
+    store_num_recorded(trace_buffer, num_recorded + 1);
+}
+
+#ifndef ARAMID_DISABLE_TRACING
+
+static uint64_t load_num_recorded(const ARMD__TraceBuffer *trace_buffer) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(trace_buffer->num_recorded, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    uint64_t num_recorded = *trace_buffer->num_recorded;
+    _ReadWriteBarrier();
+    return num_recorded;
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static void publish_trace_buffer(ARMD__Executor *executor,
+                                 ARMD__TraceBuffer *trace_buffer) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&executor->trace_buffer, trace_buffer, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+    _InterlockedExchangePointer((void *volatile *)&executor->trace_buffer,
+                                trace_buffer);
+#else
+#error Atomic implementation is not specified
+#endif
+}
+
+static int write_string(ARMD_TraceWriterFunc writer_func, void *writer_context,
+                        const char *str) {
+    return writer_func(writer_context, str, strlen(str));
+}
+
+static int write_event(ARMD_TraceWriterFunc writer_func, void *writer_context,
+                       ARMD_Size executor_id, uint64_t base_timestamp,
+                       const ARMD__TraceEvent *event) {
+    uint64_t timestamp =
+        event->timestamp > base_timestamp
+            ? armd_timestamp_to_nanoseconds(event->timestamp - base_timestamp)
+            : 0;
+
+    // Chrome Trace Event Format takes microseconds
+    char common[128];
+    snprintf(common, sizeof(common),
+             "\"pid\":0,\"tid\":%llu,\"ts\":%llu.%03u",
+             (unsigned long long)executor_id,
+             (unsigned long long)(timestamp / 1000),
+             (unsigned)(timestamp % 1000));
+
+    char buf[256];
+    switch (event->type) {
+    case ARMD__TraceEventType_JobBegin:
+    case ARMD__TraceEventType_JobEnd:
+        snprintf(buf, sizeof(buf),
+                 ",\n{\"name\":\"procedure %p\",\"cat\":\"job\","
+                 "\"ph\":\"%s\",%s}",
+                 (void *)(uintptr_t)event->arg,
+                 event->type == ARMD__TraceEventType_JobBegin ? "B" : "E",
+                 common);
+        break;
+    case ARMD__TraceEventType_Park:
+    case ARMD__TraceEventType_Unpark:
+        snprintf(buf, sizeof(buf),
+                 ",\n{\"name\":\"park\",\"cat\":\"scheduler\","
+                 "\"ph\":\"%s\",%s}",
+                 event->type == ARMD__TraceEventType_Park ? "B" : "E", common);
+        break;
+    case ARMD__TraceEventType_Fork:
+        snprintf(buf, sizeof(buf),
+                 ",\n{\"name\":\"fork\",\"cat\":\"scheduler\",\"ph\":\"i\","
+                 "\"s\":\"t\",%s,\"args\":{\"procedure\":\"%p\"}}",
+                 common, (void *)(uintptr_t)event->arg);
+        break;
+    case ARMD__TraceEventType_Steal:
+        snprintf(buf, sizeof(buf),
+                 ",\n{\"name\":\"steal\",\"cat\":\"scheduler\",\"ph\":\"i\","
+                 "\"s\":\"t\",%s,\"args\":{\"victim\":%llu}}",
+                 common, (unsigned long long)event->arg);
+        break;
+    case ARMD__TraceEventType_PromiseComplete:
+        snprintf(buf, sizeof(buf),
+                 ",\n{\"name\":\"promise complete\",\"cat\":\"promise\","
+                 "\"ph\":\"i\",\"s\":\"t\",%s,\"args\":{\"handle\":%llu}}",
+                 common, (unsigned long long)event->arg);
+        break;
+    case ARMD__TraceEventType_DependencyRelease:
+        snprintf(buf, sizeof(buf),
+                 ",\n{\"name\":\"dependency release\",\"cat\":\"promise\","
+                 "\"ph\":\"i\",\"s\":\"t\",%s,\"args\":{\"handle\":%llu}}",
+                 common, (unsigned long long)event->arg);
+        break;
+    default:
+        assert(0);
+        return 0;
+    }
+
+    return write_string(writer_func, writer_context, buf);
+}
+
+int armd_context_enable_tracing(ARMD_Context *context,
+                                ARMD_Size num_events_per_executor) {
+    if (context == NULL || num_events_per_executor == 0) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Executor *executor = context->executors[i];
+        if (executor->trace_buffer_storage != NULL) {
+            continue;
+        }
+
+        executor->trace_buffer_storage = armd__trace_buffer_create(
+            &context->memory_allocator, num_events_per_executor);
+        if (executor->trace_buffer_storage == NULL) {
+            // Keep the buffers already created; they are destroyed with
+            // the executors
+            return -1;
+        }
+    }
+
+    if (context->trace_base_timestamp == 0) {
+        context->trace_base_timestamp = armd_get_timestamp();
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        ARMD__Executor *executor = context->executors[i];
+        publish_trace_buffer(executor, executor->trace_buffer_storage);
+    }
+
+    return 0;
+}
+
+int armd_context_disable_tracing(ARMD_Context *context) {
+    if (context == NULL) {
+        return -1;
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        publish_trace_buffer(context->executors[i], NULL);
+    }
+
+    return 0;
+}
+
+int armd_context_write_trace(ARMD_Context *context,
+                             ARMD_TraceWriterFunc writer_func,
+                             void *writer_context) {
+    if (context == NULL || writer_func == NULL) {
+        return -1;
+    }
+
+    if (write_string(writer_func, writer_context, "{\"traceEvents\":[\n")) {
+        return -1;
+    }
+
+    char buf[128];
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        snprintf(buf, sizeof(buf),
+                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                 "\"tid\":%llu,\"args\":{\"name\":\"executor %llu\"}}",
+                 i == 0 ? "" : ",\n", (unsigned long long)i,
+                 (unsigned long long)i);
+        if (write_string(writer_func, writer_context, buf)) {
+            return -1;
+        }
+    }
+
+    for (ARMD_Size i = 0; i < context->num_executors; ++i) {
+        const ARMD__TraceBuffer *trace_buffer =
+            context->executors[i]->trace_buffer_storage;
+        if (trace_buffer == NULL) {
+            continue;
+        }
+
+        uint64_t end = load_num_recorded(trace_buffer);
+        uint64_t begin =
+            end > trace_buffer->capacity ? end - trace_buffer->capacity : 0;
+        for (uint64_t j = begin; j < end; ++j) {
+            if (write_event(writer_func, writer_context, i,
+                            context->trace_base_timestamp,
+                            &trace_buffer->events[j %
+                                                  trace_buffer->capacity])) {
+                return -1;
+            }
+        }
+    }
+
+    if (write_string(writer_func, writer_context, "\n]}\n")) {
+        return -1;
+    }
+
+    return 0;
+}
+
+#else
+
+int armd_context_enable_tracing(ARMD_Context *context,
+                                ARMD_Size num_events_per_executor) {
+    (void)context;
+    (void)num_events_per_executor;
+    return -1;
+}
+
+int armd_context_disable_tracing(ARMD_Context *context) {
+    (void)context;
+    return -1;
+}
+
+int armd_context_write_trace(ARMD_Context *context,
+                             ARMD_TraceWriterFunc writer_func,
+                             void *writer_context) {
+    (void)context;
+    (void)writer_func;
+    (void)writer_context;
+    return -1;
+}
+
+#endif
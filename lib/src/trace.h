@@ -0,0 +1,72 @@
+#ifndef ARAMID__TRACE_H
+#define ARAMID__TRACE_H
+
+#include <aramid/aramid.h>
+
+typedef enum TAG_ARMD__TraceEventType {
+    ARMD__TraceEventType_JobBegin,
+    ARMD__TraceEventType_JobEnd,
+    ARMD__TraceEventType_Fork,
+    ARMD__TraceEventType_Steal,
+    ARMD__TraceEventType_Park,
+    ARMD__TraceEventType_Unpark,
+    ARMD__TraceEventType_PromiseComplete,
+    ARMD__TraceEventType_DependencyRelease,
+} ARMD__TraceEventType;
+
+/*
+ * arg is the procedure for JobBegin, JobEnd and Fork, the victim executor id
+ * for Steal and the promise handle for PromiseComplete and DependencyRelease.
+ */
+typedef struct TAG_ARMD__TraceEvent {
+    // armd_get_timestamp
+    uint64_t timestamp;
+    uint64_t arg;
+    ARMD__TraceEventType type;
+} ARMD__TraceEvent;
+
+/*
+ * Ring buffer written only by the owning executor. When it is full the oldest
+ * events are overwritten. The events and the counter are either owned or
+ * placed in a flight recorder file, which outlives the buffer.
+ */
+typedef struct TAG_ARMD__TraceBuffer {
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Size capacity;
+    volatile uint64_t *num_recorded;
+    ARMD__TraceEvent *events;
+    ARMD_Bool owns_events;
+    volatile uint64_t num_recorded_storage;
+} ARMD__TraceBuffer;
+
+ARMD_EXTERN_C ARMD__TraceBuffer *
+armd__trace_buffer_create(const ARMD_MemoryAllocator *memory_allocator,
+                          ARMD_Size capacity);
+/* Records into the given memory, which must be zero-initialized */
+ARMD_EXTERN_C ARMD__TraceBuffer *armd__trace_buffer_create_mapped(
+    const ARMD_MemoryAllocator *memory_allocator, ARMD_Size capacity,
+    ARMD__TraceEvent *events, volatile uint64_t *num_recorded);
+ARMD_EXTERN_C void armd__trace_buffer_destroy(ARMD__TraceBuffer *trace_buffer);
+
+ARMD_EXTERN_C void armd__trace_buffer_record(ARMD__TraceBuffer *trace_buffer,
+                                             ARMD__TraceEventType type,
+                                             uint64_t arg);
+
+/*
+ * Records an event if tracing is enabled on the executor. The check is the
+ * only cost while disabled and it is compiled out with ARAMID_DISABLE_TRACING.
+ */
+#ifndef ARAMID_DISABLE_TRACING
+#define ARMD__TRACE(executor, type, arg)                                       \
+    do {                                                                       \
+        ARMD__TraceBuffer *armd__trace_buffer = (executor)->trace_buffer;      \
+        if (armd__trace_buffer != NULL) {                                      \
+            armd__trace_buffer_record(armd__trace_buffer, (type),              \
+                                      (uint64_t)(arg));                        \
+        }                                                                      \
+    } while (0)
+#else
+#define ARMD__TRACE(executor, type, arg) ((void)(executor))
+#endif
+
+#endif // ARAMID__TRACE_H
@@ -4,6 +4,10 @@ set -euxo pipefail
 
 proj_dir=$(cd "$(dirname "$0")/.."; pwd)
 clang-format-9 -i \
+    "$proj_dir"/bench/src/*.cpp \
+    "$proj_dir"/bench/src/*.hpp \
+    "$proj_dir"/bench/src/primitives/*.cpp \
+    "$proj_dir"/bench/src/workloads/*.cpp \
     "$proj_dir"/lib/src/*.c \
     "$proj_dir"/lib/src/*.cpp \
     "$proj_dir"/lib/src/*.h \
@@ -12,4 +16,5 @@ clang-format-9 -i \
     "$proj_dir"/tests/src/*.hpp \
     "$proj_dir"/test_executable/src/*.cpp \
     "$proj_dir"/test_library/include/aramid/*.hpp \
-    "$proj_dir"/test_library/src/*.cpp
+    "$proj_dir"/test_library/src/*.cpp \
+    "$proj_dir"/tools/src/*.cpp
@@ -0,0 +1,196 @@
+#include <cstdint>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+
+#if defined(__linux__)
+#include <poll.h>
+#endif
+
+namespace {
+
+class CompletionQueueTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+    ARMD_Procedure *procedure;
+
+    CompletionQueueTest() {}
+
+    ~CompletionQueueTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator,
+                                      aramid::test::get_num_executors());
+
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_then_single(builder, check_continuation);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    void TearDown() override {
+        int res = armd_procedure_destroy(procedure);
+        ASSERT_EQ(res, 0);
+        res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+
+    // Fails if args is not NULL
+    static int check_continuation(ARMD_Job *job, const void *constants,
+                                  void *args, void *frame) {
+        (void)job;
+        (void)constants;
+        (void)frame;
+        return args != nullptr;
+    }
+};
+
+TEST_F(CompletionQueueTest, Poll) {
+    int res;
+
+    ARMD_CompletionQueue *completion_queue =
+        armd_completion_queue_create(context, 0);
+    ASSERT_NE(completion_queue, nullptr);
+    ASSERT_EQ(armd_completion_queue_get_fd(completion_queue), -1);
+
+    // Not a valid handle
+    res = armd_completion_queue_watch(completion_queue, 12345, nullptr);
+    ASSERT_NE(res, 0);
+
+    const ARMD_Size num_promises = 100;
+    int failing_arg = 0;
+    std::vector<ARMD_Handle> handles(num_promises);
+    for (ARMD_Size i = 0; i < num_promises; ++i) {
+        // Every tenth one fails
+        void *args = i % 10 == 0 ? &failing_arg : nullptr;
+        handles[i] = armd_invoke(context, procedure, args, 0, nullptr);
+        ASSERT_NE(handles[i], 0u);
+        res = armd_completion_queue_watch(completion_queue, handles[i],
+                                          reinterpret_cast<void *>(i));
+        ASSERT_EQ(res, 0);
+    }
+
+    // Harvested in small batches
+    std::vector<bool> completed(num_promises, false);
+    ARMD_Size num_completed = 0;
+    while (num_completed < num_promises) {
+        ARMD_Completion completions[7];
+        ARMD_Size num_completions =
+            armd_completion_queue_poll(completion_queue, completions, 7);
+        ASSERT_LE(num_completions, 7u);
+
+        for (ARMD_Size i = 0; i < num_completions; ++i) {
+            ARMD_Size index =
+                reinterpret_cast<ARMD_Size>(completions[i].user_context);
+            ASSERT_LT(index, num_promises);
+            ASSERT_FALSE(completed[index]);
+            ASSERT_EQ(completions[i].handle, handles[index]);
+            ASSERT_EQ(completions[i].has_error != 0, index % 10 == 0);
+            completed[index] = true;
+
+            // Not blocking
+            res = armd_await(context, completions[i].handle);
+            ASSERT_EQ(res, index % 10 == 0 ? -2 : 0);
+        }
+        num_completed += num_completions;
+    }
+
+    ARMD_Completion completion;
+    ASSERT_EQ(armd_completion_queue_poll(completion_queue, &completion, 1),
+              0u);
+
+    res = armd_completion_queue_destroy(completion_queue);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(CompletionQueueTest, AlreadyCompleted) {
+    int res;
+
+    ARMD_CompletionQueue *completion_queue =
+        armd_completion_queue_create(context, 0);
+    ASSERT_NE(completion_queue, nullptr);
+
+    ARMD_Handle handle = armd_invoke(context, procedure, nullptr, 0, nullptr);
+    ASSERT_NE(handle, 0u);
+
+    // Ends the promise while keeping its handle
+    ARMD_Handle dependencies[1] = {handle};
+    ARMD_Handle join_handle =
+        armd_invoke(context, procedure, nullptr, 1, dependencies);
+    res = armd_await(context, join_handle);
+    ASSERT_EQ(res, 0);
+
+    res = armd_completion_queue_watch(completion_queue, handle, nullptr);
+    ASSERT_EQ(res, 0);
+
+    ARMD_Completion completion;
+    ASSERT_EQ(armd_completion_queue_poll(completion_queue, &completion, 1),
+              1u);
+    ASSERT_EQ(completion.handle, handle);
+    ASSERT_EQ(completion.has_error, 0);
+
+    res = armd_await(context, handle);
+    ASSERT_EQ(res, 0);
+
+    res = armd_completion_queue_destroy(completion_queue);
+    ASSERT_EQ(res, 0);
+}
+
+#if defined(__linux__)
+
+bool is_readable(int fd, int timeout_milliseconds) {
+    struct pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    return poll(&poll_fd, 1, timeout_milliseconds) == 1 &&
+           (poll_fd.revents & POLLIN) != 0;
+}
+
+TEST_F(CompletionQueueTest, Fd) {
+    int res;
+
+    ARMD_CompletionQueue *completion_queue =
+        armd_completion_queue_create(context, 1);
+    ASSERT_NE(completion_queue, nullptr);
+    int fd = armd_completion_queue_get_fd(completion_queue);
+    ASSERT_GE(fd, 0);
+    ASSERT_FALSE(is_readable(fd, 0));
+
+    const ARMD_Size num_promises = 10;
+    for (ARMD_Size i = 0; i < num_promises; ++i) {
+        ARMD_Handle handle =
+            armd_invoke(context, procedure, nullptr, 0, nullptr);
+        ASSERT_NE(handle, 0u);
+        res = armd_completion_queue_watch(completion_queue, handle, nullptr);
+        ASSERT_EQ(res, 0);
+        res = armd_detach(context, handle);
+        ASSERT_EQ(res, 0);
+    }
+
+    // The loop thread sleeps on the descriptor
+    ARMD_Size num_completed = 0;
+    while (num_completed < num_promises) {
+        ASSERT_TRUE(is_readable(fd, 10 * 1000));
+
+        // Readable while some are left
+        ARMD_Completion completion;
+        num_completed +=
+            armd_completion_queue_poll(completion_queue, &completion, 1);
+    }
+    ASSERT_FALSE(is_readable(fd, 0));
+
+    res = armd_completion_queue_destroy(completion_queue);
+    ASSERT_EQ(res, 0);
+}
+
+#endif
+
+} // namespace
@@ -6,9 +6,16 @@
 #include <aramid/aramid.h>
 
 #include "config.hpp"
+#include "fibonacci.hpp"
 
 namespace {
 
+using aramid::test::FibonacciArgs;
+using aramid::test::FibonacciConstants;
+using aramid::test::FibonacciFrame;
+using aramid::test::fibonacci_continuation1;
+using aramid::test::fibonacci_continuation2;
+
 class ExecutionTest : public ::testing::Test {
 protected:
     ARMD_MemoryAllocator memory_allocator;
@@ -112,68 +119,6 @@ int single_normal_spawn_child_continuation(ARMD_Job *job, const void *constants,
     return 0;
 }
 
-typedef struct TAG_FibonacciArgs {
-    uint64_t input;
-    uint64_t *result;
-} FibonacciArgs;
-
-typedef struct TAG_FibonacciFrame {
-    FibonacciArgs child_args_1;
-    FibonacciArgs child_args_2;
-    uint64_t child_result_1;
-    uint64_t child_result_2;
-} FibonacciFrame;
-
-typedef struct TAG_FibonacciConstants {
-    ARMD_Procedure *fibonacci_procedure;
-} FibonacciConstants;
-
-int fibonacci_continuation1(ARMD_Job *job, const void *constants, void *args,
-                            void *frame) {
-    const FibonacciConstants *typed_constants =
-        reinterpret_cast<const FibonacciConstants *>(constants);
-    const FibonacciArgs *typed_args =
-        reinterpret_cast<const FibonacciArgs *>(args);
-    FibonacciFrame *typed_frame = reinterpret_cast<FibonacciFrame *>(frame);
-
-    if (typed_args->input >= 2) {
-        typed_frame->child_args_1.input = typed_args->input - 1;
-        typed_frame->child_args_1.result = &typed_frame->child_result_1;
-
-        typed_frame->child_args_2.input = typed_args->input - 2;
-        typed_frame->child_args_2.result = &typed_frame->child_result_2;
-
-        armd_fork(job, typed_constants->fibonacci_procedure,
-                  &typed_frame->child_args_1);
-        armd_fork(job, typed_constants->fibonacci_procedure,
-                  &typed_frame->child_args_2);
-    }
-
-    return 0;
-}
-
-int fibonacci_continuation2(ARMD_Job *job, const void *constants, void *args,
-                            void *frame) {
-    (void)job;
-
-    const FibonacciConstants *typed_constants =
-        reinterpret_cast<const FibonacciConstants *>(constants);
-    const FibonacciArgs *typed_args =
-        reinterpret_cast<const FibonacciArgs *>(args);
-    FibonacciFrame *typed_frame = reinterpret_cast<FibonacciFrame *>(frame);
-
-    (void)typed_constants;
-
-    if (typed_args->input >= 2) {
-        *typed_args->result =
-            typed_frame->child_result_1 + typed_frame->child_result_2;
-    } else {
-        *typed_args->result = 1;
-    }
-
-    return 0;
-}
-
 TEST_F(ExecutionTest, ExecuteEmptyProcedure) {
     int res;
 
@@ -407,4 +352,109 @@ TEST_F(ExecutionTest, ExecuteUnwind) {
     ASSERT_EQ(res, 0);
 }
 
+typedef struct TAG_SetupArgs {
+    bool setup;
+    bool setup_before_continuation;
+} SetupArgs;
+
+ARMD_Bool setup_setup(ARMD_Job *job, const void *constants, void *args,
+                      void *frame, ARMD_Bool dependency_has_error) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    reinterpret_cast<SetupArgs *>(args)->setup = true;
+    return dependency_has_error;
+}
+
+int setup_continuation(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    SetupArgs *typed_args = reinterpret_cast<SetupArgs *>(args);
+    typed_args->setup_before_continuation = typed_args->setup;
+    return 0;
+}
+
+TEST_F(ExecutionTest, ExecuteSetup) {
+    int res;
+
+    ARMD_Procedure *setup_procedure;
+    {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_setup(builder, setup_setup);
+        armd_then_single(builder, setup_continuation);
+        setup_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    SetupArgs args;
+    args.setup = false;
+    args.setup_before_continuation = false;
+
+    ARMD_Handle promise =
+        armd_invoke(context, setup_procedure, &args, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_TRUE(args.setup_before_continuation);
+
+    res = armd_procedure_destroy(setup_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+typedef struct TAG_AlignedArgs {
+    bool aligned;
+} AlignedArgs;
+
+int aligned_continuation(ARMD_Job *job, const void *constants, void *args,
+                         void *frame) {
+    (void)job;
+
+    AlignedArgs *typed_args = reinterpret_cast<AlignedArgs *>(args);
+    typed_args->aligned =
+        reinterpret_cast<std::uintptr_t>(constants) % 64 == 0 &&
+        reinterpret_cast<std::uintptr_t>(frame) % 64 == 0;
+    return 0;
+}
+
+TEST_F(ExecutionTest, ExecuteAlignedProcedure) {
+    int res;
+
+    ARMD_Procedure *aligned_procedure;
+    {
+        ARMD_ProcedureBuilder *builder = armd_procedure_builder_create_aligned(
+            &memory_allocator, 24, 40, 64);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(
+                      armd_procedure_builder_get_constants(builder)) %
+                      64,
+                  0u);
+        armd_then_single(builder, aligned_continuation);
+        aligned_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    const int num_invocations = 100;
+    AlignedArgs args[num_invocations];
+    ARMD_Handle promises[num_invocations];
+    for (int i = 0; i < num_invocations; ++i) {
+        args[i].aligned = false;
+        promises[i] =
+            armd_invoke(context, aligned_procedure, &args[i], 0, nullptr);
+        ASSERT_NE(promises[i], 0u);
+    }
+
+    for (int i = 0; i < num_invocations; ++i) {
+        res = armd_await(context, promises[i]);
+        ASSERT_EQ(res, 0);
+        ASSERT_TRUE(args[i].aligned);
+    }
+
+    res = armd_procedure_destroy(aligned_procedure);
+    ASSERT_EQ(res, 0);
+}
+
 } // namespace
@@ -0,0 +1,73 @@
+#ifndef ARAMID_TESTS_FIBONACCI_HPP
+#define ARAMID_TESTS_FIBONACCI_HPP
+
+#include <cstdint>
+
+#include <aramid/aramid.h>
+
+namespace aramid {
+namespace test {
+
+typedef struct TAG_FibonacciArgs {
+    uint64_t input;
+    uint64_t *result;
+} FibonacciArgs;
+
+typedef struct TAG_FibonacciFrame {
+    FibonacciArgs child_args_1;
+    FibonacciArgs child_args_2;
+    uint64_t child_result_1;
+    uint64_t child_result_2;
+} FibonacciFrame;
+
+typedef struct TAG_FibonacciConstants {
+    ARMD_Procedure *fibonacci_procedure;
+} FibonacciConstants;
+
+inline int fibonacci_continuation1(ARMD_Job *job, const void *constants,
+                                   void *args, void *frame) {
+    const FibonacciConstants *typed_constants =
+        reinterpret_cast<const FibonacciConstants *>(constants);
+    const FibonacciArgs *typed_args =
+        reinterpret_cast<const FibonacciArgs *>(args);
+    FibonacciFrame *typed_frame = reinterpret_cast<FibonacciFrame *>(frame);
+
+    if (typed_args->input >= 2) {
+        typed_frame->child_args_1.input = typed_args->input - 1;
+        typed_frame->child_args_1.result = &typed_frame->child_result_1;
+
+        typed_frame->child_args_2.input = typed_args->input - 2;
+        typed_frame->child_args_2.result = &typed_frame->child_result_2;
+
+        armd_fork(job, typed_constants->fibonacci_procedure,
+                  &typed_frame->child_args_1);
+        armd_fork(job, typed_constants->fibonacci_procedure,
+                  &typed_frame->child_args_2);
+    }
+
+    return 0;
+}
+
+inline int fibonacci_continuation2(ARMD_Job *job, const void *constants,
+                                   void *args, void *frame) {
+    (void)job;
+    (void)constants;
+
+    const FibonacciArgs *typed_args =
+        reinterpret_cast<const FibonacciArgs *>(args);
+    FibonacciFrame *typed_frame = reinterpret_cast<FibonacciFrame *>(frame);
+
+    if (typed_args->input >= 2) {
+        *typed_args->result =
+            typed_frame->child_result_1 + typed_frame->child_result_2;
+    } else {
+        *typed_args->result = 1;
+    }
+
+    return 0;
+}
+
+} // namespace test
+} // namespace aramid
+
+#endif // ARAMID_TESTS_FIBONACCI_HPP
@@ -0,0 +1,70 @@
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+
+namespace {
+
+TEST(StaticPartitionTest, CoverAllElements) {
+    const ARMD_Size counts[] = {0, 1, 7, 64, 1000};
+    const ARMD_Size num_parts_list[] = {1, 3, 8};
+
+    for (ARMD_Size count : counts) {
+        for (ARMD_Size num_parts : num_parts_list) {
+            ARMD_Size expected_begin = 0;
+            for (ARMD_Size i = 0; i < num_parts; ++i) {
+                ARMD_Size begin, end;
+                armd_get_static_partition(count, num_parts, i, &begin, &end);
+                ASSERT_EQ(begin, expected_begin);
+                ASSERT_LE(begin, end);
+                ASSERT_LE(end - begin, count / num_parts + 1);
+                ASSERT_GE(end - begin, count / num_parts);
+                expected_begin = end;
+            }
+            ASSERT_EQ(expected_begin, count);
+        }
+    }
+}
+
+class FirstTouchTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+
+    FirstTouchTest() {}
+
+    ~FirstTouchTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator,
+                                      aramid::test::get_num_executors());
+    }
+
+    void TearDown() override {
+        int res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+};
+
+TEST_F(FirstTouchTest, Allocate) {
+    const ARMD_Size sizes[] = {1, 5000, 16 * 1024 * 1024 + 3};
+
+    for (ARMD_Size size : sizes) {
+        unsigned char *buf = static_cast<unsigned char *>(
+            armd_allocate_first_touch(context, &memory_allocator, size));
+        ASSERT_NE(buf, nullptr);
+
+        for (ARMD_Size i = 0; i < size; i += 4096) {
+            ASSERT_EQ(buf[i], 0);
+        }
+        memset(buf, 0xff, size);
+
+        armd_memory_allocator_free(&memory_allocator, buf);
+    }
+}
+
+} // namespace
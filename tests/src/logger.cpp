@@ -1,4 +1,7 @@
+#include <atomic>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -219,4 +222,309 @@ TEST_F(LoggerTest, Macros) {
     armd_log_trace(logger, "trace: %d", 6);
 }
 
+class AsyncLoggerTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_MemoryRegion *memory_region;
+    ARMD_Logger *logger;
+
+    AsyncLoggerTest() {}
+
+    ~AsyncLoggerTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        memory_region = armd_memory_region_create(&memory_allocator);
+        logger = armd_logger_create(memory_region, ARMD_LogLevel_Debug);
+    }
+
+    void TearDown() override {
+        ARMD_Bool destroyed = armd_logger_decrement_reference_count(logger);
+        ASSERT_TRUE(destroyed);
+        armd_memory_region_destroy(memory_region);
+    }
+};
+
+struct CountingCallbackContext {
+    std::atomic<int> num_elements;
+    std::atomic<bool> ok;
+    // The callback waits while it is false
+    std::atomic<bool> released;
+};
+
+static void counting_callback(void *context, ARMD_Logger *logger) {
+    CountingCallbackContext *typed_context =
+        reinterpret_cast<CountingCallbackContext *>(context);
+    while (!typed_context->released) {
+        std::this_thread::yield();
+    }
+
+    ARMD_LogElement *elem;
+    while (armd_logger_get_log_element(logger, &elem) == 0) {
+        if (elem->level != ARMD_LogLevel_Info ||
+            strncmp(elem->message, "message ", 8) != 0) {
+            typed_context->ok = false;
+        }
+        ++typed_context->num_elements;
+        armd_logger_destroy_log_element(logger, elem);
+    }
+}
+
+TEST_F(AsyncLoggerTest, LogAndFlush) {
+    int res;
+    res = armd_logger_enable_async(logger, 1, 16,
+                                   ARMD_LogOverflowPolicy_Block);
+    ASSERT_EQ(res, 0);
+
+    armd_log_info(logger, "a: %d", 1);
+    armd_logger_log_string(logger, ARMD_LogLevel_Warn, __FILE__, __LINE__,
+                           armd_memory_region_strdup(memory_region, "b"));
+    armd_log_trace(logger, "c: %d", 3);
+
+    res = armd_logger_flush(logger);
+    ASSERT_EQ(res, 0);
+
+    ARMD_LogElement *elem;
+    res = armd_logger_get_log_element(logger, &elem);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(elem->level, ARMD_LogLevel_Info);
+    ASSERT_NE(elem->timespec.seconds, 0);
+    ASSERT_STREQ(elem->message, "a: 1");
+    armd_logger_destroy_log_element(logger, elem);
+
+    res = armd_logger_get_log_element(logger, &elem);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(elem->level, ARMD_LogLevel_Warn);
+    ASSERT_STREQ(elem->message, "b");
+    armd_logger_destroy_log_element(logger, elem);
+
+    // Trace is above the level
+    res = armd_logger_get_log_element(logger, &elem);
+    ASSERT_NE(res, 0);
+}
+
+TEST_F(AsyncLoggerTest, TruncateLongMessage) {
+    int res;
+    res = armd_logger_enable_async(logger, 1, 16,
+                                   ARMD_LogOverflowPolicy_Block);
+    ASSERT_EQ(res, 0);
+
+    std::string message(1000, 'x');
+    armd_log_info(logger, "%s", message.c_str());
+    armd_logger_flush(logger);
+
+    ARMD_LogElement *elem;
+    res = armd_logger_get_log_element(logger, &elem);
+    ASSERT_EQ(res, 0);
+    ASSERT_GT(strlen(elem->message), 0u);
+    ASSERT_LT(strlen(elem->message), message.size());
+    armd_logger_destroy_log_element(logger, elem);
+}
+
+TEST_F(AsyncLoggerTest, BlockFromManyThreads) {
+    int res;
+    // Smaller than the number of records to make the producers wait
+    res = armd_logger_enable_async(logger, 2, 4,
+                                   ARMD_LogOverflowPolicy_Block);
+    ASSERT_EQ(res, 0);
+
+    CountingCallbackContext context;
+    context.num_elements = 0;
+    context.ok = true;
+    context.released = true;
+    armd_logger_set_callback(logger, counting_callback, &context);
+
+    const int num_threads = 4;
+    const int num_records_per_thread = 1000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([this, i]() {
+            for (int j = 0; j < num_records_per_thread; ++j) {
+                armd_log_info(logger, "message %d %d", i, j);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    res = armd_logger_flush(logger);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_TRUE(context.ok);
+    ASSERT_EQ(context.num_elements, num_threads * num_records_per_thread);
+    ASSERT_EQ(armd_logger_get_num_dropped(logger), 0u);
+}
+
+TEST_F(AsyncLoggerTest, Drop) {
+    int res;
+    res = armd_logger_enable_async(logger, 1, 4, ARMD_LogOverflowPolicy_Drop);
+    ASSERT_EQ(res, 0);
+
+    // Keeps the flusher in the callback while the buffer fills up
+    CountingCallbackContext context;
+    context.num_elements = 0;
+    context.ok = true;
+    context.released = false;
+    armd_logger_set_callback(logger, counting_callback, &context);
+
+    const int num_records = 100;
+    for (int i = 0; i < num_records; ++i) {
+        armd_log_info(logger, "message %d", i);
+    }
+
+    context.released = true;
+    res = armd_logger_flush(logger);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_TRUE(context.ok);
+    ARMD_Size num_dropped = armd_logger_get_num_dropped(logger);
+    ASSERT_GT(num_dropped, 0u);
+    ASSERT_EQ(context.num_elements + num_dropped, (ARMD_Size)num_records);
+}
+
+TEST_F(AsyncLoggerTest, DrainOnRelease) {
+    int res;
+    res = armd_logger_enable_async(logger, 1, 16,
+                                   ARMD_LogOverflowPolicy_Block);
+    ASSERT_EQ(res, 0);
+
+    CountingCallbackContext context;
+    context.num_elements = 0;
+    context.ok = true;
+    context.released = true;
+    armd_logger_set_callback(logger, counting_callback, &context);
+
+    armd_logger_increment_reference_count(logger);
+    armd_log_info(logger, "message %d", 0);
+    armd_log_info(logger, "message %d", 1);
+    ARMD_Bool destroyed = armd_logger_decrement_reference_count(logger);
+    ASSERT_FALSE(destroyed);
+
+    // TearDown releases the last reference, which drains the records
+    destroyed = armd_logger_decrement_reference_count(logger);
+    ASSERT_TRUE(destroyed);
+    ASSERT_TRUE(context.ok);
+    ASSERT_EQ(context.num_elements, 2);
+
+    logger = armd_logger_create(memory_region, ARMD_LogLevel_Debug);
+}
+
+TEST_F(AsyncLoggerTest, DeferredFormat) {
+    int res;
+    res = armd_logger_enable_async(logger, 1, 16,
+                                   ARMD_LogOverflowPolicy_Block);
+    ASSERT_EQ(res, 0);
+    res = armd_logger_enable_deferred_format(logger);
+    ASSERT_EQ(res, 0);
+
+    char name[] = "first";
+    armd_log_info(logger, "%s %d %.2f %c", name, -42, 1.5, 'x');
+    // The argument is copied, not referenced
+    name[0] = 'F';
+    // Formatted on the spot
+    armd_log_info(logger, "%ls", L"wide");
+    armd_logger_flush(logger);
+
+    ARMD_LogElement *elem;
+    res = armd_logger_get_log_element(logger, &elem);
+    ASSERT_EQ(res, 0);
+    ASSERT_STREQ(elem->message, "first -42 1.50 x");
+    armd_logger_destroy_log_element(logger, elem);
+
+    res = armd_logger_get_log_element(logger, &elem);
+    ASSERT_EQ(res, 0);
+    ASSERT_STREQ(elem->message, "wide");
+    armd_logger_destroy_log_element(logger, elem);
+}
+
+TEST_F(AsyncLoggerTest, EnableDeferredFormatWithoutAsync) {
+    ASSERT_NE(armd_logger_enable_deferred_format(logger), 0);
+}
+
+static int string_writer(void *writer_context, const void *data,
+                         ARMD_Size size) {
+    std::string *output = reinterpret_cast<std::string *>(writer_context);
+    output->append(reinterpret_cast<const char *>(data), size);
+    return 0;
+}
+
+struct DecodedElement {
+    ARMD_LogLevel level;
+    std::string filename;
+    ARMD_Size lineno;
+    std::string message;
+};
+
+static int collecting_decoder(void *decoder_context,
+                              const ARMD_LogElement *log_element) {
+    std::vector<DecodedElement> *elements =
+        reinterpret_cast<std::vector<DecodedElement> *>(decoder_context);
+    DecodedElement element;
+    element.level = log_element->level;
+    element.filename = log_element->filename;
+    element.lineno = log_element->lineno;
+    element.message = log_element->message;
+    elements->push_back(element);
+    return 0;
+}
+
+TEST_F(AsyncLoggerTest, BinaryWriter) {
+    int res;
+    res = armd_logger_enable_async(logger, 1, 16,
+                                   ARMD_LogOverflowPolicy_Block);
+    ASSERT_EQ(res, 0);
+
+    std::string output;
+    res = armd_logger_set_binary_writer(logger, string_writer, &output);
+    ASSERT_EQ(res, 0);
+    ASSERT_NE(armd_logger_set_binary_writer(logger, string_writer, &output),
+              0);
+
+    for (int i = 0; i < 3; ++i) {
+        armd_log_warn(logger, "%s %d", "loop", i);
+    }
+    armd_logger_log_string(logger, ARMD_LogLevel_Error, "file.c", 10,
+                           armd_memory_region_strdup(memory_region, "text"));
+    armd_logger_flush(logger);
+
+    // No log element is made
+    ARMD_LogElement *elem;
+    ASSERT_NE(armd_logger_get_log_element(logger, &elem), 0);
+
+    std::vector<DecodedElement> elements;
+    res = armd_logger_decode_binary(memory_region, output.data(),
+                                    output.size(), collecting_decoder,
+                                    &elements);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(elements.size(), 4u);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(elements[i].level, ARMD_LogLevel_Warn);
+        ASSERT_EQ(elements[i].filename, __FILE__);
+        ASSERT_EQ(elements[i].message, "loop " + std::to_string(i));
+    }
+    ASSERT_EQ(elements[3].level, ARMD_LogLevel_Error);
+    ASSERT_EQ(elements[3].filename, "file.c");
+    ASSERT_EQ(elements[3].lineno, 10u);
+    ASSERT_EQ(elements[3].message, "text");
+
+    // The incomplete record at the end is ignored
+    elements.clear();
+    res = armd_logger_decode_binary(memory_region, output.data(),
+                                    output.size() - 1, collecting_decoder,
+                                    &elements);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(elements.size(), 3u);
+}
+
+TEST_F(AsyncLoggerTest, DecodeMalformedBinary) {
+    std::vector<DecodedElement> elements;
+    const char garbage[] = "not a binary log";
+    int res = armd_logger_decode_binary(memory_region, garbage,
+                                        sizeof(garbage), collecting_decoder,
+                                        &elements);
+    ASSERT_NE(res, 0);
+    ASSERT_TRUE(elements.empty());
+}
+
 } // namespace
@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+#include "fibonacci.hpp"
+
+namespace {
+
+using aramid::test::FibonacciArgs;
+using aramid::test::FibonacciConstants;
+using aramid::test::FibonacciFrame;
+using aramid::test::fibonacci_continuation1;
+using aramid::test::fibonacci_continuation2;
+
+class PooledMemoryAllocatorTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+
+    PooledMemoryAllocatorTest() {}
+
+    ~PooledMemoryAllocatorTest() override {}
+
+    void SetUp() override {
+        int res = armd_memory_allocator_init_pooled(&memory_allocator, 0);
+        ASSERT_EQ(res, 0);
+    }
+
+    void TearDown() override {
+        armd_memory_allocator_deinit_pooled(&memory_allocator);
+    }
+};
+
+TEST_F(PooledMemoryAllocatorTest, AllocateVariousSizes) {
+    std::vector<unsigned char *> bufs;
+    for (ARMD_Size size = 0; size < 70000; size = size * 5 / 4 + 1) {
+        unsigned char *buf = static_cast<unsigned char *>(
+            armd_memory_allocator_allocate(&memory_allocator, size));
+        ASSERT_NE(buf, nullptr);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(buf) % 16, 0u);
+        memset(buf, static_cast<int>(size & 0xff), size);
+        bufs.push_back(buf);
+    }
+
+    ARMD_Size size = 0;
+    for (unsigned char *buf : bufs) {
+        for (ARMD_Size i = 0; i < size; ++i) {
+            ASSERT_EQ(buf[i], static_cast<unsigned char>(size & 0xff));
+        }
+        armd_memory_allocator_free(&memory_allocator, buf);
+        size = size * 5 / 4 + 1;
+    }
+}
+
+TEST_F(PooledMemoryAllocatorTest, ZeroFill) {
+    ARMD_MemoryAllocator zero_fill_memory_allocator;
+    int res =
+        armd_memory_allocator_init_pooled(&zero_fill_memory_allocator, 1);
+    ASSERT_EQ(res, 0);
+
+    for (int i = 0; i < 4; ++i) {
+        unsigned char *buf = static_cast<unsigned char *>(
+            armd_memory_allocator_allocate(&zero_fill_memory_allocator, 100));
+        ASSERT_NE(buf, nullptr);
+        for (int j = 0; j < 100; ++j) {
+            ASSERT_EQ(buf[j], 0);
+        }
+        memset(buf, 0xff, 100);
+        armd_memory_allocator_free(&zero_fill_memory_allocator, buf);
+    }
+
+    armd_memory_allocator_deinit_pooled(&zero_fill_memory_allocator);
+}
+
+TEST_F(PooledMemoryAllocatorTest, FreeOnAnotherThread) {
+    const int num_bufs = 1000;
+
+    std::vector<void *> bufs;
+    for (int i = 0; i < num_bufs; ++i) {
+        bufs.push_back(armd_memory_allocator_allocate(&memory_allocator, 48));
+        ASSERT_NE(bufs.back(), nullptr);
+    }
+
+    std::thread thread([this, &bufs] {
+        for (void *buf : bufs) {
+            armd_memory_allocator_free(&memory_allocator, buf);
+        }
+    });
+    thread.join();
+}
+
+TEST_F(PooledMemoryAllocatorTest, AllocateAligned) {
+    for (ARMD_Size alignment = 1; alignment <= 4096; alignment *= 2) {
+        void *buf = armd_memory_allocator_allocate_aligned(&memory_allocator,
+                                                           100, alignment);
+        ASSERT_NE(buf, nullptr);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(buf) % alignment, 0u);
+        memset(buf, 0xff, 100);
+        armd_memory_allocator_free_aligned(&memory_allocator, buf);
+    }
+}
+
+TEST(HugePageMemoryAllocatorTest, AllocateSmallAndLarge) {
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_huge_page(&memory_allocator);
+
+    const ARMD_Size sizes[] = {16, 1024 * 1024, 5 * 1024 * 1024};
+    for (ARMD_Size size : sizes) {
+        unsigned char *buf = static_cast<unsigned char *>(
+            armd_memory_allocator_allocate(&memory_allocator, size));
+        ASSERT_NE(buf, nullptr);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(buf) % 16, 0u);
+        ASSERT_EQ(buf[0], 0);
+        ASSERT_EQ(buf[size - 1], 0);
+        memset(buf, 0xff, size);
+        armd_memory_allocator_free(&memory_allocator, buf);
+    }
+
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create(&memory_allocator);
+    ASSERT_NE(memory_region, nullptr);
+    void *buf = armd_memory_region_allocate(memory_region, 4 * 1024 * 1024);
+    ASSERT_NE(buf, nullptr);
+    memset(buf, 0xff, 4 * 1024 * 1024);
+    armd_memory_region_destroy(memory_region);
+}
+
+TEST_F(PooledMemoryAllocatorTest, ExecuteFibonacci) {
+    int res;
+
+    ARMD_Context *context = armd_context_create(
+        &memory_allocator, aramid::test::get_num_executors());
+    ASSERT_NE(context, nullptr);
+
+    ARMD_Procedure *fibonacci_procedure;
+    {
+        ARMD_ProcedureBuilder *builder = armd_procedure_builder_create(
+            &memory_allocator, sizeof(FibonacciConstants),
+            sizeof(FibonacciFrame));
+        armd_then_single(builder, fibonacci_continuation1);
+        armd_then_single(builder, fibonacci_continuation2);
+        fibonacci_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    FibonacciConstants *fibonacci_constants =
+        reinterpret_cast<FibonacciConstants *>(
+            armd_procedure_get_constants(fibonacci_procedure));
+    fibonacci_constants->fibonacci_procedure = fibonacci_procedure;
+
+    FibonacciArgs args;
+    uint64_t result;
+
+    args.input = 20;
+    args.result = &result;
+
+    ARMD_Handle promise =
+        armd_invoke(context, fibonacci_procedure, &args, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_EQ(result, 10946u);
+
+    res = armd_procedure_destroy(fibonacci_procedure);
+    ASSERT_EQ(res, 0);
+
+    res = armd_context_destroy(context);
+    ASSERT_EQ(res, 0);
+}
+
+} // namespace
@@ -0,0 +1,112 @@
+#include <stdint.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+namespace {
+
+class MemoryRegionTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+    }
+};
+
+TEST_F(MemoryRegionTest, ArenaAllocate) {
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create_arena(&memory_allocator, 256);
+    ASSERT_NE(memory_region, nullptr);
+
+    unsigned char *small_bufs[64];
+    for (int i = 0; i < 64; ++i) {
+        small_bufs[i] = static_cast<unsigned char *>(
+            armd_memory_region_allocate(memory_region, 24));
+        ASSERT_NE(small_bufs[i], nullptr);
+        memset(small_bufs[i], i, 24);
+    }
+
+    unsigned char *large_buf = static_cast<unsigned char *>(
+        armd_memory_region_allocate(memory_region, 1000));
+    ASSERT_NE(large_buf, nullptr);
+    memset(large_buf, 0xff, 1000);
+
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < 24; ++j) {
+            ASSERT_EQ(small_bufs[i][j], i);
+        }
+        // No-op
+        armd_memory_region_free(memory_region, small_bufs[i]);
+    }
+
+    ASSERT_EQ(armd_memory_region_destroy(memory_region), 65u);
+}
+
+TEST_F(MemoryRegionTest, ArenaReset) {
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create_arena(&memory_allocator, 128);
+    ASSERT_NE(memory_region, nullptr);
+
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 32; ++i) {
+            char *buf = armd_memory_region_strdup(memory_region, "aramid");
+            ASSERT_NE(buf, nullptr);
+            ASSERT_STREQ(buf, "aramid");
+        }
+        ASSERT_NE(armd_memory_region_allocate(memory_region, 512), nullptr);
+
+        ASSERT_EQ(armd_memory_region_reset(memory_region), 33u);
+    }
+
+    ASSERT_EQ(armd_memory_region_destroy(memory_region), 0u);
+}
+
+TEST_F(MemoryRegionTest, AllocateAligned) {
+    ARMD_MemoryRegion *memory_regions[] = {
+        armd_memory_region_create(&memory_allocator),
+        armd_memory_region_create_arena(&memory_allocator, 1024),
+    };
+
+    for (ARMD_MemoryRegion *memory_region : memory_regions) {
+        ASSERT_NE(memory_region, nullptr);
+
+        for (ARMD_Size alignment = 1; alignment <= 4096; alignment *= 2) {
+            for (ARMD_Size size = 1; size < 3000; size = size * 3 + 1) {
+                void *buf = armd_memory_region_allocate_aligned(
+                    memory_region, size, alignment);
+                ASSERT_NE(buf, nullptr);
+                ASSERT_EQ(reinterpret_cast<uintptr_t>(buf) % alignment, 0u);
+                memset(buf, 0xff, size);
+                armd_memory_region_free(memory_region, buf);
+            }
+        }
+
+        ASSERT_EQ(armd_memory_region_allocate_aligned(memory_region, 16, 24),
+                  nullptr);
+
+        armd_memory_region_destroy(memory_region);
+    }
+}
+
+#ifndef ARAMID_DISABLE_MEMORY_REGION
+TEST_F(MemoryRegionTest, RingReset) {
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create(&memory_allocator);
+    ASSERT_NE(memory_region, nullptr);
+
+    void *buf = nullptr;
+    for (int i = 0; i < 16; ++i) {
+        buf = armd_memory_region_allocate(memory_region, 32);
+        ASSERT_NE(buf, nullptr);
+    }
+    armd_memory_region_free(memory_region, buf);
+
+    ASSERT_EQ(armd_memory_region_reset(memory_region), 15u);
+    ASSERT_EQ(armd_memory_region_destroy(memory_region), 0u);
+}
+#endif
+
+} // namespace
@@ -0,0 +1,312 @@
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+
+namespace {
+
+TEST(HistogramTest, BucketIndex) {
+    for (uint64_t value = 0; value < 8; ++value) {
+        ASSERT_EQ(armd_histogram_get_bucket_index(value), value);
+    }
+
+    ARMD_Size prev_index = 0;
+    const uint64_t limit = uint64_t(1) << 48;
+    for (uint64_t value = 1; value < limit; value = value * 3 / 2 + 1) {
+        ARMD_Size index = armd_histogram_get_bucket_index(value);
+        ASSERT_GE(index, prev_index);
+        ASSERT_LT(index, static_cast<ARMD_Size>(ARMD_HISTOGRAM_NUM_BUCKETS));
+        ASSERT_LE(armd_histogram_get_bucket_lower_bound(index), value);
+        if (index + 1 < ARMD_HISTOGRAM_NUM_BUCKETS) {
+            ASSERT_GT(armd_histogram_get_bucket_lower_bound(index + 1), value);
+        }
+        // Relative error is at most 1/8
+        ASSERT_LE(value - armd_histogram_get_bucket_lower_bound(index),
+                  value / 8);
+        prev_index = index;
+    }
+
+    ASSERT_EQ(armd_histogram_get_bucket_index(UINT64_MAX),
+              static_cast<ARMD_Size>(ARMD_HISTOGRAM_NUM_BUCKETS - 1));
+}
+
+TEST(HistogramTest, Percentile) {
+    ARMD_Histogram histogram;
+    armd_histogram_init(&histogram);
+    ASSERT_EQ(armd_histogram_get_percentile(&histogram, 50.0), 0u);
+
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        armd_histogram_record(&histogram, value);
+    }
+
+    ASSERT_EQ(histogram.count, 1000u);
+    ASSERT_EQ(histogram.sum, 500500u);
+    ASSERT_EQ(histogram.max, 1000u);
+
+    uint64_t median = armd_histogram_get_percentile(&histogram, 50.0);
+    ASSERT_GE(median, 500u);
+    ASSERT_LE(median, 500u + 500u / 8);
+
+    ASSERT_EQ(armd_histogram_get_percentile(&histogram, 100.0), 1000u);
+    ASSERT_EQ(armd_histogram_get_percentile(&histogram, 0.0), 1u);
+}
+
+TEST(HistogramTest, Merge) {
+    ARMD_Histogram histogram1;
+    ARMD_Histogram histogram2;
+    ARMD_Histogram histogram_all;
+    armd_histogram_init(&histogram1);
+    armd_histogram_init(&histogram2);
+    armd_histogram_init(&histogram_all);
+
+    for (uint64_t value = 0; value < 10000; value += 7) {
+        armd_histogram_record(value % 2 == 0 ? &histogram1 : &histogram2,
+                              value);
+        armd_histogram_record(&histogram_all, value);
+    }
+
+    armd_histogram_merge(&histogram1, &histogram2);
+    ASSERT_EQ(memcmp(&histogram1, &histogram_all, sizeof(ARMD_Histogram)), 0);
+}
+
+int profiled_continuation1(ARMD_Job *job, const void *constants, void *args,
+                           void *frame) {
+    (void)job;
+    (void)constants;
+    (void)args;
+    (void)frame;
+    return 0;
+}
+
+ARMD_Size profiled_count(void *args, void *frame) {
+    (void)args;
+    (void)frame;
+    return 3;
+}
+
+int profiled_continuation2(ARMD_Job *job, const void *constants, void *args,
+                           void *frame, ARMD_Size index) {
+    (void)job;
+    (void)constants;
+    (void)args;
+    (void)frame;
+    (void)index;
+    return 0;
+}
+
+class ProfilerTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+    ARMD_Procedure *procedure;
+
+    ProfilerTest() {}
+
+    ~ProfilerTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator,
+                                      aramid::test::get_num_executors());
+
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_then_single(builder, profiled_continuation1);
+        armd_then_sequential_for(builder, profiled_count,
+                                 profiled_continuation2);
+        procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    void TearDown() override {
+        int res;
+
+        res = armd_procedure_destroy(procedure);
+        ASSERT_EQ(res, 0);
+
+        res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+
+    void invoke(ARMD_Size num_invocations) {
+        int res;
+
+        std::vector<ARMD_Handle> promises;
+        for (ARMD_Size i = 0; i < num_invocations; ++i) {
+            ARMD_Handle promise =
+                armd_invoke(context, procedure, nullptr, 0, nullptr);
+            ASSERT_NE(promise, 0u);
+            promises.push_back(promise);
+        }
+
+        for (ARMD_Handle promise : promises) {
+            res = armd_await(context, promise);
+            ASSERT_EQ(res, 0);
+        }
+    }
+};
+
+TEST_F(ProfilerTest, Name) {
+    int res;
+
+    ASSERT_EQ(armd_procedure_get_name(procedure), nullptr);
+
+    res = armd_procedure_set_name(procedure, "profiled");
+    ASSERT_EQ(res, 0);
+    ASSERT_STREQ(armd_procedure_get_name(procedure), "profiled");
+
+    res = armd_procedure_set_name(procedure, "renamed");
+    ASSERT_EQ(res, 0);
+    ASSERT_STREQ(armd_procedure_get_name(procedure), "renamed");
+
+    res = armd_procedure_set_name(procedure, nullptr);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(armd_procedure_get_name(procedure), nullptr);
+}
+
+TEST_F(ProfilerTest, Profile) {
+    int res;
+
+    ARMD_ProcedureProfile profile;
+    res = armd_context_get_procedure_profile(context, procedure, &profile,
+                                             nullptr);
+    ASSERT_NE(res, 0);
+
+    // Not profiled
+    invoke(10);
+
+    res = armd_context_enable_profiling(context);
+    ASSERT_EQ(res, 0);
+
+    const ARMD_Size num_invocations = 100;
+    invoke(num_invocations);
+
+    res = armd_context_disable_profiling(context);
+    ASSERT_EQ(res, 0);
+
+    // Not profiled
+    invoke(10);
+
+    ASSERT_EQ(armd_procedure_get_num_continuations(procedure), 2u);
+    ARMD_Histogram execution_times[2];
+    res = armd_context_get_procedure_profile(context, procedure, &profile,
+                                             execution_times);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_EQ(profile.num_invocations, num_invocations);
+    ASSERT_EQ(profile.queueing_delay.count, num_invocations);
+    ASSERT_EQ(execution_times[0].count, num_invocations);
+    // The sequential for continuation runs for each index
+    ASSERT_EQ(execution_times[1].count, 3 * num_invocations);
+    ASSERT_LE(execution_times[1].max, execution_times[1].sum);
+
+    const ARMD_Procedure *procedures[2];
+    ASSERT_EQ(armd_context_get_profiled_procedures(context, procedures, 2), 1u);
+    ASSERT_EQ(procedures[0], procedure);
+    ASSERT_EQ(armd_context_get_profiled_procedures(context, nullptr, 0), 1u);
+}
+
+TEST_F(ProfilerTest, ReuseAddress) {
+    int res;
+
+    // Pools the freed blocks, so a procedure gets the address of the one
+    // destroyed just before
+    ARMD_MemoryAllocator pooled_memory_allocator;
+    res = armd_memory_allocator_init_pooled(&pooled_memory_allocator, 1);
+    ASSERT_EQ(res, 0);
+
+    ARMD_ProcedureBuilder *builder =
+        armd_procedure_builder_create(&pooled_memory_allocator, 0, 0);
+    armd_then_single(builder, profiled_continuation1);
+    ARMD_Procedure *small_procedure =
+        armd_procedure_builder_build_and_destroy(builder);
+
+    res = armd_context_enable_profiling(context);
+    ASSERT_EQ(res, 0);
+
+    ARMD_Handle promise =
+        armd_invoke(context, small_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+
+    builder = armd_procedure_builder_create(&pooled_memory_allocator, 0, 0);
+    for (int i = 0; i < 4; ++i) {
+        armd_then_single(builder, profiled_continuation1);
+    }
+
+    res = armd_procedure_destroy(small_procedure);
+    ASSERT_EQ(res, 0);
+    ARMD_Procedure *large_procedure =
+        armd_procedure_builder_build_and_destroy(builder);
+    ASSERT_EQ(large_procedure, small_procedure);
+
+    const ARMD_Size num_invocations = 20;
+    std::vector<ARMD_Handle> promises;
+    for (ARMD_Size i = 0; i < num_invocations; ++i) {
+        promise = armd_invoke(context, large_procedure, nullptr, 0, nullptr);
+        ASSERT_NE(promise, 0u);
+        promises.push_back(promise);
+    }
+    for (ARMD_Handle large_promise : promises) {
+        res = armd_await(context, large_promise);
+        ASSERT_EQ(res, 0);
+    }
+
+    res = armd_context_disable_profiling(context);
+    ASSERT_EQ(res, 0);
+
+    // The profile of the destroyed procedure has been discarded
+    ARMD_ProcedureProfile profile;
+    ARMD_Histogram execution_times[4];
+    res = armd_context_get_procedure_profile(context, large_procedure,
+                                             &profile, execution_times);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(profile.num_invocations, num_invocations);
+    for (const ARMD_Histogram &execution_time : execution_times) {
+        ASSERT_EQ(execution_time.count, num_invocations);
+    }
+
+    res = armd_procedure_destroy(large_procedure);
+    ASSERT_EQ(res, 0);
+    armd_memory_allocator_deinit_pooled(&pooled_memory_allocator);
+}
+
+TEST_F(ProfilerTest, PerfCounters) {
+    int res;
+
+    res = armd_context_enable_profiling(context);
+    ASSERT_EQ(res, 0);
+
+    if (armd_context_enable_perf_counters(context) != 0) {
+        // Not on Linux, or perf events are not allowed, e.g. in containers
+        res = armd_context_disable_profiling(context);
+        ASSERT_EQ(res, 0);
+        GTEST_SKIP();
+    }
+
+    const ARMD_Size num_invocations = 10;
+    invoke(num_invocations);
+
+    res = armd_context_disable_perf_counters(context);
+    ASSERT_EQ(res, 0);
+
+    res = armd_context_disable_profiling(context);
+    ASSERT_EQ(res, 0);
+
+    ARMD_ProcedureProfile profile;
+    res = armd_context_get_procedure_profile(context, procedure, &profile,
+                                             nullptr);
+    ASSERT_EQ(res, 0);
+
+    // An executor may fail to open its counters, but then it counts nothing
+    ASSERT_LE(profile.perf_counters.num_samples, 4 * num_invocations);
+    if (profile.perf_counters.num_samples != 0) {
+        ASSERT_GT(profile.perf_counters.instructions, 0u);
+    }
+}
+
+} // namespace
@@ -1,6 +1,9 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <atomic>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include <aramid/aramid.h>
@@ -105,6 +108,57 @@ TEST_F(PromiseTest, CallbackEmptyProcedure) {
     ASSERT_EQ(res, 0);
 }
 
+struct InvokingCallbackContext {
+    ARMD_Context *context;
+    ARMD_Procedure *procedure;
+    ARMD_Handle invoked_promise;
+};
+
+// Runs without the lock of the promises, so it can invoke another one
+void invoking_cb(ARMD_Handle handle, void *callback_context, int has_error) {
+    (void)handle;
+    (void)has_error;
+    InvokingCallbackContext *typed_context =
+        reinterpret_cast<InvokingCallbackContext *>(callback_context);
+    typed_context->invoked_promise =
+        armd_invoke(typed_context->context, typed_context->procedure, nullptr,
+                    0, nullptr);
+}
+
+TEST_F(PromiseTest, CallbackInvokesProcedure) {
+    int res;
+
+    ARMD_Procedure *empty_procedure;
+    {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        empty_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    InvokingCallbackContext callback_context;
+    callback_context.context = context;
+    callback_context.procedure = empty_procedure;
+    callback_context.invoked_promise = 0;
+
+    ARMD_Handle promise =
+        armd_invoke(context, empty_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+    res = armd_add_promise_callback(context, promise, &callback_context,
+                                    invoking_cb);
+    ASSERT_EQ(res, 0);
+
+    // Returns after the callback
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+    ASSERT_NE(callback_context.invoked_promise, 0u);
+
+    res = armd_await(context, callback_context.invoked_promise);
+    ASSERT_EQ(res, 0);
+
+    res = armd_procedure_destroy(empty_procedure);
+    ASSERT_EQ(res, 0);
+}
+
 #if defined(ARAMID_USE_PTHREAD)
 
 static void sleep_microsecond(unsigned long us) { usleep(us); }
@@ -241,4 +295,539 @@ TEST_F(PromiseTest, SynchronizeAfterDetach) {
     ASSERT_EQ(res, 0);
 }
 
+int square_continuation(ARMD_Job *job, const void *constants, void *args,
+                        void *frame) {
+    (void)constants;
+    (void)frame;
+    uint64_t value = *reinterpret_cast<const uint64_t *>(args);
+    *reinterpret_cast<uint64_t *>(armd_job_get_result(job)) = value * value;
+    return 0;
+}
+
+int fail_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)job;
+    (void)constants;
+    (void)args;
+    (void)frame;
+    return 1;
+}
+
+ARMD_Bool ignore_dependency_error(ARMD_Job *job, const void *constants,
+                                  void *args, void *frame,
+                                  int dependency_has_error) {
+    (void)job;
+    (void)constants;
+    (void)args;
+    (void)frame;
+    (void)dependency_has_error;
+    return 0;
+}
+
+// Sums the results of the dependencies, skipping the ones without a result
+int sum_continuation(ARMD_Job *job, const void *constants, void *args,
+                     void *frame) {
+    (void)constants;
+    (void)frame;
+    ARMD_Size num_dependencies = *reinterpret_cast<const ARMD_Size *>(args);
+    uint64_t sum = 0;
+    for (ARMD_Size i = 0; i < num_dependencies; ++i) {
+        const void *result = armd_job_get_dependency_result(job, i);
+        if (result != nullptr) {
+            sum += *reinterpret_cast<const uint64_t *>(result);
+        }
+    }
+    if (armd_job_get_dependency_result(job, num_dependencies) != nullptr) {
+        return 1;
+    }
+    *reinterpret_cast<uint64_t *>(armd_job_get_result(job)) = sum;
+    return 0;
+}
+
+const ARMD_Size large_result_size = 1024;
+
+int fill_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)constants;
+    (void)args;
+    (void)frame;
+    unsigned char *result =
+        reinterpret_cast<unsigned char *>(armd_job_get_result(job));
+    for (ARMD_Size i = 0; i < large_result_size; ++i) {
+        result[i] = static_cast<unsigned char>(i);
+    }
+    return 0;
+}
+
+int check_no_result_continuation(ARMD_Job *job, const void *constants,
+                                 void *args, void *frame) {
+    (void)constants;
+    (void)frame;
+    *reinterpret_cast<bool *>(args) = armd_job_get_result(job) == nullptr;
+    return 0;
+}
+
+struct ForkingFrame {
+    bool child_has_no_result;
+};
+
+int fork_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)args;
+    const ARMD_Procedure *const *child_procedure =
+        reinterpret_cast<const ARMD_Procedure *const *>(constants);
+    ForkingFrame *typed_frame = reinterpret_cast<ForkingFrame *>(frame);
+    typed_frame->child_has_no_result = false;
+    return armd_fork(job, const_cast<ARMD_Procedure *>(*child_procedure),
+                     &typed_frame->child_has_no_result);
+}
+
+int report_fork_continuation(ARMD_Job *job, const void *constants, void *args,
+                             void *frame) {
+    (void)constants;
+    (void)args;
+    *reinterpret_cast<bool *>(armd_job_get_result(job)) =
+        reinterpret_cast<ForkingFrame *>(frame)->child_has_no_result;
+    return 0;
+}
+
+class PromiseResultTest : public PromiseTest {
+protected:
+    ARMD_Procedure *build(ARMD_Size result_size,
+                          ARMD_SingleContinuationFunc continuation_func,
+                          ARMD_SetupFunc setup_func = nullptr) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_procedure_builder_set_result_size(builder, result_size);
+        if (setup_func != nullptr) {
+            armd_setup(builder, setup_func);
+        }
+        armd_then_single(builder, continuation_func);
+        return armd_procedure_builder_build_and_destroy(builder);
+    }
+};
+
+TEST_F(PromiseResultTest, AwaitResult) {
+    int res;
+
+    ARMD_Procedure *square_procedure =
+        build(sizeof(uint64_t), square_continuation);
+    ASSERT_EQ(armd_procedure_get_result_size(square_procedure),
+              sizeof(uint64_t));
+
+    uint64_t value = 12;
+    ARMD_Handle promise =
+        armd_invoke(context, square_procedure, &value, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+
+    // The size is checked before waiting, so the promise is still valid
+    uint32_t small_result;
+    res = armd_await_result(context, promise, &small_result,
+                            sizeof(small_result));
+    ASSERT_EQ(res, -1);
+
+    uint64_t result = 0;
+    res = armd_await_result(context, promise, &result, sizeof(result));
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(result, 144u);
+
+    res = armd_procedure_destroy(square_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(PromiseResultTest, AwaitLargeResult) {
+    int res;
+
+    ARMD_Procedure *fill_procedure =
+        build(large_result_size, fill_continuation);
+
+    ARMD_Handle promise =
+        armd_invoke(context, fill_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+
+    unsigned char result[large_result_size];
+    res = armd_await_result(context, promise, result, sizeof(result));
+    ASSERT_EQ(res, 0);
+    for (ARMD_Size i = 0; i < large_result_size; ++i) {
+        ASSERT_EQ(result[i], static_cast<unsigned char>(i));
+    }
+
+    res = armd_procedure_destroy(fill_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(PromiseResultTest, AwaitFailedResult) {
+    int res;
+
+    ARMD_Procedure *fail_procedure =
+        build(sizeof(uint64_t), fail_continuation);
+
+    ARMD_Handle promise =
+        armd_invoke(context, fail_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+
+    uint64_t result = 42;
+    res = armd_await_result(context, promise, &result, sizeof(result));
+    ASSERT_EQ(res, -2);
+    ASSERT_EQ(result, 42u);
+
+    res = armd_procedure_destroy(fail_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(PromiseResultTest, DependencyResult) {
+    int res;
+
+    ARMD_Procedure *square_procedure =
+        build(sizeof(uint64_t), square_continuation);
+    ARMD_Procedure *fail_procedure =
+        build(sizeof(uint64_t), fail_continuation);
+    ARMD_Procedure *sum_procedure =
+        build(sizeof(uint64_t), sum_continuation, ignore_dependency_error);
+    ARMD_Procedure *empty_procedure;
+    {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        empty_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    uint64_t values[2] = {3, 4};
+    ARMD_Handle dependencies[5];
+    dependencies[0] =
+        armd_invoke(context, square_procedure, &values[0], 0, nullptr);
+    dependencies[1] =
+        armd_invoke(context, empty_procedure, nullptr, 0, nullptr);
+    dependencies[2] = 0;
+    dependencies[3] =
+        armd_invoke(context, fail_procedure, nullptr, 0, nullptr);
+    dependencies[4] =
+        armd_invoke(context, square_procedure, &values[1], 0, nullptr);
+
+    ARMD_Size num_dependencies = 5;
+    ARMD_Handle sum_promise = armd_invoke(
+        context, sum_procedure, &num_dependencies, 5, dependencies);
+    ASSERT_NE(sum_promise, 0u);
+
+    // The results are kept for the dependent even after awaiting
+    for (ARMD_Handle dependency : dependencies) {
+        if (dependency != 0) {
+            armd_await(context, dependency);
+        }
+    }
+
+    uint64_t result = 0;
+    res = armd_await_result(context, sum_promise, &result, sizeof(result));
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(result, 25u);
+
+    res = armd_await_all(context);
+    ASSERT_EQ(res, 0);
+
+    res = armd_procedure_destroy(empty_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(sum_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(fail_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(square_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(PromiseResultTest, ForkedJobHasNoResult) {
+    int res;
+
+    ARMD_Procedure *child_procedure =
+        build(sizeof(uint64_t), check_no_result_continuation);
+
+    ARMD_Procedure *parent_procedure;
+    {
+        ARMD_ProcedureBuilder *builder = armd_procedure_builder_create(
+            &memory_allocator, sizeof(ARMD_Procedure *), sizeof(ForkingFrame));
+        *reinterpret_cast<ARMD_Procedure **>(
+            armd_procedure_builder_get_constants(builder)) = child_procedure;
+        armd_procedure_builder_set_result_size(builder, sizeof(bool));
+        armd_then_single(builder, fork_continuation);
+        armd_then_single(builder, report_fork_continuation);
+        parent_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    ARMD_Handle promise =
+        armd_invoke(context, parent_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+
+    bool child_has_no_result = false;
+    res = armd_await_result(context, promise, &child_has_no_result,
+                            sizeof(child_has_no_result));
+    ASSERT_EQ(res, 0);
+    ASSERT_TRUE(child_has_no_result);
+
+    res = armd_procedure_destroy(parent_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(child_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+// Holds the job and its executor until released by the test, so the tests
+// using it need another executor
+struct Gate {
+    std::atomic<bool> released;
+    uint64_t value;
+};
+
+int gate_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)constants;
+    (void)frame;
+    Gate *gate = reinterpret_cast<Gate *>(args);
+    while (!gate->released.load()) {
+        sleep_microsecond(1000);
+    }
+    *reinterpret_cast<uint64_t *>(armd_job_get_result(job)) = gate->value;
+    return 0;
+}
+
+// Reports which dependencies have a result as a bit mask
+int result_mask_continuation(ARMD_Job *job, const void *constants, void *args,
+                             void *frame) {
+    (void)constants;
+    (void)frame;
+    ARMD_Size num_dependencies = *reinterpret_cast<const ARMD_Size *>(args);
+    uint64_t mask = 0;
+    for (ARMD_Size i = 0; i < num_dependencies; ++i) {
+        if (armd_job_get_dependency_result(job, i) != nullptr) {
+            mask |= uint64_t(1) << i;
+        }
+    }
+    *reinterpret_cast<uint64_t *>(armd_job_get_result(job)) = mask;
+    return 0;
+}
+
+TEST_F(PromiseResultTest, AwaitAny) {
+    int res;
+
+    if (aramid::test::get_num_executors() < 2) {
+        GTEST_SKIP();
+    }
+
+    ARMD_Procedure *gate_procedure =
+        build(sizeof(uint64_t), gate_continuation);
+    ARMD_Procedure *fail_procedure =
+        build(sizeof(uint64_t), fail_continuation);
+
+    Gate gate;
+    gate.released = false;
+    gate.value = 1;
+
+    ARMD_Handle handles[3];
+    handles[2] = armd_invoke(context, fail_procedure, nullptr, 0, nullptr);
+    handles[0] = armd_invoke(context, gate_procedure, &gate, 0, nullptr);
+    handles[1] = 0;
+
+    ARMD_Size index = 0;
+    res = armd_await_any(context, 3, handles, &index);
+    ASSERT_EQ(res, -1); // Invalid handle
+
+    ARMD_Handle valid_handles[2] = {handles[0], handles[2]};
+    res = armd_await_any(context, 2, valid_handles, &index);
+    ASSERT_EQ(res, -2);
+    ASSERT_EQ(index, 1u);
+
+    // The ended one has been consumed
+    res = armd_await_any(context, 2, valid_handles, &index);
+    ASSERT_EQ(res, -1);
+
+    gate.released = true;
+    res = armd_await_any(context, 1, valid_handles, &index);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(index, 0u);
+
+    res = armd_procedure_destroy(fail_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(gate_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(PromiseResultTest, QuorumDependency) {
+    int res;
+
+    if (aramid::test::get_num_executors() < 2) {
+        GTEST_SKIP();
+    }
+
+    ARMD_Procedure *square_procedure =
+        build(sizeof(uint64_t), square_continuation);
+    ARMD_Procedure *gate_procedure =
+        build(sizeof(uint64_t), gate_continuation);
+    ARMD_Procedure *mask_procedure =
+        build(sizeof(uint64_t), result_mask_continuation);
+
+    Gate gate;
+    gate.released = false;
+    gate.value = 1;
+
+    uint64_t value = 3;
+    ARMD_Handle dependencies[2];
+    dependencies[1] =
+        armd_invoke(context, square_procedure, &value, 0, nullptr);
+    dependencies[0] = armd_invoke(context, gate_procedure, &gate, 0, nullptr);
+
+    ARMD_Size num_dependencies = 2;
+    ASSERT_EQ(armd_invoke_quorum(context, mask_procedure, &num_dependencies, 2,
+                                 dependencies, 0),
+              0u);
+    ASSERT_EQ(armd_invoke_quorum(context, mask_procedure, &num_dependencies, 2,
+                                 dependencies, 3),
+              0u);
+
+    ARMD_Handle promise = armd_invoke_quorum(
+        context, mask_procedure, &num_dependencies, 2, dependencies, 1);
+    ASSERT_NE(promise, 0u);
+
+    // The gated dependency is unlinked when the other one ends
+    res = armd_await(context, dependencies[1]);
+    ASSERT_EQ(res, 0);
+    gate.released = true;
+
+    uint64_t mask = 0;
+    res = armd_await_result(context, promise, &mask, sizeof(mask));
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(mask, 2u);
+
+    res = armd_await(context, dependencies[0]);
+    ASSERT_EQ(res, 0);
+
+    res = armd_procedure_destroy(mask_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(gate_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(square_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(PromiseResultTest, QuorumSatisfiedOnInvoke) {
+    int res;
+
+    if (aramid::test::get_num_executors() < 2) {
+        GTEST_SKIP();
+    }
+
+    ARMD_Procedure *square_procedure =
+        build(sizeof(uint64_t), square_continuation);
+    ARMD_Procedure *gate_procedure =
+        build(sizeof(uint64_t), gate_continuation);
+    ARMD_Procedure *mask_procedure =
+        build(sizeof(uint64_t), result_mask_continuation);
+    ARMD_Procedure *empty_procedure;
+    {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        empty_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    Gate gate;
+    gate.released = false;
+    gate.value = 1;
+
+    uint64_t values[2] = {3, 4};
+    ARMD_Handle dependencies[3];
+    dependencies[0] =
+        armd_invoke(context, square_procedure, &values[0], 0, nullptr);
+    dependencies[2] =
+        armd_invoke(context, square_procedure, &values[1], 0, nullptr);
+
+    // Ends the two while keeping their handles
+    ARMD_Handle ended_dependencies[2] = {dependencies[0], dependencies[2]};
+    ARMD_Handle join_promise =
+        armd_invoke(context, empty_procedure, nullptr, 2, ended_dependencies);
+    res = armd_await(context, join_promise);
+    ASSERT_EQ(res, 0);
+
+    dependencies[1] = armd_invoke(context, gate_procedure, &gate, 0, nullptr);
+
+    ARMD_Size num_dependencies = 3;
+    ARMD_Handle promise = armd_invoke_quorum(
+        context, mask_procedure, &num_dependencies, 3, dependencies, 2);
+    ASSERT_NE(promise, 0u);
+    gate.released = true;
+
+    uint64_t mask = 0;
+    res = armd_await_result(context, promise, &mask, sizeof(mask));
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(mask, 5u);
+
+    for (ARMD_Handle dependency : dependencies) {
+        res = armd_await(context, dependency);
+        ASSERT_EQ(res, 0);
+    }
+
+    res = armd_procedure_destroy(empty_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(mask_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(gate_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(square_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+void count_cb(ARMD_Handle handle, void *callback_context, int has_error) {
+    (void)handle;
+    (void)has_error;
+    ++*reinterpret_cast<std::atomic<int> *>(callback_context);
+}
+
+TEST_F(PromiseResultTest, FanOut) {
+    int res;
+
+    if (aramid::test::get_num_executors() < 2) {
+        GTEST_SKIP();
+    }
+
+    ARMD_Procedure *gate_procedure =
+        build(sizeof(uint64_t), gate_continuation);
+    ARMD_Procedure *mask_procedure =
+        build(sizeof(uint64_t), result_mask_continuation);
+
+    Gate gate;
+    gate.released = false;
+    gate.value = 1;
+
+    ARMD_Handle root = armd_invoke(context, gate_procedure, &gate, 0, nullptr);
+    ASSERT_NE(root, 0u);
+
+    // More than the inline slots of the promise
+    const int num_dependents = 100;
+    const int num_callbacks = 10;
+    ARMD_Size num_dependencies = 1;
+    std::vector<ARMD_Handle> dependents;
+    std::atomic<int> num_called(0);
+    for (int i = 0; i < num_dependents; ++i) {
+        ARMD_Handle dependent = armd_invoke(context, mask_procedure,
+                                            &num_dependencies, 1, &root);
+        ASSERT_NE(dependent, 0u);
+        dependents.push_back(dependent);
+        if (i < num_callbacks) {
+            res = armd_add_promise_callback(context, root, &num_called,
+                                            count_cb);
+            ASSERT_EQ(res, 0);
+        }
+    }
+    gate.released = true;
+
+    for (ARMD_Handle dependent : dependents) {
+        uint64_t mask = 0;
+        res = armd_await_result(context, dependent, &mask, sizeof(mask));
+        ASSERT_EQ(res, 0);
+        ASSERT_EQ(mask, 1u);
+    }
+    res = armd_await(context, root);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(num_called.load(), num_callbacks);
+
+    res = armd_procedure_destroy(mask_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(gate_procedure);
+    ASSERT_EQ(res, 0);
+}
+
 } // namespace
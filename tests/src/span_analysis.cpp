@@ -0,0 +1,168 @@
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+
+namespace {
+
+const uint64_t strand_nanoseconds = 2 * 1000 * 1000;
+const ARMD_Size num_children = 8;
+
+int busy_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)job;
+    (void)constants;
+    (void)args;
+    (void)frame;
+
+    auto begin = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - begin <
+           std::chrono::nanoseconds(strand_nanoseconds)) {
+    }
+
+    return 0;
+}
+
+int fork_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)constants;
+    (void)frame;
+
+    ARMD_Procedure *child_procedure = static_cast<ARMD_Procedure *>(args);
+    for (ARMD_Size i = 0; i < num_children; ++i) {
+        if (armd_fork(job, child_procedure, nullptr) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+class SpanAnalysisTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+    ARMD_Procedure *busy_procedure;
+    ARMD_Procedure *fork_procedure;
+
+    SpanAnalysisTest() {}
+
+    ~SpanAnalysisTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator,
+                                      aramid::test::get_num_executors());
+
+        ARMD_ProcedureBuilder *builder;
+
+        builder = armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_then_single(builder, busy_continuation);
+        busy_procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        builder = armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_then_single(builder, fork_continuation);
+        fork_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    void TearDown() override {
+        int res;
+
+        res = armd_procedure_destroy(busy_procedure);
+        ASSERT_EQ(res, 0);
+
+        res = armd_procedure_destroy(fork_procedure);
+        ASSERT_EQ(res, 0);
+
+        res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+};
+
+TEST_F(SpanAnalysisTest, ForkJoin) {
+    int res;
+
+    res = armd_context_enable_span_analysis(context);
+    ASSERT_EQ(res, 0);
+
+    ARMD_Handle promise =
+        armd_invoke(context, fork_procedure, busy_procedure, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+
+    res = armd_context_disable_span_analysis(context);
+    ASSERT_EQ(res, 0);
+
+    ARMD_SpanAnalysis analysis;
+    res = armd_context_get_span_analysis(context, &analysis);
+    ASSERT_EQ(res, 0);
+
+    // The children run in parallel whatever the number of executors is
+    ASSERT_EQ(analysis.num_strands, num_children + 1);
+    ASSERT_GE(analysis.work, num_children * strand_nanoseconds);
+    ASSERT_GE(analysis.span, strand_nanoseconds);
+    ASSERT_LT(analysis.span, analysis.work);
+    ASSERT_GE(analysis.burdened_span, analysis.span);
+    ASSERT_GT(analysis.parallelism, 2.0);
+    ASSERT_LE(analysis.burdened_parallelism, analysis.parallelism);
+}
+
+TEST_F(SpanAnalysisTest, Dependency) {
+    int res;
+
+    res = armd_context_enable_span_analysis(context);
+    ASSERT_EQ(res, 0);
+
+    // first -> second is the critical path, and independent runs beside them
+    ARMD_Handle first =
+        armd_invoke(context, busy_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(first, 0u);
+    ARMD_Handle second =
+        armd_invoke(context, busy_procedure, nullptr, 1, &first);
+    ASSERT_NE(second, 0u);
+    ARMD_Handle independent =
+        armd_invoke(context, busy_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(independent, 0u);
+
+    res = armd_await(context, first);
+    ASSERT_EQ(res, 0);
+    res = armd_await(context, second);
+    ASSERT_EQ(res, 0);
+    res = armd_await(context, independent);
+    ASSERT_EQ(res, 0);
+
+    ARMD_SpanAnalysis analysis;
+    res = armd_context_get_span_analysis(context, &analysis);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_EQ(analysis.num_strands, 3u);
+    ASSERT_GE(analysis.work, 3 * strand_nanoseconds);
+    ASSERT_GE(analysis.span, 2 * strand_nanoseconds);
+    // independent is off the critical path
+    ASSERT_GE(analysis.work - analysis.span, strand_nanoseconds);
+}
+
+TEST_F(SpanAnalysisTest, Disabled) {
+    int res;
+
+    ARMD_Handle promise =
+        armd_invoke(context, busy_procedure, nullptr, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+
+    ARMD_SpanAnalysis analysis;
+    res = armd_context_get_span_analysis(context, &analysis);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_EQ(analysis.num_strands, 0u);
+    ASSERT_EQ(analysis.work, 0u);
+    ASSERT_EQ(analysis.span, 0u);
+    ASSERT_EQ(analysis.parallelism, 0.0);
+}
+
+} // namespace
@@ -0,0 +1,162 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+#include "fibonacci.hpp"
+
+namespace {
+
+using aramid::test::FibonacciArgs;
+using aramid::test::FibonacciConstants;
+using aramid::test::FibonacciFrame;
+using aramid::test::fibonacci_continuation1;
+using aramid::test::fibonacci_continuation2;
+
+class StatsTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+    ARMD_Procedure *fibonacci_procedure;
+
+    StatsTest() {}
+
+    ~StatsTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator,
+                                      aramid::test::get_num_executors());
+
+        ARMD_ProcedureBuilder *builder = armd_procedure_builder_create(
+            &memory_allocator, sizeof(FibonacciConstants),
+            sizeof(FibonacciFrame));
+        armd_then_single(builder, fibonacci_continuation1);
+        armd_then_single(builder, fibonacci_continuation2);
+        fibonacci_procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        FibonacciConstants *fibonacci_constants =
+            reinterpret_cast<FibonacciConstants *>(
+                armd_procedure_get_constants(fibonacci_procedure));
+        fibonacci_constants->fibonacci_procedure = fibonacci_procedure;
+    }
+
+    void TearDown() override {
+        int res;
+
+        res = armd_procedure_destroy(fibonacci_procedure);
+        ASSERT_EQ(res, 0);
+
+        res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+};
+
+TEST_F(StatsTest, Initial) {
+    int res;
+
+    const ARMD_Size num_executors = armd_context_get_num_executors(context);
+    ASSERT_EQ(num_executors,
+              static_cast<ARMD_Size>(aramid::test::get_num_executors()));
+
+    ARMD_ContextStats context_stats;
+    std::vector<ARMD_ExecutorStats> executor_stats(num_executors);
+    std::vector<ARMD_StealStats> steal_stats(num_executors * num_executors);
+
+    res = armd_context_get_stats(context, &context_stats,
+                                 executor_stats.data(), steal_stats.data());
+    ASSERT_EQ(res, 0);
+
+    ASSERT_EQ(context_stats.num_executors, num_executors);
+    ASSERT_EQ(context_stats.num_promises, 0u);
+    ASSERT_EQ(context_stats.num_free_jobs, 0u);
+
+    for (const ARMD_ExecutorStats &stats : executor_stats) {
+        ASSERT_EQ(stats.num_jobs_executed, 0u);
+        ASSERT_EQ(stats.num_forks, 0u);
+        ASSERT_EQ(stats.num_steals, 0u);
+        ASSERT_EQ(stats.deque_high_water_mark, 0u);
+    }
+
+    for (const ARMD_StealStats &stats : steal_stats) {
+        ASSERT_EQ(stats.num_steals, 0u);
+    }
+
+    res = armd_context_get_stats(context, &context_stats, nullptr, nullptr);
+    ASSERT_EQ(res, 0);
+
+    res = armd_context_get_stats(context, nullptr, nullptr, nullptr);
+    ASSERT_NE(res, 0);
+}
+
+TEST_F(StatsTest, CountJobs) {
+    int res;
+
+    const ARMD_Size num_executors = armd_context_get_num_executors(context);
+
+    FibonacciArgs args;
+    uint64_t result;
+
+    args.input = 15;
+    args.result = &result;
+
+    ARMD_Handle promise =
+        armd_invoke(context, fibonacci_procedure, &args, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+
+    ARMD_ContextStats context_stats;
+    res = armd_context_get_stats(context, &context_stats, nullptr, nullptr);
+    ASSERT_EQ(res, 0);
+    ASSERT_LE(context_stats.num_promises, 1u);
+
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(result, 987u);
+
+    std::vector<ARMD_ExecutorStats> executor_stats(num_executors);
+    std::vector<ARMD_StealStats> steal_stats(num_executors * num_executors);
+
+    res = armd_context_get_stats(context, &context_stats,
+                                 executor_stats.data(), steal_stats.data());
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(context_stats.num_promises, 0u);
+
+    // fib(15) calls itself 1972 times besides the root invocation
+    ARMD_Size num_jobs_executed = 0;
+    ARMD_Size num_forks = 0;
+    ARMD_Size num_steals = 0;
+    ARMD_Size num_failed_steals = 0;
+    ARMD_Size deque_high_water_mark = 0;
+    for (ARMD_Size i = 0; i < num_executors; ++i) {
+        const ARMD_ExecutorStats &stats = executor_stats[i];
+        num_jobs_executed += stats.num_jobs_executed;
+        num_forks += stats.num_forks;
+        num_steals += stats.num_steals;
+        num_failed_steals += stats.num_failed_steals;
+        if (stats.deque_high_water_mark > deque_high_water_mark) {
+            deque_high_water_mark = stats.deque_high_water_mark;
+        }
+        ASSERT_LE(stats.parked_nanoseconds, stats.idle_nanoseconds);
+
+        ARMD_Size num_steals_by_victim = 0;
+        ARMD_Size num_failed_steals_by_victim = 0;
+        for (ARMD_Size j = 0; j < num_executors; ++j) {
+            const ARMD_StealStats &pair_stats =
+                steal_stats[i * num_executors + j];
+            num_steals_by_victim += pair_stats.num_steals;
+            num_failed_steals_by_victim += pair_stats.num_failed_steals;
+        }
+        ASSERT_EQ(num_steals_by_victim, stats.num_steals);
+        ASSERT_EQ(num_failed_steals_by_victim, stats.num_failed_steals);
+    }
+
+    ASSERT_EQ(num_jobs_executed, 1973u);
+    ASSERT_EQ(num_forks, 1972u);
+    ASSERT_GE(deque_high_water_mark, 1u);
+    ASSERT_LE(num_steals, num_jobs_executed);
+}
+
+} // namespace
@@ -0,0 +1,228 @@
+#include <cstdint>
+
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+
+namespace {
+
+class TaskGroupTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+
+    TaskGroupTest() {}
+
+    ~TaskGroupTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator,
+                                      aramid::test::get_num_executors());
+    }
+
+    void TearDown() override {
+        int res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+};
+
+int count_continuation(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    ++*reinterpret_cast<std::atomic<int> *>(args);
+    return 0;
+}
+
+int error_continuation(ARMD_Job *job, const void *constants, void *args,
+                       void *frame) {
+    (void)job;
+    (void)constants;
+    (void)args;
+    (void)frame;
+
+    return 1;
+}
+
+ARMD_Procedure *create_single_procedure(ARMD_MemoryAllocator *memory_allocator,
+                                        ARMD_SingleContinuationFunc func) {
+    ARMD_ProcedureBuilder *builder =
+        armd_procedure_builder_create(memory_allocator, 0, 0);
+    armd_then_single(builder, func);
+    return armd_procedure_builder_build_and_destroy(builder);
+}
+
+TEST_F(TaskGroupTest, WaitAll) {
+    int res;
+
+    ARMD_Procedure *procedure =
+        create_single_procedure(&memory_allocator, count_continuation);
+    ARMD_TaskGroup *task_group = armd_task_group_create(context);
+    ASSERT_NE(task_group, nullptr);
+
+    std::atomic<int> count(0);
+    for (int round = 1; round <= 3; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            res = armd_task_group_invoke(task_group, procedure, &count);
+            ASSERT_EQ(res, 0);
+        }
+
+        // The group can be reused after the wait
+        res = armd_task_group_wait(task_group);
+        ASSERT_EQ(res, 0);
+        ASSERT_EQ(count.load(), round * 100);
+    }
+
+    // Nothing to wait for
+    res = armd_task_group_wait(task_group);
+    ASSERT_EQ(res, 0);
+
+    res = armd_task_group_destroy(task_group);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(TaskGroupTest, Error) {
+    int res;
+
+    ARMD_Procedure *procedure =
+        create_single_procedure(&memory_allocator, count_continuation);
+    ARMD_Procedure *error_procedure =
+        create_single_procedure(&memory_allocator, error_continuation);
+    ARMD_TaskGroup *task_group = armd_task_group_create(context);
+    ASSERT_NE(task_group, nullptr);
+
+    std::atomic<int> count(0);
+    for (int i = 0; i < 10; ++i) {
+        res = armd_task_group_invoke(task_group, procedure, &count);
+        ASSERT_EQ(res, 0);
+    }
+    res = armd_task_group_invoke(task_group, error_procedure, nullptr);
+    ASSERT_EQ(res, 0);
+
+    // The other jobs still run to the end
+    res = armd_task_group_wait(task_group);
+    ASSERT_EQ(res, -2);
+    ASSERT_EQ(count.load(), 10);
+
+    // The error is reported once
+    res = armd_task_group_invoke(task_group, procedure, &count);
+    ASSERT_EQ(res, 0);
+    res = armd_task_group_wait(task_group);
+    ASSERT_EQ(res, 0);
+
+    res = armd_task_group_destroy(task_group);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(error_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(procedure);
+    ASSERT_EQ(res, 0);
+}
+
+// Written for armd_invoke, fills the whole result
+int fill_result_continuation(ARMD_Job *job, const void *constants,
+                             void *args, void *frame) {
+    (void)constants;
+    (void)frame;
+
+    ARMD_Size result_size = *reinterpret_cast<const ARMD_Size *>(args);
+    unsigned char *result =
+        reinterpret_cast<unsigned char *>(armd_job_get_result(job));
+    if (result == nullptr) {
+        return 1;
+    }
+    for (ARMD_Size i = 0; i < result_size; ++i) {
+        result[i] = static_cast<unsigned char>(i);
+    }
+    return 0;
+}
+
+TEST_F(TaskGroupTest, ResultDiscarded) {
+    int res;
+
+    ARMD_TaskGroup *task_group = armd_task_group_create(context);
+    ASSERT_NE(task_group, nullptr);
+
+    // Small enough to be inline in a promise, and too large for that
+    for (ARMD_Size result_size : {ARMD_Size(8), ARMD_Size(1024)}) {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_procedure_builder_set_result_size(builder, result_size);
+        armd_then_single(builder, fill_result_continuation);
+        ARMD_Procedure *procedure =
+            armd_procedure_builder_build_and_destroy(builder);
+
+        for (int i = 0; i < 100; ++i) {
+            res = armd_task_group_invoke(task_group, procedure, &result_size);
+            ASSERT_EQ(res, 0);
+        }
+        res = armd_task_group_wait(task_group);
+        ASSERT_EQ(res, 0);
+
+        res = armd_procedure_destroy(procedure);
+        ASSERT_EQ(res, 0);
+    }
+
+    res = armd_task_group_destroy(task_group);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(TaskGroupTest, IndependentGroups) {
+    int res;
+
+    ARMD_Procedure *procedure =
+        create_single_procedure(&memory_allocator, count_continuation);
+    ARMD_Procedure *error_procedure =
+        create_single_procedure(&memory_allocator, error_continuation);
+    ARMD_TaskGroup *task_group_a = armd_task_group_create(context);
+    ASSERT_NE(task_group_a, nullptr);
+    ARMD_TaskGroup *task_group_b = armd_task_group_create(context);
+    ASSERT_NE(task_group_b, nullptr);
+
+    // Promises and groups coexist
+    std::atomic<int> count_a(0);
+    std::atomic<int> count_b(0);
+    std::atomic<int> count_promise(0);
+    ARMD_Handle promise =
+        armd_invoke(context, procedure, &count_promise, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+    for (int i = 0; i < 50; ++i) {
+        res = armd_task_group_invoke(task_group_a, procedure, &count_a);
+        ASSERT_EQ(res, 0);
+        res = armd_task_group_invoke(task_group_b, procedure, &count_b);
+        ASSERT_EQ(res, 0);
+    }
+    res = armd_task_group_invoke(task_group_b, error_procedure, nullptr);
+    ASSERT_EQ(res, 0);
+
+    res = armd_task_group_wait(task_group_a);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(count_a.load(), 50);
+
+    res = armd_task_group_wait(task_group_b);
+    ASSERT_EQ(res, -2);
+    ASSERT_EQ(count_b.load(), 50);
+
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+    ASSERT_EQ(count_promise.load(), 1);
+
+    res = armd_task_group_destroy(task_group_b);
+    ASSERT_EQ(res, 0);
+    res = armd_task_group_destroy(task_group_a);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(error_procedure);
+    ASSERT_EQ(res, 0);
+    res = armd_procedure_destroy(procedure);
+    ASSERT_EQ(res, 0);
+}
+
+} // namespace
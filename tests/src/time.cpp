@@ -1,5 +1,8 @@
 #include <stdio.h>
 
+#include <chrono>
+#include <thread>
+
 #include <gtest/gtest.h>
 
 #include <aramid/aramid.h>
@@ -26,4 +29,28 @@ TEST(TimeTest, GetTimeAndFormat) {
     armd_memory_region_destroy(memory_region);
 }
 
+TEST(TimeTest, Timestamp) {
+    // Calibrates the clock
+    armd_get_timestamp();
+
+    std::chrono::steady_clock::time_point clock_begin =
+        std::chrono::steady_clock::now();
+    uint64_t begin = armd_get_timestamp();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    uint64_t end = armd_get_timestamp();
+    std::chrono::steady_clock::time_point clock_end =
+        std::chrono::steady_clock::now();
+
+    ASSERT_GE(end, begin);
+    uint64_t nanoseconds = armd_timestamp_to_nanoseconds(end - begin);
+    uint64_t expected = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end -
+                                                             clock_begin)
+            .count());
+
+    // Allows the error of the calibration
+    ASSERT_GE(nanoseconds, 50000000u * 99 / 100);
+    ASSERT_LE(nanoseconds, expected * 101 / 100);
+}
+
 } // namespace
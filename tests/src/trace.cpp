@@ -0,0 +1,234 @@
+#include <atomic>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <aramid/aramid.h>
+
+#include "config.hpp"
+
+namespace {
+
+typedef struct TAG_TreeArgs {
+    ARMD_Size depth;
+} TreeArgs;
+
+typedef struct TAG_TreeFrame {
+    TreeArgs child_args;
+} TreeFrame;
+
+typedef struct TAG_TreeConstants {
+    ARMD_Procedure *tree_procedure;
+} TreeConstants;
+
+int tree_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    const TreeConstants *typed_constants =
+        reinterpret_cast<const TreeConstants *>(constants);
+    const TreeArgs *typed_args = reinterpret_cast<const TreeArgs *>(args);
+    TreeFrame *typed_frame = reinterpret_cast<TreeFrame *>(frame);
+
+    if (typed_args->depth > 0) {
+        typed_frame->child_args.depth = typed_args->depth - 1;
+
+        // Both children share the arguments as they only read them
+        armd_fork(job, typed_constants->tree_procedure,
+                  &typed_frame->child_args);
+        armd_fork(job, typed_constants->tree_procedure,
+                  &typed_frame->child_args);
+    }
+
+    return 0;
+}
+
+int write_to_string(void *writer_context, const char *data, ARMD_Size size) {
+    reinterpret_cast<std::string *>(writer_context)->append(data, size);
+    return 0;
+}
+
+class TraceTest : public ::testing::Test {
+protected:
+    ARMD_MemoryAllocator memory_allocator;
+    ARMD_Context *context;
+    ARMD_Procedure *tree_procedure;
+
+    TraceTest() {}
+
+    ~TraceTest() override {}
+
+    void SetUp() override {
+        armd_memory_allocator_init_default(&memory_allocator);
+        context = armd_context_create(&memory_allocator,
+                                      aramid::test::get_num_executors());
+
+        ARMD_ProcedureBuilder *builder = armd_procedure_builder_create(
+            &memory_allocator, sizeof(TreeConstants), sizeof(TreeFrame));
+        armd_then_single(builder, tree_continuation);
+        tree_procedure = armd_procedure_builder_build_and_destroy(builder);
+
+        TreeConstants *tree_constants = reinterpret_cast<TreeConstants *>(
+            armd_procedure_get_constants(tree_procedure));
+        tree_constants->tree_procedure = tree_procedure;
+    }
+
+    void TearDown() override {
+        int res;
+
+        res = armd_procedure_destroy(tree_procedure);
+        ASSERT_EQ(res, 0);
+
+        res = armd_context_destroy(context);
+        ASSERT_EQ(res, 0);
+    }
+};
+
+#ifndef ARAMID_DISABLE_TRACING
+
+int wait_continuation(ARMD_Job *job, const void *constants, void *args,
+                      void *frame) {
+    (void)job;
+    (void)constants;
+    (void)frame;
+
+    std::atomic<bool> *released = reinterpret_cast<std::atomic<bool> *>(args);
+    while (!released->load()) {
+    }
+
+    return 0;
+}
+
+int fail_to_write(void *writer_context, const char *data, ARMD_Size size) {
+    (void)writer_context;
+    (void)data;
+    (void)size;
+    return -1;
+}
+
+ARMD_Size count(const std::string &str, const std::string &pattern) {
+    ARMD_Size result = 0;
+    for (std::string::size_type pos = str.find(pattern);
+         pos != std::string::npos; pos = str.find(pattern, pos + 1)) {
+        ++result;
+    }
+    return result;
+}
+
+TEST_F(TraceTest, WriteChromeTrace) {
+    int res;
+
+    res = armd_context_enable_tracing(context, 1024 * 1024);
+    ASSERT_EQ(res, 0);
+
+    ARMD_Procedure *wait_procedure;
+    {
+        ARMD_ProcedureBuilder *builder =
+            armd_procedure_builder_create(&memory_allocator, 0, 0);
+        armd_then_single(builder, wait_continuation);
+        wait_procedure = armd_procedure_builder_build_and_destroy(builder);
+    }
+
+    TreeArgs args;
+    args.depth = 6;
+
+    // The dependency is held until the dependent is invoked
+    std::atomic<bool> released(false);
+    ARMD_Handle promise1 =
+        armd_invoke(context, wait_procedure, &released, 0, nullptr);
+    ASSERT_NE(promise1, 0u);
+
+    ARMD_Handle promise2 =
+        armd_invoke(context, tree_procedure, &args, 1, &promise1);
+    ASSERT_NE(promise2, 0u);
+    released.store(true);
+
+    ARMD_Handle promise3 =
+        armd_invoke(context, tree_procedure, &args, 0, nullptr);
+    ASSERT_NE(promise3, 0u);
+
+    res = armd_await(context, promise1);
+    ASSERT_EQ(res, 0);
+    res = armd_await(context, promise2);
+    ASSERT_EQ(res, 0);
+    res = armd_await(context, promise3);
+    ASSERT_EQ(res, 0);
+
+    res = armd_context_disable_tracing(context);
+    ASSERT_EQ(res, 0);
+
+    // Not recorded
+    ARMD_Handle promise4 =
+        armd_invoke(context, tree_procedure, &args, 0, nullptr);
+    ASSERT_NE(promise4, 0u);
+    res = armd_await(context, promise4);
+    ASSERT_EQ(res, 0);
+
+    std::string trace;
+    res = armd_context_write_trace(context, write_to_string, &trace);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_EQ(trace.compare(0, 16, "{\"traceEvents\":["), 0);
+    ASSERT_EQ(trace.compare(trace.size() - 4, 4, "\n]}\n"), 0);
+
+    // The waiting job and two trees of 127 jobs, each running one continuation
+    const ARMD_Size num_tree_jobs = 2 * 127;
+    ASSERT_EQ(count(trace, "\"cat\":\"job\",\"ph\":\"B\""),
+              num_tree_jobs + 1);
+    ASSERT_EQ(count(trace, "\"cat\":\"job\",\"ph\":\"E\""),
+              num_tree_jobs + 1);
+    ASSERT_EQ(count(trace, "\"name\":\"fork\""), num_tree_jobs - 2);
+    ASSERT_EQ(count(trace, "\"name\":\"promise complete\""), 3u);
+    ASSERT_EQ(count(trace, "\"name\":\"dependency release\""), 1u);
+
+    // Executors may be parked when tracing is enabled or disabled
+    const ARMD_Size num_executors =
+        static_cast<ARMD_Size>(aramid::test::get_num_executors());
+    const std::string park = "\"name\":\"park\",\"cat\":\"scheduler\",";
+    ARMD_Size num_parks = count(trace, park + "\"ph\":\"B\"");
+    ARMD_Size num_unparks = count(trace, park + "\"ph\":\"E\"");
+    ASSERT_LE(num_parks, num_unparks + num_executors);
+    ASSERT_LE(num_unparks, num_parks + num_executors);
+
+    ASSERT_EQ(count(trace, "\"name\":\"thread_name\""), num_executors);
+
+    res = armd_context_write_trace(context, fail_to_write, nullptr);
+    ASSERT_NE(res, 0);
+
+    res = armd_procedure_destroy(wait_procedure);
+    ASSERT_EQ(res, 0);
+}
+
+TEST_F(TraceTest, OverwriteOldest) {
+    int res;
+
+    res = armd_context_enable_tracing(context, 16);
+    ASSERT_EQ(res, 0);
+
+    TreeArgs args;
+    args.depth = 6;
+
+    ARMD_Handle promise =
+        armd_invoke(context, tree_procedure, &args, 0, nullptr);
+    ASSERT_NE(promise, 0u);
+    res = armd_await(context, promise);
+    ASSERT_EQ(res, 0);
+
+    std::string trace;
+    res = armd_context_write_trace(context, write_to_string, &trace);
+    ASSERT_EQ(res, 0);
+
+    ASSERT_LE(count(trace, "\"ph\":\""),
+              static_cast<ARMD_Size>(aramid::test::get_num_executors()) *
+                  (16 + 1));
+}
+
+#else
+
+TEST_F(TraceTest, Unavailable) {
+    std::string trace;
+    ASSERT_NE(armd_context_enable_tracing(context, 1024), 0);
+    ASSERT_NE(armd_context_write_trace(context, write_to_string, &trace), 0);
+}
+
+#endif
+
+} // namespace
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <aramid/aramid.h>
+
+// The file layout is private to the library
+#include "../../lib/src/flight_recorder.h"
+
+// Prints the scheduler events and the log records kept in a flight recorder
+// file, merged in the order of time.
+
+namespace {
+
+struct Entry {
+    ARMD_Timespec timespec;
+    std::string text;
+};
+
+struct DecoderContext {
+    ARMD_MemoryRegion *memory_region;
+    std::vector<Entry> entries;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "Usage: %s FILE\n"
+                 "  Decode a flight recorder file written by the aramid\n"
+                 "  executors and logger.\n",
+                 program);
+}
+
+bool read_all(std::FILE *file, std::vector<char> *data) {
+    char buf[65536];
+    std::size_t size;
+    while ((size = std::fread(buf, 1, sizeof(buf), file)) != 0) {
+        data->insert(data->end(), buf, buf + size);
+    }
+    return std::ferror(file) == 0;
+}
+
+const char *get_event_name(ARMD__TraceEventType type) {
+    switch (type) {
+    case ARMD__TraceEventType_JobBegin:
+        return "job begin";
+    case ARMD__TraceEventType_JobEnd:
+        return "job end";
+    case ARMD__TraceEventType_Fork:
+        return "fork";
+    case ARMD__TraceEventType_Steal:
+        return "steal";
+    case ARMD__TraceEventType_Park:
+        return "park";
+    case ARMD__TraceEventType_Unpark:
+        return "unpark";
+    case ARMD__TraceEventType_PromiseComplete:
+        return "promise complete";
+    case ARMD__TraceEventType_DependencyRelease:
+        return "dependency release";
+    default:
+        return "unknown";
+    }
+}
+
+const char *get_level_name(ARMD_LogLevel level) {
+    switch (level) {
+    case ARMD_LogLevel_Fatal:
+        return "FATAL";
+    case ARMD_LogLevel_Error:
+        return "ERROR";
+    case ARMD_LogLevel_Warn:
+        return "WARN ";
+    case ARMD_LogLevel_Info:
+        return "INFO ";
+    case ARMD_LogLevel_Debug:
+        return "DEBUG";
+    case ARMD_LogLevel_Trace:
+        return "TRACE";
+    default:
+        return "UNK  ";
+    }
+}
+
+int add_trace_event(void *decoder_context,
+                    const ARMD__FlightTraceEvent *trace_event) {
+    DecoderContext *context =
+        reinterpret_cast<DecoderContext *>(decoder_context);
+
+    // The argument is the procedure, the victim or the promise handle
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "EVENT executor %u %s 0x%llx",
+                  (unsigned)trace_event->executor_id,
+                  get_event_name(trace_event->type),
+                  (unsigned long long)trace_event->arg);
+
+    Entry entry;
+    entry.timespec = trace_event->timespec;
+    entry.text = buf;
+    context->entries.push_back(entry);
+
+    return 0;
+}
+
+int add_log_element(void *decoder_context,
+                    const ARMD_LogElement *log_element) {
+    DecoderContext *context =
+        reinterpret_cast<DecoderContext *>(decoder_context);
+
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "%s %s:%lu ",
+                  get_level_name(log_element->level), log_element->filename,
+                  (unsigned long)log_element->lineno);
+
+    Entry entry;
+    entry.timespec = log_element->timespec;
+    entry.text = std::string(buf) + log_element->message;
+    context->entries.push_back(entry);
+
+    return 0;
+}
+
+bool is_earlier(const Entry &lhs, const Entry &rhs) {
+    if (lhs.timespec.seconds != rhs.timespec.seconds) {
+        return lhs.timespec.seconds < rhs.timespec.seconds;
+    }
+    return lhs.timespec.nanoseconds < rhs.timespec.nanoseconds;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::FILE *file = std::fopen(argv[1], "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<char> data;
+    bool read = read_all(file, &data);
+    std::fclose(file);
+    if (!read) {
+        std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+
+    DecoderContext context;
+    context.memory_region = armd_memory_region_create(&memory_allocator);
+
+    int res = armd__flight_recorder_decode(data.data(), data.size(),
+                                           add_trace_event, add_log_element,
+                                           &context);
+    if (res != 0) {
+        armd_memory_region_destroy(context.memory_region);
+        std::fprintf(stderr,
+                     "%s is not a flight recorder file of this platform\n",
+                     argv[1]);
+        return 1;
+    }
+
+    // Each lane is in order, so merge them by time
+    std::stable_sort(context.entries.begin(), context.entries.end(),
+                     is_earlier);
+
+    for (const Entry &entry : context.entries) {
+        char *timestamp =
+            armd_format_time_iso8601(context.memory_region, &entry.timespec);
+        std::printf("%s %s\n", timestamp != nullptr ? timestamp : "-",
+                    entry.text.c_str());
+        if (timestamp != nullptr) {
+            armd_memory_region_free(context.memory_region, timestamp);
+        }
+    }
+
+    armd_memory_region_destroy(context.memory_region);
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <aramid/aramid.h>
+
+// Prints the records written by armd_logger_set_binary_writer in the same
+// form as armd_logger_set_stdout_callback.
+
+namespace {
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "Usage: %s FILE\n"
+                 "  Decode a binary log written by the aramid logger. FILE\n"
+                 "  may be - for the standard input.\n",
+                 program);
+}
+
+bool read_all(std::FILE *file, std::vector<char> *data) {
+    char buf[65536];
+    std::size_t size;
+    while ((size = std::fread(buf, 1, sizeof(buf), file)) != 0) {
+        data->insert(data->end(), buf, buf + size);
+    }
+    return std::ferror(file) == 0;
+}
+
+const char *get_level_name(ARMD_LogLevel level) {
+    switch (level) {
+    case ARMD_LogLevel_Fatal:
+        return "FATAL";
+    case ARMD_LogLevel_Error:
+        return "ERROR";
+    case ARMD_LogLevel_Warn:
+        return "WARN ";
+    case ARMD_LogLevel_Info:
+        return "INFO ";
+    case ARMD_LogLevel_Debug:
+        return "DEBUG";
+    case ARMD_LogLevel_Trace:
+        return "TRACE";
+    default:
+        return "UNK  ";
+    }
+}
+
+int print_element(void *decoder_context, const ARMD_LogElement *log_element) {
+    ARMD_MemoryRegion *memory_region =
+        reinterpret_cast<ARMD_MemoryRegion *>(decoder_context);
+
+    // The timestamps are formatted only here
+    char *timestamp =
+        armd_format_time_iso8601(memory_region, &log_element->timespec);
+    std::printf("%s %s %s:%lu %s\n", timestamp != nullptr ? timestamp : "-",
+                get_level_name(log_element->level),
+                log_element->filename != nullptr ? log_element->filename : "-",
+                (unsigned long)log_element->lineno, log_element->message);
+    if (timestamp != nullptr) {
+        armd_memory_region_free(memory_region, timestamp);
+    }
+
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bool from_stdin = std::strcmp(argv[1], "-") == 0;
+    std::FILE *file = from_stdin ? stdin : std::fopen(argv[1], "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<char> data;
+    bool read = read_all(file, &data);
+    if (!from_stdin) {
+        std::fclose(file);
+    }
+    if (!read) {
+        std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    ARMD_MemoryAllocator memory_allocator;
+    armd_memory_allocator_init_default(&memory_allocator);
+    ARMD_MemoryRegion *memory_region =
+        armd_memory_region_create(&memory_allocator);
+
+    int res = armd_logger_decode_binary(memory_region, data.data(),
+                                        data.size(), print_element,
+                                        memory_region);
+
+    armd_memory_region_destroy(memory_region);
+
+    if (res != 0) {
+        std::fprintf(stderr, "%s is not a binary log of this platform or "
+                             "is corrupted\n",
+                     argv[1]);
+        return 1;
+    }
+
+    return 0;
+}